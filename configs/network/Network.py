@@ -111,6 +111,14 @@ def define_options(parser):
         default=50000,
         help="network-level deadlock threshold.",
     )
+    parser.add_argument(
+        "--garnet-parallel-threads",
+        action="store",
+        type=int,
+        default=0,
+        help="""number of host threads evaluating the garnet routers.
+            0 evaluates them serially.""",
+    )
     parser.add_argument(
         "--simple-physical-channels",
         action="store_true",
@@ -169,6 +177,7 @@ def init_network(options, network, InterfaceClass):
         network.ni_flit_size = options.link_width_bits / 8
         network.routing_algorithm = options.routing_algorithm
         network.garnet_deadlock_threshold = options.garnet_deadlock_threshold
+        network.parallel_threads = options.garnet_parallel_threads
 
         # Create Bridges and connect them to the corresponding links
         for intLink in network.int_links:
@@ -229,6 +229,14 @@ class ThreadContext : public gem5::ThreadContext
 
     void sendFunctional(PacketPtr pkt) override;
 
+    void
+    sendMemBackdoorReq(const MemBackdoorReq &req,
+                       MemBackdoorPtr &backdoor) override
+    {
+        // Memory is accessed through the fast model, which doesn't hand
+        // out back doors.
+    }
+
     Process *
     getProcessPtr() override
     {
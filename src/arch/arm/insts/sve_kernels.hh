@@ -0,0 +1,389 @@
+/*
+ * Copyright (c) 2024 The University of Edinburgh
+ * All rights reserved
+ *
+ * The license below extends only to copyright in the software and shall
+ * not be construed as granting a license to any other intellectual
+ * property including but not limited to intellectual property relating
+ * to a hardware implementation of the functionality of the software
+ * licensed hereunder.  You may use the software subject to the license
+ * terms below provided that you ensure that this notice is replicated
+ * unmodified and in its entirety in all distributions of the software,
+ * modified or unmodified, in source code or in binary form.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Host SIMD implementations of the element-wise integer operations,
+ * predicated moves and reductions used by the SVE instructions.
+ *
+ * The kernels work on the raw element arrays of a vector register and
+ * on the one-bool-per-byte representation of a predicate register.
+ * They use the GCC/Clang generic vector extensions, which compile to
+ * whatever SIMD instructions the host has, and process any remaining
+ * elements (or element types the extensions don't support) with the
+ * scalar loops in the scalar namespace, which are also the reference
+ * the vector code must match bit for bit.
+ */
+
+#ifndef __ARCH_ARM_INSTS_SVE_KERNELS_HH__
+#define __ARCH_ARM_INSTS_SVE_KERNELS_HH__
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace gem5
+{
+
+namespace ArmISA
+{
+
+namespace sve_kernels
+{
+
+/** Size in bytes of the host vectors the kernels operate on. */
+#if defined(__AVX2__)
+constexpr std::size_t HostVecBytes = 32;
+#else
+constexpr std::size_t HostVecBytes = 16;
+#endif
+
+/** Predicate bytes can be loaded straight into lane masks. */
+constexpr bool HostLittleEndian =
+    __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__;
+
+/**
+ * Host vector type for an element type. Only plain integer elements of
+ * up to 64 bits are vectorized; everything else uses the scalar code.
+ */
+template <typename Element, typename Enable=void>
+struct HostVec
+{
+    static constexpr bool enabled = false;
+};
+
+template <typename Element>
+struct HostVec<Element, std::enable_if_t<
+    std::is_integral_v<Element> && !std::is_same_v<Element, bool> &&
+    sizeof(Element) <= 8>>
+{
+    static constexpr bool enabled = true;
+    static constexpr unsigned lanes = HostVecBytes / sizeof(Element);
+
+    typedef Element Type __attribute__((vector_size(HostVecBytes)));
+
+    static Type
+    load(const Element *ptr)
+    {
+        Type v;
+        std::memcpy(&v, ptr, sizeof(v));
+        return v;
+    }
+
+    static void
+    store(Element *ptr, const Type &v)
+    {
+        std::memcpy(ptr, &v, sizeof(v));
+    }
+
+    static Type splat(Element e) { return Type{} + e; }
+
+    /**
+     * Build a lane mask (all ones for active lanes) from the predicate
+     * bits of lanes [first, first + lanes). Each element owns
+     * sizeof(Element) predicate bits, of which only the lowest counts.
+     */
+    static Type
+    predMask(const bool *pred, unsigned first)
+    {
+        static_assert(sizeof(bool) == 1);
+        if constexpr (HostLittleEndian) {
+            // The predicate bytes of a lane line up with the lane's
+            // bytes, the lowest one being its governing bit
+            Type bits;
+            std::memcpy(&bits, pred + first * sizeof(Element), sizeof(bits));
+            return (Type)((bits & (Element)0xff) != 0);
+        } else {
+            Type m;
+            for (unsigned j = 0; j < lanes; j++)
+                m[j] = pred[(first + j) * sizeof(Element)] ? ~(Element)0 : 0;
+            return m;
+        }
+    }
+};
+
+/**
+ * Select between a and b by cond, for both scalars (bool condition)
+ * and vectors (lane mask as produced by a vector comparison).
+ */
+template <typename T, typename Cond>
+inline T
+choose(const Cond &cond, const T &a, const T &b)
+{
+    if constexpr (std::is_same_v<Cond, bool>) {
+        return cond ? a : b;
+    } else {
+        return ((T)cond & a) | (~(T)cond & b);
+    }
+}
+
+/** Operations usable on both elements and host vectors. */
+struct Add
+{
+    template <typename T> T operator()(T a, T b) const { return a + b; }
+};
+
+struct Sub
+{
+    template <typename T> T operator()(T a, T b) const { return a - b; }
+};
+
+struct Mul
+{
+    template <typename T> T operator()(T a, T b) const { return a * b; }
+};
+
+struct And
+{
+    template <typename T> T operator()(T a, T b) const { return a & b; }
+};
+
+struct Orr
+{
+    template <typename T> T operator()(T a, T b) const { return a | b; }
+};
+
+struct Eor
+{
+    template <typename T> T operator()(T a, T b) const { return a ^ b; }
+};
+
+struct Bic
+{
+    template <typename T> T operator()(T a, T b) const { return a & ~b; }
+};
+
+struct Max
+{
+    template <typename T> T
+    operator()(T a, T b) const { return choose(a > b, a, b); }
+};
+
+struct Min
+{
+    template <typename T> T
+    operator()(T a, T b) const { return choose(a < b, a, b); }
+};
+
+/** Returns its first operand, for predicated selects (SEL). */
+struct First
+{
+    template <typename T> T operator()(T a, T) const { return a; }
+};
+
+/**
+ * Whether to use host vectors for an element type and operation. Hosts
+ * without 64 bit lane comparisons (x86 before SSE4.2) emulate them, which
+ * is slower than the scalar code.
+ */
+template <typename Element, typename Op>
+constexpr bool
+useHostVec()
+{
+#if defined(__x86_64__) && !defined(__SSE4_2__)
+    constexpr bool vec64_compare = false;
+#else
+    constexpr bool vec64_compare = true;
+#endif
+    constexpr bool compares =
+        std::is_same_v<Op, Max> || std::is_same_v<Op, Min>;
+    return HostVec<Element>::enabled &&
+        (vec64_compare || !compares || sizeof(Element) < 8);
+}
+
+/** Integer type twice as wide as T, with the same signedness. */
+template <typename T>
+using DoubleWidth = std::conditional_t<std::is_signed_v<T>,
+      std::conditional_t<sizeof(T) == 1, int16_t,
+          std::conditional_t<sizeof(T) == 2, int32_t, int64_t>>,
+      std::conditional_t<sizeof(T) == 1, uint16_t,
+          std::conditional_t<sizeof(T) == 2, uint32_t, uint64_t>>>;
+
+namespace scalar
+{
+
+template <typename Element, typename Op>
+inline void
+binary(Element *dest, const Element *src1, const Element *src2,
+       unsigned first, unsigned count, Op op)
+{
+    for (unsigned i = first; i < count; i++)
+        dest[i] = op(src1[i], src2[i]);
+}
+
+template <typename Element, typename Op>
+inline void
+predBinary(Element *dest, const Element *src1, const Element *src2,
+           const Element *inactive, const bool *pred,
+           unsigned first, unsigned count, Op op)
+{
+    for (unsigned i = first; i < count; i++) {
+        dest[i] = pred[i * sizeof(Element)] ?
+            op(src1[i], src2[i]) : inactive[i];
+    }
+}
+
+template <typename Acc, typename Element, typename Op>
+inline Acc
+reduce(const Element *src, const bool *pred, unsigned first,
+       unsigned count, Acc acc, Op op)
+{
+    for (unsigned i = first; i < count; i++) {
+        if (pred[i * sizeof(Element)])
+            acc = op(acc, (Acc)src[i]);
+    }
+    return acc;
+}
+
+} // namespace scalar
+
+/** dest[i] = op(src1[i], src2[i]) for all i < count. */
+template <typename Element, typename Op>
+inline void
+binary(Element *dest, const Element *src1, const Element *src2,
+       unsigned count, Op op)
+{
+    unsigned i = 0;
+    if constexpr (useHostVec<Element, Op>()) {
+        using V = HostVec<Element>;
+        for (; i + V::lanes <= count; i += V::lanes)
+            V::store(dest + i, op(V::load(src1 + i), V::load(src2 + i)));
+    }
+    scalar::binary(dest, src1, src2, i, count, op);
+}
+
+/**
+ * dest[i] = op(src1[i], src2[i]) for the elements active in pred, and
+ * dest[i] = inactive[i] for the others.
+ */
+template <typename Element, typename Op>
+inline void
+predBinary(Element *dest, const Element *src1, const Element *src2,
+           const Element *inactive, const bool *pred, unsigned count, Op op)
+{
+    unsigned i = 0;
+    if constexpr (useHostVec<Element, Op>()) {
+        using V = HostVec<Element>;
+        for (; i + V::lanes <= count; i += V::lanes) {
+            V::store(dest + i, choose(V::predMask(pred, i),
+                        op(V::load(src1 + i), V::load(src2 + i)),
+                        V::load(inactive + i)));
+        }
+    }
+    scalar::predBinary(dest, src1, src2, inactive, pred, i, count, op);
+}
+
+/**
+ * Fold the active elements of src into identity with an associative
+ * and commutative op, in the element type.
+ */
+template <typename Element, typename Op>
+inline Element
+reduce(const Element *src, const bool *pred, unsigned count,
+       Element identity, Op op)
+{
+    Element acc = identity;
+    unsigned i = 0;
+    if constexpr (useHostVec<Element, Op>()) {
+        using V = HostVec<Element>;
+        const typename V::Type videntity = V::splat(identity);
+        typename V::Type vacc = videntity;
+        for (; i + V::lanes <= count; i += V::lanes) {
+            vacc = op(vacc, choose(V::predMask(pred, i), V::load(src + i),
+                        videntity));
+        }
+        for (unsigned j = 0; j < V::lanes; j++)
+            acc = op(acc, (Element)vacc[j]);
+    }
+    return scalar::reduce(src, pred, i, count, acc, op);
+}
+
+/**
+ * Fold the active elements of src into identity with an associative
+ * and commutative op, after widening each of them to Acc. Only sums,
+ * the one widening reduction SVE has, are vectorized.
+ */
+template <typename Acc, typename Element, typename Op>
+inline Acc
+reduceWiden(const Element *src, const bool *pred, unsigned count,
+            Acc identity, Op op)
+{
+    Acc acc = identity;
+    unsigned i = 0;
+    if constexpr (std::is_same_v<Op, Add> && useHostVec<Element, Op>() &&
+                  sizeof(Element) == sizeof(Acc)) {
+        return reduce(src, pred, count, (Element)identity, op);
+    } else if constexpr (std::is_same_v<Op, Add> &&
+                         useHostVec<Element, Op>()) {
+        using V = HostVec<Element>;
+        using M = HostVec<DoubleWidth<Element>>;
+        using UM = HostVec<std::make_unsigned_t<DoubleWidth<Element>>>;
+        constexpr unsigned shift = 8 * sizeof(Element);
+        // Each chunk adds at most 2 * 2^shift to a lane, so the double
+        // width lanes can't overflow in this many chunks
+        constexpr unsigned max_chunks = 64;
+
+        typename M::Type vacc{};
+        unsigned chunks = 0;
+        for (; i + V::lanes <= count; i += V::lanes) {
+            typename V::Type elems = choose(V::predMask(pred, i),
+                    V::load(src + i), typename V::Type{});
+            // Add the two elements in each double width lane, sign or
+            // zero extending them as the shifts are on M
+            typename UM::Type w = (typename UM::Type)elems;
+            vacc += ((typename M::Type)(w << shift) >> shift) +
+                ((typename M::Type)w >> shift);
+            if (++chunks == max_chunks) {
+                for (unsigned j = 0; j < M::lanes; j++)
+                    acc += (Acc)vacc[j];
+                vacc = typename M::Type{};
+                chunks = 0;
+            }
+        }
+        for (unsigned j = 0; j < M::lanes; j++)
+            acc += (Acc)vacc[j];
+    }
+    return scalar::reduce(src, pred, i, count, acc, op);
+}
+
+} // namespace sve_kernels
+
+} // namespace ArmISA
+} // namespace gem5
+
+#endif // __ARCH_ARM_INSTS_SVE_KERNELS_HH__
@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2024 The University of Edinburgh
+ * All rights reserved
+ *
+ * The license below extends only to copyright in the software and shall
+ * not be construed as granting a license to any other intellectual
+ * property including but not limited to intellectual property relating
+ * to a hardware implementation of the functionality of the software
+ * licensed hereunder.  You may use the software subject to the license
+ * terms below provided that you ensure that this notice is replicated
+ * unmodified and in its entirety in all distributions of the software,
+ * modified or unmodified, in source code or in binary form.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <random>
+
+#include "arch/arm/insts/sve_kernels.hh"
+
+using namespace gem5::ArmISA::sve_kernels;
+
+namespace
+{
+
+// Large enough for a 2048-bit vector of bytes, plus a ragged tail
+constexpr unsigned MaxElems = 256 + 7;
+
+template <typename Element>
+struct Operands
+{
+    std::array<Element, MaxElems> src1, src2, inactive, dest, ref;
+    std::array<bool, MaxElems * sizeof(Element)> pred;
+
+    explicit Operands(unsigned seed)
+    {
+        std::mt19937_64 rng(seed);
+        for (unsigned i = 0; i < MaxElems; i++) {
+            src1[i] = rng();
+            src2[i] = rng();
+            inactive[i] = rng();
+        }
+        // Set the non-governing predicate bits too, they must be ignored
+        for (auto &p : pred)
+            p = rng() & 1;
+    }
+};
+
+template <typename Element, typename Op>
+void
+checkBinary(Op op)
+{
+    for (unsigned count : {1u, 16u, 17u, 64u, MaxElems}) {
+        Operands<Element> o(count);
+        binary(o.dest.data(), o.src1.data(), o.src2.data(), count, op);
+        scalar::binary(o.ref.data(), o.src1.data(), o.src2.data(), 0, count,
+                       op);
+        for (unsigned i = 0; i < count; i++)
+            ASSERT_EQ(o.dest[i], o.ref[i]) << "count " << count << " i " << i;
+    }
+}
+
+template <typename Element, typename Op>
+void
+checkPredBinary(Op op)
+{
+    for (unsigned count : {1u, 16u, 17u, 64u, MaxElems}) {
+        Operands<Element> o(count);
+        predBinary(o.dest.data(), o.src1.data(), o.src2.data(),
+                   o.inactive.data(), o.pred.data(), count, op);
+        scalar::predBinary(o.ref.data(), o.src1.data(), o.src2.data(),
+                           o.inactive.data(), o.pred.data(), 0, count, op);
+        for (unsigned i = 0; i < count; i++)
+            ASSERT_EQ(o.dest[i], o.ref[i]) << "count " << count << " i " << i;
+    }
+}
+
+template <typename Element, typename Op>
+void
+checkReduce(Element identity, Op op)
+{
+    for (unsigned count : {1u, 16u, 17u, 64u, MaxElems}) {
+        Operands<Element> o(count);
+        EXPECT_EQ(reduce(o.src1.data(), o.pred.data(), count, identity, op),
+                  scalar::reduce(o.src1.data(), o.pred.data(), 0, count,
+                                 identity, op));
+    }
+}
+
+template <typename Acc, typename Element>
+void
+checkReduceWiden()
+{
+    for (unsigned count : {1u, 16u, 17u, 64u, MaxElems}) {
+        Operands<Element> o(count);
+        EXPECT_EQ(reduceWiden(o.src1.data(), o.pred.data(), count, Acc(0),
+                              Add()),
+                  scalar::reduce(o.src1.data(), o.pred.data(), 0, count,
+                                 Acc(0), Add()));
+    }
+}
+
+template <typename Element>
+void
+checkIntegerOps()
+{
+    checkBinary<Element>(Add());
+    checkBinary<Element>(Sub());
+    checkBinary<Element>(Mul());
+    checkBinary<Element>(And());
+    checkBinary<Element>(Orr());
+    checkBinary<Element>(Eor());
+    checkBinary<Element>(Bic());
+    checkPredBinary<Element>(Add());
+    checkPredBinary<Element>(Bic());
+    checkPredBinary<Element>(Max());
+    checkPredBinary<Element>(Min());
+    checkPredBinary<Element>(First());
+    checkReduce<Element>(0, Eor());
+    checkReduce<Element>(0, Orr());
+    checkReduce<Element>(std::numeric_limits<Element>::max(), And());
+    checkReduce<Element>(std::numeric_limits<Element>::min(), Max());
+    checkReduce<Element>(std::numeric_limits<Element>::max(), Min());
+}
+
+} // anonymous namespace
+
+TEST(SveKernelsTest, Unsigned)
+{
+    checkIntegerOps<uint8_t>();
+    checkIntegerOps<uint16_t>();
+    checkIntegerOps<uint32_t>();
+    checkIntegerOps<uint64_t>();
+}
+
+TEST(SveKernelsTest, Signed)
+{
+    checkIntegerOps<int8_t>();
+    checkIntegerOps<int16_t>();
+    checkIntegerOps<int32_t>();
+    checkIntegerOps<int64_t>();
+}
+
+TEST(SveKernelsTest, WideningSum)
+{
+    checkReduceWiden<uint64_t, uint8_t>();
+    checkReduceWiden<uint64_t, uint16_t>();
+    checkReduceWiden<uint64_t, uint32_t>();
+    checkReduceWiden<uint64_t, uint64_t>();
+    checkReduceWiden<int64_t, int8_t>();
+    checkReduceWiden<int64_t, int16_t>();
+    checkReduceWiden<int64_t, int32_t>();
+}
+
+// Predicate bits above the governing one of each element are ignored
+TEST(SveKernelsTest, GoverningPredicateBit)
+{
+    std::array<uint32_t, 16> a, b, dest;
+    std::array<bool, 16 * sizeof(uint32_t)> pred{};
+    for (unsigned i = 0; i < 16; i++) {
+        a[i] = i;
+        b[i] = 100 + i;
+        pred[i * sizeof(uint32_t) + (i % 2 ? 0 : 1)] = true;
+    }
+    predBinary(dest.data(), a.data(), b.data(), b.data(), pred.data(), 16,
+               First());
+    for (unsigned i = 0; i < 16; i++)
+        EXPECT_EQ(dest[i], i % 2 ? a[i] : b[i]);
+
+    EXPECT_EQ(reduce(a.data(), pred.data(), 16, 0u, Add()),
+              1u + 3 + 5 + 7 + 9 + 11 + 13 + 15);
+}
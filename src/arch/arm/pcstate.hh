@@ -110,6 +110,11 @@ class PCState : public GenericISA::UPCState<4>
     explicit PCState(Addr val) { set(val); }
 
     PCStateBase *clone() const override { return new PCState(*this); }
+    PCStateBase *
+    cloneInto(void *mem) const override
+    {
+        return constructAt(*this, mem);
+    }
 
     void
     update(const PCStateBase &other) override
@@ -42,8 +42,10 @@
 #ifndef __ARCH_GENERIC_TYPES_HH__
 #define __ARCH_GENERIC_TYPES_HH__
 
+#include <cstddef>
 #include <iostream>
 #include <memory>
+#include <new>
 #include <type_traits>
 
 #include "base/compiler.hh"
@@ -83,6 +85,20 @@ class PCStateBase : public Serializable
     }
 
     virtual PCStateBase *clone() const = 0;
+
+    /** Largest PC state PCStateHolder can store inline. */
+    static constexpr std::size_t MaxSize = 64;
+
+    /**
+     * Copy construct this PC state in place, like clone() but without a
+     * heap allocation.
+     *
+     * @param mem Storage for the copy, MaxSize bytes aligned like
+     *     std::max_align_t.
+     * @return The copy.
+     */
+    virtual PCStateBase *cloneInto(void *mem) const = 0;
+
     virtual void
     update(const PCStateBase &other)
     {
@@ -150,6 +166,75 @@ class PCStateBase : public Serializable
         UNSERIALIZE_SCALAR(_pc);
         UNSERIALIZE_SCALAR(_upc);
     }
+
+  protected:
+    /** Helper for the cloneInto() implementations. */
+    template <class PC>
+    static PCStateBase *
+    constructAt(const PC &pc, void *mem)
+    {
+        static_assert(sizeof(PC) <= MaxSize &&
+                alignof(PC) <= alignof(std::max_align_t),
+                "PC state doesn't fit in PCStateHolder's storage");
+        return new (mem) PC(pc);
+    }
+};
+
+/**
+ * Inline storage for a PC state of any ISA. It is used like a
+ * std::unique_ptr<PCStateBase> that deep copies, but never allocates:
+ * copying into an empty holder constructs the PC state in place with
+ * cloneInto(), and copying into an occupied one update()s it.
+ */
+class PCStateHolder
+{
+  private:
+    alignas(std::max_align_t) unsigned char storage[PCStateBase::MaxSize];
+    PCStateBase *ptr = nullptr;
+
+  public:
+    PCStateHolder() {}
+    explicit PCStateHolder(const PCStateBase &pc) :
+        ptr(pc.cloneInto(storage))
+    {}
+    PCStateHolder(const PCStateHolder &other) :
+        ptr(other ? other->cloneInto(storage) : nullptr)
+    {}
+    ~PCStateHolder() { reset(); }
+
+    PCStateHolder &
+    operator=(const PCStateBase &pc)
+    {
+        if (ptr)
+            ptr->update(pc);
+        else
+            ptr = pc.cloneInto(storage);
+        return *this;
+    }
+
+    PCStateHolder &
+    operator=(const PCStateHolder &other)
+    {
+        if (other)
+            *this = *other;
+        else
+            reset();
+        return *this;
+    }
+
+    void
+    reset()
+    {
+        if (ptr) {
+            ptr->~PCStateBase();
+            ptr = nullptr;
+        }
+    }
+
+    PCStateBase *get() const { return ptr; }
+    PCStateBase &operator*() const { return *ptr; }
+    PCStateBase *operator->() const { return ptr; }
+    explicit operator bool() const { return ptr != nullptr; }
 };
 
 static inline std::ostream &
@@ -249,6 +334,40 @@ set(PCStateBase &dest, const PCStateBase &src)
     dest.update(src);
 }
 
+inline void
+set(PCStateHolder &dest, const PCStateBase &src)
+{
+    dest = src;
+}
+
+inline void
+set(PCStateHolder &dest, const PCStateBase *src)
+{
+    if (GEM5_LIKELY(src))
+        dest = *src;
+    else
+        dest.reset();
+}
+
+inline void
+set(PCStateHolder &dest, const PCStateHolder &src)
+{
+    dest = src;
+}
+
+inline void
+set(PCStateHolder &dest, const std::unique_ptr<PCStateBase> &src)
+{
+    set(dest, src.get());
+}
+
+inline void
+set(std::unique_ptr<PCStateBase> &dest, const PCStateHolder &src)
+{
+    const PCStateBase *src_ptr = src.get();
+    set(dest, src_ptr);
+}
+
 } // anonymous namespace
 
 namespace GenericISA
@@ -368,6 +487,12 @@ class SimplePCState : public PCStateWithNext
         return new SimplePCState<InstWidth>(*this);
     }
 
+    PCStateBase *
+    cloneInto(void *mem) const override
+    {
+        return this->constructAt(*this, mem);
+    }
+
     /**
      * Force this PC to reflect a particular value, resetting all its other
      * fields around it. This is useful for in place (re)initialization.
@@ -417,6 +542,12 @@ class UPCState : public SimplePCState<InstWidth>
         return new UPCState<InstWidth>(*this);
     }
 
+    PCStateBase *
+    cloneInto(void *mem) const override
+    {
+        return this->constructAt(*this, mem);
+    }
+
     void
     set(Addr val) override
     {
@@ -477,6 +608,12 @@ class DelaySlotPCState : public SimplePCState<InstWidth>
         return new DelaySlotPCState<InstWidth>(*this);
     }
 
+    PCStateBase *
+    cloneInto(void *mem) const override
+    {
+        return this->constructAt(*this, mem);
+    }
+
     void
     update(const PCStateBase &other) override
     {
@@ -562,6 +699,12 @@ class DelaySlotUPCState : public DelaySlotPCState<InstWidth>
         return new DelaySlotUPCState<InstWidth>(*this);
     }
 
+    PCStateBase *
+    cloneInto(void *mem) const override
+    {
+        return this->constructAt(*this, mem);
+    }
+
     void
     set(Addr val)
     {
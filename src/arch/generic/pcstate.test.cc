@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2024 The University of Edinburgh
+ * All rights reserved
+ *
+ * The license below extends only to copyright in the software and shall
+ * not be construed as granting a license to any other intellectual
+ * property including but not limited to intellectual property relating
+ * to a hardware implementation of the functionality of the software
+ * licensed hereunder.  You may use the software subject to the license
+ * terms below provided that you ensure that this notice is replicated
+ * unmodified and in its entirety in all distributions of the software,
+ * modified or unmodified, in source code or in binary form.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <memory>
+
+#include "arch/generic/pcstate.hh"
+
+using namespace gem5;
+
+using UPCState = GenericISA::UPCState<4>;
+using DelaySlotUPCState = GenericISA::DelaySlotUPCState<4>;
+
+TEST(PCStateHolderTest, Empty)
+{
+    PCStateHolder holder;
+    EXPECT_FALSE(holder);
+    EXPECT_EQ(holder.get(), nullptr);
+
+    PCStateHolder copy(holder);
+    EXPECT_FALSE(copy);
+}
+
+TEST(PCStateHolderTest, StoresInline)
+{
+    UPCState pc(0x1000);
+    PCStateHolder holder(pc);
+    ASSERT_TRUE(holder);
+
+    auto *begin = reinterpret_cast<const char *>(&holder);
+    auto *stored = reinterpret_cast<const char *>(holder.get());
+    EXPECT_GE(stored, begin);
+    EXPECT_LT(stored, begin + sizeof(holder));
+
+    EXPECT_EQ(*holder, pc);
+    EXPECT_EQ(holder->as<UPCState>().npc(), 0x1004);
+}
+
+TEST(PCStateHolderTest, CopyIsIndependent)
+{
+    PCStateHolder a(UPCState(0x1000));
+    PCStateHolder b(a);
+    b->advance();
+    EXPECT_EQ(a->instAddr(), 0x1000);
+    EXPECT_EQ(b->instAddr(), 0x1004);
+
+    a = b;
+    EXPECT_EQ(*a, *b);
+    EXPECT_NE(a.get(), b.get());
+}
+
+TEST(PCStateHolderTest, Set)
+{
+    DelaySlotUPCState pc(0x2000);
+    PCStateHolder holder;
+    set(holder, pc);
+    EXPECT_EQ(*holder, pc);
+
+    pc.advance();
+    set(holder, pc);
+    EXPECT_EQ(holder->as<DelaySlotUPCState>().nnpc(), pc.nnpc());
+
+    std::unique_ptr<PCStateBase> ptr;
+    set(ptr, holder);
+    ASSERT_TRUE(ptr);
+    EXPECT_EQ(*ptr, pc);
+
+    set(holder, std::unique_ptr<PCStateBase>());
+    EXPECT_FALSE(holder);
+}
@@ -0,0 +1,275 @@
+/*
+ * Copyright (c) 2024 The University of Edinburgh
+ * All rights reserved
+ *
+ * The license below extends only to copyright in the software and shall
+ * not be construed as granting a license to any other intellectual
+ * property including but not limited to intellectual property relating
+ * to a hardware implementation of the functionality of the software
+ * licensed hereunder.  You may use the software subject to the license
+ * terms below provided that you ensure that this notice is replicated
+ * unmodified and in its entirety in all distributions of the software,
+ * modified or unmodified, in source code or in binary form.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __ARCH_GENERIC_TLB_ARRAY_HH__
+#define __ARCH_GENERIC_TLB_ARRAY_HH__
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "base/intmath.hh"
+#include "base/logging.hh"
+#include "base/types.hh"
+
+namespace gem5
+{
+
+/**
+ * Set associative storage for the entries of a TLB, or of any other
+ * structure caching translations, that holds pages of several sizes.
+ *
+ * Entries are tagged with the virtual page number, the size of the
+ * page and a context, such as an ASID, and are placed in the set
+ * selected by their page number. A lookup probes the set of every page
+ * size in turn, so it costs O(assoc) per page size and never
+ * allocates. Replacement is LRU within a set.
+ *
+ * The ISA specific payload is stored by value, and the array does not
+ * interpret it.
+ */
+template <class Entry>
+class SetAssocTLBArray
+{
+  public:
+    /** What an entry is looked up by. */
+    struct Tag
+    {
+        /// Virtual address shifted right by the page size
+        Addr vpn;
+        /// Size of the page, in address bits
+        unsigned pageShift;
+        uint64_t context;
+
+        /** Start of the virtual page. */
+        Addr vaddr() const { return vpn << pageShift; }
+    };
+
+  private:
+    struct Way
+    {
+        Tag tag;
+        bool valid;
+        uint64_t lastUse;
+        Entry entry;
+    };
+
+    const size_t _assoc;
+    const size_t numSets;
+
+    /** Page sizes held, probed in this order on lookups. */
+    const std::vector<unsigned> pageShifts;
+
+    /** All entries, set after set. */
+    std::vector<Way> ways;
+
+    /** Time stamp for LRU replacement. */
+    uint64_t useCount;
+
+    Way *
+    setOf(Addr vpn)
+    {
+        return &ways[(vpn & (numSets - 1)) * _assoc];
+    }
+
+    Way *
+    find(Addr vpn, unsigned page_shift, uint64_t context)
+    {
+        if (ways.empty())
+            return nullptr;
+
+        Way *set = setOf(vpn);
+        for (size_t i = 0; i < _assoc; i++) {
+            Way &way = set[i];
+            if (way.valid && way.tag.vpn == vpn &&
+                way.tag.pageShift == page_shift &&
+                way.tag.context == context) {
+                return &way;
+            }
+        }
+        return nullptr;
+    }
+
+  public:
+    /**
+     * @param entries Total number of entries, may be zero
+     * @param assoc Associativity, zero for fully associative
+     * @param page_shifts Sizes of the pages held, in address bits
+     */
+    SetAssocTLBArray(size_t entries, size_t assoc,
+                     std::vector<unsigned> page_shifts) :
+        _assoc(assoc && assoc < entries ? assoc : entries),
+        numSets(entries ? entries / _assoc : 0),
+        pageShifts(std::move(page_shifts)), ways(entries), useCount(0)
+    {
+        fatal_if(entries && (entries % _assoc || !isPowerOf2(numSets)),
+                 "%d TLB entries cannot be split into a power of two "
+                 "number of %d-way sets\n", entries, _assoc);
+        fatal_if(pageShifts.empty(), "A TLB needs at least one page size\n");
+        for (auto &way : ways)
+            way.valid = false;
+    }
+
+    size_t size() const { return ways.size(); }
+    size_t assoc() const { return _assoc; }
+
+    /**
+     * Find the entry translating an address, of any page size.
+     *
+     * @param touch Whether the lookup counts as a use of the entry
+     * @return The entry or nullptr
+     */
+    Entry *
+    lookup(Addr vaddr, uint64_t context, bool touch = true)
+    {
+        for (unsigned shift : pageShifts) {
+            if (Entry *entry = lookup(vaddr, shift, context, touch))
+                return entry;
+        }
+        return nullptr;
+    }
+
+    /**
+     * Find the entry translating an address with a page of one size.
+     */
+    Entry *
+    lookup(Addr vaddr, unsigned page_shift, uint64_t context,
+           bool touch = true)
+    {
+        Way *way = find(vaddr >> page_shift, page_shift, context);
+        if (!way)
+            return nullptr;
+        if (touch)
+            way->lastUse = ++useCount;
+        return &way->entry;
+    }
+
+    /**
+     * Insert an entry, replacing the one with the same tag if any, or
+     * else an invalid or the least recently used one of its set.
+     *
+     * @return The entry in the array, or nullptr if it has no entries
+     */
+    Entry *
+    insert(Addr vaddr, unsigned page_shift, uint64_t context,
+           const Entry &entry)
+    {
+        if (ways.empty())
+            return nullptr;
+
+        const Addr vpn = vaddr >> page_shift;
+        Way *victim = find(vpn, page_shift, context);
+        if (!victim) {
+            Way *set = setOf(vpn);
+            victim = &set[0];
+            for (size_t i = 1; i < _assoc && victim->valid; i++) {
+                if (!set[i].valid || set[i].lastUse < victim->lastUse)
+                    victim = &set[i];
+            }
+        }
+
+        victim->tag = Tag{vpn, page_shift, context};
+        victim->valid = true;
+        victim->lastUse = ++useCount;
+        victim->entry = entry;
+        return &victim->entry;
+    }
+
+    /**
+     * Invalidate the entry translating an address, of any page size.
+     *
+     * @return Whether there was one
+     */
+    bool
+    invalidate(Addr vaddr, uint64_t context)
+    {
+        for (unsigned shift : pageShifts) {
+            if (Way *way = find(vaddr >> shift, shift, context)) {
+                way->valid = false;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * Invalidate the entries a predicate taking the tag and the entry
+     * selects.
+     */
+    template <class Pred>
+    void
+    invalidateIf(Pred pred)
+    {
+        for (auto &way : ways) {
+            if (way.valid && pred(way.tag, way.entry))
+                way.valid = false;
+        }
+    }
+
+    /** Invalidate all entries. */
+    void
+    flush()
+    {
+        for (auto &way : ways)
+            way.valid = false;
+    }
+
+    /** Call a function with the tag and entry of all valid entries. */
+    template <class Func>
+    void
+    forEach(Func func) const
+    {
+        for (const auto &way : ways) {
+            if (way.valid)
+                func(way.tag, way.entry);
+        }
+    }
+
+    /** Number of valid entries. */
+    size_t
+    occupancy() const
+    {
+        size_t count = 0;
+        for (const auto &way : ways)
+            count += way.valid;
+        return count;
+    }
+};
+
+} // namespace gem5
+
+#endif // __ARCH_GENERIC_TLB_ARRAY_HH__
@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2024 The University of Edinburgh
+ * All rights reserved
+ *
+ * The license below extends only to copyright in the software and shall
+ * not be construed as granting a license to any other intellectual
+ * property including but not limited to intellectual property relating
+ * to a hardware implementation of the functionality of the software
+ * licensed hereunder.  You may use the software subject to the license
+ * terms below provided that you ensure that this notice is replicated
+ * unmodified and in its entirety in all distributions of the software,
+ * modified or unmodified, in source code or in binary form.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "arch/generic/tlb_array.hh"
+
+using namespace gem5;
+
+TEST(SetAssocTLBArray, Empty)
+{
+    SetAssocTLBArray<int> array(0, 4, {12});
+    ASSERT_EQ(0, array.size());
+    ASSERT_EQ(nullptr, array.insert(0x1000, 12, 0, 1));
+    ASSERT_EQ(nullptr, array.lookup(0x1000, 0));
+}
+
+TEST(SetAssocTLBArray, PageSizes)
+{
+    SetAssocTLBArray<int> array(16, 4, {12, 21});
+    array.insert(0x1000, 12, 0, 1);
+    array.insert(0x40200000, 21, 0, 2);
+
+    ASSERT_EQ(1, *array.lookup(0x1fff, 0));
+    ASSERT_EQ(nullptr, array.lookup(0x2000, 0));
+    // Anywhere in the 2MiB page
+    ASSERT_EQ(2, *array.lookup(0x40200000, 0));
+    ASSERT_EQ(2, *array.lookup(0x403fffff, 0));
+    ASSERT_EQ(nullptr, array.lookup(0x40400000, 0));
+    ASSERT_EQ(2, array.occupancy());
+}
+
+TEST(SetAssocTLBArray, Context)
+{
+    SetAssocTLBArray<int> array(8, 0, {12});
+    array.insert(0x1000, 12, 1, 1);
+    array.insert(0x1000, 12, 2, 2);
+
+    ASSERT_EQ(1, *array.lookup(0x1000, 1));
+    ASSERT_EQ(2, *array.lookup(0x1000, 2));
+    ASSERT_EQ(nullptr, array.lookup(0x1000, 3));
+
+    ASSERT_TRUE(array.invalidate(0x1000, 1));
+    ASSERT_FALSE(array.invalidate(0x1000, 1));
+    ASSERT_EQ(nullptr, array.lookup(0x1000, 1));
+    ASSERT_EQ(2, *array.lookup(0x1000, 2));
+}
+
+TEST(SetAssocTLBArray, Replace)
+{
+    SetAssocTLBArray<int> array(8, 8, {12});
+    array.insert(0x1000, 12, 0, 1);
+    array.insert(0x1000, 12, 0, 2);
+    ASSERT_EQ(1, array.occupancy());
+    ASSERT_EQ(2, *array.lookup(0x1000, 0));
+}
+
+TEST(SetAssocTLBArray, LRU)
+{
+    // Two sets of two ways, even page numbers share set 0
+    SetAssocTLBArray<int> array(4, 2, {12});
+    array.insert(0x0000, 12, 0, 0);
+    array.insert(0x2000, 12, 0, 2);
+    // Make page 2 the least recently used
+    array.lookup(0x0000, 0);
+    array.insert(0x4000, 12, 0, 4);
+
+    ASSERT_EQ(0, *array.lookup(0x0000, 0));
+    ASSERT_EQ(nullptr, array.lookup(0x2000, 0));
+    ASSERT_EQ(4, *array.lookup(0x4000, 0));
+
+    // The other set is unaffected
+    array.insert(0x1000, 12, 0, 1);
+    ASSERT_EQ(1, *array.lookup(0x1000, 0));
+    ASSERT_EQ(3, array.occupancy());
+}
+
+TEST(SetAssocTLBArray, InvalidateIf)
+{
+    SetAssocTLBArray<int> array(16, 4, {12});
+    for (int i = 0; i < 8; i++)
+        array.insert(i << 12, 12, i % 2, i);
+
+    array.invalidateIf([](const SetAssocTLBArray<int>::Tag &tag, int) {
+        return tag.context == 1;
+    });
+    ASSERT_EQ(4, array.occupancy());
+    array.forEach([](const SetAssocTLBArray<int>::Tag &tag, int entry) {
+        ASSERT_EQ(0, tag.context);
+        ASSERT_EQ(tag.vaddr(), Addr(entry) << 12);
+    });
+
+    array.flush();
+    ASSERT_EQ(0, array.occupancy());
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2024 The University of Edinburgh
+ * All rights reserved
+ *
+ * The license below extends only to copyright in the software and shall
+ * not be construed as granting a license to any other intellectual
+ * property including but not limited to intellectual property relating
+ * to a hardware implementation of the functionality of the software
+ * licensed hereunder.  You may use the software subject to the license
+ * terms below provided that you ensure that this notice is replicated
+ * unmodified and in its entirety in all distributions of the software,
+ * modified or unmodified, in source code or in binary form.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "arch/generic/walk_cache.hh"
+
+namespace gem5
+{
+
+PageWalkCache::PageWalkCache(statistics::Group *parent, size_t entries,
+                             size_t assoc,
+                             const std::vector<unsigned> &level_shifts)
+    : tables(entries, assoc, level_shifts), levelShifts(level_shifts),
+      stats(parent, level_shifts.size())
+{}
+
+bool
+PageWalkCache::lookup(Addr vaddr, uint64_t context, unsigned &level,
+                      Addr &table)
+{
+    if (!enabled())
+        return false;
+
+    stats.lookups++;
+    for (unsigned l = 0; l < levelShifts.size(); l++) {
+        if (Addr *entry = tables.lookup(vaddr, levelShifts[l], context)) {
+            stats.hits[l]++;
+            level = l;
+            table = *entry;
+            return true;
+        }
+    }
+    stats.misses++;
+    return false;
+}
+
+void
+PageWalkCache::insert(unsigned level, Addr vaddr, uint64_t context,
+                      Addr table)
+{
+    assert(level < levelShifts.size());
+    tables.insert(vaddr, levelShifts[level], context, table);
+}
+
+void
+PageWalkCache::flush()
+{
+    tables.flush();
+}
+
+void
+PageWalkCache::flush(uint64_t context)
+{
+    tables.invalidateIf(
+        [context](const SetAssocTLBArray<Addr>::Tag &tag, const Addr &) {
+            return tag.context == context;
+        });
+}
+
+PageWalkCache::WalkCacheStats::WalkCacheStats(statistics::Group *parent,
+                                              unsigned levels)
+    : statistics::Group(parent, "walkCache"),
+      ADD_STAT(lookups, statistics::units::Count::get(),
+               "Number of walks looked up in the walk cache"),
+      ADD_STAT(hits, statistics::units::Count::get(),
+               "Number of walks that started at a cached table, per level"),
+      ADD_STAT(misses, statistics::units::Count::get(),
+               "Number of walks that started at the root table")
+{
+    hits.init(levels);
+}
+
+} // namespace gem5
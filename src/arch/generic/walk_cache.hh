@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2024 The University of Edinburgh
+ * All rights reserved
+ *
+ * The license below extends only to copyright in the software and shall
+ * not be construed as granting a license to any other intellectual
+ * property including but not limited to intellectual property relating
+ * to a hardware implementation of the functionality of the software
+ * licensed hereunder.  You may use the software subject to the license
+ * terms below provided that you ensure that this notice is replicated
+ * unmodified and in its entirety in all distributions of the software,
+ * modified or unmodified, in source code or in binary form.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __ARCH_GENERIC_WALK_CACHE_HH__
+#define __ARCH_GENERIC_WALK_CACHE_HH__
+
+#include <cstdint>
+#include <vector>
+
+#include "arch/generic/tlb_array.hh"
+#include "base/statistics.hh"
+#include "base/types.hh"
+
+namespace gem5
+{
+
+/**
+ * Cache of the intermediate levels of a radix page table, for a
+ * walker to skip the upper levels of a walk.
+ *
+ * Level l of the cache maps the part of a virtual address above
+ * level_shifts[l] to the physical address of the table indexed by the
+ * bits below it. Levels are numbered from the deepest table, the one
+ * holding leaf entries of the smallest pages, so that a hit at a
+ * lower level skips more of the walk.
+ */
+class PageWalkCache
+{
+  private:
+    /** Tables of all levels, the level being the index of the page size. */
+    SetAssocTLBArray<Addr> tables;
+
+    const std::vector<unsigned> levelShifts;
+
+  public:
+    /**
+     * @param parent Statistics group to register the stats with
+     * @param entries Number of tables cached, zero disables the cache
+     * @param assoc Associativity, zero for fully associative
+     * @param level_shifts Address bits covered by a table of each level,
+     *                     deepest first
+     */
+    PageWalkCache(statistics::Group *parent, size_t entries, size_t assoc,
+                  const std::vector<unsigned> &level_shifts);
+
+    bool enabled() const { return tables.size() != 0; }
+
+    /**
+     * Find the deepest table known for an address.
+     *
+     * @param level Level of the table found
+     * @param table Physical address of the table found
+     * @return Whether a table was found
+     */
+    bool lookup(Addr vaddr, uint64_t context, unsigned &level, Addr &table);
+
+    /** Record the table of a level used for an address. */
+    void insert(unsigned level, Addr vaddr, uint64_t context, Addr table);
+
+    /** Forget all tables. */
+    void flush();
+
+    /** Forget the tables of one context. */
+    void flush(uint64_t context);
+
+  private:
+    struct WalkCacheStats : public statistics::Group
+    {
+        WalkCacheStats(statistics::Group *parent, unsigned levels);
+
+        statistics::Scalar lookups;
+        statistics::Vector hits;
+        statistics::Scalar misses;
+    } stats;
+};
+
+} // namespace gem5
+
+#endif // __ARCH_GENERIC_WALK_CACHE_HH__
@@ -54,6 +54,11 @@ class PCState : public GenericISA::SimplePCState<4>
     PCState &operator=(const PCState &other) = default;
 
     PCStateBase *clone() const override { return new PCState(*this); }
+    PCStateBase *
+    cloneInto(void *mem) const override
+    {
+        return constructAt(*this, mem);
+    }
 
     void
     update(const PCStateBase &other) override
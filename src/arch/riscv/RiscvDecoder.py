@@ -24,9 +24,19 @@
 # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 from m5.objects.InstDecoder import InstDecoder
+from m5.params import *
 
 
 class RiscvDecoder(InstDecoder):
     type = "RiscvDecoder"
     cxx_class = "gem5::RiscvISA::Decoder"
     cxx_header = "arch/riscv/decoder.hh"
+
+    # Share decoded instructions with every other RISC-V decoder on the
+    # same event queue using the shared cache rather than keeping a
+    # private copy per core
+    shared_decode_cache = Param.Bool(
+        False,
+        "Use a decode cache shared across the RISC-V decoders on the "
+        "same event queue",
+    )
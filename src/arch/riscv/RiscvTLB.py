@@ -48,6 +48,12 @@ class RiscvPagetableWalker(ClockedObject):
     # Grab the pma_checker from the MMU
     pma_checker = Param.PMAChecker(Parent.any, "PMA Checker")
     pmp = Param.PMP(Parent.any, "PMP")
+    walk_cache_entries = Param.Unsigned(
+        0, "Number of intermediate page tables cached, 0 disables the cache"
+    )
+    walk_cache_assoc = Param.Unsigned(
+        0, "Associativity of the walk cache, 0 for fully associative"
+    )
 
 
 class RiscvTLB(BaseTLB):
@@ -56,6 +62,7 @@ class RiscvTLB(BaseTLB):
     cxx_header = "arch/riscv/tlb.hh"
 
     size = Param.Int(64, "TLB size")
+    assoc = Param.Unsigned(0, "TLB associativity, 0 for fully associative")
     walker = Param.RiscvPagetableWalker(
         RiscvPagetableWalker(), "page table walker"
     )
@@ -30,6 +30,7 @@
 #include "arch/riscv/decoder.hh"
 #include "arch/riscv/types.hh"
 #include "base/bitfield.hh"
+#include "base/cprintf.hh"
 #include "debug/Decode.hh"
 
 namespace gem5
@@ -38,6 +39,40 @@ namespace gem5
 namespace RiscvISA
 {
 
+Decoder::Decoder(const RiscvDecoderParams &p)
+    : InstDecoder(p, &machInst), stats(this)
+{
+    // The decoded instruction only depends on the extended machine
+    // instruction, which includes the mode, so all RISC-V decoders on
+    // the same event queue can share one cache
+    if (p.shared_decode_cache) {
+        sharedCache = SharedCache::get(
+            csprintf("riscv.eventq%d", p.eventq_index));
+        sharedUser = sharedCache->addUser();
+    }
+    reset();
+}
+
+Decoder::DecoderStats::DecoderStats(Decoder *decoder)
+    : statistics::Group(decoder, "decodeCache"),
+      ADD_STAT(sharedHits, statistics::units::Count::get(),
+               "Number of hits in the shared decode cache"),
+      ADD_STAT(sharedMisses, statistics::units::Count::get(),
+               "Number of misses in the shared decode cache"),
+      ADD_STAT(sharedBytesSaved, statistics::units::Byte::get(),
+               "Host memory saved by sharing the decode cache, per user")
+{
+    sharedHits.flags(statistics::nozero);
+    sharedMisses.flags(statistics::nozero);
+    sharedBytesSaved
+        .functor([decoder]() -> double {
+            const auto &cache = decoder->sharedCache;
+            return cache ?
+                (double)cache->bytesSaved() / cache->users() : 0;
+        })
+        .flags(statistics::nozero);
+}
+
 void Decoder::reset()
 {
     aligned = true;
@@ -86,6 +121,21 @@ Decoder::decode(ExtMachInst mach_inst, Addr addr)
     DPRINTF(Decode, "Decoding instruction 0x%08x at address %#x\n",
             mach_inst.instBits, addr);
 
+    if (sharedCache) {
+        StaticInstPtr si = sharedCache->lookup(addr, mach_inst, sharedUser,
+                                               sharedCursor);
+        if (si) {
+            ++stats.sharedHits;
+            return si;
+        }
+        ++stats.sharedMisses;
+        si = sharedCache->insert(addr, mach_inst, sharedUser,
+            [this](const ExtMachInst &emi) { return decodeInst(emi); });
+        DPRINTF(Decode, "Decode: Decoded %s instruction: %#x\n",
+                si->getName(), mach_inst);
+        return si;
+    }
+
     StaticInstPtr &si = instMap[mach_inst];
     if (!si)
         si = decodeInst(mach_inst);
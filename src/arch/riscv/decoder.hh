@@ -34,7 +34,9 @@
 #include "arch/generic/decoder.hh"
 #include "arch/riscv/types.hh"
 #include "base/logging.hh"
+#include "base/statistics.hh"
 #include "base/types.hh"
+#include "cpu/shared_decode_cache.hh"
 #include "cpu/static_inst.hh"
 #include "debug/Decode.hh"
 #include "params/RiscvDecoder.hh"
@@ -54,6 +56,29 @@ class Decoder : public InstDecoder
     bool aligned;
     bool mid;
 
+    using SharedCache = decode_cache::SharedCache<ExtMachInst>;
+
+    /** Decode cache shared with the other decoders, if enabled */
+    std::shared_ptr<SharedCache> sharedCache;
+
+    /** Id of this decoder in the shared cache */
+    unsigned sharedUser = 0;
+
+    /** Last page of the shared cache used by this decoder */
+    SharedCache::Cursor sharedCursor;
+
+    struct DecoderStats : public statistics::Group
+    {
+        DecoderStats(Decoder *decoder);
+
+        /** Lookups which hit in the shared decode cache */
+        statistics::Scalar sharedHits;
+        /** Lookups which missed in the shared decode cache */
+        statistics::Scalar sharedMisses;
+        /** This decoder's share of the memory saved by sharing */
+        statistics::Value sharedBytesSaved;
+    } stats;
+
   protected:
     //The extended machine instruction being generated
     ExtMachInst emi;
@@ -67,10 +92,7 @@ class Decoder : public InstDecoder
     StaticInstPtr decode(ExtMachInst mach_inst, Addr addr);
 
   public:
-    Decoder(const RiscvDecoderParams &p) : InstDecoder(p, &machInst)
-    {
-        reset();
-    }
+    Decoder(const RiscvDecoderParams &p);
 
     void reset() override;
 
@@ -57,7 +57,6 @@
 #include "arch/riscv/pagetable.hh"
 #include "arch/riscv/tlb.hh"
 #include "base/bitfield.hh"
-#include "base/trie.hh"
 #include "cpu/base.hh"
 #include "cpu/thread_context.hh"
 #include "debug/PageTableWalker.hh"
@@ -388,6 +387,10 @@ Walker::WalkerState::stepWalk(PacketPtr &write)
                     Addr idx = (entry.vaddr >> shift) & LEVEL_MASK;
                     nextRead = (pte.ppn << PageShift) + (idx * sizeof(pte));
                     nextState = Translate;
+                    if (!functional) {
+                        walker->_walkCache.insert(level, entry.vaddr,
+                                entry.asid, pte.ppn << PageShift);
+                    }
                 }
             }
         }
@@ -453,10 +456,19 @@ Walker::WalkerState::setupWalk(Addr vaddr)
 {
     vaddr = Addr(sext<VADDR_BITS>(vaddr));
 
-    Addr shift = PageShift + LEVEL_BITS * 2;
+    // Skip the levels whose tables the walk cache knows of.
+    unsigned cached_level;
+    Addr table;
+    if (walker->_walkCache.lookup(vaddr, satp.asid, cached_level, table)) {
+        level = cached_level;
+    } else {
+        level = 2;
+        table = satp.ppn << PageShift;
+    }
+
+    Addr shift = PageShift + LEVEL_BITS * level;
     Addr idx = (vaddr >> shift) & LEVEL_MASK;
-    Addr topAddr = (satp.ppn << PageShift) + (idx * sizeof(PTESv39));
-    level = 2;
+    Addr topAddr = table + (idx * sizeof(PTESv39));
 
     DPRINTF(PageTableWalker, "Performing table walk for address %#x\n", vaddr);
     DPRINTF(PageTableWalker, "Loading level%d PTE from %#x\n", level, topAddr);
@@ -42,6 +42,8 @@
 #include <vector>
 
 #include "arch/generic/mmu.hh"
+#include "arch/generic/walk_cache.hh"
+#include "arch/riscv/page_size.hh"
 #include "arch/riscv/pagetable.hh"
 #include "arch/riscv/pma_checker.hh"
 #include "arch/riscv/pmp.hh"
@@ -180,6 +182,9 @@ namespace RiscvISA
         // The number of outstanding walks that can be squashed per cycle.
         unsigned numSquashable;
 
+        // Tables of the lower levels, indexed by the level of the walk.
+        PageWalkCache _walkCache;
+
         // Wrapper for checking for squashes before starting a translation.
         void startWalkWrapper();
 
@@ -200,6 +205,8 @@ namespace RiscvISA
             tlb = _tlb;
         }
 
+        PageWalkCache &walkCache() { return _walkCache; }
+
         using Params = RiscvPagetableWalkerParams;
 
         Walker(const Params &params) :
@@ -209,6 +216,9 @@ namespace RiscvISA
             pmp(params.pmp),
             requestorId(sys->getRequestorId(this)),
             numSquashable(params.num_squash_per_cycle),
+            _walkCache(this, params.walk_cache_entries,
+                       params.walk_cache_assoc,
+                       {PageShift + LEVEL_BITS, PageShift + 2 * LEVEL_BITS}),
             startWalkWrapperEvent([this]{ startWalkWrapper(); }, name())
         {
         }
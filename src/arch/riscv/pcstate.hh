@@ -68,6 +68,11 @@ class PCState : public GenericISA::UPCState<4>
     }
 
     PCStateBase *clone() const override { return new PCState(*this); }
+    PCStateBase *
+    cloneInto(void *mem) const override
+    {
+        return constructAt(*this, mem);
+    }
 
     void
     update(const PCStateBase &other) override
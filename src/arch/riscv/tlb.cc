@@ -64,20 +64,16 @@ using namespace RiscvISA;
 //  RISC-V TLB
 //
 
-static Addr
-buildKey(Addr vpn, uint16_t asid)
-{
-    return (static_cast<Addr>(asid) << 48) | vpn;
-}
-
 TLB::TLB(const Params &p) :
-    BaseTLB(p), size(p.size), tlb(size),
-    lruSeq(0), stats(this), pma(p.pma_checker),
+    BaseTLB(p), size(p.size),
+    tlb(size, p.assoc,
+        {PageShift, PageShift + LEVEL_BITS, PageShift + 2 * LEVEL_BITS}),
+    l2(nullptr), stats(this), pma(p.pma_checker),
     pmp(p.pmp)
 {
-    for (size_t x = 0; x < size; x++) {
-        tlb[x].trieHandle = NULL;
-        freeList.push_back(&tlb[x]);
+    if (p.next_level) {
+        l2 = dynamic_cast<TLB *>(p.next_level);
+        fatal_if(!l2, "The next level of %s must be a RISC-V TLB\n", name());
     }
 
     walker = p.walker;
@@ -90,30 +86,12 @@ TLB::getWalker()
     return walker;
 }
 
-void
-TLB::evictLRU()
-{
-    // Find the entry with the lowest (and hence least recently updated)
-    // sequence number.
-
-    size_t lru = 0;
-    for (size_t i = 1; i < size; i++) {
-        if (tlb[i].lruSeq < tlb[lru].lruSeq)
-            lru = i;
-    }
-
-    remove(lru);
-}
-
 TlbEntry *
 TLB::lookup(Addr vpn, uint16_t asid, BaseMMU::Mode mode, bool hidden)
 {
-    TlbEntry *entry = trie.lookup(buildKey(vpn, asid));
+    TlbEntry *entry = tlb.lookup(vpn, asid, !hidden);
 
     if (!hidden) {
-        if (entry)
-            entry->lruSeq = nextSeq();
-
         if (mode == BaseMMU::Write)
             stats.writeAccesses++;
         else
@@ -124,6 +102,15 @@ TLB::lookup(Addr vpn, uint16_t asid, BaseMMU::Mode mode, bool hidden)
                 stats.writeMisses++;
             else
                 stats.readMisses++;
+
+            // Refill from the next level rather than walking.
+            if (l2) {
+                if (TlbEntry *l2_entry = l2->lookup(vpn, asid, mode, false)) {
+                    stats.nextLevelHits++;
+                    entry = tlb.insert(l2_entry->vaddr, l2_entry->logBytes,
+                                       asid, *l2_entry);
+                }
+            }
         }
         else {
             if (mode == BaseMMU::Write)
@@ -145,8 +132,12 @@ TLB::insert(Addr vpn, const TlbEntry &entry)
     DPRINTF(TLB, "insert(vpn=%#x, asid=%#x): ppn=%#x pte=%#x size=%#x\n",
         vpn, entry.asid, entry.paddr, entry.pte, entry.size());
 
+    // Keep the next level inclusive of what the walker brings in.
+    if (l2)
+        l2->insert(vpn, entry);
+
     // If somebody beat us to it, just use that existing entry.
-    TlbEntry *newEntry = lookup(vpn, entry.asid, BaseMMU::Read, true);
+    TlbEntry *newEntry = tlb.lookup(vpn, entry.logBytes, entry.asid, false);
     if (newEntry) {
         // update PTE flags (maybe we set the dirty/writable flag)
         newEntry->pte = entry.pte;
@@ -154,18 +145,9 @@ TLB::insert(Addr vpn, const TlbEntry &entry)
         return newEntry;
     }
 
-    if (freeList.empty())
-        evictLRU();
-
-    newEntry = freeList.front();
-    freeList.pop_front();
-
-    Addr key = buildKey(vpn, entry.asid);
-    *newEntry = entry;
-    newEntry->lruSeq = nextSeq();
-    newEntry->vaddr = vpn;
-    newEntry->trieHandle =
-    trie.insert(key, TlbEntryTrie::MaxBits - entry.logBytes, newEntry);
+    newEntry = tlb.insert(vpn, entry.logBytes, entry.asid, entry);
+    if (newEntry)
+        newEntry->vaddr = vpn;
     return newEntry;
 }
 
@@ -179,44 +161,35 @@ TLB::demapPage(Addr vpn, uint64_t asid)
     else {
         DPRINTF(TLB, "flush(vpn=%#x, asid=%#x)\n", vpn, asid);
         if (vpn != 0 && asid != 0) {
-            TlbEntry *newEntry = lookup(vpn, asid, BaseMMU::Read, true);
-            if (newEntry)
-                remove(newEntry - tlb.data());
+            tlb.invalidate(vpn, asid);
         }
         else {
-            for (size_t i = 0; i < size; i++) {
-                if (tlb[i].trieHandle) {
-                    Addr mask = ~(tlb[i].size() - 1);
-                    if ((vpn == 0 || (vpn & mask) == tlb[i].vaddr) &&
-                        (asid == 0 || tlb[i].asid == asid))
-                        remove(i);
-                }
-            }
+            tlb.invalidateIf(
+                [vpn, asid](const SetAssocTLBArray<TlbEntry>::Tag &tag,
+                            const TlbEntry &entry) {
+                    Addr mask = ~(entry.size() - 1);
+                    return (vpn == 0 || (vpn & mask) == entry.vaddr) &&
+                        (asid == 0 || entry.asid == asid);
+                });
         }
+
+        // A fence for a single address only orders updates of leaf
+        // entries, cached tables only go away with the whole ASID.
+        if (vpn == 0)
+            walker->walkCache().flush(asid);
     }
+
+    // The MMU only demaps the first level TLBs.
+    if (l2)
+        l2->demapPage(vpn, asid);
 }
 
 void
 TLB::flushAll()
 {
     DPRINTF(TLB, "flushAll()\n");
-    for (size_t i = 0; i < size; i++) {
-        if (tlb[i].trieHandle)
-            remove(i);
-    }
-}
-
-void
-TLB::remove(size_t idx)
-{
-    DPRINTF(TLB, "remove(vpn=%#x, asid=%#x): ppn=%#x pte=%#x size=%#x\n",
-        tlb[idx].vaddr, tlb[idx].asid, tlb[idx].paddr, tlb[idx].pte,
-        tlb[idx].size());
-
-    assert(tlb[idx].trieHandle);
-    trie.remove(tlb[idx].trieHandle);
-    tlb[idx].trieHandle = NULL;
-    freeList.push_back(&tlb[idx]);
+    tlb.flush();
+    walker->walkCache().flush();
 }
 
 Fault
@@ -482,15 +455,14 @@ void
 TLB::serialize(CheckpointOut &cp) const
 {
     // Only store the entries in use.
-    uint32_t _size = size - freeList.size();
+    uint32_t _size = tlb.occupancy();
     SERIALIZE_SCALAR(_size);
-    SERIALIZE_SCALAR(lruSeq);
 
     uint32_t _count = 0;
-    for (uint32_t x = 0; x < size; x++) {
-        if (tlb[x].trieHandle != NULL)
-            tlb[x].serializeSection(cp, csprintf("Entry%d", _count++));
-    }
+    tlb.forEach([&](const SetAssocTLBArray<TlbEntry>::Tag &tag,
+                    const TlbEntry &entry) {
+        entry.serializeSection(cp, csprintf("Entry%d", _count++));
+    });
 }
 
 void
@@ -503,16 +475,10 @@ TLB::unserialize(CheckpointIn &cp)
         fatal("TLB size less than the one in checkpoint!");
     }
 
-    UNSERIALIZE_SCALAR(lruSeq);
-
     for (uint32_t x = 0; x < _size; x++) {
-        TlbEntry *newEntry = freeList.front();
-        freeList.pop_front();
-
-        newEntry->unserializeSection(cp, csprintf("Entry%d", x));
-        Addr key = buildKey(newEntry->vaddr, newEntry->asid);
-        newEntry->trieHandle = trie.insert(key,
-            TlbEntryTrie::MaxBits - newEntry->logBytes, newEntry);
+        TlbEntry entry;
+        entry.unserializeSection(cp, csprintf("Entry%d", x));
+        tlb.insert(entry.vaddr, entry.logBytes, entry.asid, entry);
     }
 }
 
@@ -524,6 +490,8 @@ TLB::TlbStats::TlbStats(statistics::Group *parent)
     ADD_STAT(writeHits, statistics::units::Count::get(), "write hits"),
     ADD_STAT(writeMisses, statistics::units::Count::get(), "write misses"),
     ADD_STAT(writeAccesses, statistics::units::Count::get(), "write accesses"),
+    ADD_STAT(nextLevelHits, statistics::units::Count::get(),
+             "Misses refilled from the next level TLB"),
     ADD_STAT(hits, statistics::units::Count::get(),
              "Total TLB (read and write) hits", readHits + writeHits),
     ADD_STAT(misses, statistics::units::Count::get(),
@@ -32,9 +32,8 @@
 #ifndef __ARCH_RISCV_TLB_HH__
 #define __ARCH_RISCV_TLB_HH__
 
-#include <list>
-
 #include "arch/generic/tlb.hh"
+#include "arch/generic/tlb_array.hh"
 #include "arch/riscv/isa.hh"
 #include "arch/riscv/pagetable.hh"
 #include "arch/riscv/pma_checker.hh"
@@ -58,14 +57,14 @@ class Walker;
 
 class TLB : public BaseTLB
 {
-    typedef std::list<TlbEntry *> EntryList;
-
   protected:
     size_t size;
-    std::vector<TlbEntry> tlb;  // our TLB
-    TlbEntryTrie trie;          // for quick access
-    EntryList freeList;         // free entries
-    uint64_t lruSeq;
+
+    /** Entries of 4KiB, 2MiB and 1GiB pages, tagged with their ASID. */
+    SetAssocTLBArray<TlbEntry> tlb;
+
+    /** Next level TLB filled from this one and looked up on misses. */
+    TLB *l2;
 
     Walker *walker;
 
@@ -79,6 +78,7 @@ class TLB : public BaseTLB
         statistics::Scalar writeHits;
         statistics::Scalar writeMisses;
         statistics::Scalar writeAccesses;
+        statistics::Scalar nextLevelHits;
 
         statistics::Formula hits;
         statistics::Formula misses;
@@ -136,13 +136,8 @@ class TLB : public BaseTLB
                            BaseMMU::Mode mode) const override;
 
   private:
-    uint64_t nextSeq() { return ++lruSeq; }
-
     TlbEntry *lookup(Addr vpn, uint16_t asid, BaseMMU::Mode mode, bool hidden);
 
-    void evictLRU();
-    void remove(size_t idx);
-
     Fault translate(const RequestPtr &req, ThreadContext *tc,
                     BaseMMU::Translation *translation, BaseMMU::Mode mode,
                     bool &delayed);
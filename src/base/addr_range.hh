@@ -315,6 +315,22 @@ class AddrRange
      */
     uint32_t stripes() const { return 1ULL << masks.size(); }
 
+    /**
+     * Get the interleaving masks, the i-th mask selecting the address
+     * bits whose parity gives bit i of the stripe number.
+     *
+     * @ingroup api_addr_range
+     */
+    const std::vector<Addr> &intlvMasks() const { return masks; }
+
+    /**
+     * Get the stripe number of the addresses that are part of this
+     * range.
+     *
+     * @ingroup api_addr_range
+     */
+    uint8_t intlvMatchBits() const { return intlvMatch; }
+
     /**
      * Get the size of the address range. For a case where
      * interleaving is used we make the simplifying assumption that
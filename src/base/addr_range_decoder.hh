@@ -0,0 +1,228 @@
+/*
+ * Copyright (c) 2024 The University of Edinburgh
+ * All rights reserved
+ *
+ * The license below extends only to copyright in the software and shall
+ * not be construed as granting a license to any other intellectual
+ * property including but not limited to intellectual property relating
+ * to a hardware implementation of the functionality of the software
+ * licensed hereunder.  You may use the software subject to the license
+ * terms below provided that you ensure that this notice is replicated
+ * unmodified and in its entirety in all distributions of the software,
+ * modified or unmodified, in source code or in binary form.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __BASE_ADDR_RANGE_DECODER_HH__
+#define __BASE_ADDR_RANGE_DECODER_HH__
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "base/addr_range.hh"
+#include "base/bitfield.hh"
+#include "base/types.hh"
+
+namespace gem5
+{
+
+/**
+ * A read-only decoder from addresses to the value of the range holding
+ * them, built from a set of non-intersecting address ranges.
+ *
+ * Interleaved ranges covering the same span with the same masks are
+ * folded into a single segment holding one value per stripe, so that
+ * the segments are disjoint and kept sorted in a flat array. A lookup
+ * is then a binary search for the segment followed by the computation
+ * of the stripe number, which is a shift and a mask when the
+ * interleaving bits are contiguous single bits, the common case for
+ * interleaved memory channels. The last segment found is checked first
+ * as accesses tend to stay within a range.
+ *
+ * Unlike AddrRangeMap the decoder cannot be modified incrementally; it
+ * is meant to be rebuilt whenever the set of ranges changes.
+ */
+template <typename V>
+class AddrRangeDecoder
+{
+  private:
+    struct Segment
+    {
+        Addr start;
+        Addr end;
+        std::vector<Addr> masks;
+        /** Interleaving bits are bits shift..shift+masks.size()-1 */
+        bool packed;
+        unsigned shift;
+        /** Size of a contiguous stripe chunk */
+        Addr granularity;
+        std::vector<V> values;
+        std::vector<bool> present;
+
+        unsigned
+        select(Addr a) const
+        {
+            if (packed)
+                return (a >> shift) & mask(masks.size());
+
+            unsigned sel = 0;
+            for (unsigned i = 0; i < masks.size(); i++)
+                sel |= (popCount(a & masks[i]) % 2) << i;
+            return sel;
+        }
+    };
+
+    std::vector<Segment> segments;
+    mutable std::size_t lastSegment = 0;
+
+  public:
+    /**
+     * Rebuild the decoder from a sequence of (range, value) pairs, such
+     * as the contents of an AddrRangeMap.
+     *
+     * @return false if the ranges cannot be represented, i.e. if
+     *         interleaved ranges with different masks overlap, in
+     *         which case the decoder is left empty.
+     */
+    template <class Iterator>
+    bool
+    build(Iterator first, Iterator last)
+    {
+        clear();
+
+        for (auto it = first; it != last; ++it) {
+            const AddrRange &r = it->first;
+            auto seg = std::find_if(segments.begin(), segments.end(),
+                [&r](const Segment &s) {
+                    return s.start == r.start() && s.end == r.end() &&
+                        s.masks == r.intlvMasks();
+                });
+
+            if (seg == segments.end()) {
+                Segment s;
+                s.start = r.start();
+                s.end = r.end();
+                s.masks = r.intlvMasks();
+                s.granularity = r.granularity();
+                s.packed = true;
+                s.shift = s.masks.empty() ? 0 : ctz64(s.masks[0]);
+                for (unsigned i = 0; i < s.masks.size(); i++)
+                    s.packed &= s.masks[i] == (Addr(1) << (s.shift + i));
+                s.values.resize(r.stripes());
+                s.present.resize(r.stripes(), false);
+                segments.push_back(s);
+                seg = segments.end() - 1;
+            }
+
+            seg->values[r.intlvMatchBits()] = it->second;
+            seg->present[r.intlvMatchBits()] = true;
+        }
+
+        std::sort(segments.begin(), segments.end(),
+            [](const Segment &a, const Segment &b) {
+                return a.start < b.start;
+            });
+
+        for (std::size_t i = 1; i < segments.size(); i++) {
+            if (segments[i].start < segments[i - 1].end) {
+                clear();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void
+    clear()
+    {
+        segments.clear();
+        lastSegment = 0;
+    }
+
+    bool empty() const { return segments.empty(); }
+
+    /**
+     * Find the value of the range that contains all of r, which must
+     * not be interleaved.
+     *
+     * @param r The range to look up.
+     * @param cached If not null, set to whether the segment was found
+     *        without searching.
+     * @return A pointer to the value, or nullptr if no range contains r.
+     */
+    const V *
+    find(const AddrRange &r, bool *cached=nullptr) const
+    {
+        const Addr a = r.start();
+        const Addr last = r.end() - 1;
+
+        const Segment *seg = nullptr;
+        if (lastSegment < segments.size() &&
+            a >= segments[lastSegment].start &&
+            a < segments[lastSegment].end) {
+            seg = &segments[lastSegment];
+            if (cached)
+                *cached = true;
+        } else {
+            if (cached)
+                *cached = false;
+            auto next = std::upper_bound(segments.begin(), segments.end(),
+                a, [](Addr addr, const Segment &s) {
+                    return addr < s.start;
+                });
+            if (next == segments.begin())
+                return nullptr;
+            --next;
+            if (a >= next->end)
+                return nullptr;
+            seg = &*next;
+            lastSegment = next - segments.begin();
+        }
+
+        if (last >= seg->end)
+            return nullptr;
+
+        const unsigned sel = seg->select(a);
+        if (!seg->masks.empty() &&
+            (r.size() > seg->granularity || seg->select(last) != sel)) {
+            return nullptr;
+        }
+
+        return seg->present[sel] ? &seg->values[sel] : nullptr;
+    }
+
+    /** Find the value of the range that contains the address a. */
+    const V *
+    find(Addr a, bool *cached=nullptr) const
+    {
+        return find(RangeSize(a, 1), cached);
+    }
+};
+
+} // namespace gem5
+
+#endif // __BASE_ADDR_RANGE_DECODER_HH__
@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2024 The University of Edinburgh
+ * All rights reserved
+ *
+ * The license below extends only to copyright in the software and shall
+ * not be construed as granting a license to any other intellectual
+ * property including but not limited to intellectual property relating
+ * to a hardware implementation of the functionality of the software
+ * licensed hereunder.  You may use the software subject to the license
+ * terms below provided that you ensure that this notice is replicated
+ * unmodified and in its entirety in all distributions of the software,
+ * modified or unmodified, in source code or in binary form.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <utility>
+#include <vector>
+
+#include "base/addr_range_decoder.hh"
+#include "base/addr_range_map.hh"
+
+using namespace gem5;
+
+TEST(AddrRangeDecoderTest, ContiguousRanges)
+{
+    AddrRangeMap<int> map;
+    map.insert(RangeIn(10, 40), 5);
+    map.insert(RangeIn(60, 90), 3);
+    map.insert(RangeIn(0, 9), 1);
+
+    AddrRangeDecoder<int> decoder;
+    ASSERT_TRUE(decoder.build(map.begin(), map.end()));
+
+    ASSERT_NE(decoder.find(RangeIn(20, 30)), nullptr);
+    EXPECT_EQ(*decoder.find(RangeIn(20, 30)), 5);
+    EXPECT_EQ(*decoder.find(Addr(0)), 1);
+    EXPECT_EQ(*decoder.find(Addr(90)), 3);
+    EXPECT_EQ(decoder.find(RangeIn(55, 55)), nullptr);
+    EXPECT_EQ(decoder.find(Addr(91)), nullptr);
+
+    // Ranges straddling two entries are not contained in either
+    EXPECT_EQ(decoder.find(RangeIn(35, 65)), nullptr);
+    EXPECT_EQ(decoder.find(RangeIn(5, 15)), nullptr);
+}
+
+TEST(AddrRangeDecoderTest, RepeatedLookupsAreCached)
+{
+    AddrRangeMap<int> map;
+    map.insert(RangeIn(0, 0xfff), 0);
+    map.insert(RangeIn(0x1000, 0x1fff), 1);
+
+    AddrRangeDecoder<int> decoder;
+    ASSERT_TRUE(decoder.build(map.begin(), map.end()));
+
+    bool cached;
+    EXPECT_EQ(*decoder.find(Addr(0x1800), &cached), 1);
+    EXPECT_FALSE(cached);
+    EXPECT_EQ(*decoder.find(Addr(0x1900), &cached), 1);
+    EXPECT_TRUE(cached);
+    EXPECT_EQ(*decoder.find(Addr(0x10), &cached), 0);
+    EXPECT_FALSE(cached);
+}
+
+/**
+ * Compare the decoder with AddrRangeMap on interleaved ranges, both
+ * with contiguous interleaving bits and with hashed (xor) masks.
+ */
+TEST(AddrRangeDecoderTest, InterleavedRanges)
+{
+    const std::vector<std::vector<Addr>> mask_sets = {
+        {1 << 6, 1 << 7},
+        {(1 << 6) | (1 << 12), (1 << 7) | (1 << 13)},
+    };
+
+    for (const auto &masks : mask_sets) {
+        AddrRangeMap<int> map;
+        for (int i = 0; i < 4; i++)
+            map.insert(AddrRange(0x0, 0x10000, masks, i), i);
+        map.insert(RangeIn(0x10000, 0x1ffff), 4);
+
+        AddrRangeDecoder<int> decoder;
+        ASSERT_TRUE(decoder.build(map.begin(), map.end()));
+
+        for (Addr a = 0; a < 0x20000; a += 0x10) {
+            for (Addr size : {Addr(1), Addr(0x10), Addr(0x40), Addr(0x80)}) {
+                const AddrRange r = RangeSize(a, size);
+                auto expected = map.contains(r);
+                const int *found = decoder.find(r);
+                if (expected == map.end()) {
+                    EXPECT_EQ(found, nullptr);
+                } else {
+                    ASSERT_NE(found, nullptr);
+                    EXPECT_EQ(*found, expected->second);
+                }
+            }
+        }
+    }
+}
+
+TEST(AddrRangeDecoderTest, MissingStripe)
+{
+    const std::vector<Addr> masks = {1 << 6};
+    AddrRangeMap<int> map;
+    map.insert(AddrRange(0x0, 0x1000, masks, 1), 7);
+
+    AddrRangeDecoder<int> decoder;
+    ASSERT_TRUE(decoder.build(map.begin(), map.end()));
+
+    EXPECT_EQ(decoder.find(Addr(0x0)), nullptr);
+    ASSERT_NE(decoder.find(Addr(0x40)), nullptr);
+    EXPECT_EQ(*decoder.find(Addr(0x40)), 7);
+}
+
+TEST(AddrRangeDecoderTest, OverlappingInterleavings)
+{
+    const std::vector<std::pair<AddrRange, int>> ranges = {
+        {AddrRange(0x0, 0x1000, {1 << 6}, 0), 0},
+        {AddrRange(0x0, 0x1000, {1 << 7}, 1), 1},
+    };
+
+    AddrRangeDecoder<int> decoder;
+    EXPECT_FALSE(decoder.build(ranges.begin(), ranges.end()));
+    EXPECT_TRUE(decoder.empty());
+}
@@ -0,0 +1,237 @@
+/*
+ * Copyright (c) 2024 The University of Edinburgh
+ * All rights reserved
+ *
+ * The license below extends only to copyright in the software and shall
+ * not be construed as granting a license to any other intellectual
+ * property including but not limited to intellectual property relating
+ * to a hardware implementation of the functionality of the software
+ * licensed hereunder.  You may use the software subject to the license
+ * terms below provided that you ensure that this notice is replicated
+ * unmodified and in its entirety in all distributions of the software,
+ * modified or unmodified, in source code or in binary form.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __BASE_FLAT_ADDR_MAP_HH__
+#define __BASE_FLAT_ADDR_MAP_HH__
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "base/intmath.hh"
+#include "base/types.hh"
+
+namespace gem5
+{
+
+/**
+ * A compact hash map from addresses to small values.
+ *
+ * The map uses open addressing with linear probing over a single flat
+ * array of (address, value) buckets, so a lookup usually touches one
+ * host cache line, unlike a node-based std::unordered_map. Deletion
+ * shifts the following members of a probe run back, so no tombstones
+ * are needed. The table is kept at most half full and doubles in size
+ * when needed. MaxAddr is reserved to mark empty buckets.
+ *
+ * Pointers to values are only valid until the next insertion or
+ * erasure, as those can move buckets around.
+ */
+template <class Value>
+class FlatAddrMap
+{
+  private:
+    static constexpr Addr emptyAddr = MaxAddr;
+    static constexpr size_t minBuckets = 8;
+
+    struct Bucket
+    {
+        Addr addr = emptyAddr;
+        Value value = Value();
+    };
+
+    std::vector<Bucket> buckets;
+    size_t mask = 0;
+    int shift = 0;
+    size_t _size = 0;
+
+    size_t
+    home(Addr addr) const
+    {
+        // Fibonacci hashing spreads addresses with their low bits clear
+        return (addr * 0x9E3779B97F4A7C15ULL) >> shift;
+    }
+
+    /** Bucket holding addr, or the empty bucket ending its probe run */
+    size_t
+    findBucket(Addr addr) const
+    {
+        size_t idx = home(addr);
+        while (buckets[idx].addr != addr && buckets[idx].addr != emptyAddr)
+            idx = (idx + 1) & mask;
+        return idx;
+    }
+
+    void
+    rehash(size_t num_buckets)
+    {
+        std::vector<Bucket> old;
+        old.swap(buckets);
+
+        buckets.resize(num_buckets);
+        mask = num_buckets - 1;
+        shift = 64 - floorLog2(num_buckets);
+
+        for (auto &bucket : old) {
+            if (bucket.addr != emptyAddr)
+                buckets[findBucket(bucket.addr)] = std::move(bucket);
+        }
+    }
+
+  public:
+    FlatAddrMap(size_t capacity=0) { reserve(capacity); }
+
+    /** Make room for capacity elements without growing the table. */
+    void
+    reserve(size_t capacity)
+    {
+        size_t num_buckets = std::max<size_t>(
+            minBuckets, size_t(1) << ceilLog2(std::max<size_t>(
+                2 * capacity, 1)));
+        if (num_buckets > buckets.size())
+            rehash(num_buckets);
+    }
+
+    Value *
+    find(Addr addr)
+    {
+        assert(addr != emptyAddr);
+        Bucket &bucket = buckets[findBucket(addr)];
+        return bucket.addr == addr ? &bucket.value : nullptr;
+    }
+
+    const Value *
+    find(Addr addr) const
+    {
+        return const_cast<FlatAddrMap *>(this)->find(addr);
+    }
+
+    bool contains(Addr addr) const { return find(addr) != nullptr; }
+
+    /**
+     * Map addr to value, replacing any previous value.
+     *
+     * @return The stored value.
+     */
+    Value &
+    assign(Addr addr, const Value &value)
+    {
+        assert(addr != emptyAddr);
+        if (2 * (_size + 1) > buckets.size())
+            rehash(2 * buckets.size());
+
+        Bucket &bucket = buckets[findBucket(addr)];
+        if (bucket.addr == emptyAddr) {
+            bucket.addr = addr;
+            _size++;
+        }
+        bucket.value = value;
+        return bucket.value;
+    }
+
+    /**
+     * Remove the mapping of addr.
+     *
+     * @return false if addr was not mapped.
+     */
+    bool
+    erase(Addr addr)
+    {
+        assert(addr != emptyAddr);
+        size_t hole = findBucket(addr);
+        if (buckets[hole].addr != addr)
+            return false;
+
+        // Backward-shift deletion: move later members of the probe run
+        // into the hole so that lookups never need tombstones
+        size_t idx = hole;
+        while (true) {
+            idx = (idx + 1) & mask;
+            Bucket &bucket = buckets[idx];
+            if (bucket.addr == emptyAddr)
+                break;
+            size_t bucket_home = home(bucket.addr);
+            if (((idx - bucket_home) & mask) >= ((idx - hole) & mask)) {
+                buckets[hole] = std::move(bucket);
+                hole = idx;
+            }
+        }
+        buckets[hole] = Bucket();
+        _size--;
+        return true;
+    }
+
+    void
+    clear()
+    {
+        for (auto &bucket : buckets)
+            bucket = Bucket();
+        _size = 0;
+    }
+
+    size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+
+    /** Host memory used by the buckets in bytes. */
+    size_t bytes() const { return buckets.size() * sizeof(Bucket); }
+
+    /** Call func(addr, value) for every mapping, in no particular order. */
+    template <class Func>
+    void
+    forEach(Func &&func)
+    {
+        for (auto &bucket : buckets) {
+            if (bucket.addr != emptyAddr)
+                func(bucket.addr, bucket.value);
+        }
+    }
+
+    template <class Func>
+    void
+    forEach(Func &&func) const
+    {
+        for (const auto &bucket : buckets) {
+            if (bucket.addr != emptyAddr)
+                func(bucket.addr, bucket.value);
+        }
+    }
+};
+
+} // namespace gem5
+
+#endif // __BASE_FLAT_ADDR_MAP_HH__
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2024 The University of Edinburgh
+ * All rights reserved
+ *
+ * The license below extends only to copyright in the software and shall
+ * not be construed as granting a license to any other intellectual
+ * property including but not limited to intellectual property relating
+ * to a hardware implementation of the functionality of the software
+ * licensed hereunder.  You may use the software subject to the license
+ * terms below provided that you ensure that this notice is replicated
+ * unmodified and in its entirety in all distributions of the software,
+ * modified or unmodified, in source code or in binary form.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <gtest/gtest.h>
+
+#include <random>
+#include <unordered_map>
+
+#include "base/flat_addr_map.hh"
+
+using namespace gem5;
+
+TEST(FlatAddrMapTest, AssignFindErase)
+{
+    FlatAddrMap<int> map;
+    EXPECT_TRUE(map.empty());
+    EXPECT_EQ(map.find(0x40), nullptr);
+
+    map.assign(0x40, 1);
+    map.assign(0x80, 2);
+    EXPECT_EQ(map.size(), 2);
+    ASSERT_NE(map.find(0x40), nullptr);
+    EXPECT_EQ(*map.find(0x40), 1);
+    EXPECT_EQ(*map.find(0x80), 2);
+
+    // Assigning again replaces the value
+    map.assign(0x40, 3);
+    EXPECT_EQ(map.size(), 2);
+    EXPECT_EQ(*map.find(0x40), 3);
+
+    EXPECT_TRUE(map.erase(0x40));
+    EXPECT_FALSE(map.erase(0x40));
+    EXPECT_FALSE(map.contains(0x40));
+    EXPECT_TRUE(map.contains(0x80));
+    EXPECT_EQ(map.size(), 1);
+
+    map.clear();
+    EXPECT_TRUE(map.empty());
+    EXPECT_FALSE(map.contains(0x80));
+}
+
+TEST(FlatAddrMapTest, GrowsAndKeepsHalfEmpty)
+{
+    FlatAddrMap<int> map;
+    for (int i = 0; i < 1000; i++)
+        map.assign(i * 64, i);
+    EXPECT_EQ(map.size(), 1000);
+    EXPECT_GE(map.bytes(), 2 * 1000 * sizeof(std::pair<Addr, int>));
+    for (int i = 0; i < 1000; i++) {
+        ASSERT_NE(map.find(i * 64), nullptr);
+        EXPECT_EQ(*map.find(i * 64), i);
+    }
+
+    int count = 0;
+    map.forEach([&](Addr addr, int value) {
+        EXPECT_EQ(addr, value * 64);
+        count++;
+    });
+    EXPECT_EQ(count, 1000);
+}
+
+TEST(FlatAddrMapTest, MatchesUnorderedMap)
+{
+    // Few distinct keys in a small table give long probe runs, which
+    // exercises the backward-shift deletion
+    std::mt19937_64 rng(1);
+    FlatAddrMap<uint64_t> map(16);
+    std::unordered_map<Addr, uint64_t> ref;
+
+    for (int i = 0; i < 100000; i++) {
+        const Addr addr = (rng() % 64) << 6;
+        switch (rng() % 3) {
+          case 0:
+            map.assign(addr, i);
+            ref[addr] = i;
+            break;
+          case 1:
+            EXPECT_EQ(map.erase(addr), ref.erase(addr) == 1);
+            break;
+          default:
+            break;
+        }
+
+        ASSERT_EQ(map.size(), ref.size());
+        const Addr probe = (rng() % 64) << 6;
+        auto it = ref.find(probe);
+        if (it == ref.end()) {
+            EXPECT_EQ(map.find(probe), nullptr);
+        } else {
+            ASSERT_NE(map.find(probe), nullptr);
+            EXPECT_EQ(*map.find(probe), it->second);
+        }
+    }
+}
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2024 The University of Edinburgh
+ * All rights reserved
+ *
+ * The license below extends only to copyright in the software and shall
+ * not be construed as granting a license to any other intellectual
+ * property including but not limited to intellectual property relating
+ * to a hardware implementation of the functionality of the software
+ * licensed hereunder.  You may use the software subject to the license
+ * terms below provided that you ensure that this notice is replicated
+ * unmodified and in its entirety in all distributions of the software,
+ * modified or unmodified, in source code or in binary form.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdint>
+
+#include "base/hyperloglog.hh"
+
+using namespace gem5;
+
+TEST(HyperLogLogTest, EmptyIsZero)
+{
+    HyperLogLog hll;
+    EXPECT_EQ(hll.estimate(), 0.0);
+    EXPECT_EQ(hll.size(), 4096);
+}
+
+TEST(HyperLogLogTest, DuplicatesDoNotCount)
+{
+    HyperLogLog hll;
+    for (int i = 0; i < 1000; i++) {
+        hll.insert(0x1000);
+        hll.insert(0x2000);
+    }
+    EXPECT_NEAR(hll.estimate(), 2.0, 0.1);
+}
+
+TEST(HyperLogLogTest, SmallRange)
+{
+    HyperLogLog hll;
+    for (uint64_t i = 0; i < 1000; i++)
+        hll.insert(i * 64);
+    EXPECT_NEAR(hll.estimate(), 1000.0, 1000.0 * 0.03);
+}
+
+TEST(HyperLogLogTest, LargeRange)
+{
+    HyperLogLog hll;
+    const uint64_t n = 1000000;
+    for (uint64_t i = 0; i < n; i++)
+        hll.insert(i << 12);
+    // Six standard errors
+    EXPECT_NEAR(hll.estimate(), n, n * 6 * 1.04 / 64);
+}
+
+TEST(HyperLogLogTest, Clear)
+{
+    HyperLogLog hll(8);
+    for (uint64_t i = 0; i < 100; i++)
+        hll.insert(i);
+    EXPECT_GT(hll.estimate(), 0.0);
+    hll.clear();
+    EXPECT_EQ(hll.estimate(), 0.0);
+}
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2024 The University of Edinburgh
+ * All rights reserved
+ *
+ * The license below extends only to copyright in the software and shall
+ * not be construed as granting a license to any other intellectual
+ * property including but not limited to intellectual property relating
+ * to a hardware implementation of the functionality of the software
+ * licensed hereunder.  You may use the software subject to the license
+ * terms below provided that you ensure that this notice is replicated
+ * unmodified and in its entirety in all distributions of the software,
+ * modified or unmodified, in source code or in binary form.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __BASE_LOG_BUCKETS_HH__
+#define __BASE_LOG_BUCKETS_HH__
+
+#include <cstdint>
+
+#include "base/bitfield.hh"
+
+namespace gem5
+{
+
+/**
+ * Log-linear (HDR style) bucketing of unsigned values. Each power of
+ * two range is split into 2^sub_bits equal buckets, so every value is
+ * placed in a bucket whose width is at most 1 / 2^sub_bits of the
+ * value. Values below 2^sub_bits get a bucket each. This gives a fixed
+ * relative precision over the whole 64-bit range with a small, fixed
+ * number of buckets, and the index is computed with a single bit scan.
+ */
+class LogBuckets
+{
+  private:
+    const unsigned subBits;
+
+  public:
+    explicit constexpr LogBuckets(unsigned sub_bits) : subBits(sub_bits) {}
+
+    /** Total number of buckets needed to cover 64-bit values. */
+    constexpr unsigned
+    size() const
+    {
+        return (64 - subBits + 1) << subBits;
+    }
+
+    /** Bucket holding the given value. */
+    unsigned
+    index(uint64_t value) const
+    {
+        if (value < (1ULL << subBits))
+            return value;
+        const unsigned msb = findMsbSet(value);
+        const unsigned shift = msb - subBits;
+        // The top sub_bits below the leading one select the bucket
+        // within the power of two range
+        return ((shift + 1) << subBits) +
+            ((value >> shift) & ((1ULL << subBits) - 1));
+    }
+
+    /** Smallest value placed in the given bucket. */
+    uint64_t
+    lowerBound(unsigned idx) const
+    {
+        const unsigned group = idx >> subBits;
+        const uint64_t sub = idx & ((1ULL << subBits) - 1);
+        if (group == 0)
+            return sub;
+        return ((1ULL << subBits) | sub) << (group - 1);
+    }
+};
+
+} // namespace gem5
+
+#endif // __BASE_LOG_BUCKETS_HH__
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2024 The University of Edinburgh
+ * All rights reserved
+ *
+ * The license below extends only to copyright in the software and shall
+ * not be construed as granting a license to any other intellectual
+ * property including but not limited to intellectual property relating
+ * to a hardware implementation of the functionality of the software
+ * licensed hereunder.  You may use the software subject to the license
+ * terms below provided that you ensure that this notice is replicated
+ * unmodified and in its entirety in all distributions of the software,
+ * modified or unmodified, in source code or in binary form.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+
+#include "base/log_buckets.hh"
+
+using namespace gem5;
+
+TEST(LogBucketsTest, SmallValuesAreExact)
+{
+    LogBuckets buckets(3);
+    for (uint64_t v = 0; v < 8; v++) {
+        EXPECT_EQ(buckets.index(v), v);
+        EXPECT_EQ(buckets.lowerBound(v), v);
+    }
+}
+
+TEST(LogBucketsTest, RelativePrecision)
+{
+    LogBuckets buckets(3);
+    // 8..15 still one value per bucket, then two per bucket from 16
+    EXPECT_EQ(buckets.index(8), 8);
+    EXPECT_EQ(buckets.index(15), 15);
+    EXPECT_EQ(buckets.index(16), 16);
+    EXPECT_EQ(buckets.index(17), 16);
+    EXPECT_EQ(buckets.index(18), 17);
+    EXPECT_EQ(buckets.lowerBound(17), 18);
+
+    for (uint64_t v = 1; v < (1ULL << 40); v = v * 3 + 1) {
+        unsigned idx = buckets.index(v);
+        uint64_t lo = buckets.lowerBound(idx);
+        EXPECT_LE(lo, v);
+        EXPECT_LE(v - lo, lo / 8);
+        EXPECT_GT(buckets.lowerBound(idx + 1), v);
+    }
+}
+
+TEST(LogBucketsTest, CoversFullRange)
+{
+    LogBuckets buckets(4);
+    EXPECT_EQ(buckets.index(UINT64_MAX), buckets.size() - 1);
+    EXPECT_EQ(buckets.size(), 61 << 4);
+}
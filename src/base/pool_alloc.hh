@@ -0,0 +1,443 @@
+/*
+ * Copyright (c) 2024 The University of Edinburgh
+ * All rights reserved
+ *
+ * The license below extends only to copyright in the software and shall
+ * not be construed as granting a license to any other intellectual
+ * property including but not limited to intellectual property relating
+ * to a hardware implementation of the functionality of the software
+ * licensed hereunder.  You may use the software subject to the license
+ * terms below provided that you ensure that this notice is replicated
+ * unmodified and in its entirety in all distributions of the software,
+ * modified or unmodified, in source code or in binary form.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __BASE_POOL_ALLOC_HH__
+#define __BASE_POOL_ALLOC_HH__
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace gem5
+{
+
+/**
+ * A small-object allocator that recycles freed chunks through per
+ * size-class free lists instead of handing them back to the system
+ * allocator. Chunks are carved out of larger slabs so that objects that
+ * are allocated together also end up close together in host memory.
+ *
+ * Every thread allocates from its own pool, so the pool is safe to use
+ * from parallel event queues without locking on the fast path. Each slab
+ * records the pool it belongs to. A chunk freed by the thread that owns
+ * it goes back to that thread's free list. A chunk freed by any other
+ * thread is pushed onto a lock-free remote list of the owning pool, which
+ * the owner takes over in one go when its own list runs dry. Chunks
+ * therefore always return to the pool they came from, and the footprint
+ * of a pool is bounded by the peak number of objects it had live at once.
+ * The pool of a thread that exits is handed over, with its chunks, to the
+ * next thread that starts allocating.
+ *
+ * The static allocate() draws from pools shared by everything running on
+ * a thread. A Domain keeps its own set of per-thread pools instead, so
+ * that the objects of one component do not share slabs with those of
+ * others; see Domain.
+ *
+ * Memory handed to the pool is never returned to the system. Requests
+ * larger than MaxPooledSize bypass the pool.
+ */
+class SizeClassPool
+{
+  public:
+    /** Size-class granularity, also the alignment of every chunk. */
+    static constexpr std::size_t Granularity = alignof(std::max_align_t);
+    /** Largest request served from the pool. */
+    static constexpr std::size_t MaxPooledSize = 2048;
+    /** Size and alignment of the slabs chunks are carved out of. */
+    static constexpr std::size_t SlabSize = 64 * 1024;
+
+    class Domain;
+
+    static void *
+    allocate(std::size_t size)
+    {
+        if (size > MaxPooledSize)
+            return ::operator new(size);
+        return allocateFrom(localPool(), size);
+    }
+
+    /** Free a chunk from the static pools or from any Domain. */
+    static void
+    deallocate(void *ptr, std::size_t size)
+    {
+        if (!ptr)
+            return;
+
+        if (size > MaxPooledSize) {
+            ::operator delete(ptr);
+            return;
+        }
+
+        const std::size_t size_class = sizeClass(size);
+        FreeChunk *chunk = static_cast<FreeChunk *>(ptr);
+        ThreadPool *owner = slabOf(ptr)->owner;
+        if (owner->thread.load(std::memory_order_relaxed) == threadId()) {
+            chunk->next = owner->local[size_class];
+            owner->local[size_class] = chunk;
+            return;
+        }
+
+        // Only the owner takes chunks off the remote list, and always the
+        // whole list at once, so a plain CAS push is free of ABA issues.
+        std::atomic<FreeChunk *> &remote = owner->remote[size_class];
+        FreeChunk *head = remote.load(std::memory_order_relaxed);
+        do {
+            chunk->next = head;
+        } while (!remote.compare_exchange_weak(head, chunk,
+                                               std::memory_order_release,
+                                               std::memory_order_relaxed));
+    }
+
+  private:
+    struct FreeChunk
+    {
+        FreeChunk *next;
+    };
+
+    static constexpr std::size_t NumClasses = MaxPooledSize / Granularity;
+
+    /** Free lists of one thread */
+    struct ThreadPool
+    {
+        /** Chunks only touched by the owning thread */
+        FreeChunk *local[NumClasses] = {};
+        /** Chunks freed by other threads */
+        std::atomic<FreeChunk *> remote[NumClasses] = {};
+        /** threadId() of the owning thread, 0 while it has none */
+        std::atomic<uint64_t> thread{0};
+        /** Domain the pool belongs to, nullptr for the static pools */
+        Domain *domain = nullptr;
+    };
+
+    /** Header at the start of every slab */
+    struct alignas(Granularity) Slab
+    {
+        ThreadPool *owner;
+    };
+
+    static_assert(SlabSize >= sizeof(Slab) + MaxPooledSize,
+                  "Slabs must hold at least one chunk of every size");
+
+    /** Pools of the threads that exited, for reuse by new threads */
+    struct IdlePools
+    {
+        std::mutex lock;
+        std::vector<ThreadPool *> pools;
+    };
+
+    /** Returns the pool of an exiting thread to the idle pools. */
+    struct PoolReleaser
+    {
+        ~PoolReleaser();
+    };
+
+    static constexpr std::size_t
+    sizeClass(std::size_t size)
+    {
+        return size == 0 ? 0 : (size - 1) / Granularity;
+    }
+
+    static Slab *
+    slabOf(const void *ptr)
+    {
+        return reinterpret_cast<Slab *>(
+            reinterpret_cast<std::uintptr_t>(ptr) & ~(SlabSize - 1));
+    }
+
+    /**
+     * A number identifying the calling thread. Unlike the address of a
+     * thread_local variable, it is never reused by a later thread.
+     */
+    static uint64_t
+    threadId()
+    {
+        static std::atomic<uint64_t> next_id{1};
+        thread_local uint64_t id =
+            next_id.fetch_add(1, std::memory_order_relaxed);
+        return id;
+    }
+
+    static IdlePools &
+    idlePools()
+    {
+        // Never destroyed, threads may exit during static destruction
+        static IdlePools *idle = new IdlePools;
+        return *idle;
+    }
+
+    static ThreadPool *&
+    threadPool()
+    {
+        thread_local ThreadPool *pool = nullptr;
+        return pool;
+    }
+
+    static ThreadPool &
+    localPool()
+    {
+        ThreadPool *&pool = threadPool();
+        if (!pool) {
+            IdlePools &idle = idlePools();
+            {
+                std::lock_guard<std::mutex> guard(idle.lock);
+                if (!idle.pools.empty()) {
+                    pool = idle.pools.back();
+                    idle.pools.pop_back();
+                }
+            }
+            if (!pool)
+                pool = new ThreadPool;
+            pool->thread.store(threadId(), std::memory_order_relaxed);
+            thread_local PoolReleaser releaser;
+        }
+        return *pool;
+    }
+
+    static void *
+    allocateFrom(ThreadPool &pool, std::size_t size)
+    {
+        const std::size_t size_class = sizeClass(size);
+        FreeChunk *&head = pool.local[size_class];
+        if (!head) {
+            // Take over everything other threads have freed so far
+            head = pool.remote[size_class].exchange(
+                nullptr, std::memory_order_acquire);
+            if (!head)
+                refill(pool, size_class);
+        }
+
+        FreeChunk *chunk = head;
+        head = chunk->next;
+        return chunk;
+    }
+
+    static void
+    refill(ThreadPool &pool, std::size_t size_class)
+    {
+        const std::size_t chunk_size = (size_class + 1) * Granularity;
+        char *slab = static_cast<char *>(
+            ::operator new(SlabSize, std::align_val_t(SlabSize)));
+        new (slab) Slab{&pool};
+
+        FreeChunk *&head = pool.local[size_class];
+        const std::size_t num_chunks =
+            (SlabSize - sizeof(Slab)) / chunk_size;
+        for (std::size_t i = num_chunks; i-- > 0;) {
+            FreeChunk *chunk = reinterpret_cast<FreeChunk *>(
+                slab + sizeof(Slab) + i * chunk_size);
+            chunk->next = head;
+            head = chunk;
+        }
+    }
+};
+
+inline
+SizeClassPool::PoolReleaser::~PoolReleaser()
+{
+    // Objects freed by this thread after this point allocate a new pool
+    // that is not recycled, which only happens during thread teardown.
+    ThreadPool *&pool = threadPool();
+    pool->thread.store(0, std::memory_order_relaxed);
+    IdlePools &idle = idlePools();
+    std::lock_guard<std::mutex> guard(idle.lock);
+    idle.pools.push_back(pool);
+    pool = nullptr;
+}
+
+/**
+ * A private set of pools, one per thread allocating from it, for the
+ * objects of one component, e.g. the flits and credits of one network.
+ * Its slabs only hold its own objects, which keeps them together in host
+ * memory and makes its footprint independent of other users of the
+ * pools. Chunks are freed with SizeClassPool::deallocate(), on any
+ * thread, and find their way back to the domain through their slab.
+ *
+ * Like the rest of the pool memory, the slabs of a domain are never
+ * returned to the system, also not when the domain is destroyed, so
+ * objects may outlive the domain they were allocated from.
+ */
+class SizeClassPool::Domain
+{
+  public:
+    Domain() : id(nextId().fetch_add(1, std::memory_order_relaxed)) {}
+
+    Domain(const Domain &) = delete;
+    Domain &operator=(const Domain &) = delete;
+
+    void *
+    allocate(std::size_t size)
+    {
+        if (size > MaxPooledSize)
+            return ::operator new(size);
+        return allocateFrom(localPool(), size);
+    }
+
+    /**
+     * Domain a chunk was allocated from, or nullptr if it came from the
+     * static pools. Only valid for chunks of at most MaxPooledSize.
+     */
+    static Domain *
+    of(const void *ptr)
+    {
+        return slabOf(ptr)->owner->domain;
+    }
+
+  private:
+    /** Index of the domain in the per-thread pool tables */
+    const std::size_t id;
+
+    static std::atomic<std::size_t> &
+    nextId()
+    {
+        static std::atomic<std::size_t> next_id{0};
+        return next_id;
+    }
+
+    /** Pools of the calling thread, indexed by domain id */
+    static std::vector<ThreadPool *> &
+    threadPools()
+    {
+        thread_local std::vector<ThreadPool *> pools;
+        return pools;
+    }
+
+    ThreadPool &
+    localPool()
+    {
+        std::vector<ThreadPool *> &pools = threadPools();
+        if (id < pools.size() && pools[id])
+            return *pools[id];
+
+        // The pool of a thread is kept after it exits, chunks it owns
+        // may still be freed remotely. Ids are never reused, so a later
+        // domain never finds it.
+        ThreadPool *pool = new ThreadPool;
+        pool->thread.store(threadId(), std::memory_order_relaxed);
+        pool->domain = this;
+        if (pools.size() <= id)
+            pools.resize(id + 1, nullptr);
+        pools[id] = pool;
+        return *pool;
+    }
+};
+
+/**
+ * Mix-in that makes every object of a class hierarchy come from the
+ * SizeClassPool. The sized operator delete receives the size of the
+ * dynamic type as long as the hierarchy has a virtual destructor, so
+ * derived classes of different sizes are recycled correctly.
+ */
+class PoolAllocated
+{
+  public:
+    static void *
+    operator new(std::size_t size)
+    {
+        return SizeClassPool::allocate(size);
+    }
+
+    static void
+    operator delete(void *ptr, std::size_t size)
+    {
+        SizeClassPool::deallocate(ptr, size);
+    }
+};
+
+/**
+ * Mix-in for classes whose objects come from a SizeClassPool::Domain.
+ * Objects are created with new (domain) T(...); plain new does not
+ * compile, so no object silently ends up outside its domain. The
+ * hierarchy needs a virtual destructor, as for PoolAllocated.
+ */
+class DomainPoolAllocated
+{
+  public:
+    static void *
+    operator new(std::size_t size, SizeClassPool::Domain &domain)
+    {
+        return domain.allocate(size);
+    }
+
+    static void
+    operator delete(void *ptr, std::size_t size)
+    {
+        SizeClassPool::deallocate(ptr, size);
+    }
+};
+
+/**
+ * Standard allocator adapter over the SizeClassPool, for node-based
+ * containers (lists, maps) whose nodes are frequently created and
+ * destroyed. Bucket arrays and other large allocations fall through to
+ * the system allocator.
+ */
+template <class T>
+class PoolAllocator
+{
+  public:
+    using value_type = T;
+
+    PoolAllocator() = default;
+
+    template <class U>
+    PoolAllocator(const PoolAllocator<U> &) {}
+
+    T *
+    allocate(std::size_t n)
+    {
+        return static_cast<T *>(SizeClassPool::allocate(n * sizeof(T)));
+    }
+
+    void
+    deallocate(T *ptr, std::size_t n)
+    {
+        SizeClassPool::deallocate(ptr, n * sizeof(T));
+    }
+
+    template <class U>
+    bool operator==(const PoolAllocator<U> &) const { return true; }
+
+    template <class U>
+    bool operator!=(const PoolAllocator<U> &) const { return false; }
+};
+
+} // namespace gem5
+
+#endif // __BASE_POOL_ALLOC_HH__
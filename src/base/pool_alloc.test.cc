@@ -0,0 +1,360 @@
+/*
+ * Copyright (c) 2024 The University of Edinburgh
+ * All rights reserved
+ *
+ * The license below extends only to copyright in the software and shall
+ * not be construed as granting a license to any other intellectual
+ * property including but not limited to intellectual property relating
+ * to a hardware implementation of the functionality of the software
+ * licensed hereunder.  You may use the software subject to the license
+ * terms below provided that you ensure that this notice is replicated
+ * unmodified and in its entirety in all distributions of the software,
+ * modified or unmodified, in source code or in binary form.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <list>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "base/pool_alloc.hh"
+
+using namespace gem5;
+
+namespace
+{
+
+struct Base : public PoolAllocated
+{
+    virtual ~Base() = default;
+    uint64_t value = 0;
+};
+
+struct Derived : public Base
+{
+    uint64_t extra[12] = {};
+};
+
+struct DomainBase : public DomainPoolAllocated
+{
+    virtual ~DomainBase() = default;
+    uint64_t value = 0;
+};
+
+struct DomainDerived : public DomainBase
+{
+    uint64_t extra[5] = {};
+};
+
+uintptr_t
+slabOf(const void *p)
+{
+    return reinterpret_cast<uintptr_t>(p) & ~(SizeClassPool::SlabSize - 1);
+}
+
+} // anonymous namespace
+
+/** Freed chunks are handed out again for requests of the same class. */
+TEST(PoolAllocTest, RecyclesChunks)
+{
+    void *first = SizeClassPool::allocate(40);
+    SizeClassPool::deallocate(first, 40);
+    void *second = SizeClassPool::allocate(33);
+    EXPECT_EQ(first, second);
+    SizeClassPool::deallocate(second, 33);
+}
+
+/** Live chunks never alias and are suitably aligned. */
+TEST(PoolAllocTest, DistinctAlignedChunks)
+{
+    std::vector<void *> chunks;
+    std::set<void *> unique;
+    for (int i = 0; i < 300; i++) {
+        void *p = SizeClassPool::allocate(24);
+        EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(p) %
+                  SizeClassPool::Granularity);
+        chunks.push_back(p);
+        unique.insert(p);
+    }
+    EXPECT_EQ(chunks.size(), unique.size());
+    for (auto p : chunks)
+        SizeClassPool::deallocate(p, 24);
+}
+
+/** Oversized requests fall through to the system allocator. */
+TEST(PoolAllocTest, LargeAllocation)
+{
+    const std::size_t size = SizeClassPool::MaxPooledSize + 1;
+    char *p = static_cast<char *>(SizeClassPool::allocate(size));
+    p[0] = 1;
+    p[size - 1] = 2;
+    SizeClassPool::deallocate(p, size);
+}
+
+/** Deleting through a base pointer recycles into the derived class. */
+TEST(PoolAllocTest, PolymorphicDelete)
+{
+    Base *d = new Derived;
+    void *addr = d;
+    delete d;
+
+    Base *b = new Base;
+    EXPECT_NE(addr, static_cast<void *>(b));
+    Base *d2 = new Derived;
+    EXPECT_EQ(addr, static_cast<void *>(d2));
+    delete b;
+    delete d2;
+}
+
+/** Node-based containers work on top of the pool allocator. */
+TEST(PoolAllocTest, ContainerAllocator)
+{
+    std::unordered_map<int, std::list<int, PoolAllocator<int>>,
+        std::hash<int>, std::equal_to<int>,
+        PoolAllocator<std::pair<const int, std::list<int,
+            PoolAllocator<int>>>>> table;
+
+    for (int i = 0; i < 1000; i++)
+        table[i % 17].push_back(i);
+    EXPECT_EQ(17u, table.size());
+    EXPECT_EQ(59u, table[0].size());
+    EXPECT_EQ(16, table[16].front());
+
+    table.erase(3);
+    EXPECT_EQ(16u, table.size());
+    EXPECT_EQ(0u, table.count(3));
+}
+
+/** Chunks freed by another thread go back to the allocating thread. */
+TEST(PoolAllocTest, RemoteFreeReturnsToOwner)
+{
+    auto slab_of = [](void *p) {
+        return reinterpret_cast<uintptr_t>(p) & ~(SizeClassPool::SlabSize - 1);
+    };
+
+    const int num_chunks = 1000;
+    std::vector<void *> chunks;
+    std::set<uintptr_t> slabs;
+    for (int i = 0; i < num_chunks; i++) {
+        chunks.push_back(SizeClassPool::allocate(56));
+        slabs.insert(slab_of(chunks.back()));
+    }
+
+    std::thread remote([&chunks]() {
+        for (auto p : chunks)
+            SizeClassPool::deallocate(p, 56);
+    });
+    remote.join();
+
+    // The chunks freed remotely are reused, no new slab is needed
+    for (int i = 0; i < num_chunks; i++) {
+        chunks[i] = SizeClassPool::allocate(56);
+        EXPECT_EQ(1u, slabs.count(slab_of(chunks[i])));
+    }
+    for (auto p : chunks)
+        SizeClassPool::deallocate(p, 56);
+}
+
+/**
+ * Objects allocated on one thread and freed on another, concurrently, as
+ * credits in a parallel network are: the producer's footprint must stay
+ * bounded by the number of objects in flight.
+ */
+TEST(PoolAllocTest, CrossThreadFootprint)
+{
+    const int batch_size = 500;
+    const int num_batches = 400;
+    const int max_in_flight = 2;
+
+    std::mutex lock;
+    std::condition_variable cv;
+    std::vector<std::vector<Base *>> queue;
+    bool done = false;
+
+    std::thread consumer([&]() {
+        while (true) {
+            std::vector<Base *> batch;
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                cv.wait(guard, [&]() { return done || !queue.empty(); });
+                if (queue.empty())
+                    return;
+                batch = std::move(queue.front());
+                queue.erase(queue.begin());
+            }
+            cv.notify_all();
+            for (auto obj : batch)
+                delete obj;
+        }
+    });
+
+    std::set<void *> seen;
+    for (int b = 0; b < num_batches; b++) {
+        std::vector<Base *> batch;
+        for (int i = 0; i < batch_size; i++) {
+            batch.push_back(new Derived);
+            seen.insert(batch.back());
+        }
+        std::unique_lock<std::mutex> guard(lock);
+        cv.wait(guard, [&]() { return queue.size() < max_in_flight; });
+        queue.push_back(std::move(batch));
+        cv.notify_all();
+    }
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        done = true;
+    }
+    cv.notify_all();
+    consumer.join();
+
+    // At most max_in_flight queued batches, one being freed and one being
+    // built, plus the chunks left over in partially used slabs.
+    const std::size_t slab_chunks = SizeClassPool::SlabSize / sizeof(Derived);
+    EXPECT_LE(seen.size(),
+              (max_in_flight + 2) * batch_size + 2 * slab_chunks);
+}
+
+/** The pool of an exited thread is reused by the next thread. */
+TEST(PoolAllocTest, ExitedThreadPoolReused)
+{
+    void *first = nullptr;
+    std::thread([&first]() {
+        first = SizeClassPool::allocate(72);
+        SizeClassPool::deallocate(first, 72);
+    }).join();
+
+    void *second = nullptr;
+    std::thread([&second]() {
+        second = SizeClassPool::allocate(72);
+        SizeClassPool::deallocate(second, 72);
+    }).join();
+
+    EXPECT_EQ(first, second);
+}
+
+/** Domains and the static pools never share slabs. */
+TEST(PoolAllocTest, DomainSlabsAreSeparate)
+{
+    SizeClassPool::Domain first, second;
+
+    std::vector<void *> chunks[3];
+    std::set<uintptr_t> slabs[3];
+    for (int i = 0; i < 200; i++) {
+        chunks[0].push_back(first.allocate(48));
+        chunks[1].push_back(second.allocate(48));
+        chunks[2].push_back(SizeClassPool::allocate(48));
+        for (int j = 0; j < 3; j++)
+            slabs[j].insert(slabOf(chunks[j].back()));
+    }
+
+    for (auto p : chunks[0])
+        EXPECT_EQ(SizeClassPool::Domain::of(p), &first);
+    for (auto p : chunks[1])
+        EXPECT_EQ(SizeClassPool::Domain::of(p), &second);
+    for (auto p : chunks[2])
+        EXPECT_EQ(SizeClassPool::Domain::of(p), nullptr);
+
+    for (int j = 0; j < 3; j++) {
+        for (int k = j + 1; k < 3; k++) {
+            for (auto slab : slabs[j])
+                EXPECT_EQ(0u, slabs[k].count(slab));
+        }
+    }
+
+    for (int j = 0; j < 3; j++) {
+        for (auto p : chunks[j])
+            SizeClassPool::deallocate(p, 48);
+    }
+
+    // Freed chunks go back to their own domain
+    void *again = second.allocate(48);
+    EXPECT_EQ(1u, slabs[1].count(slabOf(again)));
+    SizeClassPool::deallocate(again, 48);
+}
+
+/**
+ * Each thread allocating from a domain gets its own pool, and chunks
+ * freed by another thread return to it, as for the static pools.
+ */
+TEST(PoolAllocTest, DomainRemoteFreeReturnsToOwner)
+{
+    SizeClassPool::Domain domain;
+
+    const int num_chunks = 1000;
+    std::vector<void *> chunks;
+    std::set<uintptr_t> slabs;
+    for (int i = 0; i < num_chunks; i++) {
+        chunks.push_back(domain.allocate(56));
+        slabs.insert(slabOf(chunks.back()));
+    }
+
+    std::set<uintptr_t> remote_slabs;
+    std::thread remote([&]() {
+        void *own = domain.allocate(56);
+        remote_slabs.insert(slabOf(own));
+        SizeClassPool::deallocate(own, 56);
+        for (auto p : chunks)
+            SizeClassPool::deallocate(p, 56);
+    });
+    remote.join();
+
+    // The other thread carved its chunk out of a slab of its own
+    for (auto slab : remote_slabs)
+        EXPECT_EQ(0u, slabs.count(slab));
+
+    // The chunks freed remotely are reused, no new slab is needed
+    for (int i = 0; i < num_chunks; i++) {
+        chunks[i] = domain.allocate(56);
+        EXPECT_EQ(1u, slabs.count(slabOf(chunks[i])));
+    }
+    for (auto p : chunks)
+        SizeClassPool::deallocate(p, 56);
+}
+
+/** Objects of a hierarchy created with new (domain) come from it. */
+TEST(PoolAllocTest, DomainPoolAllocatedObjects)
+{
+    SizeClassPool::Domain domain;
+
+    DomainBase *d = new (domain) DomainDerived;
+    EXPECT_EQ(SizeClassPool::Domain::of(d), &domain);
+    void *addr = d;
+    delete d;
+
+    // The derived class size was recycled, not the base class one
+    DomainBase *b = new (domain) DomainBase;
+    EXPECT_NE(addr, static_cast<void *>(b));
+    DomainBase *d2 = new (domain) DomainDerived;
+    EXPECT_EQ(addr, static_cast<void *>(d2));
+    delete b;
+    delete d2;
+}
@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) 2024 The University of Edinburgh
+ * All rights reserved
+ *
+ * The license below extends only to copyright in the software and shall
+ * not be construed as granting a license to any other intellectual
+ * property including but not limited to intellectual property relating
+ * to a hardware implementation of the functionality of the software
+ * licensed hereunder.  You may use the software subject to the license
+ * terms below provided that you ensure that this notice is replicated
+ * unmodified and in its entirety in all distributions of the software,
+ * modified or unmodified, in source code or in binary form.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __BASE_READY_MASK_HH__
+#define __BASE_READY_MASK_HH__
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#include "base/bitfield.hh"
+
+namespace gem5
+{
+
+/**
+ * A fixed-size set of small integers, typically the ports or buffers
+ * that have work pending, kept as a bitmap.
+ *
+ * Arbiters use it to find the next ready member with find-first-set on
+ * whole 64-bit words instead of testing the members one at a time, so
+ * the cost of a round-robin pick depends on the number of ready members
+ * rather than the number of members.
+ */
+class ReadyMask
+{
+  private:
+    std::vector<uint64_t> bits;
+    int numBits = 0;
+
+  public:
+    ReadyMask(int n=0) { resize(n); }
+
+    /** Set the number of members. All of them are cleared. */
+    void
+    resize(int n)
+    {
+        numBits = n;
+        bits.assign((n + 63) / 64, 0);
+    }
+
+    int size() const { return numBits; }
+
+    void
+    set(int i)
+    {
+        assert(i >= 0 && i < numBits);
+        bits[i / 64] |= (1ULL << (i % 64));
+    }
+
+    void
+    clear(int i)
+    {
+        assert(i >= 0 && i < numBits);
+        bits[i / 64] &= ~(1ULL << (i % 64));
+    }
+
+    bool
+    test(int i) const
+    {
+        assert(i >= 0 && i < numBits);
+        return bits[i / 64] & (1ULL << (i % 64));
+    }
+
+    /** Clear all members. */
+    void reset() { std::fill(bits.begin(), bits.end(), 0); }
+
+    bool
+    none() const
+    {
+        return std::all_of(bits.begin(), bits.end(),
+                           [](uint64_t w) { return w == 0; });
+    }
+
+    /** The first set member in [i, end), or end if there is none. */
+    int
+    next(int i, int end) const
+    {
+        assert(end <= numBits);
+        if (i >= end)
+            return end;
+
+        int word = i / 64;
+        uint64_t w = bits[word] & (~0ULL << (i % 64));
+        while (!w) {
+            if (++word == (int)bits.size())
+                return end;
+            w = bits[word];
+        }
+        return std::min(end, word * 64 + ctz64(w));
+    }
+
+    /** The first set member at or after i, or size() if there is none. */
+    int next(int i) const { return next(i, numBits); }
+
+    /**
+     * Round-robin pick: the first set member at or after start, wrapping
+     * around to 0. Returns -1 if no member is set.
+     */
+    int
+    nextWrapped(int start) const
+    {
+        int i = next(start);
+        if (i < numBits)
+            return i;
+        i = next(0, start);
+        return (i < start) ? i : -1;
+    }
+
+    /**
+     * Call func(i) for the set members in round-robin order, i.e. from
+     * start up to the end and then from 0 up to start. The mask is read
+     * again after each call, so func may clear members it has not been
+     * called for yet to skip them.
+     */
+    template <class Func>
+    void
+    forEachFrom(int start, Func func) const
+    {
+        for (int i = next(start); i < numBits; i = next(i + 1))
+            func(i);
+        for (int i = next(0, start); i < start; i = next(i + 1, start))
+            func(i);
+    }
+
+    /** Call func(i) for the set members in increasing order. */
+    template <class Func>
+    void forEach(Func func) const { forEachFrom(0, func); }
+};
+
+} // namespace gem5
+
+#endif // __BASE_READY_MASK_HH__
@@ -0,0 +1,213 @@
+/*
+ * Copyright (c) 2024 The University of Edinburgh
+ * All rights reserved
+ *
+ * The license below extends only to copyright in the software and shall
+ * not be construed as granting a license to any other intellectual
+ * property including but not limited to intellectual property relating
+ * to a hardware implementation of the functionality of the software
+ * licensed hereunder.  You may use the software subject to the license
+ * terms below provided that you ensure that this notice is replicated
+ * unmodified and in its entirety in all distributions of the software,
+ * modified or unmodified, in source code or in binary form.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "base/ready_mask.hh"
+
+using namespace gem5;
+
+TEST(ReadyMaskTest, SetClearTest)
+{
+    ReadyMask mask(130);
+    EXPECT_EQ(mask.size(), 130);
+    EXPECT_TRUE(mask.none());
+
+    mask.set(0);
+    mask.set(63);
+    mask.set(64);
+    mask.set(129);
+    EXPECT_FALSE(mask.none());
+    EXPECT_TRUE(mask.test(63));
+    EXPECT_TRUE(mask.test(64));
+    EXPECT_FALSE(mask.test(65));
+
+    mask.clear(63);
+    EXPECT_FALSE(mask.test(63));
+    mask.reset();
+    EXPECT_TRUE(mask.none());
+
+    // Resizing clears the members
+    mask.set(5);
+    mask.resize(10);
+    EXPECT_EQ(mask.size(), 10);
+    EXPECT_TRUE(mask.none());
+}
+
+TEST(ReadyMaskTest, NextAcrossWords)
+{
+    ReadyMask mask(200);
+    EXPECT_EQ(mask.next(0), 200);
+
+    mask.set(3);
+    mask.set(64);
+    mask.set(199);
+    EXPECT_EQ(mask.next(0), 3);
+    EXPECT_EQ(mask.next(3), 3);
+    EXPECT_EQ(mask.next(4), 64);
+    EXPECT_EQ(mask.next(65), 199);
+    EXPECT_EQ(mask.next(200), 200);
+
+    // A bounded search stops at its end
+    EXPECT_EQ(mask.next(4, 64), 64);
+    EXPECT_EQ(mask.next(4, 65), 64);
+    EXPECT_EQ(mask.next(65, 150), 150);
+    EXPECT_EQ(mask.next(10, 10), 10);
+}
+
+TEST(ReadyMaskTest, NextWrapped)
+{
+    ReadyMask mask(70);
+    EXPECT_EQ(mask.nextWrapped(0), -1);
+    EXPECT_EQ(mask.nextWrapped(69), -1);
+
+    mask.set(5);
+    EXPECT_EQ(mask.nextWrapped(0), 5);
+    EXPECT_EQ(mask.nextWrapped(5), 5);
+    EXPECT_EQ(mask.nextWrapped(6), 5);
+
+    mask.set(68);
+    EXPECT_EQ(mask.nextWrapped(6), 68);
+    EXPECT_EQ(mask.nextWrapped(69), 5);
+}
+
+TEST(ReadyMaskTest, ForEachFromSkipsClearedMembers)
+{
+    ReadyMask mask(8);
+    for (int i = 0; i < 8; i++)
+        mask.set(i);
+
+    // Members cleared by the callback before they are reached are
+    // skipped, as a scan over the live state would skip them.
+    std::vector<int> order;
+    mask.forEachFrom(6, [&](int i) {
+        order.push_back(i);
+        if (i == 7)
+            mask.clear(1);
+    });
+    EXPECT_EQ(order, std::vector<int>({6, 7, 0, 2, 3, 4, 5}));
+}
+
+/**
+ * The order in which forEachFrom() visits the members must be the one
+ * of the modular scan it replaces, which visited (start + i) % n for
+ * every i and skipped the members that were not set.
+ */
+TEST(ReadyMaskTest, ServiceOrderMatchesModularScan)
+{
+    std::mt19937 rng(11);
+    for (int n : {1, 3, 63, 64, 65, 130}) {
+        for (int trial = 0; trial < 200; trial++) {
+            ReadyMask mask(n);
+            std::vector<bool> ref(n);
+            for (int i = 0; i < n; i++) {
+                if (rng() % 3 == 0) {
+                    mask.set(i);
+                    ref[i] = true;
+                }
+            }
+            int start = rng() % n;
+
+            std::vector<int> expected;
+            for (int i = 0; i < n; i++) {
+                int pos = (start + i) % n;
+                if (ref[pos])
+                    expected.push_back(pos);
+            }
+
+            std::vector<int> order;
+            mask.forEachFrom(start, [&](int i) { order.push_back(i); });
+            EXPECT_EQ(order, expected) << "n=" << n << " start=" << start;
+
+            int first = expected.empty() ? -1 : expected.front();
+            EXPECT_EQ(mask.nextWrapped(start), first);
+        }
+    }
+}
+
+/**
+ * A round-robin arbiter that moves its pointer past each winner must
+ * serve every persistent requester in turn, and pick exactly the
+ * winners of the linear scan it replaces.
+ */
+TEST(ReadyMaskTest, RoundRobinIsFair)
+{
+    const int n = 70;
+    std::mt19937 rng(5);
+
+    ReadyMask mask(n);
+    std::vector<int> wins(n), ref_wins(n);
+    int ptr = 0, ref_ptr = 0;
+    for (int cycle = 0; cycle < 7000; cycle++) {
+        mask.reset();
+        std::vector<bool> ref(n);
+        for (int i = 0; i < n; i++) {
+            // Even members always request, odd ones now and then
+            if (i % 2 == 0 || rng() % 4 == 0) {
+                mask.set(i);
+                ref[i] = true;
+            }
+        }
+
+        int winner = mask.nextWrapped(ptr);
+        ASSERT_GE(winner, 0);
+        wins[winner]++;
+        ptr = (winner + 1) % n;
+
+        int ref_winner = -1;
+        for (int i = 0; i < n; i++) {
+            int pos = (ref_ptr + i) % n;
+            if (ref[pos]) {
+                ref_winner = pos;
+                break;
+            }
+        }
+        ASSERT_EQ(winner, ref_winner);
+        ref_wins[ref_winner]++;
+        ref_ptr = (ref_winner + 1) % n;
+    }
+
+    EXPECT_EQ(wins, ref_wins);
+
+    // Persistent requesters never fall more than one turn behind
+    for (int i = 2; i < n; i += 2)
+        EXPECT_LE(std::abs(wins[i] - wins[0]), 1);
+}
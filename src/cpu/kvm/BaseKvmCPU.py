@@ -79,3 +79,23 @@ class BaseKvmCPU(BaseCPU):
 
     hostFreq = Param.Clock("2GHz", "Host clock frequency")
     hostFactor = Param.Float(1.0, "Cycle scale factor")
+
+    simpoint_interval = Param.UInt64(
+        0,
+        "SimPoint interval size (insts) for sampled BBV collection "
+        "(0 to disable). Requires usePerf.",
+    )
+    simpoint_profile_file = Param.String(
+        "simpoint.bb.gz", "Sampled BBV (output) file"
+    )
+    simpoint_sample_period = Param.UInt64(
+        100003, "Guest instructions between two BBV samples"
+    )
+    # Off by default, as the host PMU doesn't record the branches taken
+    # by the guest on all hosts (e.g., Intel VMX without guest LBR
+    # support), in which case samples fall back to the guest IP anyway
+    simpoint_branch_stack = Param.Bool(
+        False,
+        "Build BBVs from sampled taken-branch records if the host PMU "
+        "supports them, from sampled instruction pointers otherwise",
+    )
@@ -42,11 +42,13 @@
 #include <sys/mman.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <cerrno>
 #include <csignal>
 #include <ostream>
 
 #include "base/compiler.hh"
+#include "base/output.hh"
 #include "debug/Checkpoint.hh"
 #include "debug/Drain.hh"
 #include "debug/Kvm.hh"
@@ -81,7 +83,10 @@ BaseKvmCPU::BaseKvmCPU(const BaseKvmCPUParams &params)
       hwCycles(nullptr),
       hwInstructions(nullptr),
       perfControlledByTimer(params.usePerfOverflow),
-      hostFactor(params.hostFactor), stats(this),
+      hostFactor(params.hostFactor),
+      bbvInterval(params.simpoint_interval),
+      bbvEvent([this]{ bbvIntervalDone(); }, name() + ".bbvEvent"),
+      stats(this),
       ctrInsts(0)
 {
     if (pageSize == -1)
@@ -115,6 +120,19 @@ BaseKvmCPU::BaseKvmCPU(const BaseKvmCPUParams &params)
                "be updated. The stats should not be used for performance "
                "evaluation.");
     }
+
+    if (bbvInterval && usePerf) {
+        bbvStream = simout.create(params.simpoint_profile_file, false);
+        if (!bbvStream)
+            fatal("unable to open SimPoint profile_file");
+        bbvSampler.reset(new KvmBBVSampler(name() + ".bbv",
+                                           *bbvStream->stream(),
+                                           params.simpoint_sample_period,
+                                           params.simpoint_branch_stack));
+    } else if (bbvInterval) {
+        warn("KVM: Sampled BBV collection requires perf, not collecting "
+             "BBVs.\n");
+    }
 }
 
 BaseKvmCPU::~BaseKvmCPU()
@@ -122,6 +140,10 @@ BaseKvmCPU::~BaseKvmCPU()
     if (_kvmRun)
         munmap(_kvmRun, vcpuMMapSize);
     close(vcpuFD);
+
+    bbvSampler.reset();
+    if (bbvStream)
+        simout.close(bbvStream);
 }
 
 void
@@ -266,6 +288,9 @@ BaseKvmCPU::restartEqThread()
 
     setupCounters();
 
+    if (bbvSampler && !bbvEvent.scheduled())
+        tc->scheduleInstCountEvent(&bbvEvent, ctrInsts + bbvInterval);
+
     if (p.usePerfOverflow) {
         runTimer.reset(new PerfKvmTimer(*hwCycles,
                                         KVM_KICK_SIGNAL,
@@ -296,7 +321,9 @@ BaseKvmCPU::StatGroup::StatGroup(statistics::Group *parent)
              "number of VM exits due to wait for interrupt instructions"),
     ADD_STAT(numInterrupts, statistics::units::Count::get(),
              "number of interrupts delivered"),
-    ADD_STAT(numHypercalls, statistics::units::Count::get(), "number of hypercalls")
+    ADD_STAT(numHypercalls, statistics::units::Count::get(), "number of hypercalls"),
+    ADD_STAT(numBBVSamples, statistics::units::Count::get(),
+             "number of guest samples used to build BBVs")
 {
 }
 
@@ -444,6 +471,8 @@ BaseKvmCPU::notifyFork()
         _kvmRun = NULL;
 
         if (usePerf) {
+            if (bbvSampler)
+                bbvSampler->detach();
             hwInstructions->detach();
             hwCycles->detach();
         }
@@ -797,6 +826,9 @@ BaseKvmCPU::kvmRun(Tick ticks)
         // enter into KVM.
         discardPendingSignal(KVM_KICK_SIGNAL);
 
+        if (bbvSampler)
+            stats.numBBVSamples += bbvSampler->collect();
+
         const uint64_t hostCyclesExecuted(getHostCycles() - baseCycles);
         const uint64_t simCyclesExecuted(hostCyclesExecuted * hostFactor);
         uint64_t instsExecuted = 0;
@@ -1326,9 +1358,29 @@ BaseKvmCPU::setupCounters()
 
         hwCycles->attach(cfgCycles, 0); // TID (0 => currentThread)
         setupInstCounter();
+
+        // The BBV sampler is a member of the cycle counter's group,
+        // so it has to follow it. Stop collecting BBVs if the host
+        // can't sample guest instructions.
+        if (bbvSampler && !bbvSampler->attach(*hwCycles)) {
+            if (bbvEvent.scheduled())
+                tc->descheduleInstCountEvent(&bbvEvent);
+            bbvSampler.reset();
+        }
     }
 }
 
+void
+BaseKvmCPU::bbvIntervalDone()
+{
+    bbvSampler->dumpInterval();
+
+    // The vCPU may exit a few instructions late, keep the intervals
+    // aligned but make sure the next one ends in the future.
+    tc->scheduleInstCountEvent(&bbvEvent,
+        std::max<Tick>(bbvEvent.when() + bbvInterval, ctrInsts + 1));
+}
+
 bool
 BaseKvmCPU::tryDrain()
 {
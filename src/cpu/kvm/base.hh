@@ -45,6 +45,7 @@
 #include <queue>
 
 #include "base/statistics.hh"
+#include "cpu/kvm/bbv_sampler.hh"
 #include "cpu/kvm/perfevent.hh"
 #include "cpu/kvm/timer.hh"
 #include "cpu/kvm/vm.hh"
@@ -66,6 +67,7 @@ namespace gem5
 {
 
 // forward declarations
+class OutputStream;
 class ThreadContext;
 struct BaseKvmCPUParams;
 
@@ -802,6 +804,23 @@ class BaseKvmCPU : public BaseCPU
     /** Host factor as specified in the configuration */
     float hostFactor;
 
+    /** @{ */
+    /** Sampled SimPoint BBV collection, null if disabled */
+    std::unique_ptr<KvmBBVSampler> bbvSampler;
+
+    /** Sampled BBV output file */
+    OutputStream *bbvStream = nullptr;
+
+    /** BBV interval size in guest instructions */
+    const uint64_t bbvInterval;
+
+    /** Instruction count event ending the current BBV interval */
+    EventFunctionWrapper bbvEvent;
+
+    /** Write the current BBV and schedule the end of the next interval */
+    void bbvIntervalDone();
+    /** @} */
+
   public:
     /* @{ */
     struct StatGroup : public statistics::Group
@@ -816,6 +835,7 @@ class BaseKvmCPU : public BaseCPU
         statistics::Scalar numHalt;
         statistics::Scalar numInterrupts;
         statistics::Scalar numHypercalls;
+        statistics::Scalar numBBVSamples;
     } stats;
     /* @} */
 
@@ -0,0 +1,251 @@
+/*
+ * Copyright (c) 2024 The University of Edinburgh
+ * All rights reserved
+ *
+ * The license below extends only to copyright in the software and shall
+ * not be construed as granting a license to any other intellectual
+ * property including but not limited to intellectual property relating
+ * to a hardware implementation of the functionality of the software
+ * licensed hereunder.  You may use the software subject to the license
+ * terms below provided that you ensure that this notice is replicated
+ * unmodified and in its entirety in all distributions of the software,
+ * modified or unmodified, in source code or in binary form.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cpu/kvm/bbv_sampler.hh"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+#include "base/logging.hh"
+#include "base/trace.hh"
+#include "debug/Kvm.hh"
+
+namespace gem5
+{
+
+KvmBBVSampler::KvmBBVSampler(const std::string &name, std::ostream &os,
+                             uint64_t sample_period, bool branch_stack)
+    : Named(name),
+      samplePeriod(sample_period),
+      useBranchStack(branch_stack),
+      os(os),
+      nextId(1),
+      lostSamples(0),
+      hostSamples(0),
+      invalidBranchSamples(0)
+{
+    fatal_if(samplePeriod == 0, "%s: The BBV sample period must be "
+             "larger than 0.\n", name);
+}
+
+bool
+KvmBBVSampler::attach(const PerfKvmCounter &group)
+{
+    if (counter.attached())
+        counter.detach();
+
+    while (true) {
+        PerfKvmCounterConfig cfg(PERF_TYPE_HARDWARE,
+                                 PERF_COUNT_HW_INSTRUCTIONS);
+        cfg.exclude_hv(true)
+            .exclude_host(true)
+            .samplePeriod(samplePeriod)
+            .sampleType(PERF_SAMPLE_IP);
+        if (useBranchStack)
+            cfg.branchSampleType(PERF_SAMPLE_BRANCH_ANY);
+
+        if (counter.tryAttach(cfg, 0, group, RingPages))
+            break;
+
+        if (!useBranchStack) {
+            warn("%s: Host PMU can't sample guest instructions (%s), "
+                 "not collecting BBVs.\n", name(), strerror(errno));
+            return false;
+        }
+
+        inform("%s: Host PMU can't record taken branches (%s), "
+               "sampling instruction pointers instead.\n",
+               name(), strerror(errno));
+        useBranchStack = false;
+    }
+
+    DPRINTF(Kvm, "Sampling BBVs every %i instructions using %s\n",
+            samplePeriod,
+            useBranchStack ? "branch records" : "instruction pointers");
+    return true;
+}
+
+void
+KvmBBVSampler::detach()
+{
+    if (counter.attached())
+        counter.detach();
+}
+
+uint64_t
+KvmBBVSampler::collect()
+{
+    if (!counter.attached())
+        return 0;
+
+    uint64_t samples = 0;
+    counter.readRecords([&](const struct perf_event_header &hdr,
+                            const uint8_t *data) {
+        if (hdr.type == PERF_RECORD_SAMPLE) {
+            addSample(hdr, data);
+            ++samples;
+        } else if (hdr.type == PERF_RECORD_LOST) {
+            // struct { u64 id; u64 lost; }
+            uint64_t lost;
+            memcpy(&lost, data + sizeof(uint64_t), sizeof(lost));
+            if (!lostSamples) {
+                warn("%s: BBV sample buffer overflowed, consider "
+                     "increasing the sample period.\n", name());
+            }
+            lostSamples += lost;
+        }
+    });
+
+    return samples;
+}
+
+void
+KvmBBVSampler::addSample(const struct perf_event_header &hdr,
+                         const uint8_t *data)
+{
+    const uint16_t mode = hdr.misc & PERF_RECORD_MISC_CPUMODE_MASK;
+    if (mode != PERF_RECORD_MISC_GUEST_KERNEL &&
+            mode != PERF_RECORD_MISC_GUEST_USER) {
+        ++hostSamples;
+        return;
+    }
+
+    const size_t size = hdr.size - sizeof(hdr);
+    uint64_t ip;
+    if (size < sizeof(ip))
+        return;
+    memcpy(&ip, data, sizeof(ip));
+
+    std::vector<BlockRange> blocks;
+    // struct { u64 ip; u64 bnr; struct perf_branch_entry lbr[bnr]; }
+    const size_t lbr_offset = 2 * sizeof(uint64_t);
+    uint64_t bnr = 0;
+    if (useBranchStack && size >= lbr_offset) {
+        memcpy(&bnr, data + sizeof(ip), sizeof(bnr));
+        bnr = std::min<uint64_t>(bnr, (size - lbr_offset) /
+                                 sizeof(struct perf_branch_entry));
+    }
+
+    if (bnr) {
+        // Records are ordered from the most recent branch. The
+        // instructions between the target of a branch and the source
+        // of the next one form a basic block, the most recent of which
+        // ends at the sampled instruction. Only use the records as far
+        // as they form such a chain of guest branches, which breaks at
+        // records that weren't taken by the guest or don't follow each
+        // other (e.g., because of an interrupt).
+        std::vector<struct perf_branch_entry> lbr(bnr);
+        memcpy(lbr.data(), data + lbr_offset,
+               bnr * sizeof(struct perf_branch_entry));
+
+        const bool user = mode == PERF_RECORD_MISC_GUEST_USER;
+        Addr end = ip;
+        for (const auto &br : lbr) {
+            if (user && (kernelAddr(br.from) || kernelAddr(br.to)))
+                break;
+            if (br.to > end || end - br.to >= MaxBlockSize)
+                break;
+            blocks.emplace_back(br.to, end);
+            end = br.from;
+        }
+
+        if (blocks.empty()) {
+            if (!invalidBranchSamples) {
+                warn("%s: Branch records don't lead to the sampled guest "
+                     "instruction, the host PMU may not record guest "
+                     "branches. Using instruction pointers for such "
+                     "samples.\n", name());
+            }
+            ++invalidBranchSamples;
+        }
+    }
+
+    if (blocks.empty()) {
+        addBlock(ipMap, ip & ~(IpGranularity - 1), samplePeriod);
+        return;
+    }
+
+    // Split the sampled instructions between the blocks in proportion
+    // to their size.
+    uint64_t total = 0;
+    for (const auto &bb : blocks)
+        total += bb.second - bb.first + 1;
+    for (const auto &bb : blocks) {
+        addBlock(bbMap, bb.first,
+                 samplePeriod * (bb.second - bb.first + 1) / total);
+    }
+}
+
+void
+KvmBBVSampler::addBlock(BBMap &map, Addr start, uint64_t weight)
+{
+    auto [it, inserted] = map.try_emplace(start, BBInfo{0, 0});
+    if (inserted)
+        it->second.id = nextId++;
+    it->second.count += weight;
+}
+
+void
+KvmBBVSampler::dumpInterval()
+{
+    collect();
+
+    std::vector<std::pair<uint64_t, uint64_t>> counts;
+    for (auto *map : {&bbMap, &ipMap}) {
+        for (auto &[start, info] : *map) {
+            if (info.count != 0) {
+                counts.emplace_back(info.id, info.count);
+                info.count = 0;
+            }
+        }
+    }
+    std::sort(counts.begin(), counts.end());
+
+    // Same format as the SimPoint probe
+    os << "T";
+    for (const auto &[id, count] : counts)
+        os << ":" << id << ":" << count << " ";
+    os << "\n";
+
+    DPRINTF(Kvm, "BBV interval with %i blocks (%i lost, %i host and %i "
+            "invalid branch samples so far)\n", counts.size(), lostSamples,
+            hostSamples, invalidBranchSamples);
+}
+
+} // namespace gem5
@@ -0,0 +1,197 @@
+/*
+ * Copyright (c) 2024 The University of Edinburgh
+ * All rights reserved
+ *
+ * The license below extends only to copyright in the software and shall
+ * not be construed as granting a license to any other intellectual
+ * property including but not limited to intellectual property relating
+ * to a hardware implementation of the functionality of the software
+ * licensed hereunder.  You may use the software subject to the license
+ * terms below provided that you ensure that this notice is replicated
+ * unmodified and in its entirety in all distributions of the software,
+ * modified or unmodified, in source code or in binary form.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __CPU_KVM_BBV_SAMPLER_HH__
+#define __CPU_KVM_BBV_SAMPLER_HH__
+
+#include <linux/perf_event.h>
+
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "base/named.hh"
+#include "base/types.hh"
+#include "cpu/kvm/perfevent.hh"
+
+namespace gem5
+{
+
+/**
+ * Approximate SimPoint basic block vector (BBV) collection for KVM
+ * CPUs.
+ *
+ * The KVM CPU doesn't observe individual instructions, so the BBVs
+ * are built from samples taken by the host PMU while the guest
+ * executes. A guest instruction counter overflows every samplePeriod
+ * instructions and writes a sample to a ring buffer. Where the host
+ * supports it, every sample contains the most recent taken branches
+ * (e.g., from the LBR on Intel CPUs). Consecutive branch records
+ * delimit the basic blocks executed before the sample and the sampled
+ * period is split between them in proportion to their size in bytes.
+ * Basic blocks are identified by their start address, as the block
+ * leading to the sampled instruction is only seen up to that
+ * instruction.
+ *
+ * Branch records are only used as far as they chain up to the sampled
+ * guest instruction pointer. Hosts where the PMU doesn't record the
+ * branches taken by the guest (e.g., the LBR on Intel VMX without
+ * guest LBR support) produce records that don't, and user mode samples
+ * with kernel branch addresses are rejected too. Such samples, and
+ * hosts without branch records, fall back to the guest instruction
+ * pointer, attributing the sampled period to the IpGranularity aligned
+ * code region containing it.
+ *
+ * The output uses the same format as the SimPoint probe, so the
+ * SimPoint tools can consume it directly.
+ */
+class KvmBBVSampler : public Named
+{
+  public:
+    /**
+     * @param name Name used for diagnostics
+     * @param os BBV output stream
+     * @param sample_period Guest instructions between two samples
+     * @param branch_stack Try to sample taken branch records
+     */
+    KvmBBVSampler(const std::string &name, std::ostream &os,
+                  uint64_t sample_period, bool branch_stack);
+
+    /**
+     * Attach the sampling counter to a counter group.
+     *
+     * Falls back to instruction pointer sampling if the host can't
+     * record taken branches.
+     *
+     * @param group Group leader that starts and stops the sampler
+     * @return false if the host doesn't support sampling at all.
+     */
+    bool attach(const PerfKvmCounter &group);
+
+    /** Detach the sampling counter. */
+    void detach();
+
+    bool attached() const { return counter.attached(); }
+
+    /** Are samples taken with branch records? */
+    bool branchStack() const { return useBranchStack; }
+
+    /**
+     * Add the samples in the ring buffer to the current interval.
+     *
+     * @return Number of samples consumed.
+     */
+    uint64_t collect();
+
+    /** Write the BBV of the current interval and start a new one. */
+    void dumpInterval();
+
+    /**
+     * Add a sample record to the current interval.
+     *
+     * @param hdr Record header
+     * @param data Record contents following the header
+     */
+    void addSample(const struct perf_event_header &hdr,
+                   const uint8_t *data);
+
+  private:
+    /** Code region size used when sampling instruction pointers */
+    static constexpr Addr IpGranularity = 64;
+
+    /**
+     * Largest basic block accepted from a pair of branch records.
+     * Larger ranges are the result of records that don't follow each
+     * other (e.g., because of an interrupt) and are dropped.
+     */
+    static constexpr Addr MaxBlockSize = 4096;
+
+    /** Pages in the sample ring buffer */
+    static constexpr int RingPages = 64;
+
+    /** Start and end address of a basic block */
+    using BlockRange = std::pair<Addr, Addr>;
+
+    /** Basic block information */
+    struct BBInfo
+    {
+        /** Unique ID */
+        uint64_t id;
+        /** Estimated dynamic inst count in the current interval */
+        uint64_t count;
+    };
+
+    using BBMap = std::unordered_map<Addr, BBInfo>;
+
+    /** Add weight guest instructions to a block or code region. */
+    void addBlock(BBMap &map, Addr start, uint64_t weight);
+
+    /** Is an address in the upper (kernel) half of the address space? */
+    static bool
+    kernelAddr(Addr addr)
+    {
+        return addr >> 63;
+    }
+
+    const uint64_t samplePeriod;
+    bool useBranchStack;
+
+    /** Sampling guest instruction counter */
+    PerfKvmCounter counter;
+
+    /** BBV output stream */
+    std::ostream &os;
+
+    /** All previously seen basic blocks, by start address */
+    BBMap bbMap;
+    /** All previously sampled code regions without branch records */
+    BBMap ipMap;
+    /** Next basic block or code region ID */
+    uint64_t nextId;
+
+    /** Samples lost because the ring buffer was full */
+    uint64_t lostSamples;
+    /** Samples dropped because they weren't taken in the guest */
+    uint64_t hostSamples;
+    /** Samples whose branch records didn't lead to the guest IP */
+    uint64_t invalidBranchSamples;
+};
+
+} // namespace gem5
+
+#endif // __CPU_KVM_BBV_SAMPLER_HH__
@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2024 The University of Edinburgh
+ * All rights reserved
+ *
+ * The license below extends only to copyright in the software and shall
+ * not be construed as granting a license to any other intellectual
+ * property including but not limited to intellectual property relating
+ * to a hardware implementation of the functionality of the software
+ * licensed hereunder.  You may use the software subject to the license
+ * terms below provided that you ensure that this notice is replicated
+ * unmodified and in its entirety in all distributions of the software,
+ * modified or unmodified, in source code or in binary form.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <sstream>
+#include <vector>
+
+#include "cpu/kvm/bbv_sampler.hh"
+
+using namespace gem5;
+
+namespace
+{
+
+/** Builds a PERF_RECORD_SAMPLE with PERF_SAMPLE_IP and branch records */
+class SampleRecord
+{
+  public:
+    SampleRecord(uint16_t mode, uint64_t ip,
+                 const std::vector<std::pair<uint64_t, uint64_t>> &lbr = {})
+    {
+        append(ip);
+        append(lbr.size());
+        for (const auto &[from, to] : lbr) {
+            struct perf_branch_entry br = {};
+            br.from = from;
+            br.to = to;
+            append(br);
+        }
+
+        hdr.type = PERF_RECORD_SAMPLE;
+        hdr.misc = mode;
+        hdr.size = sizeof(hdr) + data.size();
+    }
+
+    void
+    addTo(KvmBBVSampler &sampler) const
+    {
+        sampler.addSample(hdr, data.data());
+    }
+
+  private:
+    template <typename T>
+    void
+    append(const T &value)
+    {
+        const size_t offset = data.size();
+        data.resize(offset + sizeof(value));
+        memcpy(data.data() + offset, &value, sizeof(value));
+    }
+
+    struct perf_event_header hdr;
+    std::vector<uint8_t> data;
+};
+
+const uint16_t GuestUser = PERF_RECORD_MISC_GUEST_USER;
+const uint16_t GuestKernel = PERF_RECORD_MISC_GUEST_KERNEL;
+
+} // anonymous namespace
+
+TEST(KvmBBVSamplerTest, InstructionPointers)
+{
+    std::ostringstream os;
+    KvmBBVSampler sampler("bbv", os, 100, false);
+
+    // Samples in the same 64 byte region share a block
+    SampleRecord(GuestUser, 0x1010).addTo(sampler);
+    SampleRecord(GuestKernel, 0x1030).addTo(sampler);
+    SampleRecord(GuestUser, 0x2000).addTo(sampler);
+    // Samples taken in the host are dropped
+    SampleRecord(PERF_RECORD_MISC_KERNEL, 0x1010).addTo(sampler);
+    sampler.dumpInterval();
+
+    SampleRecord(GuestUser, 0x2004).addTo(sampler);
+    sampler.dumpInterval();
+    sampler.dumpInterval();
+
+    EXPECT_EQ(os.str(), "T:1:200 :2:100 \nT:2:100 \nT\n");
+}
+
+TEST(KvmBBVSamplerTest, BranchRecords)
+{
+    std::ostringstream os;
+    KvmBBVSampler sampler("bbv", os, 274, true);
+
+    // Most recent branch first: the sampled block starts at 0x1000 and
+    // the one before it spans [0x2f00, 0x3000]. The period is split in
+    // proportion to their 17 and 257 bytes.
+    SampleRecord(GuestUser, 0x1010,
+                 {{0x3000, 0x1000}, {0x500, 0x2f00}}).addTo(sampler);
+    sampler.dumpInterval();
+
+    // The block leading to the sample is keyed by its start, whichever
+    // instruction is sampled in it
+    SampleRecord(GuestUser, 0x1100, {{0x3000, 0x1000}}).addTo(sampler);
+    SampleRecord(GuestUser, 0x1004, {{0x3000, 0x1000}}).addTo(sampler);
+    sampler.dumpInterval();
+
+    EXPECT_EQ(os.str(), "T:1:17 :2:257 \nT:1:548 \n");
+}
+
+TEST(KvmBBVSamplerTest, InvalidBranchRecords)
+{
+    std::ostringstream os;
+    KvmBBVSampler sampler("bbv", os, 100, true);
+
+    // Host kernel branches in a guest user sample
+    SampleRecord(GuestUser, 0x1010,
+                 {{0xffffffff81000000, 0xffffffff81000100}}).addTo(sampler);
+    // Branch to an address after the sampled instruction
+    SampleRecord(GuestKernel, 0x1020, {{0x3000, 0x2000}}).addTo(sampler);
+    sampler.dumpInterval();
+
+    // Records are used up to the first one which breaks the chain
+    SampleRecord(GuestUser, 0x1010,
+                 {{0x3000, 0x1000}, {0xffffffff81000000, 0x2f00},
+                  {0x500, 0x2f00}}).addTo(sampler);
+    sampler.dumpInterval();
+
+    EXPECT_EQ(os.str(), "T:1:200 \nT:2:100 \n");
+}
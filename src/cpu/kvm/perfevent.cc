@@ -43,10 +43,12 @@
 #include <syscall.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <cassert>
 #include <cerrno>
 #include <csignal>
 #include <cstring>
+#include <vector>
 
 #include "base/logging.hh"
 #include "perfevent.hh"
@@ -158,9 +160,65 @@ PerfKvmCounter::enableSignals(pid_t tid, int signal)
               errno);
 }
 
-void
-PerfKvmCounter::attach(PerfKvmCounterConfig &config,
-                    pid_t tid, int group_fd)
+uint64_t
+PerfKvmCounter::readRecords(const RecordHandler &handler)
+{
+    assert(attached());
+
+    const uint64_t size = (ringNumPages - 1) * pageSize;
+    const uint8_t *data = (const uint8_t *)ringBuffer + pageSize;
+
+    // The kernel updates data_head; make sure we see the records it
+    // wrote before the update.
+    const uint64_t head =
+        __atomic_load_n(&ringBuffer->data_head, __ATOMIC_ACQUIRE);
+    uint64_t tail = ringBuffer->data_tail;
+
+    // Records may wrap around the end of the buffer, copy them out
+    // before handing them over.
+    auto copy = [&](void *dst, uint64_t pos, size_t len) {
+        const uint64_t offset = pos % size;
+        const size_t first = std::min<uint64_t>(len, size - offset);
+        memcpy(dst, data + offset, first);
+        memcpy((uint8_t *)dst + first, data, len - first);
+    };
+
+    std::vector<uint8_t> record;
+    uint64_t count = 0;
+    while (tail < head) {
+        struct perf_event_header hdr;
+        copy(&hdr, tail, sizeof(hdr));
+        if (hdr.size < sizeof(hdr) || hdr.size > head - tail) {
+            warn("PerfKvmCounter: Corrupt sample record, dropping %i "
+                 "bytes\n", head - tail);
+            tail = head;
+            break;
+        }
+
+        record.resize(hdr.size - sizeof(hdr));
+        copy(record.data(), tail + sizeof(hdr), record.size());
+        handler(hdr, record.data());
+
+        tail += hdr.size;
+        ++count;
+    }
+
+    // Hand the space back to the kernel.
+    __atomic_store_n(&ringBuffer->data_tail, tail, __ATOMIC_RELEASE);
+
+    return count;
+}
+
+bool
+PerfKvmCounter::tryAttach(PerfKvmCounterConfig &config, pid_t tid,
+                          const PerfKvmCounter &parent, int ring_pages)
+{
+    return open(config, tid, parent.fd, ring_pages);
+}
+
+bool
+PerfKvmCounter::open(PerfKvmCounterConfig &config, pid_t tid,
+                     int group_fd, int ring_pages)
 {
     assert(!attached());
 
@@ -170,6 +228,24 @@ PerfKvmCounter::attach(PerfKvmCounterConfig &config,
                  group_fd,
                  0); // Flags
     if (fd == -1)
+        return false;
+
+    if (!mmapPerf(ring_pages)) {
+        const int error = errno;
+        close(fd);
+        fd = -1;
+        errno = error;
+        return false;
+    }
+
+    return true;
+}
+
+void
+PerfKvmCounter::attach(PerfKvmCounterConfig &config,
+                    pid_t tid, int group_fd)
+{
+    if (!open(config, tid, group_fd, 1))
     {
         if (errno == EACCES)
         {
@@ -190,8 +266,6 @@ PerfKvmCounter::attach(PerfKvmCounterConfig &config,
         }
         panic("PerfKvmCounter::attach failed (%i)\n", errno);
     }
-
-    mmapPerf(1);
 }
 
 pid_t
@@ -200,7 +274,7 @@ PerfKvmCounter::sysGettid()
     return syscall(__NR_gettid);
 }
 
-void
+bool
 PerfKvmCounter::mmapPerf(int pages)
 {
     assert(attached());
@@ -215,12 +289,15 @@ PerfKvmCounter::mmapPerf(int pages)
 
     ringNumPages = pages + 1;
     ringBuffer = (struct perf_event_mmap_page *)mmap(
-        NULL, ringNumPages * 4096,
+        NULL, ringNumPages * pageSize,
         PROT_READ | PROT_WRITE, MAP_SHARED,
         fd, 0);
-    if (ringBuffer == MAP_FAILED)
-        panic("PerfKvmCounter: MMAP failed (%i)\n",
-              errno);
+    if (ringBuffer == MAP_FAILED) {
+        ringBuffer = NULL;
+        return false;
+    }
+
+    return true;
 }
 
 int
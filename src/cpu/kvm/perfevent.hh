@@ -43,6 +43,8 @@
 
 #include <inttypes.h>
 
+#include <functional>
+
 #include "config/have_perf_attr_exclude_host.hh"
 
 namespace gem5
@@ -91,6 +93,33 @@ class PerfKvmCounterConfig
         return *this;
     }
 
+    /**
+     * Select the data recorded in each sample written to the ring
+     * buffer (PERF_SAMPLE_* flags).
+     *
+     * @param type Bit mask of PERF_SAMPLE_* values
+     */
+    PerfKvmCounterConfig &sampleType(uint64_t type) {
+        attr.sample_type = type;
+        return *this;
+    }
+
+    /**
+     * Record the last taken branches (e.g., from the LBR on Intel
+     * CPUs) with every sample. Not all host PMUs support this;
+     * attaching such a counter fails with EOPNOTSUPP or ENOENT if
+     * they don't.
+     *
+     * @param type Bit mask of PERF_SAMPLE_BRANCH_* values
+     */
+    PerfKvmCounterConfig &branchSampleType(uint64_t type) {
+        if (attr.size < PERF_ATTR_SIZE_VER2)
+            attr.size = PERF_ATTR_SIZE_VER2;
+        attr.sample_type |= PERF_SAMPLE_BRANCH_STACK;
+        attr.branch_sample_type = type;
+        return *this;
+    }
+
     /**
      * Set the number of samples that need to be triggered before
      * reporting data as being available on the perf event
@@ -224,6 +253,21 @@ public:
         attach(config, tid, parent.fd);
     }
 
+    /**
+     * Try to attach a counter to an existing counter group with a
+     * sample ring buffer, but don't panic if the host doesn't support
+     * the requested configuration.
+     *
+     * @param config Counter configuration
+     * @param tid Thread to sample (0 indicates current thread)
+     * @param parent Group leader
+     * @param ring_pages Number of pages in the sample ring buffer. Must
+     * be a power of 2.
+     * @return true on success, false (with errno set) otherwise.
+     */
+    bool tryAttach(PerfKvmCounterConfig &config, pid_t tid,
+                   const PerfKvmCounter &parent, int ring_pages);
+
     /** Detach a counter from PerfEvent. */
     void detach();
 
@@ -300,6 +344,21 @@ public:
      */
     void enableSignals(int signal) { enableSignals(sysGettid(), signal); }
 
+    /**
+     * Sample record handler. Called with the record header and a
+     * pointer to the record payload following it.
+     */
+    using RecordHandler = std::function<void(
+        const struct perf_event_header &hdr, const uint8_t *data)>;
+
+    /**
+     * Consume all records currently in the sample ring buffer.
+     *
+     * @param handler Function to call for every record
+     * @return Number of records consumed
+     */
+    uint64_t readRecords(const RecordHandler &handler);
+
 private:
     // Disallow copying
     PerfKvmCounter(const PerfKvmCounter &that);
@@ -308,6 +367,14 @@ private:
 
     void attach(PerfKvmCounterConfig &config, pid_t tid, int group_fd);
 
+    /**
+     * Open and map a counter.
+     *
+     * @return true on success, false (with errno set) otherwise.
+     */
+    bool open(PerfKvmCounterConfig &config, pid_t tid, int group_fd,
+              int ring_pages);
+
     /**
      * Get the TID of the current thread.
      *
@@ -318,16 +385,17 @@ private:
     /**
      * MMAP the PerfEvent file descriptor.
      *
-     * @note We currently don't use the ring buffer, but PerfEvent
-     * requires this to be mapped for overflow handling to work.
+     * @note Counters that don't record samples still need this to be
+     * mapped for overflow handling to work.
      *
      * @note Overflow handling requires at least one buf_page to be
      * mapped.
      *
      * @param pages number of pages in circular sample buffer. Must be
      * an even power of 2.
+     * @return true on success, false (with errno set) otherwise.
      */
-    void mmapPerf(int pages);
+    bool mmapPerf(int pages);
 
     /** @{ */
     /**
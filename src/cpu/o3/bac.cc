@@ -666,7 +666,7 @@ BAC::generateFetchTargets(ThreadID tid, bool &status_change)
     // advance the PC to start the search at the following address.
 
     // Make a copy of the current PC since the BPU will update it.
-    std::unique_ptr<PCStateBase> next_pc(cur_pc.clone());
+    PCStateHolder next_pc(cur_pc);
     StaticInstPtr staticInst = nullptr;
 
     if (branch_found) {
@@ -874,7 +874,7 @@ BAC::updatePreDecode(ThreadID tid, const InstSeqNum seqNum,
         hist->predTaken = hist->condPred = false;
         hist->targetProvider = BPredUnit::TargetProvider::NoTarget;
 
-        set(hist->target, std::unique_ptr<PCStateBase>(pc.clone()));
+        set(hist->target, pc);
         inst->advancePC(*hist->target);
 
     }
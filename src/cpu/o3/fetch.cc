@@ -1159,7 +1159,7 @@ Fetch::fetch(bool &status_change)
     }
 
     ++fetchStats.cycles;
-    std::unique_ptr<PCStateBase> next_pc(this_pc.clone());
+    PCStateHolder next_pc(this_pc);
 
     StaticInstPtr staticInst = NULL;
     StaticInstPtr curMacroop = macroop[tid];
@@ -75,14 +75,14 @@ class FetchTarget
 
   private:
     /** Start address of the fetch target */
-    std::unique_ptr<PCStateBase> startPC;
+    PCStateHolder startPC;
 
     /** End address of the fetch target */
-    std::unique_ptr<PCStateBase> endPC;
+    PCStateHolder endPC;
 
     /** Predicted target address of the fetch target.
      *  Only valid when the ft ends with branch. */
-    std::unique_ptr<PCStateBase> predPC;
+    PCStateHolder predPC;
 
     /* Fetch targets sequence number */
     const FTSeqNum ftSeqNum;
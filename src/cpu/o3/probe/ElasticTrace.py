@@ -68,3 +68,9 @@ class ElasticTrace(ProbeListenerObject):
     traceVirtAddr = Param.Bool(
         False, "Set to true if virtual addresses are to be traced."
     )
+    # When recording a multi-core trace, the probes of all cores share a
+    # domain that marks the accesses to locks and other synchronisation
+    # variables with the order in which the cores made them
+    syncDomain = Param.TraceSyncDomain(
+        NULL, "Domain ordering synchronising accesses across cores"
+    )
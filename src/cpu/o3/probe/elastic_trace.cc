@@ -42,6 +42,7 @@
 #include "base/trace.hh"
 #include "cpu/o3/dyn_inst.hh"
 #include "cpu/reg_class.hh"
+#include "cpu/trace/sync_domain.hh"
 #include "debug/ElasticTrace.hh"
 #include "mem/packet.hh"
 
@@ -62,6 +63,7 @@ ElasticTrace::ElasticTrace(const ElasticTraceParams &params)
        startTraceInst(params.startTraceInst),
        allProbesReg(false),
        traceVirtAddr(params.traceVirtAddr),
+       syncDomain(params.syncDomain),
        stats(this)
 {
     cpu = dynamic_cast<CPU *>(params.manager);
@@ -415,6 +417,22 @@ ElasticTrace::addDepTraceRecord(const DynInstConstPtr& head_inst,
     new_record->size = head_inst->effSize;
     new_record->pc = head_inst->pcState().instAddr();
 
+    // Committed accesses are seen in the order in which they were made
+    // visible, which the sync domain turns into cross-core epochs
+    if (syncDomain && commit && new_record->type != Record::COMP) {
+        const bool sync_op = head_inst->isAtomic() ||
+            head_inst->isStoreConditional() ||
+            (head_inst->memReqFlags &
+             (Request::LLSC | Request::LOCKED_RMW));
+        const bool write = new_record->type == Record::STORE ||
+            head_inst->isAtomic();
+        if (syncDomain->record(new_record->physAddr, write, sync_op,
+                               new_record->syncEpoch)) {
+            new_record->syncWrite = write;
+            ++stats.numSyncMarkers;
+        }
+    }
+
     // Assign the timing information stored in the execution info object
     new_record->executeTick = exec_info_ptr->executeTick;
     new_record->toCommitTick = exec_info_ptr->toCommitTick;
@@ -838,6 +856,10 @@ ElasticTrace::writeDepTrace(uint32_t num_to_write)
                 if (traceVirtAddr)
                     dep_pkt.set_v_addr(temp_ptr->virtAddr);
                 dep_pkt.set_size(temp_ptr->size);
+                if (temp_ptr->syncEpoch != 0) {
+                    dep_pkt.set_sync_epoch(temp_ptr->syncEpoch);
+                    dep_pkt.set_sync_write(temp_ptr->syncWrite);
+                }
             }
             dep_pkt.set_comp_delay(temp_ptr->compDelay);
             if (temp_ptr->robDepList.empty()) {
@@ -905,7 +927,9 @@ ElasticTrace::ElasticTraceStats::ElasticTraceStats(statistics::Group *parent)
       ADD_STAT(maxTempStoreSize, statistics::units::Count::get(),
                "Maximum size of the temporary store during the run"),
       ADD_STAT(maxPhysRegDepMapSize, statistics::units::Count::get(),
-               "Maximum size of register dependency map")
+               "Maximum size of register dependency map"),
+      ADD_STAT(numSyncMarkers, statistics::units::Count::get(),
+               "Number of loads/stores recorded as synchronisation markers")
 {
 }
 
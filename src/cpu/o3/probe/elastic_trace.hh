@@ -64,6 +64,8 @@
 namespace gem5
 {
 
+class TraceSyncDomain;
+
 namespace o3
 {
 
@@ -292,9 +294,13 @@ class ElasticTrace : public ProbeListenerObject
         Addr virtAddr;
         /* Request size in case of a load/store instruction */
         unsigned size;
+        /* Synchronisation epoch of a load/store, zero if it has none */
+        uint64_t syncEpoch;
+        /* If the synchronising access is a write */
+        bool syncWrite;
         /** Default Constructor */
         TraceInfo()
-          : type(Record::INVALID)
+          : type(Record::INVALID), syncEpoch(0), syncWrite(false)
         { }
         /** Is the record a load */
         bool isLoad() const { return (type == Record::LOAD); }
@@ -368,6 +374,12 @@ class ElasticTrace : public ProbeListenerObject
     /** Whether to trace virtual addresses for memory requests. */
     const bool traceVirtAddr;
 
+    /**
+     * Domain ordering synchronising accesses across the traced cores, if
+     * recording a multi-core trace.
+     */
+    TraceSyncDomain *syncDomain;
+
     /** Pointer to the O3CPU that is this listener's parent a.k.a. manager */
     CPU *cpu;
 
@@ -556,6 +568,9 @@ class ElasticTrace : public ProbeListenerObject
          * register.
          */
         statistics::Scalar maxPhysRegDepMapSize;
+
+        /** Number of loads/stores recorded with a synchronisation epoch */
+        statistics::Scalar numSyncMarkers;
     } stats;
 
 };
@@ -287,7 +287,7 @@ class BPredUnit : public SimObject
               call(inst->isCall()), uncond(inst->isUncondCtrl()),
               predTaken(false), actuallyTaken(false), condPred(false),
               btbHit(false), targetProvider(TargetProvider::NoTarget),
-              resteered(false), mispredict(false), target(nullptr),
+              resteered(false), mispredict(false),
               bpHistory(nullptr),
               indirectHistory(nullptr), rasHistory(nullptr)
         { }
@@ -351,7 +351,7 @@ class BPredUnit : public SimObject
         bool mispredict;
 
         /** The predicted target */
-        std::unique_ptr<PCStateBase> target;
+        PCStateHolder target;
 
         /**
          * Pointer to the history objects passed back from the branch
@@ -0,0 +1,315 @@
+/*
+ * Copyright (c) 2024 The University of Edinburgh
+ * All rights reserved
+ *
+ * The license below extends only to copyright in the software and shall
+ * not be construed as granting a license to any other intellectual
+ * property including but not limited to intellectual property relating
+ * to a hardware implementation of the functionality of the software
+ * licensed hereunder.  You may use the software subject to the license
+ * terms below provided that you ensure that this notice is replicated
+ * unmodified and in its entirety in all distributions of the software,
+ * modified or unmodified, in source code or in binary form.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __CPU_SHARED_DECODE_CACHE_HH__
+#define __CPU_SHARED_DECODE_CACHE_HH__
+
+#include <algorithm>
+#include <array>
+#include <map>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "base/logging.hh"
+#include "base/types.hh"
+#include "cpu/static_inst.hh"
+
+namespace gem5
+{
+
+namespace decode_cache
+{
+
+/**
+ * A decode cache shared by all the decoders that decode instructions
+ * the same way, e.g. the cores of a system running the same ISA in
+ * the same mode. Decoded instructions are kept per instruction address
+ * in pages, alongside a map of machine instruction to the decoded
+ * instruction. A core therefore reuses code decoded by any other core
+ * instead of decoding and caching its own copy.
+ *
+ * The cache is not thread safe, and neither are the reference counts
+ * of the instructions it hands out, so all its users must run on the
+ * same event queue. Decoders on different event queues should use
+ * different contexts, see get().
+ *
+ * Every entry records the machine instruction it was decoded from and
+ * only hits if the fetched bytes still match, so code modified after
+ * it was decoded is decoded again. Ranges can also be dropped
+ * explicitly with invalidate().
+ *
+ * @tparam EMI Extended machine instruction type.
+ * @tparam SlotShift Log2 of the instruction alignment in bytes.
+ * @tparam Value Pointer to a decoded instruction.
+ */
+template <typename EMI, unsigned SlotShift = 1,
+          typename Value = StaticInstPtr>
+class SharedCache
+{
+  public:
+    static constexpr unsigned PageShift = 12;
+    static constexpr Addr PageBytes = 1ULL << PageShift;
+    static constexpr Addr SlotBytes = 1ULL << SlotShift;
+    static constexpr Addr PageSlots = PageBytes >> SlotShift;
+
+  private:
+    /** A decoded instruction and the users which have used it */
+    struct Decoded
+    {
+        Value inst;
+        std::vector<bool> users;
+    };
+
+    struct Entry
+    {
+        EMI machInst;
+        Decoded *decoded;
+    };
+
+  public:
+    struct Page
+    {
+        std::array<std::unique_ptr<Entry>, PageSlots> entries;
+    };
+
+    /**
+     * Last page used by a reader, which skips the page lookup when
+     * consecutive lookups hit the same page.
+     */
+    struct Cursor
+    {
+        Addr pageNum = MaxAddr;
+        Page *page = nullptr;
+    };
+
+  private:
+    /** Pages, which are kept until the cache is destroyed */
+    std::unordered_map<Addr, std::unique_ptr<Page>> pages;
+    std::unordered_map<EMI, Decoded> instMap;
+    size_t numEntries = 0;
+
+    /** Distinct instructions used by each user */
+    std::vector<size_t> userInsts;
+
+    static Addr
+    slot(Addr addr)
+    {
+        assert(addr % SlotBytes == 0);
+        return (addr & (PageBytes - 1)) >> SlotShift;
+    }
+
+    Page *
+    findPage(Addr page_num) const
+    {
+        auto it = pages.find(page_num);
+        return it == pages.end() ? nullptr : it->second.get();
+    }
+
+    /** Count an instruction towards the footprint of a user */
+    void
+    use(Decoded &decoded, unsigned user)
+    {
+        assert(user < userInsts.size());
+        if (user >= decoded.users.size())
+            decoded.users.resize(user + 1);
+        if (!decoded.users[user]) {
+            decoded.users[user] = true;
+            ++userInsts[user];
+        }
+    }
+
+  public:
+    /** Host memory used by each decoded instruction */
+    static constexpr size_t InstBytes = sizeof(EMI) + sizeof(Value) +
+        sizeof(std::remove_reference_t<decltype(*std::declval<Value>())>);
+
+    /**
+     * Look up the instruction decoded at an address.
+     *
+     * @param addr Address of the instruction.
+     * @param mach_inst Machine instruction fetched from addr.
+     * @param user Id of the user, as returned by addUser().
+     * @param cursor User's last page, updated by the lookup.
+     * @return The cached instruction, or nullptr on a miss.
+     */
+    Value
+    lookup(Addr addr, const EMI &mach_inst, unsigned user, Cursor &cursor)
+    {
+        const Addr page_num = addr >> PageShift;
+        if (cursor.pageNum != page_num || !cursor.page) {
+            cursor.page = findPage(page_num);
+            if (!cursor.page)
+                return nullptr;
+            cursor.pageNum = page_num;
+        }
+
+        Entry *entry = cursor.page->entries[slot(addr)].get();
+        if (!entry || !(entry->machInst == mach_inst))
+            return nullptr;
+        use(*entry->decoded, user);
+        return entry->decoded->inst;
+    }
+
+    /**
+     * Cache the instruction at an address, replacing any stale entry,
+     * and decode it unless the same machine instruction has already
+     * been decoded for another address or user.
+     *
+     * @param decode Called with the machine instruction to decode it.
+     */
+    template <class DecodeFunc>
+    Value
+    insert(Addr addr, const EMI &mach_inst, unsigned user,
+           DecodeFunc &&decode)
+    {
+        auto &page = pages[addr >> PageShift];
+        if (!page)
+            page.reset(new Page);
+
+        Decoded &decoded = instMap[mach_inst];
+        if (!decoded.inst)
+            decoded.inst = decode(mach_inst);
+        use(decoded, user);
+
+        auto &entry = page->entries[slot(addr)];
+        if (!entry)
+            ++numEntries;
+        entry.reset(new Entry{mach_inst, &decoded});
+        return decoded.inst;
+    }
+
+    /** Drop the entries for all the addresses in [addr, addr + size). */
+    void
+    invalidate(Addr addr, Addr size)
+    {
+        const Addr end = addr + size;
+        Addr a = addr & ~(SlotBytes - 1);
+        while (a < end) {
+            const Addr page_end = (a | (PageBytes - 1)) + 1;
+            const Addr stop = page_end && page_end < end ? page_end : end;
+            Page *page = findPage(a >> PageShift);
+            for (; page && a < stop; a += SlotBytes) {
+                auto &entry = page->entries[slot(a)];
+                if (entry) {
+                    entry.reset();
+                    --numEntries;
+                }
+            }
+            if (page_end == 0)
+                break;
+            a = page_end;
+        }
+    }
+
+    /** Number of addresses with a cached instruction */
+    size_t entries() const { return numEntries; }
+
+    /** Host memory used by the cache in bytes. */
+    size_t
+    bytes() const
+    {
+        return sizeof(*this) +
+            pages.size() * (sizeof(Page) + sizeof(Addr) + sizeof(void *)) +
+            numEntries * sizeof(Entry) +
+            instMap.size() * (InstBytes + sizeof(std::vector<bool>));
+    }
+
+    /**
+     * Host memory a user would need to keep a private map of the
+     * instructions it has decoded.
+     */
+    size_t
+    privateBytes(unsigned user) const
+    {
+        assert(user < userInsts.size());
+        return userInsts[user] * InstBytes;
+    }
+
+    /**
+     * Host memory saved compared to each user keeping a private map
+     * of the instructions it has used.
+     */
+    size_t
+    bytesSaved() const
+    {
+        size_t private_bytes = 0;
+        for (unsigned user = 0; user < userInsts.size(); user++)
+            private_bytes += privateBytes(user);
+        const size_t shared_bytes = bytes();
+        return private_bytes > shared_bytes ?
+            private_bytes - shared_bytes : 0;
+    }
+
+    /** Register a new user and return its id. */
+    unsigned
+    addUser()
+    {
+        userInsts.push_back(0);
+        return userInsts.size() - 1;
+    }
+
+    unsigned users() const { return userInsts.size(); }
+
+    /**
+     * Get the cache for a decoding context, creating it if needed.
+     * Decoders which decode any given machine instruction the same
+     * way, and run on the same event queue, should use the same
+     * context name.
+     */
+    static std::shared_ptr<SharedCache>
+    get(const std::string &context)
+    {
+        static std::map<std::string, std::weak_ptr<SharedCache>> registry;
+
+        auto &weak = registry[context];
+        auto cache = weak.lock();
+        if (!cache) {
+            cache = std::make_shared<SharedCache>();
+            weak = cache;
+        }
+        return cache;
+    }
+};
+
+} // namespace decode_cache
+} // namespace gem5
+
+#endif // __CPU_SHARED_DECODE_CACHE_HH__
@@ -0,0 +1,192 @@
+/*
+ * Copyright (c) 2024 The University of Edinburgh
+ * All rights reserved
+ *
+ * The license below extends only to copyright in the software and shall
+ * not be construed as granting a license to any other intellectual
+ * property including but not limited to intellectual property relating
+ * to a hardware implementation of the functionality of the software
+ * licensed hereunder.  You may use the software subject to the license
+ * terms below provided that you ensure that this notice is replicated
+ * unmodified and in its entirety in all distributions of the software,
+ * modified or unmodified, in source code or in binary form.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+#include <memory>
+
+#include "cpu/shared_decode_cache.hh"
+
+using namespace gem5;
+
+namespace
+{
+
+/** Stands in for a StaticInst, which takes a few hundred bytes */
+struct FakeInst
+{
+    uint32_t machInst;
+    std::array<uint8_t, 256> operands;
+};
+
+using Inst = std::shared_ptr<const FakeInst>;
+using Cache = decode_cache::SharedCache<uint32_t, 1, Inst>;
+
+/** Decodes a machine instruction, counting the calls */
+struct Decoder
+{
+    unsigned decodes = 0;
+
+    Inst
+    operator()(uint32_t mach_inst)
+    {
+        ++decodes;
+        return std::make_shared<const FakeInst>(FakeInst{mach_inst, {}});
+    }
+};
+
+} // anonymous namespace
+
+TEST(SharedDecodeCacheTest, LookupAndInsert)
+{
+    Cache cache;
+    const unsigned user = cache.addUser();
+    Cache::Cursor cursor;
+    Decoder decoder;
+
+    EXPECT_EQ(cache.lookup(0x1000, 13, user, cursor), nullptr);
+
+    Inst inst = cache.insert(0x1000, 13, user, decoder);
+    ASSERT_NE(inst, nullptr);
+    EXPECT_EQ(inst->machInst, 13);
+    EXPECT_EQ(cache.lookup(0x1000, 13, user, cursor), inst);
+    EXPECT_EQ(cache.entries(), 1);
+
+    // Entries are per two byte slot
+    EXPECT_EQ(cache.lookup(0x1002, 13, user, cursor), nullptr);
+
+    // The same machine instruction elsewhere is not decoded again
+    EXPECT_EQ(cache.insert(0x5002, 13, user, decoder), inst);
+    EXPECT_EQ(cache.lookup(0x5002, 13, user, cursor), inst);
+    EXPECT_EQ(cache.lookup(0x1000, 13, user, cursor), inst);
+    EXPECT_EQ(cache.entries(), 2);
+    EXPECT_EQ(decoder.decodes, 1);
+}
+
+TEST(SharedDecodeCacheTest, ModifiedCodeIsReplaced)
+{
+    Cache cache;
+    const unsigned user = cache.addUser();
+    Cache::Cursor cursor;
+    Decoder decoder;
+
+    Inst old_inst = cache.insert(0x2000, 1, user, decoder);
+
+    // Different bytes fetched from the same address miss
+    EXPECT_EQ(cache.lookup(0x2000, 2, user, cursor), nullptr);
+
+    Inst new_inst = cache.insert(0x2000, 2, user, decoder);
+    EXPECT_EQ(new_inst->machInst, 2);
+    EXPECT_EQ(cache.lookup(0x2000, 2, user, cursor), new_inst);
+    EXPECT_EQ(cache.lookup(0x2000, 1, user, cursor), nullptr);
+    EXPECT_EQ(cache.entries(), 1);
+
+    // The replaced instruction is still valid for its holders
+    EXPECT_EQ(old_inst->machInst, 1);
+}
+
+TEST(SharedDecodeCacheTest, Invalidate)
+{
+    Cache cache;
+    const unsigned user = cache.addUser();
+    Cache::Cursor cursor;
+    Decoder decoder;
+
+    for (Addr addr = 0x3ff8; addr < 0x4008; addr += 2)
+        cache.insert(addr, addr, user, decoder);
+    cache.insert(0x9000, 1, user, decoder);
+    EXPECT_EQ(cache.entries(), 9);
+
+    // Drop a range crossing a page boundary and a page never used
+    cache.invalidate(0x3ffc, 0x5000);
+    EXPECT_EQ(cache.entries(), 3);
+    EXPECT_NE(cache.lookup(0x3ff8, 0x3ff8, user, cursor), nullptr);
+    EXPECT_NE(cache.lookup(0x3ffa, 0x3ffa, user, cursor), nullptr);
+    for (Addr addr = 0x3ffc; addr < 0x4008; addr += 2)
+        EXPECT_EQ(cache.lookup(addr, addr, user, cursor), nullptr);
+    EXPECT_NE(cache.lookup(0x9000, 1, user, cursor), nullptr);
+
+    // Invalidated addresses can be filled again
+    cache.insert(0x4000, 0x4000, user, decoder);
+    EXPECT_NE(cache.lookup(0x4000, 0x4000, user, cursor), nullptr);
+    EXPECT_EQ(cache.entries(), 4);
+}
+
+TEST(SharedDecodeCacheTest, SharedBetweenUsers)
+{
+    Cache cache;
+    const unsigned first = cache.addUser();
+    const unsigned second = cache.addUser();
+    EXPECT_EQ(cache.users(), 2);
+    Cache::Cursor first_cursor, second_cursor;
+    Decoder decoder;
+
+    for (Addr addr = 0; addr < 0x1000; addr += 4)
+        cache.insert(addr, addr, first, decoder);
+    EXPECT_EQ(cache.privateBytes(first), 0x400 * Cache::InstBytes);
+    EXPECT_EQ(cache.privateBytes(second), 0);
+
+    // A single user saves nothing
+    EXPECT_EQ(cache.bytesSaved(), 0);
+
+    for (Addr addr = 0; addr < 0x1000; addr += 4) {
+        EXPECT_NE(cache.lookup(addr, addr, second, second_cursor),
+                  nullptr);
+    }
+    EXPECT_EQ(decoder.decodes, 0x400);
+    EXPECT_EQ(cache.privateBytes(second), 0x400 * Cache::InstBytes);
+
+    // Instructions are only counted once per user
+    cache.lookup(0, 0, second, second_cursor);
+    EXPECT_EQ(cache.privateBytes(second), 0x400 * Cache::InstBytes);
+
+    // The second user's private copy is saved, less the per address
+    // entries only the shared cache keeps
+    const size_t private_bytes = 2 * 0x400 * Cache::InstBytes;
+    ASSERT_GT(private_bytes, cache.bytes());
+    EXPECT_EQ(cache.bytesSaved(), private_bytes - cache.bytes());
+}
+
+TEST(SharedDecodeCacheTest, CachesPerContext)
+{
+    auto a = Cache::get("test.eventq0");
+    auto b = Cache::get("test.eventq0");
+    auto c = Cache::get("test.eventq1");
+    EXPECT_EQ(a, b);
+    EXPECT_NE(a, c);
+}
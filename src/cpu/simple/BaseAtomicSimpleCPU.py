@@ -61,6 +61,14 @@ class BaseAtomicSimpleCPU(BaseSimpleCPU):
     width = Param.Int(1, "CPU width")
     simulate_data_stalls = Param.Bool(False, "Simulate dcache stall cycles")
     simulate_inst_stalls = Param.Bool(False, "Simulate icache stall cycles")
+    block_execution = Param.Bool(
+        False,
+        "Cache decoded basic blocks by physical PC and execute a whole "
+        "block per tick (intended for fast-forwarding)",
+    )
+    max_block_insts = Param.Unsigned(
+        64, "Maximum number of instructions in a cached basic block"
+    )
 
     def addSimPointProbe(self, interval):
         simpoint = SimPoint()
@@ -41,6 +41,8 @@
 
 #include "cpu/simple/atomic.hh"
 
+#include <algorithm>
+
 #include "arch/generic/decoder.hh"
 #include "base/output.hh"
 #include "cpu/exetrace.hh"
@@ -51,6 +53,7 @@
 #include "mem/packet.hh"
 #include "mem/packet_access.hh"
 #include "mem/physical.hh"
+#include "mem/port_proxy.hh"
 #include "params/BaseAtomicSimpleCPU.hh"
 #include "sim/faults.hh"
 #include "sim/full_system.hh"
@@ -81,8 +84,15 @@ AtomicSimpleCPU::AtomicSimpleCPU(const BaseAtomicSimpleCPUParams &p)
       icachePort(name() + ".icache_port"),
       dcachePort(name() + ".dcache_port", this),
       dcache_access(false), dcache_latency(0),
-      ppCommit(nullptr)
+      ppCommit(nullptr),
+      blockExecution(p.block_execution),
+      maxBlockInsts(p.max_block_insts),
+      backdoorWrites(PortProxy::backdoorWrites()),
+      recording(false), recordThread(0), recordAddr(0), recordVAddr(0)
 {
+    fatal_if(blockExecution && maxBlockInsts == 0,
+             "%s: max_block_insts must be non-zero.", name());
+
     _status = Idle;
     ifetch_req = std::make_shared<Request>();
     data_read_req = std::make_shared<Request>();
@@ -148,6 +158,9 @@ AtomicSimpleCPU::drainResume()
     DPRINTF(SimpleCPU, "Resume\n");
     verifyMemoryMode();
 
+    // Memory may have been changed behind our back while drained
+    flushBlocks();
+
     assert(!threadContexts.empty());
 
     _status = BaseSimpleCPU::Idle;
@@ -206,6 +219,8 @@ AtomicSimpleCPU::takeOverFrom(BaseCPU *old_cpu)
 
     // The tick event should have been descheduled by drain()
     assert(!tickEvent.scheduled());
+
+    flushBlocks();
 }
 
 void
@@ -298,6 +313,7 @@ AtomicSimpleCPU::AtomicCPUDPort::recvAtomicSnoop(PacketPtr pkt)
             t_info->thread->getIsaPtr()->handleLockedSnoop(pkt,
                     cacheBlockMask);
         }
+        cpu->checkCodeWrite(pkt->getAddr(), pkt->getSize());
     }
 
     return 0;
@@ -325,6 +341,9 @@ AtomicSimpleCPU::AtomicCPUDPort::recvFunctionalSnoop(PacketPtr pkt)
                     cacheBlockMask);
         }
     }
+
+    if (pkt->isInvalidate() || pkt->isWrite())
+        cpu->checkCodeWrite(pkt->getAddr(), pkt->getSize());
 }
 
 bool
@@ -504,6 +523,7 @@ AtomicSimpleCPU::writeMem(uint8_t *data, unsigned size, Addr addr,
                     // Notify other threads on this CPU of write
                     threadSnoop(&pkt, curThread);
                 }
+                checkCodeWrite(req->getPaddr(), req->getSize());
                 dcache_access = true;
                 panic_if(pkt.isError(), "Data write (%s) failed: %s",
                         pkt.getAddrRange().to_string(), pkt.print());
@@ -591,6 +611,7 @@ AtomicSimpleCPU::amoMem(Addr addr, uint8_t* data, unsigned size,
         } else {
             dcache_latency += sendPacket(dcachePort, &pkt);
         }
+        checkCodeWrite(req->getPaddr(), req->getSize());
 
         dcache_access = true;
 
@@ -647,11 +668,19 @@ AtomicSimpleCPU::tick()
 
         serviceInstCountEvents();
 
+        if (blockExecution && executeBlock(latency))
+            continue;
+
         Fault fault = NoFault;
 
         const PCStateBase &pc = thread->pcState();
 
+        // Only instructions fetched in one go are recorded into blocks
+        PCStateHolder fetch_pc, decoded_pc;
         bool needToFetch = !isRomMicroPC(pc.microPC()) && !curMacroStaticInst;
+        if (recording && needToFetch && t_info.fetchOffset == 0)
+            fetch_pc = pc;
+
         if (needToFetch) {
             ifetch_req->taskId(taskId());
             setupFetchRequest(ifetch_req);
@@ -679,6 +708,9 @@ AtomicSimpleCPU::tick()
 
             preExecute();
 
+            if (fetch_pc && curStaticInst && !t_info.stayAtPC)
+                decoded_pc = thread->pcState();
+
             Tick stall_ticks = 0;
             if (curStaticInst) {
                 fault = curStaticInst->execute(&t_info, traceData);
@@ -725,6 +757,14 @@ AtomicSimpleCPU::tick()
         }
         if (fault != NoFault || !t_info.stayAtPC)
             advancePC(fault);
+
+        if (recording)
+            recordInst(fetch_pc, decoded_pc, fault);
+
+        // System calls may write guest memory through functional
+        // accesses that are never snooped
+        if (blockExecution && curStaticInst && curStaticInst->isSyscall())
+            flushBlocks();
     }
 
     if (tryCompleteDrain())
@@ -738,6 +778,222 @@ AtomicSimpleCPU::tick()
         reschedule(tickEvent, curTick() + latency, true);
 }
 
+bool
+AtomicSimpleCPU::blockable(const StaticInstPtr &inst)
+{
+    return !inst->isMacroop() && !inst->isMicroop() &&
+        !inst->isDelayedCommit() && !inst->isSerializing() &&
+        !inst->isNonSpeculative() && !inst->isSquashAfter() &&
+        !inst->isSyscall() && !inst->isQuiesce() && !inst->isHtmCmd();
+}
+
+bool
+AtomicSimpleCPU::executeBlock(Tick &latency)
+{
+    SimpleExecContext &t_info = *threadInfo[curThread];
+    SimpleThread *thread = t_info.thread;
+
+    if (backdoorWritten())
+        flushBlocks();
+    if (!dirtyCodePages.empty())
+        invalidateCode();
+
+    const PCStateBase &pc = thread->pcState();
+    if (locked || curMacroStaticInst || isRomMicroPC(pc.microPC()) ||
+            t_info.stayAtPC || t_info.fetchOffset != 0 ||
+            (curStaticInst && curStaticInst->isDelayedCommit())) {
+        finishBlock();
+        return false;
+    }
+
+    if (recording) {
+        // Keep recording while execution falls through
+        if (curThread == recordThread && *recordNextPC == pc)
+            return false;
+        finishBlock();
+    }
+
+    ifetch_req->taskId(taskId());
+    setupFetchRequest(ifetch_req);
+    Fault fault = thread->mmu->translateAtomic(ifetch_req, thread->getTC(),
+                                               BaseMMU::Execute);
+    // Let the regular path deal with the fault
+    if (fault != NoFault)
+        return false;
+
+    const Addr paddr =
+        ifetch_req->getPaddr() + (pc.instAddr() - ifetch_req->getVaddr());
+
+    auto it = blockCache.find(paddr);
+    if (it == blockCache.end() || *it->second.front().fetchPC != pc) {
+        recording = true;
+        recordThread = curThread;
+        recordAddr = paddr;
+        recordVAddr = pc.instAddr();
+        recordBlock.clear();
+        return false;
+    }
+
+    const DecodedBlock &block = it->second;
+    DPRINTF(SimpleCPU, "Executing block at %#x (%d insts)\n",
+            paddr, block.size());
+
+    for (size_t n = 0; n < block.size(); ++n) {
+        const DecodedInst &di = block[n];
+
+        if (n > 0) {
+            // Leave pending instruction count events to the next tick
+            EventQueue &inst_events = thread->comInstEventQueue;
+            if (!inst_events.empty() &&
+                    inst_events.nextTick() <= t_info.numInst) {
+                break;
+            }
+
+            checkPcEventQueue();
+            if (_status == Idle || thread->pcState() != *di.fetchPC)
+                break;
+
+            baseStats.numCycles++;
+            updateCycleCounters(BaseCPU::CPU_STATE_ON);
+        }
+
+        thread->pcState(*di.decodedPC);
+        curStaticInst = di.inst;
+        dcache_access = false;
+
+        prepareInst();
+
+        fault = curStaticInst->execute(&t_info, traceData);
+        if (fault == NoFault) {
+            countInst();
+            ppCommit->notify(std::make_pair(thread, curStaticInst));
+        } else if (traceData) {
+            traceFault();
+        }
+
+        postExecute();
+        instCnt++;
+
+        // Every instruction takes at least one cycle, as in tick()
+        Tick stall_ticks = 0;
+        if (simulate_data_stalls && dcache_access)
+            stall_ticks = dcache_latency;
+        latency += std::max<Tick>(
+                divCeil(stall_ticks, clockPeriod()), 1) * clockPeriod();
+
+        advancePC(fault);
+
+        if (fault != NoFault || locked || _status == Idle ||
+                !dirtyCodePages.empty() || backdoorWritten()) {
+            break;
+        }
+    }
+
+    // The decoder was bypassed, make it start afresh at the next PC
+    thread->decoder->reset();
+
+    if (backdoorWritten())
+        flushBlocks();
+    if (!dirtyCodePages.empty())
+        invalidateCode();
+
+    return true;
+}
+
+void
+AtomicSimpleCPU::recordInst(const PCStateHolder &fetch_pc,
+                            const PCStateHolder &decoded_pc,
+                            const Fault &fault)
+{
+    if (fault != NoFault || !decoded_pc || curThread != recordThread ||
+            !blockable(curStaticInst)) {
+        finishBlock();
+        return;
+    }
+
+    // Blocks must not cross a page so that one translation covers them
+    const Addr paddr = ifetch_req->getPaddr() +
+        (fetch_pc->instAddr() - ifetch_req->getVaddr());
+    if ((paddr >> BlockPageShift) != (recordAddr >> BlockPageShift) ||
+            (fetch_pc->instAddr() >> BlockPageShift) !=
+            (recordVAddr >> BlockPageShift) ||
+            paddr - recordAddr != fetch_pc->instAddr() - recordVAddr) {
+        finishBlock();
+        return;
+    }
+
+    recordBlock.push_back(DecodedInst{curStaticInst, fetch_pc, decoded_pc});
+    set(recordNextPC, threadInfo[curThread]->thread->pcState());
+
+    if (curStaticInst->isControl() || recordBlock.size() >= maxBlockInsts)
+        finishBlock();
+}
+
+void
+AtomicSimpleCPU::finishBlock()
+{
+    if (recording && !recordBlock.empty()) {
+        DPRINTF(SimpleCPU, "Caching block at %#x (%d insts)\n",
+                recordAddr, recordBlock.size());
+        auto [it, inserted] =
+            blockCache.insert_or_assign(recordAddr, std::move(recordBlock));
+        if (inserted)
+            blockPages[recordAddr >> BlockPageShift].push_back(recordAddr);
+    }
+    recordBlock.clear();
+    recording = false;
+}
+
+void
+AtomicSimpleCPU::flushBlocks()
+{
+    blockCache.clear();
+    blockPages.clear();
+    dirtyCodePages.clear();
+    backdoorWrites = PortProxy::backdoorWrites();
+    recordBlock.clear();
+    recording = false;
+}
+
+bool
+AtomicSimpleCPU::backdoorWritten() const
+{
+    return PortProxy::backdoorWrites() != backdoorWrites;
+}
+
+void
+AtomicSimpleCPU::invalidateCode()
+{
+    for (Addr page : dirtyCodePages) {
+        auto it = blockPages.find(page);
+        if (it == blockPages.end())
+            continue;
+        DPRINTF(SimpleCPU, "Invalidating blocks in page %#x\n",
+                page << BlockPageShift);
+        for (Addr addr : it->second)
+            blockCache.erase(addr);
+        blockPages.erase(it);
+    }
+    dirtyCodePages.clear();
+}
+
+void
+AtomicSimpleCPU::checkCodeWrite(Addr paddr, unsigned size)
+{
+    if (!blockExecution || size == 0)
+        return;
+
+    const Addr last = (paddr + size - 1) >> BlockPageShift;
+    for (Addr page = paddr >> BlockPageShift; page <= last; ++page) {
+        if (recording && page == (recordAddr >> BlockPageShift)) {
+            recordBlock.clear();
+            recording = false;
+        }
+        if (blockPages.count(page))
+            dirtyCodePages.push_back(page);
+    }
+}
+
 Tick
 AtomicSimpleCPU::fetchInstMem()
 {
@@ -41,6 +41,10 @@
 #ifndef __CPU_SIMPLE_ATOMIC_HH__
 #define __CPU_SIMPLE_ATOMIC_HH__
 
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
 #include "cpu/simple/base.hh"
 #include "cpu/simple/exec_context.hh"
 #include "mem/request.hh"
@@ -67,6 +71,75 @@ class AtomicSimpleCPU : public BaseSimpleCPU
     const bool simulate_data_stalls;
     const bool simulate_inst_stalls;
 
+    /**
+     * A decoded instruction of a cached basic block, together with the
+     * PC state it was fetched at and the PC state after decoding (the
+     * decoder may update ISA specific fields of the PC state).
+     */
+    struct DecodedInst
+    {
+        StaticInstPtr inst;
+        PCStateHolder fetchPC;
+        PCStateHolder decodedPC;
+    };
+
+    using DecodedBlock = std::vector<DecodedInst>;
+
+    /** Granularity used to track which memory holds cached code. */
+    static constexpr unsigned BlockPageShift = 12;
+
+    const bool blockExecution;
+    const unsigned maxBlockInsts;
+
+    /** Cached basic blocks keyed by the physical PC of the first inst. */
+    std::unordered_map<Addr, DecodedBlock> blockCache;
+    /** Start addresses of the cached blocks in each physical page. */
+    std::unordered_map<Addr, std::vector<Addr>> blockPages;
+    /** Pages of cached code written since the last invalidation. */
+    std::vector<Addr> dirtyCodePages;
+    /**
+     * Back door writes seen at the last flush. These are not snooped,
+     * so any new one flushes the whole cache.
+     */
+    uint64_t backdoorWrites;
+
+    /** State of the block currently being recorded, if any. */
+    bool recording;
+    ThreadID recordThread;
+    Addr recordAddr;
+    Addr recordVAddr;
+    DecodedBlock recordBlock;
+    PCStateHolder recordNextPC;
+
+    /**
+     * Execute the cached block starting at the current PC, if there is
+     * one. Interrupts are only checked before the first instruction of
+     * a block; PC and instruction count events are honoured at every
+     * instruction boundary.
+     *
+     * @param latency Accumulated latency of the current tick.
+     * @return true if at least one instruction was executed.
+     */
+    bool executeBlock(Tick &latency);
+
+    /**
+     * Append the instruction just executed by tick() to the block being
+     * recorded, or close the block if it can't be part of it.
+     */
+    void recordInst(const PCStateHolder &fetch_pc,
+                    const PCStateHolder &decoded_pc, const Fault &fault);
+    void finishBlock();
+    void flushBlocks();
+    /** Has memory been written through a back door since the flush? */
+    bool backdoorWritten() const;
+    /** Drop the cached blocks in pages recorded in dirtyCodePages. */
+    void invalidateCode();
+    /** Note a write to physical memory that may hold cached code. */
+    void checkCodeWrite(Addr paddr, unsigned size);
+
+    /** Can the instruction be replayed from a cached block? */
+    static bool blockable(const StaticInstPtr &inst);
+
     // main simulation loop (one cycle)
     void tick();
 
@@ -141,7 +214,7 @@ class AtomicSimpleCPU : public BaseSimpleCPU
     {
 
       public:
-        AtomicCPUDPort(const std::string &_name, BaseSimpleCPU *_cpu)
+        AtomicCPUDPort(const std::string &_name, AtomicSimpleCPU *_cpu)
             : AtomicCPUPort(_name), cpu(_cpu)
         {
             cacheBlockMask = ~(cpu->cacheLineSize() - 1);
@@ -151,7 +224,7 @@ class AtomicSimpleCPU : public BaseSimpleCPU
 
         Addr cacheBlockMask;
       protected:
-        BaseSimpleCPU *cpu;
+        AtomicSimpleCPU *cpu;
 
         virtual Tick recvAtomicSnoop(PacketPtr pkt);
         virtual void recvFunctionalSnoop(PacketPtr pkt);
@@ -330,10 +330,6 @@ BaseSimpleCPU::preExecute()
     SimpleExecContext &t_info = *threadInfo[curThread];
     SimpleThread* thread = t_info.thread;
 
-    // resets predicates
-    t_info.setPredicate(true);
-    t_info.setMemAccPredicate(true);
-
     // decode the instruction
     set(preExecuteTempPC, thread->pcState());
     auto &pc_state = *preExecuteTempPC;
@@ -380,6 +376,19 @@ BaseSimpleCPU::preExecute()
         curStaticInst = curMacroStaticInst->fetchMicroop(pc_state.microPC());
     }
 
+    prepareInst();
+}
+
+void
+BaseSimpleCPU::prepareInst()
+{
+    SimpleExecContext &t_info = *threadInfo[curThread];
+    SimpleThread* thread = t_info.thread;
+
+    // resets predicates
+    t_info.setPredicate(true);
+    t_info.setMemAccPredicate(true);
+
     //If we decoded an instruction this "tick", record information about it.
     if (curStaticInst) {
 #if TRACING_ON
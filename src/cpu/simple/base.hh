@@ -137,6 +137,12 @@ class BaseSimpleCPU : public BaseCPU
     void setupFetchRequest(const RequestPtr &req);
     void serviceInstCountEvents();
     void preExecute();
+    /**
+     * Set up execution of an already decoded curStaticInst: reset the
+     * predicates, create the trace record, predict branches and count
+     * the fetch. Called by preExecute() after decoding.
+     */
+    void prepareInst();
     void postExecute();
     void advancePC(const Fault &fault);
 
@@ -63,6 +63,9 @@ class MemTest(ClockedObject):
     percent_reads = Param.Percent(65, "Percentage reads")
     percent_functional = Param.Percent(50, "Percentage functional accesses")
     percent_uncacheable = Param.Percent(10, "Percentage uncacheable")
+    # Cleans to the point of coherency check that the memory is up to
+    # date when they complete
+    percent_cleans = Param.Percent(0, "Percentage cache cleans")
 
     # Determine how often to print progress messages and what timeout
     # to use for checking progress of both requests and responses
@@ -94,6 +94,8 @@ MemTest::MemTest(const Params &p)
       percentReads(p.percent_reads),
       percentFunctional(p.percent_functional),
       percentUncacheable(p.percent_uncacheable),
+      percentCleans(p.percent_cleans),
+      system(p.system),
       requestorId(p.system->getRequestorId(this)),
       blockSize(p.system->cacheLineSize()),
       blockAddrMask(blockSize - 1),
@@ -115,8 +117,15 @@ MemTest::MemTest(const Params &p)
     // set up counters
     numReads = 0;
     numWrites = 0;
+}
 
-    // kick things into action
+void
+MemTest::startup()
+{
+    ClockedObject::startup();
+
+    // kick things into action, this is only done now as a restored
+    // checkpoint moves the current tick
     schedule(tickEvent, curTick());
     schedule(noRequestEvent, clockEdge(progressCheck));
 }
@@ -134,24 +143,47 @@ void
 MemTest::completeRequest(PacketPtr pkt, bool functional)
 {
     const RequestPtr &req = pkt->req;
-    assert(req->getSize() == 1);
+    const bool clean = req->isCacheClean();
+    assert(req->getSize() == (clean ? blockSize : 1));
 
-    // this address is no longer outstanding
-    auto remove_addr = outstandingAddrs.find(req->getPaddr());
+    // this address is no longer outstanding, cleans are tracked by
+    // the byte of this tester in the block
+    const Addr addr = clean ? req->getPaddr() + id : req->getPaddr();
+    auto remove_addr = outstandingAddrs.find(addr);
     assert(remove_addr != outstandingAddrs.end());
     outstandingAddrs.erase(remove_addr);
 
     DPRINTF(MemTest, "Completing %s at address %x (blk %x) %s\n",
-            pkt->isWrite() ? "write" : "read",
-            req->getPaddr(), blockAlign(req->getPaddr()),
+            clean ? "clean" : pkt->isWrite() ? "write" : "read",
+            addr, blockAlign(addr),
             pkt->isError() ? "error" : "success");
 
-    const uint8_t *pkt_data = pkt->getConstPtr<uint8_t>();
+    const uint8_t *pkt_data = clean ? nullptr : pkt->getConstPtr<uint8_t>();
 
     if (pkt->isError()) {
         if (!functional || !suppressFuncErrors)
             panic( "%s access failed at %#x\n",
                 pkt->isWrite() ? "Write" : "Read", req->getPaddr());
+    } else if (clean) {
+        // the clean is only complete once any dirty copy of the block
+        // reached the point of coherency, so the memory must hold the
+        // last value written
+        auto ref = referenceData.find(addr);
+        if (ref != referenceData.end()) {
+            uint8_t mem_data;
+            RequestPtr mem_req = std::make_shared<Request>(
+                addr, 1, 0, requestorId);
+            Packet mem_pkt(mem_req, MemCmd::ReadReq);
+            mem_pkt.dataStatic(&mem_data);
+            system->getPhysMem().functionalAccess(&mem_pkt);
+            if (mem_data != ref->second) {
+                panic("%s: clean of %x (blk %x) @ cycle %d left %x "
+                      "in memory, expected %x\n", name(), addr,
+                      blockAlign(addr), curTick(), mem_data, ref->second);
+            }
+        }
+
+        stats.numCleans++;
     } else {
         if (pkt->isRead()) {
             uint8_t ref_data = referenceData[req->getPaddr()];
@@ -205,7 +237,9 @@ MemTest::MemTestStats::MemTestStats(statistics::Group *parent)
       ADD_STAT(numReads, statistics::units::Count::get(),
                "number of read accesses completed"),
       ADD_STAT(numWrites, statistics::units::Count::get(),
-               "number of write accesses completed")
+               "number of write accesses completed"),
+      ADD_STAT(numCleans, statistics::units::Count::get(),
+               "number of cache cleans completed")
 {
 
 }
@@ -222,6 +256,9 @@ MemTest::tick()
     uint8_t data = random_mt.random<uint8_t>();
     bool uncacheable = random_mt.random(0, 100) < percentUncacheable;
     unsigned base = random_mt.random(0, 1);
+    // only draw when enabled, to keep the sequence of other tests
+    bool clean = percentCleans && !uncacheable &&
+        random_mt.random(0, 100) < percentCleans;
     Request::Flags flags;
     Addr paddr;
 
@@ -249,8 +286,18 @@ MemTest::tick()
     } while (outstandingAddrs.find(paddr) != outstandingAddrs.end());
 
     bool do_functional = (random_mt.random(0, 100) < percentFunctional) &&
-        !uncacheable;
-    RequestPtr req = std::make_shared<Request>(paddr, 1, flags, requestorId);
+        !uncacheable && !clean;
+    RequestPtr req;
+    if (clean) {
+        // cache maintenance works on whole blocks
+        flags.set(Request::CLEAN | Request::DST_POC);
+        if (random_mt.random(0, 1))
+            flags.set(Request::INVALIDATE);
+        req = std::make_shared<Request>(blockAlign(paddr), blockSize, flags,
+                                        requestorId);
+    } else {
+        req = std::make_shared<Request>(paddr, 1, flags, requestorId);
+    }
     req->setContext(id);
 
     outstandingAddrs.insert(paddr);
@@ -260,9 +307,16 @@ MemTest::tick()
              "Tester %s has more than 100 outstanding requests\n", name());
 
     PacketPtr pkt = nullptr;
-    uint8_t *pkt_data = new uint8_t[1];
+    uint8_t *pkt_data = clean ? nullptr : new uint8_t[1];
+
+    if (clean) {
+        DPRINTF(MemTest, "Initiating clean%s at addr %x (blk %x)\n",
+                req->isCacheInvalidate() ? " and invalidate" : "",
+                paddr, blockAlign(paddr));
 
-    if (cmd < percentReads) {
+        pkt = new Packet(req, req->isCacheInvalidate() ?
+                         MemCmd::CleanInvalidReq : MemCmd::CleanSharedReq);
+    } else if (cmd < percentReads) {
         // start by ensuring there is a reference value if we have not
         // seen this address before
         [[maybe_unused]] uint8_t ref_data = 0;
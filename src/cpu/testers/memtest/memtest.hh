@@ -54,6 +54,8 @@
 namespace gem5
 {
 
+class System;
+
 /**
  * The MemTest class tests a cache coherent memory system by
  * generating false sharing and verifying the read data against a
@@ -75,6 +77,7 @@ class MemTest : public ClockedObject
     typedef MemTestParams Params;
     MemTest(const Params &p);
 
+    void startup() override;
 
     Port &getPort(const std::string &if_name,
                   PortID idx=InvalidPortID) override;
@@ -131,6 +134,10 @@ class MemTest : public ClockedObject
     const unsigned percentReads;
     const unsigned percentFunctional;
     const unsigned percentUncacheable;
+    const unsigned percentCleans;
+
+    /** System, to check the memory after cleans */
+    System *system;
 
     /** Request id for all generated traffic */
     RequestorID requestorId;
@@ -180,6 +187,7 @@ class MemTest : public ClockedObject
         MemTestStats(statistics::Group *parent);
         statistics::Scalar numReads;
         statistics::Scalar numWrites;
+        statistics::Scalar numCleans;
     } stats;
 
     /**
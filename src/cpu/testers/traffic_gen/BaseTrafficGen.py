@@ -85,6 +85,13 @@ class BaseTrafficGen(ClockedObject):
         "1ms", "Time before exiting due to lack of progress"
     )
 
+    # Number of packets generated in one go. Above 1, all packets due
+    # on the same tick are sent from a single event, the stochastic
+    # generators work out this many accesses ahead of time and packets
+    # are recycled rather than allocated. The timing at the port is
+    # unchanged, but the random draws are interleaved differently.
+    batch_size = Param.Unsigned(1, "Number of packets generated in one go")
+
     # Generator type used for applying Stream and/or Substream IDs to requests
     stream_gen = Param.StreamGenType(
         "none", "Generator for adding Stream and/or Substream ID's to requests"
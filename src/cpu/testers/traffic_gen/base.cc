@@ -36,6 +36,7 @@
  */
 #include "cpu/testers/traffic_gen/base.hh"
 
+#include <algorithm>
 #include <sstream>
 
 #include "base/intmath.hh"
@@ -49,6 +50,7 @@
 #include "cpu/testers/traffic_gen/idle_gen.hh"
 #include "cpu/testers/traffic_gen/linear_gen.hh"
 #include "cpu/testers/traffic_gen/nvm_gen.hh"
+#include "cpu/testers/traffic_gen/packet_pool.hh"
 #include "cpu/testers/traffic_gen/random_gen.hh"
 #include "cpu/testers/traffic_gen/stream_gen.hh"
 #include "cpu/testers/traffic_gen/strided_gen.hh"
@@ -76,6 +78,7 @@ BaseTrafficGen::BaseTrafficGen(const BaseTrafficGenParams &p)
       nextTransitionTick(0),
       nextPacketTick(0),
       maxOutstandingReqs(p.max_outstanding_reqs),
+      batchSize(std::max(p.batch_size, 1U)),
       port(name() + ".port", *this),
       retryPkt(NULL),
       retryPktTick(0), blockedWaitingResp(false),
@@ -84,6 +87,8 @@ BaseTrafficGen::BaseTrafficGen(const BaseTrafficGenParams &p)
       requestorId(system->getRequestorId(this)),
       streamGenerator(StreamGen::create(p))
 {
+    if (batchSize > 1)
+        packetPool.reset(new PacketPool(requestorId));
 }
 
 BaseTrafficGen::~BaseTrafficGen()
@@ -177,43 +182,19 @@ BaseTrafficGen::update()
         transition();
     } else {
         assert(curTick() >= nextPacketTick);
-        // get the next packet and try to send it
-        PacketPtr pkt = activeGenerator->getNextPacket();
-
-        // If generating stream/substream IDs are enabled,
-        // try to pick and assign them to the new packet
-        if (streamGenerator) {
-            auto sid = streamGenerator->pickStreamID();
-            auto ssid = streamGenerator->pickSubstreamID();
-
-            pkt->req->setStreamId(sid);
-
-            if (streamGenerator->ssidValid()) {
-                pkt->req->setSubstreamId(ssid);
+        sendNextPacket();
+
+        // when batching, keep going with the packets that are due on
+        // this very tick rather than scheduling an event for each
+        for (unsigned burst = 1; burst < batchSize && retryPkt == NULL;
+             burst++) {
+            nextPacketTick = activeGenerator->nextPacketTick(elasticReq, 0);
+            if (nextPacketTick > curTick() ||
+                nextTransitionTick <= curTick()) {
+                scheduleUpdate();
+                return;
             }
-        }
-
-        // suppress packets that are not destined for a memory, such as
-        // device accesses that could be part of a trace
-        if (pkt && system->isMemAddr(pkt->getAddr())) {
-            stats.numPackets++;
-            // Only attempts to send if not blocked by pending responses
-            blockedWaitingResp = allocateWaitingRespSlot(pkt);
-            if (blockedWaitingResp || !port.sendTimingReq(pkt)) {
-                retryPkt = pkt;
-                retryPktTick = curTick();
-            }
-        } else if (pkt) {
-            DPRINTF(TrafficGen, "Suppressed packet %s 0x%x\n",
-                    pkt->cmdString(), pkt->getAddr());
-
-            ++stats.numSuppressed;
-            if (!(static_cast<int>(stats.numSuppressed.value()) % 10000))
-                warn("%s suppressed %d packets with non-memory addresses\n",
-                     name(), stats.numSuppressed.value());
-
-            delete pkt;
-            pkt = nullptr;
+            sendNextPacket();
         }
     }
 
@@ -226,6 +207,58 @@ BaseTrafficGen::update()
     }
 }
 
+void
+BaseTrafficGen::sendNextPacket()
+{
+    // get the next packet and try to send it
+    PacketPtr pkt = activeGenerator->getNextPacket();
+
+    // If generating stream/substream IDs are enabled,
+    // try to pick and assign them to the new packet
+    if (streamGenerator) {
+        auto sid = streamGenerator->pickStreamID();
+        auto ssid = streamGenerator->pickSubstreamID();
+
+        pkt->req->setStreamId(sid);
+
+        if (streamGenerator->ssidValid()) {
+            pkt->req->setSubstreamId(ssid);
+        }
+    }
+
+    // suppress packets that are not destined for a memory, such as
+    // device accesses that could be part of a trace
+    if (pkt && system->isMemAddr(pkt->getAddr())) {
+        stats.numPackets++;
+        // Only attempts to send if not blocked by pending responses
+        blockedWaitingResp = allocateWaitingRespSlot(pkt);
+        if (blockedWaitingResp || !port.sendTimingReq(pkt)) {
+            retryPkt = pkt;
+            retryPktTick = curTick();
+        }
+    } else if (pkt) {
+        DPRINTF(TrafficGen, "Suppressed packet %s 0x%x\n",
+                pkt->cmdString(), pkt->getAddr());
+
+        ++stats.numSuppressed;
+        if (!(static_cast<int>(stats.numSuppressed.value()) % 10000))
+            warn("%s suppressed %d packets with non-memory addresses\n",
+                 name(), stats.numSuppressed.value());
+
+        freePacket(pkt);
+        pkt = nullptr;
+    }
+}
+
+void
+BaseTrafficGen::freePacket(PacketPtr pkt)
+{
+    if (packetPool)
+        packetPool->release(pkt);
+    else
+        delete pkt;
+}
+
 void
 BaseTrafficGen::transition()
 {
@@ -234,6 +267,9 @@ BaseTrafficGen::transition()
 
     activeGenerator = nextGenerator();
 
+    if (activeGenerator && packetPool)
+        activeGenerator->setBatch(packetPool.get(), batchSize);
+
     if (activeGenerator) {
         const Tick duration = activeGenerator->duration;
         if (duration != MaxTick && duration != 0) {
@@ -544,11 +580,13 @@ BaseTrafficGen::createStrided(Tick duration,
 
 std::shared_ptr<BaseGen>
 BaseTrafficGen::createTrace(Tick duration,
-                            const std::string& trace_file, Addr addr_offset)
+                            const std::string& trace_file, Addr addr_offset,
+                            Tick start_tick)
 {
 #if HAVE_PROTOBUF
     return std::shared_ptr<BaseGen>(
-        new TraceGen(*this, requestorId, duration, trace_file, addr_offset));
+        new TraceGen(*this, requestorId, duration, trace_file, addr_offset,
+                     start_tick));
 #else
     panic("Can't instantiate trace generation without Protobuf support!\n");
 #endif
@@ -577,7 +615,7 @@ BaseTrafficGen::recvTimingResp(PacketPtr pkt)
 
     waitingResp.erase(iter);
 
-    delete pkt;
+    freePacket(pkt);
 
     // Sends up the request if we were blocked
     if (blockedWaitingResp) {
@@ -51,6 +51,7 @@ namespace gem5
 {
 
 class BaseGen;
+class PacketPool;
 class StreamGen;
 class System;
 struct BaseTrafficGenParams;
@@ -125,6 +126,12 @@ class BaseTrafficGen : public ClockedObject
 
     const int maxOutstandingReqs;
 
+    /** Number of packets generated in one go */
+    const unsigned batchSize;
+
+    /** Packets recycled when batching, nullptr otherwise */
+    std::unique_ptr<PacketPool> packetPool;
+
 
     /** Request port specialisation for the traffic generator */
     class TrafficGenPort : public RequestPort
@@ -160,6 +167,15 @@ class BaseTrafficGen : public ClockedObject
      */
     void update();
 
+    /**
+     * Get the next packet from the active generator and try to send
+     * it.
+     */
+    void sendNextPacket();
+
+    /** Delete a packet or give it back to the pool. */
+    void freePacket(PacketPtr pkt);
+
     /** The instance of request port used by the traffic generator. */
     TrafficGenPort port;
 
@@ -327,7 +343,8 @@ class BaseTrafficGen : public ClockedObject
 
     std::shared_ptr<BaseGen> createTrace(
         Tick duration,
-        const std::string& trace_file, Addr addr_offset);
+        const std::string& trace_file, Addr addr_offset,
+        Tick start_tick = 0);
 
   protected:
     void start();
@@ -41,13 +41,14 @@
 
 #include "base/logging.hh"
 #include "cpu/testers/traffic_gen/base.hh"
+#include "cpu/testers/traffic_gen/packet_pool.hh"
 
 namespace gem5
 {
 
 BaseGen::BaseGen(SimObject &obj, RequestorID requestor_id, Tick _duration)
     : _name(obj.name()), requestorId(requestor_id),
-      duration(_duration)
+      pool(nullptr), batchSize(1), duration(_duration)
 {
 }
 
@@ -55,21 +56,28 @@ PacketPtr
 BaseGen::getPacket(Addr addr, unsigned size, const MemCmd& cmd,
                    Request::FlagsType flags)
 {
-    // Create new request
-    RequestPtr req = std::make_shared<Request>(addr, size, flags,
-                                               requestorId);
-    // Dummy PC to have PC-based prefetchers latch on; get entropy into higher
-    // bits
-    req->setPC(((Addr)requestorId) << 2);
+    PacketPtr pkt;
+    uint8_t* pkt_data;
+    if (pool) {
+        pkt = pool->allocate(addr, size, cmd, flags);
+        pkt_data = pkt->getPtr<uint8_t>();
+    } else {
+        // Create new request
+        RequestPtr req = std::make_shared<Request>(addr, size, flags,
+                                                   requestorId);
+        // Embed it in a packet
+        pkt = new Packet(req, cmd);
 
-    // Embed it in a packet
-    PacketPtr pkt = new Packet(req, cmd);
+        pkt_data = new uint8_t[req->getSize()];
+        pkt->dataDynamic(pkt_data);
+    }
 
-    uint8_t* pkt_data = new uint8_t[req->getSize()];
-    pkt->dataDynamic(pkt_data);
+    // Dummy PC to have PC-based prefetchers latch on; get entropy into higher
+    // bits
+    pkt->req->setPC(((Addr)requestorId) << 2);
 
     if (cmd.isWrite()) {
-        std::fill_n(pkt_data, req->getSize(), (uint8_t)requestorId);
+        std::fill_n(pkt_data, size, (uint8_t)requestorId);
     }
 
     return pkt;
@@ -85,7 +93,7 @@ StochasticGen::StochasticGen(SimObject &obj,
           startAddr(start_addr), endAddr(end_addr),
           blocksize(_blocksize), cacheLineSize(cacheline_size),
           minPeriod(min_period), maxPeriod(max_period),
-          readPercent(read_percent), dataLimit(data_limit)
+          readPercent(read_percent), dataLimit(data_limit), batchPos(0)
 {
     if (blocksize > cacheLineSize)
         fatal("TrafficGen %s block size (%d) is larger than "
@@ -99,4 +107,34 @@ StochasticGen::StochasticGen(SimObject &obj,
         fatal("%s cannot have min_period > max_period", name());
 }
 
+void
+StochasticGen::generateAccess(Addr &addr, bool &is_read)
+{
+    panic("%s does not generate accesses in batches\n", name());
+}
+
+void
+StochasticGen::nextAccess(Addr &addr, bool &is_read)
+{
+    if (batchSize <= 1) {
+        generateAccess(addr, is_read);
+        return;
+    }
+
+    if (batchPos == batchAddrs.size()) {
+        batchAddrs.resize(batchSize);
+        batchReads.resize(batchSize);
+        for (unsigned i = 0; i < batchSize; i++) {
+            bool read;
+            generateAccess(batchAddrs[i], read);
+            batchReads[i] = read;
+        }
+        batchPos = 0;
+    }
+
+    addr = batchAddrs[batchPos];
+    is_read = batchReads[batchPos];
+    batchPos++;
+}
+
 } // namespace gem5
@@ -45,6 +45,7 @@
 
 #include <cstdint>
 #include <string>
+#include <vector>
 
 #include "base/types.hh"
 #include "mem/packet.hh"
@@ -54,6 +55,7 @@ namespace gem5
 {
 
 class BaseTrafficGen;
+class PacketPool;
 class SimObject;
 
 /**
@@ -72,6 +74,12 @@ class BaseGen
     /** The RequestorID used for generating requests */
     const RequestorID requestorId;
 
+    /** Pool to take packets from, or nullptr to allocate them */
+    PacketPool *pool;
+
+    /** Number of accesses to generate ahead of time */
+    unsigned batchSize;
+
     /**
      * Generate a new request and associated packet
      *
@@ -134,6 +142,20 @@ class BaseGen
      */
     virtual Tick nextPacketTick(bool elastic, Tick delay) const = 0;
 
+    /**
+     * Generate packets in batches, taking them from a pool. Generators
+     * that can do so work out the next batch_size accesses at once.
+     *
+     * @param packet_pool pool owned by the traffic generator
+     * @param batch_size number of accesses to generate ahead of time
+     */
+    void
+    setBatch(PacketPool *packet_pool, unsigned batch_size)
+    {
+        pool = packet_pool;
+        batchSize = batch_size;
+    }
+
 };
 
 class StochasticGen : public BaseGen
@@ -170,6 +192,38 @@ class StochasticGen : public BaseGen
 
     /** Maximum amount of data to manipulate */
     const Addr dataLimit;
+
+    /**
+     * Choose the address and command of the next access, for the
+     * generators that batch them.
+     *
+     * @param addr Address of the access
+     * @param is_read Whether the access is a read
+     */
+    virtual void generateAccess(Addr &addr, bool &is_read);
+
+    /**
+     * Get the next access, generating batchSize of them at once when
+     * batching.
+     */
+    void nextAccess(Addr &addr, bool &is_read);
+
+    /** Drop the accesses generated ahead of time. */
+    void
+    resetBatch()
+    {
+        batchAddrs.clear();
+        batchReads.clear();
+        batchPos = 0;
+    }
+
+  private:
+    /** Accesses generated ahead of time */
+    std::vector<Addr> batchAddrs;
+    std::vector<bool> batchReads;
+
+    /** Next access to hand out of the batch */
+    size_t batchPos;
 };
 
 } // namespace gem5
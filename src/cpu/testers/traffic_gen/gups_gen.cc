@@ -44,6 +44,7 @@ GUPSGen::GUPSGen(const GUPSGenParams& params):
     nextSendEvent([this]{ sendNextReq(); }, name()),
     system(params.system),
     requestorId(system->getRequestorId(this)),
+    packetPool(requestorId),
     port(name() + ".port", this),
     startAddr(params.start_addr),
     memSize(params.mem_size),
@@ -92,7 +93,7 @@ GUPSGen::startup()
             Addr addr = indexToAddr(start_index);
             PacketPtr pkt = getWritePacket(addr, block_size, write_data);
             port.sendFunctionalPacket(pkt);
-            delete pkt;
+            packetPool.release(pkt);
         }
     }
     schedule(nextCreateEvent, nextCycle());
@@ -108,14 +109,10 @@ GUPSGen::indexToAddr (uint64_t index)
 PacketPtr
 GUPSGen::getReadPacket(Addr addr, unsigned int size)
 {
-    RequestPtr req = std::make_shared<Request>(addr, size, 0, requestorId);
+    PacketPtr pkt = packetPool.allocate(addr, size, MemCmd::ReadReq);
     // Dummy PC to have PC-based prefetchers latch on; get entropy into higher
     // bits
-    req->setPC(((Addr)requestorId) << 2);
-
-    // Embed it in a packet
-    PacketPtr pkt = new Packet(req, MemCmd::ReadReq);
-    pkt->allocate();
+    pkt->req->setPC(((Addr)requestorId) << 2);
 
     return pkt;
 }
@@ -123,14 +120,10 @@ GUPSGen::getReadPacket(Addr addr, unsigned int size)
 PacketPtr
 GUPSGen::getWritePacket(Addr addr, unsigned int size, uint8_t *data)
 {
-    RequestPtr req = std::make_shared<Request>(addr, size, 0,
-                                               requestorId);
+    PacketPtr pkt = packetPool.allocate(addr, size, MemCmd::WriteReq);
     // Dummy PC to have PC-based prefetchers latch on; get entropy into higher
     // bits
-    req->setPC(((Addr)requestorId) << 2);
-
-    PacketPtr pkt = new Packet(req, MemCmd::WriteReq);
-    pkt->allocate();
+    pkt->req->setPC(((Addr)requestorId) << 2);
     pkt->setData(data);
 
     return pkt;
@@ -153,7 +146,7 @@ GUPSGen::handleResponse(PacketPtr pkt)
         stats.totalWriteLat += curTick() - exitTimes[pkt->req];
 
         exitTimes.erase(pkt->req);
-        delete pkt;
+        packetPool.release(pkt);
     } else {
         DPRINTF(GUPSGen, "%s: received a read resp. pkt->addr_range: %s\n",
                         __func__, pkt->getAddrRange().to_string());
@@ -204,7 +197,7 @@ GUPSGen::createNextReq()
         Addr addr = pkt->getAddr();
         PacketPtr new_pkt = getWritePacket(addr,
                             elementSize, (uint8_t*) updated_value);
-        delete pkt;
+        packetPool.release(pkt);
         requestPool.push(new_pkt);
     } else if (!doneReading) {
         // If no writes then read
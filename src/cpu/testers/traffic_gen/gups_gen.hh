@@ -42,6 +42,7 @@
 #include <vector>
 
 #include "base/statistics.hh"
+#include "cpu/testers/traffic_gen/packet_pool.hh"
 #include "mem/port.hh"
 #include "params/GUPSGen.hh"
 #include "sim/clocked_object.hh"
@@ -243,6 +244,12 @@ class GUPSGen : public ClockedObject
      */
     const RequestorID requestorId;
 
+    /**
+     * @brief Recycles the packets and requests once their responses
+     * have been handled.
+     */
+    PacketPool packetPool;
+
     /**
      * @brief An instance of GenPort to communicate with the outside.
      */
@@ -52,26 +52,20 @@ LinearGen::enter()
     // reset the address and the data counter
     nextAddr = startAddr;
     dataManipulated = 0;
+    resetBatch();
 }
 
-PacketPtr
-LinearGen::getNextPacket()
+void
+LinearGen::generateAccess(Addr &addr, bool &is_read)
 {
     // choose if we generate a read or a write here
-    bool isRead = readPercent != 0 &&
+    is_read = readPercent != 0 &&
         (readPercent == 100 || random_mt.random(0, 100) < readPercent);
 
-    assert((readPercent == 0 && !isRead) || (readPercent == 100 && isRead) ||
-           readPercent != 100);
+    assert((readPercent == 0 && !is_read) ||
+           (readPercent == 100 && is_read) || readPercent != 100);
 
-    DPRINTF(TrafficGen, "LinearGen::getNextPacket: %c to addr %x, size %d\n",
-            isRead ? 'r' : 'w', nextAddr, blocksize);
-
-    // Add the amount of data manipulated to the total
-    dataManipulated += blocksize;
-
-    PacketPtr pkt = getPacket(nextAddr, blocksize,
-                              isRead ? MemCmd::ReadReq : MemCmd::WriteReq);
+    addr = nextAddr;
 
     // increment the address
     nextAddr += blocksize;
@@ -83,8 +77,23 @@ LinearGen::getNextPacket()
                 "the range\n");
         nextAddr = startAddr;
     }
+}
+
+PacketPtr
+LinearGen::getNextPacket()
+{
+    Addr addr;
+    bool isRead;
+    nextAccess(addr, isRead);
+
+    DPRINTF(TrafficGen, "LinearGen::getNextPacket: %c to addr %x, size %d\n",
+            isRead ? 'r' : 'w', addr, blocksize);
+
+    // Add the amount of data manipulated to the total
+    dataManipulated += blocksize;
 
-    return pkt;
+    return getPacket(addr, blocksize,
+                     isRead ? MemCmd::ReadReq : MemCmd::WriteReq);
 }
 
 Tick
@@ -100,6 +100,9 @@ class LinearGen : public StochasticGen
 
     Tick nextPacketTick(bool elastic, Tick delay) const;
 
+  protected:
+    void generateAccess(Addr &addr, bool &is_read) override;
+
   private:
     /** Address of next request */
     Addr nextAddr;
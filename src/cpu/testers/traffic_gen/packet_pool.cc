@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2024 The University of Edinburgh
+ * All rights reserved
+ *
+ * The license below extends only to copyright in the software and shall
+ * not be construed as granting a license to any other intellectual
+ * property including but not limited to intellectual property relating
+ * to a hardware implementation of the functionality of the software
+ * licensed hereunder.  You may use the software subject to the license
+ * terms below provided that you ensure that this notice is replicated
+ * unmodified and in its entirety in all distributions of the software,
+ * modified or unmodified, in source code or in binary form.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cpu/testers/traffic_gen/packet_pool.hh"
+
+#include <new>
+
+namespace gem5
+{
+
+PacketPool::PacketPool(RequestorID requestor_id)
+    : requestorId(requestor_id)
+{
+}
+
+PacketPool::~PacketPool()
+{
+    // Packets still in flight are left to whoever holds them
+    for (auto *slot : freeSlots) {
+        delete[] slot->data;
+        delete slot;
+    }
+}
+
+PacketPtr
+PacketPool::allocate(Addr addr, unsigned size, const MemCmd &cmd,
+                     Request::FlagsType flags)
+{
+    RequestPtr req;
+    if (freeRequests.empty()) {
+        req = std::make_shared<Request>(addr, size, flags, requestorId);
+    } else {
+        // Construct the new request in place to keep the control block
+        req = std::move(freeRequests.back());
+        freeRequests.pop_back();
+        req->~Request();
+        new (req.get()) Request(addr, size, flags, requestorId);
+    }
+
+    Slot *slot;
+    if (freeSlots.empty()) {
+        slot = new Slot;
+        slot->data = nullptr;
+        slot->capacity = 0;
+    } else {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    }
+
+    if (slot->capacity < size) {
+        delete[] slot->data;
+        slot->data = new uint8_t[size];
+        slot->capacity = size;
+    }
+
+    PacketPtr pkt = new (slot->packet) Packet(req, cmd);
+    pkt->dataStatic(slot->data);
+    return pkt;
+}
+
+void
+PacketPool::release(PacketPtr pkt)
+{
+    Slot *slot = reinterpret_cast<Slot *>(pkt);
+    RequestPtr req = std::move(pkt->req);
+    pkt->~Packet();
+
+    if (req.use_count() == 1)
+        freeRequests.push_back(std::move(req));
+    freeSlots.push_back(slot);
+}
+
+} // namespace gem5
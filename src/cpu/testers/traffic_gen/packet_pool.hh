@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2024 The University of Edinburgh
+ * All rights reserved
+ *
+ * The license below extends only to copyright in the software and shall
+ * not be construed as granting a license to any other intellectual
+ * property including but not limited to intellectual property relating
+ * to a hardware implementation of the functionality of the software
+ * licensed hereunder.  You may use the software subject to the license
+ * terms below provided that you ensure that this notice is replicated
+ * unmodified and in its entirety in all distributions of the software,
+ * modified or unmodified, in source code or in binary form.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Declaration of a pool recycling the packets of a traffic generator.
+ */
+
+#ifndef __CPU_TRAFFIC_GEN_PACKET_POOL_HH__
+#define __CPU_TRAFFIC_GEN_PACKET_POOL_HH__
+
+#include <vector>
+
+#include "base/types.hh"
+#include "mem/packet.hh"
+#include "mem/request.hh"
+
+namespace gem5
+{
+
+/**
+ * A pool of packets, requests and data buffers for a requestor that
+ * owns the packets it sends once they come back. Packets that are
+ * released are kept and reused by the next allocations, so that a
+ * generator in steady state does not go to the heap for every
+ * request it creates.
+ *
+ * Packets from the pool must be handed back with release() rather
+ * than deleted.
+ */
+class PacketPool
+{
+  private:
+    /**
+     * Storage for a packet and its data. The packet goes first, so
+     * that the slot can be found from a pointer to the packet.
+     */
+    struct Slot
+    {
+        alignas(Packet) unsigned char packet[sizeof(Packet)];
+        uint8_t *data;
+        unsigned capacity;
+    };
+
+    const RequestorID requestorId;
+
+    /** Slots not holding a packet in flight. */
+    std::vector<Slot *> freeSlots;
+
+    /** Requests nobody but the pool refers to any more. */
+    std::vector<RequestPtr> freeRequests;
+
+  public:
+    /**
+     * @param requestor_id RequestorID set on each request
+     */
+    PacketPool(RequestorID requestor_id);
+
+    ~PacketPool();
+
+    /**
+     * Get a packet with a new request and an uninitialised data
+     * buffer of the request size.
+     *
+     * @param addr Physical address to use
+     * @param size Size of the request
+     * @param cmd Memory command to send
+     * @param flags Optional request flags
+     */
+    PacketPtr allocate(Addr addr, unsigned size, const MemCmd &cmd,
+                       Request::FlagsType flags = 0);
+
+    /**
+     * Give back a packet got from allocate().
+     */
+    void release(PacketPtr pkt);
+};
+
+} // namespace gem5
+
+#endif // __CPU_TRAFFIC_GEN_PACKET_POOL_HH__
@@ -51,23 +51,32 @@ RandomGen::enter()
 {
     // reset the counter to zero
     dataManipulated = 0;
+    resetBatch();
 }
 
-PacketPtr
-RandomGen::getNextPacket()
+void
+RandomGen::generateAccess(Addr &addr, bool &is_read)
 {
     // choose if we generate a read or a write here
-    bool isRead = readPercent != 0 &&
+    is_read = readPercent != 0 &&
         (readPercent == 100 || random_mt.random(0, 100) < readPercent);
 
-    assert((readPercent == 0 && !isRead) || (readPercent == 100 && isRead) ||
-           readPercent != 100);
+    assert((readPercent == 0 && !is_read) ||
+           (readPercent == 100 && is_read) || readPercent != 100);
 
     // address of the request
-    Addr addr = random_mt.random(startAddr, endAddr - 1);
+    addr = random_mt.random(startAddr, endAddr - 1);
 
     // round down to start address of block
     addr -= addr % blocksize;
+}
+
+PacketPtr
+RandomGen::getNextPacket()
+{
+    Addr addr;
+    bool isRead;
+    nextAccess(addr, isRead);
 
     DPRINTF(TrafficGen, "RandomGen::getNextPacket: %c to addr %x, size %d\n",
             isRead ? 'r' : 'w', addr, blocksize);
@@ -97,6 +97,9 @@ class RandomGen : public StochasticGen
 
     Tick nextPacketTick(bool elastic, Tick delay) const;
 
+  protected:
+    void generateAccess(Addr &addr, bool &is_read) override;
+
   protected:
     /**
      * Counter to determine the amount of data
@@ -92,6 +92,12 @@ TraceGen::InputStream::read(TraceElement& element)
     return false;
 }
 
+bool
+TraceGen::InputStream::seek(Tick tick)
+{
+    return trace.seek(tick);
+}
+
 Tick
 TraceGen::nextPacketTick(bool elastic, Tick delay) const
 {
@@ -118,14 +124,22 @@ TraceGen::nextPacketTick(bool elastic, Tick delay) const
 void
 TraceGen::enter()
 {
-    // update the trace offset to the time where the state was entered.
-    tickOffset = curTick();
+    // update the trace offset so that the start tick is played back
+    // at the time where the state was entered.
+    tickOffset = curTick() - startTick;
 
     // clear everything
     currElement.clear();
 
-    // read the first element in the file and set the complete flag
-    traceComplete = !trace.read(nextElement);
+    // without an index, skip the elements before the start one by one
+    if (startTick != 0 && !trace.seek(startTick))
+        DPRINTF(TrafficGen, "Trace is not indexed, skipping to tick %d\n",
+                startTick);
+
+    // read the first element to play and set the complete flag
+    do {
+        traceComplete = !trace.read(nextElement);
+    } while (!traceComplete && nextElement.tick < startTick);
 }
 
 PacketPtr
@@ -144,6 +144,15 @@ class TraceGen : public BaseGen
          * @return True if an element could be read successfully
          */
         bool read(TraceElement& element);
+
+        /**
+         * Skip ahead to the elements at or after a tick, as far as
+         * the trace index allows.
+         *
+         * @param tick Tick to skip ahead to
+         * @return False if the trace is not indexed
+         */
+        bool seek(Tick tick);
     };
 
   public:
@@ -156,13 +165,16 @@ class TraceGen : public BaseGen
      * @param _duration duration of this state before transitioning
      * @param trace_file File to read the transactions from
      * @param addr_offset Positive offset to add to trace address
+     * @param start_tick Trace tick to start replaying from
      */
     TraceGen(SimObject &obj, RequestorID requestor_id, Tick _duration,
-             const std::string& trace_file, Addr addr_offset)
+             const std::string& trace_file, Addr addr_offset,
+             Tick start_tick = 0)
         : BaseGen(obj, requestor_id, _duration),
           trace(trace_file),
           tickOffset(0),
           addrOffset(addr_offset),
+          startTick(start_tick),
           traceComplete(false)
     {
     }
@@ -202,6 +214,12 @@ class TraceGen : public BaseGen
      */
     Addr addrOffset;
 
+    /**
+     * Trace tick to start replaying from, which is played back at the
+     * time the state is entered. Earlier elements are skipped.
+     */
+    const Tick startTick;
+
     /**
      * Set to true when the trace replay for one instance of
      * state is complete.
@@ -165,11 +165,16 @@ TrafficGen::parseConfig()
                 if (mode == "TRACE") {
                     std::string traceFile;
                     Addr addrOffset;
+                    Tick startTick = 0;
 
+                    // the tick to start replaying from is optional
                     is >> traceFile >> addrOffset;
+                    if (!(is >> startTick))
+                        startTick = 0;
                     traceFile = resolveFile(traceFile);
 
-                    states[id] = createTrace(duration, traceFile, addrOffset);
+                    states[id] = createTrace(duration, traceFile, addrOffset,
+                                             startTick);
                     DPRINTF(TrafficGen, "State: %d TraceGen\n", id);
                 } else if (mode == "IDLE") {
                     states[id] = createIdle(duration);
@@ -163,6 +163,16 @@ ThreadContext::sendFunctional(PacketPtr pkt)
     port->sendFunctional(pkt);
 }
 
+void
+ThreadContext::sendMemBackdoorReq(const MemBackdoorReq &req,
+                                  MemBackdoorPtr &backdoor)
+{
+    const auto *port =
+        dynamic_cast<const RequestPort *>(&getCpuPtr()->getDataPort());
+    assert(port);
+    port->sendMemBackdoorReq(req, backdoor);
+}
+
 void
 ThreadContext::quiesce()
 {
@@ -51,6 +51,7 @@
 #include "base/types.hh"
 #include "cpu/pc_event.hh"
 #include "cpu/reg_class.hh"
+#include "mem/backdoor.hh"
 
 namespace gem5
 {
@@ -144,6 +145,13 @@ class ThreadContext : public PCEventScope
 
     virtual void sendFunctional(PacketPtr pkt);
 
+    /**
+     * Request a back door to memory along the path functional accesses
+     * take, leaving backdoor untouched if there is none.
+     */
+    virtual void sendMemBackdoorReq(const MemBackdoorReq &req,
+                                    MemBackdoorPtr &backdoor);
+
     virtual Process *getProcessPtr() = 0;
 
     virtual void setProcessPtr(Process *p) = 0;
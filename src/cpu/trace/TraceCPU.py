@@ -86,6 +86,13 @@ class TraceCPU(BaseCPU):
     # If progress msg interval is set to a non-zero value, it is treated as
     # the interval of committed instructions at which an info message is
     # printed.
+    # When replaying the traces of several cores recorded together, the
+    # Trace CPUs share the domain used when recording, so that they acquire
+    # and release locks in the recorded order
+    syncDomain = Param.TraceSyncDomain(
+        NULL, "Domain ordering synchronising accesses across cores"
+    )
+
     progressMsgInterval = Param.Unsigned(
         0,
         "Interval of committed "
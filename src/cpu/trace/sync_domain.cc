@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2024 The University of Edinburgh
+ * All rights reserved
+ *
+ * The license below extends only to copyright in the software and shall
+ * not be construed as granting a license to any other intellectual
+ * property including but not limited to intellectual property relating
+ * to a hardware implementation of the functionality of the software
+ * licensed hereunder.  You may use the software subject to the license
+ * terms below provided that you ensure that this notice is replicated
+ * unmodified and in its entirety in all distributions of the software,
+ * modified or unmodified, in source code or in binary form.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cpu/trace/sync_domain.hh"
+
+#include <algorithm>
+
+#include "base/trace.hh"
+#include "debug/TraceCPUSync.hh"
+
+namespace gem5
+{
+
+TraceSyncDomain::TraceSyncDomain(const TraceSyncDomainParams &p)
+    : SimObject(p), stallTimeout(p.stall_timeout),
+      stallTimeoutEvent([this]{ expireStalls(); }, name()), stats(this)
+{
+}
+
+bool
+TraceSyncDomain::record(Addr addr, bool write, bool sync_op,
+                        uint64_t &epoch)
+{
+    if (!epochs.record(addr, write, sync_op, epoch))
+        return false;
+
+    if (write)
+        ++stats.recordedWrites;
+    else
+        ++stats.recordedReads;
+
+    DPRINTF(TraceCPUSync, "Recorded %s of %#x at epoch %d\n",
+            write ? "write" : "read", addr, epoch);
+    return true;
+}
+
+bool
+TraceSyncDomain::mayProceed(Addr addr, uint64_t epoch, bool write) const
+{
+    return epochs.mayProceed(addr, epoch, write);
+}
+
+void
+TraceSyncDomain::complete(Addr addr, uint64_t epoch, bool write)
+{
+    if (!write)
+        return;
+
+    if (!epochs.complete(addr, epoch, write)) {
+        DPRINTF(TraceCPUSync, "Replayed write of %#x at skipped epoch %d\n",
+                addr, epoch);
+        return;
+    }
+    ++stats.replayedWrites;
+
+    DPRINTF(TraceCPUSync, "Replayed write of %#x at epoch %d\n",
+            addr, epoch);
+}
+
+void
+TraceSyncDomain::waitFor(Addr addr, uint64_t epoch, bool write,
+                         std::function<void()> wake)
+{
+    epochs.waitFor(addr, epoch, write, curTick(), std::move(wake));
+    ++stats.replayStalls;
+
+    if (stallTimeout && !stallTimeoutEvent.scheduled())
+        schedule(stallTimeoutEvent, curTick() + stallTimeout);
+}
+
+void
+TraceSyncDomain::expireStalls()
+{
+    stats.stallTimeouts += epochs.expire(curTick(), stallTimeout);
+
+    const Tick next = epochs.nextTimeout(stallTimeout);
+    if (next != MaxTick)
+        schedule(stallTimeoutEvent, std::max(next, curTick()));
+}
+
+TraceSyncDomain::SyncDomainStats::SyncDomainStats(statistics::Group *parent)
+    : statistics::Group(parent),
+      ADD_STAT(recordedWrites, statistics::units::Count::get(),
+               "Number of synchronising writes recorded"),
+      ADD_STAT(recordedReads, statistics::units::Count::get(),
+               "Number of synchronising reads recorded"),
+      ADD_STAT(replayedWrites, statistics::units::Count::get(),
+               "Number of synchronising writes replayed"),
+      ADD_STAT(replayStalls, statistics::units::Count::get(),
+               "Number of times a replayed access waited for another core"),
+      ADD_STAT(stallTimeouts, statistics::units::Count::get(),
+               "Number of times a variable was skipped ahead after a "
+               "replayed access waited for too long")
+{
+}
+
+} // namespace gem5
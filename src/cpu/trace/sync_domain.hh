@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2024 The University of Edinburgh
+ * All rights reserved
+ *
+ * The license below extends only to copyright in the software and shall
+ * not be construed as granting a license to any other intellectual
+ * property including but not limited to intellectual property relating
+ * to a hardware implementation of the functionality of the software
+ * licensed hereunder.  You may use the software subject to the license
+ * terms below provided that you ensure that this notice is replicated
+ * unmodified and in its entirety in all distributions of the software,
+ * modified or unmodified, in source code or in binary form.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __CPU_TRACE_SYNC_DOMAIN_HH__
+#define __CPU_TRACE_SYNC_DOMAIN_HH__
+
+#include <functional>
+
+#include "base/statistics.hh"
+#include "base/types.hh"
+#include "cpu/trace/sync_epochs.hh"
+#include "params/TraceSyncDomain.hh"
+#include "sim/eventq.hh"
+#include "sim/sim_object.hh"
+
+namespace gem5
+{
+
+/**
+ * A TraceSyncDomain orders synchronising memory accesses across the
+ * cores of a multi-core elastic trace.
+ *
+ * When recording, every ElasticTrace of the domain reports its
+ * committed accesses. Atomics, store conditionals and locked
+ * read-modify-writes make their address a synchronisation variable,
+ * for instance a lock. Every later write to the variable, including
+ * plain release stores, is given the next epoch of the variable. Every
+ * read of it is marked with the epoch of the last write it could have
+ * observed. As the accesses are reported in commit order, the epochs
+ * follow the order in which the cores went through their critical
+ * sections.
+ *
+ * When replaying, the TraceCPUs of the domain hold back a marked write
+ * until the write of the previous epoch has been performed by whichever
+ * core made it, and a marked read until the write it observed has. The
+ * cores thus acquire and release their locks in the recorded order,
+ * while everything else replays elastically on the shared hierarchy.
+ *
+ * If the trace of a core ends before one of its marked writes, for
+ * instance because it was cut short, the other cores would wait for
+ * the write forever. An access that has waited for longer than the
+ * stall timeout therefore lets the domain skip the variable ahead to
+ * its epoch, with a warning.
+ */
+class TraceSyncDomain : public SimObject
+{
+  public:
+    TraceSyncDomain(const TraceSyncDomainParams &p);
+
+    /**
+     * Record a committed memory access.
+     *
+     * @param addr Physical address of the access
+     * @param write True for writes and read-modify-writes
+     * @param sync_op True for atomics, LL/SC and locked accesses
+     * @param epoch Epoch to record with the access
+     * @return True if the access has to be recorded as a marker
+     */
+    bool record(Addr addr, bool write, bool sync_op, uint64_t &epoch);
+
+    /**
+     * Check if a marked access may be replayed.
+     *
+     * @param addr Physical address of the access
+     * @param epoch Epoch recorded with the access
+     * @param write True if the access is a write
+     */
+    bool mayProceed(Addr addr, uint64_t epoch, bool write) const;
+
+    /**
+     * Note that a marked access has been replayed, waking up the
+     * accesses waiting for it.
+     *
+     * @param addr Physical address of the access
+     * @param epoch Epoch recorded with the access
+     * @param write True if the access is a write
+     */
+    void complete(Addr addr, uint64_t epoch, bool write);
+
+    /**
+     * Call back once the next marked write to an address has been
+     * replayed, or once the stall timeout has expired.
+     *
+     * @param addr Physical address to wait on
+     * @param epoch Epoch recorded with the waiting access
+     * @param write True if the waiting access is a write
+     * @param wake Function to call back
+     */
+    void waitFor(Addr addr, uint64_t epoch, bool write,
+                 std::function<void()> wake);
+
+  private:
+    /**
+     * Skip the variables ahead that accesses have waited on for longer
+     * than the stall timeout.
+     */
+    void expireStalls();
+
+    /** Synchronisation variables and their epochs */
+    SyncEpochTable epochs;
+
+    /** Time an access may wait for another core, 0 for no limit */
+    const Tick stallTimeout;
+
+    EventFunctionWrapper stallTimeoutEvent;
+
+    struct SyncDomainStats : public statistics::Group
+    {
+        SyncDomainStats(statistics::Group *parent);
+
+        statistics::Scalar recordedWrites;
+        statistics::Scalar recordedReads;
+        statistics::Scalar replayedWrites;
+        statistics::Scalar replayStalls;
+        statistics::Scalar stallTimeouts;
+    } stats;
+};
+
+} // namespace gem5
+
+#endif // __CPU_TRACE_SYNC_DOMAIN_HH__
@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2024 The University of Edinburgh
+ * All rights reserved
+ *
+ * The license below extends only to copyright in the software and shall
+ * not be construed as granting a license to any other intellectual
+ * property including but not limited to intellectual property relating
+ * to a hardware implementation of the functionality of the software
+ * licensed hereunder.  You may use the software subject to the license
+ * terms below provided that you ensure that this notice is replicated
+ * unmodified and in its entirety in all distributions of the software,
+ * modified or unmodified, in source code or in binary form.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cpu/trace/sync_epochs.hh"
+
+#include <algorithm>
+
+#include "base/logging.hh"
+
+namespace gem5
+{
+
+bool
+SyncEpochTable::record(Addr addr, bool write, bool sync_op, uint64_t &epoch)
+{
+    auto it = vars.find(addr);
+    if (it == vars.end()) {
+        // only synchronising accesses turn an address into a variable
+        if (!sync_op)
+            return false;
+        it = vars.emplace(addr, SyncVar()).first;
+    }
+
+    SyncVar &var = it->second;
+    if (write) {
+        epoch = ++var.epoch;
+    } else {
+        // a read of a variable nobody wrote yet needs no ordering
+        if (var.epoch == 0)
+            return false;
+        epoch = var.epoch;
+    }
+    return true;
+}
+
+bool
+SyncEpochTable::mayProceed(Addr addr, uint64_t epoch, bool write) const
+{
+    auto it = vars.find(addr);
+    const uint64_t done = it == vars.end() ? 0 : it->second.epoch;
+    // a write whose epoch was skipped goes ahead whenever it turns up
+    return write ? epoch <= done + 1 : done >= epoch;
+}
+
+bool
+SyncEpochTable::complete(Addr addr, uint64_t epoch, bool write)
+{
+    if (!write)
+        return true;
+
+    SyncVar &var = vars[addr];
+    if (var.skipped && epoch <= var.epoch)
+        return false;
+    panic_if(var.epoch + 1 != epoch, "Write of %#x replayed at epoch %d, "
+             "expected epoch %d\n", addr, epoch, var.epoch + 1);
+    var.epoch = epoch;
+
+    // the waiters check again and may queue up anew
+    wakeAll(var);
+    return true;
+}
+
+void
+SyncEpochTable::waitFor(Addr addr, uint64_t epoch, bool write, Tick now,
+                        std::function<void()> wake)
+{
+    vars[addr].waiters.push_back({write ? epoch - 1 : epoch, now,
+                                  std::move(wake)});
+}
+
+Tick
+SyncEpochTable::nextTimeout(Tick timeout) const
+{
+    Tick next = MaxTick;
+    for (const auto &v : vars) {
+        for (const auto &waiter : v.second.waiters)
+            next = std::min(next, waiter.since + timeout);
+    }
+    return next;
+}
+
+unsigned
+SyncEpochTable::expire(Tick now, Tick timeout)
+{
+    unsigned skipped = 0;
+    std::vector<std::function<void()>> wakes;
+    for (auto &v : vars) {
+        SyncVar &var = v.second;
+
+        // only skip as far as the oldest epoch a timed out access
+        // needs, the writes after it may still turn up
+        uint64_t needed = 0;
+        bool timed_out = false;
+        for (const auto &waiter : var.waiters) {
+            if (waiter.since + timeout <= now) {
+                needed = timed_out ? std::min(needed, waiter.needed) :
+                                     waiter.needed;
+                timed_out = true;
+            }
+        }
+        if (!timed_out)
+            continue;
+
+        if (needed > var.epoch) {
+            warn("Replayed access to %#x waited %d ticks for epoch %d, "
+                 "skipping ahead from epoch %d. The trace of the core "
+                 "that made the write may be truncated.\n", v.first,
+                 timeout, needed, var.epoch);
+            var.epoch = needed;
+            var.skipped = true;
+            ++skipped;
+        }
+
+        for (auto &waiter : var.waiters)
+            wakes.push_back(std::move(waiter.wake));
+        var.waiters.clear();
+    }
+
+    // the waiters may queue up anew, so only call them back once the
+    // variables are no longer being walked
+    for (auto &wake : wakes)
+        wake();
+    return skipped;
+}
+
+void
+SyncEpochTable::wakeAll(SyncVar &var)
+{
+    std::vector<Waiter> waiters;
+    waiters.swap(var.waiters);
+    for (auto &waiter : waiters)
+        waiter.wake();
+}
+
+} // namespace gem5
@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2024 The University of Edinburgh
+ * All rights reserved
+ *
+ * The license below extends only to copyright in the software and shall
+ * not be construed as granting a license to any other intellectual
+ * property including but not limited to intellectual property relating
+ * to a hardware implementation of the functionality of the software
+ * licensed hereunder.  You may use the software subject to the license
+ * terms below provided that you ensure that this notice is replicated
+ * unmodified and in its entirety in all distributions of the software,
+ * modified or unmodified, in source code or in binary form.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __CPU_TRACE_SYNC_EPOCHS_HH__
+#define __CPU_TRACE_SYNC_EPOCHS_HH__
+
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include "base/types.hh"
+
+namespace gem5
+{
+
+/**
+ * Epochs of the synchronisation variables of a TraceSyncDomain, kept
+ * apart from the SimObject so that the ordering can be tested on its
+ * own.
+ */
+class SyncEpochTable
+{
+  public:
+    /**
+     * Record a committed memory access.
+     *
+     * @param addr Physical address of the access
+     * @param write True for writes and read-modify-writes
+     * @param sync_op True for atomics, LL/SC and locked accesses
+     * @param epoch Epoch to record with the access
+     * @return True if the access has to be recorded as a marker
+     */
+    bool record(Addr addr, bool write, bool sync_op, uint64_t &epoch);
+
+    /**
+     * Check if a marked access may be replayed.
+     *
+     * @param addr Physical address of the access
+     * @param epoch Epoch recorded with the access
+     * @param write True if the access is a write
+     */
+    bool mayProceed(Addr addr, uint64_t epoch, bool write) const;
+
+    /**
+     * Note that a marked access has been replayed, waking up the
+     * accesses waiting for it.
+     *
+     * @param addr Physical address of the access
+     * @param epoch Epoch recorded with the access
+     * @param write True if the access is a write
+     * @return False if the write came after its epoch was given up on
+     */
+    bool complete(Addr addr, uint64_t epoch, bool write);
+
+    /**
+     * Call back once the next marked write to an address has been
+     * replayed, or once the wait has been given up on.
+     *
+     * @param addr Physical address to wait on
+     * @param epoch Epoch recorded with the waiting access
+     * @param write True if the waiting access is a write
+     * @param now Current tick
+     * @param wake Function to call back
+     */
+    void waitFor(Addr addr, uint64_t epoch, bool write, Tick now,
+                 std::function<void()> wake);
+
+    /**
+     * Tick at which the longest waiting access runs out of time.
+     *
+     * @param timeout Time an access may wait for
+     * @return The tick, or MaxTick if nothing is waiting
+     */
+    Tick nextTimeout(Tick timeout) const;
+
+    /**
+     * Give up on the writes that the accesses waiting for at least a
+     * timeout are held back by, typically because the trace of the
+     * core that made them ends early, and wake the accesses up.
+     *
+     * @param now Current tick
+     * @param timeout Time an access may wait for
+     * @return Number of variables whose epoch was skipped ahead
+     */
+    unsigned expire(Tick now, Tick timeout);
+
+  private:
+    /** A replayed access waiting for another core */
+    struct Waiter
+    {
+        /** Epoch the variable has to reach for the access to go */
+        uint64_t needed;
+        /** Tick at which the access started waiting */
+        Tick since;
+        std::function<void()> wake;
+    };
+
+    /** State kept for every synchronisation variable */
+    struct SyncVar
+    {
+        /**
+         * Last epoch handed out when recording, or the last epoch
+         * performed when replaying
+         */
+        uint64_t epoch = 0;
+
+        /** Set once epochs have been skipped after a timeout */
+        bool skipped = false;
+
+        /** Replayers waiting for the next epoch */
+        std::vector<Waiter> waiters;
+    };
+
+    /** Call back all the waiters of a variable */
+    static void wakeAll(SyncVar &var);
+
+    /** Synchronisation variables by physical address */
+    std::unordered_map<Addr, SyncVar> vars;
+};
+
+} // namespace gem5
+
+#endif // __CPU_TRACE_SYNC_EPOCHS_HH__
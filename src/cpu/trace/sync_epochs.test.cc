@@ -0,0 +1,260 @@
+/*
+ * Copyright (c) 2024 The University of Edinburgh
+ * All rights reserved
+ *
+ * The license below extends only to copyright in the software and shall
+ * not be construed as granting a license to any other intellectual
+ * property including but not limited to intellectual property relating
+ * to a hardware implementation of the functionality of the software
+ * licensed hereunder.  You may use the software subject to the license
+ * terms below provided that you ensure that this notice is replicated
+ * unmodified and in its entirety in all distributions of the software,
+ * modified or unmodified, in source code or in binary form.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "base/gtest/logging.hh"
+#include "cpu/trace/sync_epochs.hh"
+
+using namespace gem5;
+
+namespace
+{
+
+const Addr lock = 0x1000;
+const Addr flag = 0x2000;
+
+/** A marked access as recorded in the trace of one core */
+struct Marker
+{
+    Addr addr;
+    bool write;
+    uint64_t epoch;
+};
+
+/**
+ * Record an access, returning the marker it leaves in the trace or a
+ * marker with epoch 0 if it is left unmarked.
+ */
+Marker
+record(SyncEpochTable &table, Addr addr, bool write, bool sync_op)
+{
+    Marker marker{addr, write, 0};
+    if (!table.record(addr, write, sync_op, marker.epoch))
+        marker.epoch = 0;
+    return marker;
+}
+
+bool
+mayProceed(const SyncEpochTable &table, const Marker &marker)
+{
+    return table.mayProceed(marker.addr, marker.epoch, marker.write);
+}
+
+} // anonymous namespace
+
+/**
+ * Only synchronising accesses turn an address into a variable, after
+ * which every write gets the next epoch and every read the epoch of the
+ * last write.
+ */
+TEST(SyncEpochTableTest, Record)
+{
+    SyncEpochTable table;
+
+    // plain accesses to an unknown address are left alone
+    EXPECT_EQ(record(table, lock, true, false).epoch, 0);
+    EXPECT_EQ(record(table, lock, false, false).epoch, 0);
+
+    // and so is a read of a variable nobody wrote yet
+    EXPECT_EQ(record(table, lock, false, true).epoch, 0);
+
+    EXPECT_EQ(record(table, lock, true, true).epoch, 1);
+    EXPECT_EQ(record(table, lock, false, false).epoch, 1);
+    // a plain release store still orders against the acquire
+    EXPECT_EQ(record(table, lock, true, false).epoch, 2);
+    EXPECT_EQ(record(table, lock, false, true).epoch, 2);
+    EXPECT_EQ(record(table, lock, true, true).epoch, 3);
+
+    // variables are independent
+    EXPECT_EQ(record(table, flag, true, false).epoch, 0);
+    EXPECT_EQ(record(table, flag, true, true).epoch, 1);
+}
+
+/**
+ * Replaying two cores that took a lock in turns makes each acquire wait
+ * for the release before it, and each read for the write it observed.
+ */
+TEST(SyncEpochTableTest, ReplayOrder)
+{
+    SyncEpochTable recorder;
+    // core 0 takes and releases the lock, then core 1 does
+    const Marker acquire0 = record(recorder, lock, true, true);
+    const Marker release0 = record(recorder, lock, true, false);
+    const Marker spin1 = record(recorder, lock, false, false);
+    const Marker acquire1 = record(recorder, lock, true, true);
+    const Marker release1 = record(recorder, lock, true, false);
+
+    SyncEpochTable replayer;
+    // core 1 runs ahead and has to wait for core 0 throughout
+    EXPECT_FALSE(mayProceed(replayer, spin1));
+    EXPECT_FALSE(mayProceed(replayer, acquire1));
+    EXPECT_TRUE(mayProceed(replayer, acquire0));
+    EXPECT_TRUE(replayer.complete(lock, acquire0.epoch, true));
+
+    EXPECT_FALSE(mayProceed(replayer, spin1));
+    EXPECT_FALSE(mayProceed(replayer, acquire1));
+    EXPECT_TRUE(mayProceed(replayer, release0));
+    EXPECT_TRUE(replayer.complete(lock, release0.epoch, true));
+
+    EXPECT_TRUE(mayProceed(replayer, spin1));
+    EXPECT_TRUE(replayer.complete(lock, spin1.epoch, false));
+    EXPECT_TRUE(mayProceed(replayer, acquire1));
+    EXPECT_TRUE(replayer.complete(lock, acquire1.epoch, true));
+    EXPECT_TRUE(mayProceed(replayer, release1));
+    EXPECT_TRUE(replayer.complete(lock, release1.epoch, true));
+}
+
+/**
+ * Completing a write calls back everything waiting on the variable,
+ * and nothing waiting on other variables.
+ */
+TEST(SyncEpochTableTest, WakeOnComplete)
+{
+    SyncEpochTable table;
+    int lock_wakes = 0;
+    int flag_wakes = 0;
+    table.waitFor(lock, 2, true, 0, [&] { ++lock_wakes; });
+    table.waitFor(lock, 1, false, 0, [&] { ++lock_wakes; });
+    table.waitFor(flag, 1, false, 0, [&] { ++flag_wakes; });
+
+    EXPECT_TRUE(table.complete(lock, 1, true));
+    EXPECT_EQ(lock_wakes, 2);
+    EXPECT_EQ(flag_wakes, 0);
+
+    // the waiters have been dropped once called back
+    EXPECT_TRUE(table.complete(lock, 2, true));
+    EXPECT_EQ(lock_wakes, 2);
+}
+
+/**
+ * Replaying a write out of its epoch is a bug in the replayer.
+ */
+TEST(SyncEpochTableTest, OutOfOrderWrite)
+{
+    SyncEpochTable table;
+    gtestLogOutput.str("");
+    EXPECT_THROW(table.complete(lock, 2, true), GTestException);
+    EXPECT_NE(gtestLogOutput.str().find("expected epoch 1"),
+              std::string::npos);
+}
+
+/**
+ * The timeout runs from the oldest waiting access.
+ */
+TEST(SyncEpochTableTest, NextTimeout)
+{
+    SyncEpochTable table;
+    EXPECT_EQ(table.nextTimeout(100), MaxTick);
+
+    table.waitFor(lock, 1, false, 50, [] {});
+    table.waitFor(flag, 1, false, 20, [] {});
+    EXPECT_EQ(table.nextTimeout(100), 120);
+
+    EXPECT_TRUE(table.complete(flag, 1, true));
+    EXPECT_EQ(table.nextTimeout(100), 150);
+}
+
+/**
+ * When the core that owes a write stops short, the cores waiting on it
+ * are let go ahead after the timeout, and nothing happens before.
+ */
+TEST(SyncEpochTableTest, TruncatedTrace)
+{
+    SyncEpochTable recorder;
+    // core 0 takes the lock and its trace ends before the release,
+    // after which core 1 takes the lock and sets a flag
+    const Marker acquire0 = record(recorder, lock, true, true);
+    record(recorder, lock, true, false);
+    const Marker acquire1 = record(recorder, lock, true, true);
+    const Marker release1 = record(recorder, lock, true, false);
+
+    SyncEpochTable replayer;
+    EXPECT_TRUE(replayer.complete(lock, acquire0.epoch, true));
+
+    int wakes = 0;
+    ASSERT_FALSE(mayProceed(replayer, acquire1));
+    replayer.waitFor(lock, acquire1.epoch, true, 1000, [&] { ++wakes; });
+
+    EXPECT_EQ(replayer.expire(1999, 1000), 0);
+    EXPECT_EQ(wakes, 0);
+    EXPECT_FALSE(mayProceed(replayer, acquire1));
+
+    gtestLogOutput.str("");
+    EXPECT_EQ(replayer.expire(2000, 1000), 1);
+    EXPECT_EQ(wakes, 1);
+    EXPECT_NE(gtestLogOutput.str().find("may be truncated"),
+              std::string::npos);
+    EXPECT_EQ(replayer.nextTimeout(1000), MaxTick);
+
+    // core 1 carries on in order from there
+    EXPECT_TRUE(mayProceed(replayer, acquire1));
+    EXPECT_TRUE(replayer.complete(lock, acquire1.epoch, true));
+    EXPECT_TRUE(mayProceed(replayer, release1));
+    EXPECT_TRUE(replayer.complete(lock, release1.epoch, true));
+}
+
+/**
+ * Only the epochs the timed out accesses need are skipped, and a write
+ * that turns up late after all goes through without effect.
+ */
+TEST(SyncEpochTableTest, SkipOnlyWhatIsNeeded)
+{
+    SyncEpochTable table;
+    int wakes = 0;
+    // a read that needs epoch 2 has timed out, a write of epoch 5 has
+    // not yet
+    table.waitFor(lock, 2, false, 0, [&] { ++wakes; });
+    table.waitFor(lock, 5, true, 900, [&] { ++wakes; });
+
+    EXPECT_EQ(table.expire(1000, 1000), 1);
+    EXPECT_EQ(wakes, 2);
+    EXPECT_TRUE(table.mayProceed(lock, 2, false));
+    EXPECT_FALSE(table.mayProceed(lock, 3, false));
+    EXPECT_FALSE(table.mayProceed(lock, 4, true));
+    EXPECT_TRUE(table.mayProceed(lock, 3, true));
+
+    // the late writes of the skipped epochs neither wait nor count
+    EXPECT_TRUE(table.mayProceed(lock, 1, true));
+    EXPECT_FALSE(table.complete(lock, 1, true));
+    EXPECT_FALSE(table.complete(lock, 2, true));
+    EXPECT_TRUE(table.complete(lock, 3, true));
+    EXPECT_TRUE(table.mayProceed(lock, 4, true));
+}
@@ -38,6 +38,7 @@
 #include "cpu/trace/trace_cpu.hh"
 
 #include "base/compiler.hh"
+#include "cpu/trace/sync_domain.hh"
 #include "sim/sim_exit.hh"
 
 namespace gem5
@@ -63,6 +64,7 @@ TraceCPU::TraceCPU(const TraceCPUParams &params)
         traceOffset(0),
         execCompleteEvent(nullptr),
         enableEarlyExit(params.enableEarlyExit),
+        syncDomain(params.syncDomain),
         progressMsgInterval(params.progressMsgInterval),
         progressMsgThreshold(params.progressMsgInterval), traceStats(this)
 {
@@ -243,6 +245,8 @@ ElasticDataGenStatGroup::ElasticDataGenStatGroup(statistics::Group *parent,
              "Number of strictly ordered loads"),
     ADD_STAT(numSOStores, statistics::units::Count::get(),
              "Number of strictly ordered stores"),
+    ADD_STAT(numSyncStalls, statistics::units::Count::get(),
+             "Number of times a node waited for an access of another core"),
     ADD_STAT(dataLastTick, statistics::units::Tick::get(),
              "Last tick simulated from the elastic data trace")
 {
@@ -405,13 +409,34 @@ TraceCPU::ElasticDataGen::execute()
     auto free_itr = readyList.begin();
     // Iterate through readyList until the next free node has its execute
     // tick later than curTick or the end of readyList is reached
-    while (free_itr->execTick <= curTick() && free_itr != readyList.end()) {
+    while (free_itr != readyList.end() && free_itr->execTick <= curTick()) {
 
         // Get pointer to the node to be executed
         graph_itr = depGraph.find(free_itr->seqNum);
         assert(graph_itr != depGraph.end());
         GraphNode* node_ptr = graph_itr->second;
 
+        // Hold back a synchronising access until the accesses of other
+        // cores it was recorded after have been replayed, letting the
+        // nodes behind it go ahead in the meantime
+        if (!retryPkt && node_ptr->syncEpoch != 0 && owner.syncDomain &&
+            !owner.syncDomain->mayProceed(node_ptr->physAddr,
+                                          node_ptr->syncEpoch,
+                                          node_ptr->syncWrite)) {
+            DPRINTF(TraceCPUData, "Node seq. num %lli waits for epoch %lli "
+                    "of %#x.\n", node_ptr->seqNum, node_ptr->syncEpoch,
+                    node_ptr->physAddr);
+            ++elasticStats.numSyncStalls;
+            syncWaitList.push_back(node_ptr->seqNum);
+            owner.syncDomain->waitFor(node_ptr->physAddr,
+                                      node_ptr->syncEpoch,
+                                      node_ptr->syncWrite,
+                                      [this] { wakeSyncWaiters(); });
+            readyList.erase(free_itr);
+            free_itr = readyList.begin();
+            continue;
+        }
+
         // If there is a retryPkt send that else execute the load
         if (retryPkt) {
             // The retryPkt must be the request that was created by the
@@ -439,6 +464,13 @@ TraceCPU::ElasticDataGen::execute()
             break;
         }
 
+        // Let the other cores go ahead with what was ordered after this
+        if (node_ptr->syncEpoch != 0 && owner.syncDomain) {
+            owner.syncDomain->complete(node_ptr->physAddr,
+                                       node_ptr->syncEpoch,
+                                       node_ptr->syncWrite);
+        }
+
         // Proceed to remove dependencies for the successfully executed node.
         // If it is a load which is not strictly ordered and we sent a
         // request for it successfully, we do not yet mark any register
@@ -750,6 +782,22 @@ TraceCPU::ElasticDataGen::completeMemAccess(PacketPtr pkt)
     }
 }
 
+void
+TraceCPU::ElasticDataGen::wakeSyncWaiters()
+{
+    if (syncWaitList.empty())
+        return;
+
+    // Nodes that still cannot proceed will wait again in execute()
+    for (auto seq_num : syncWaitList)
+        addToSortedReadyList(seq_num, owner.clockEdge());
+    syncWaitList.clear();
+
+    // A pending retry brings control back to execute() anyway
+    if (!retryPkt)
+        owner.schedDcacheNextEvent(owner.clockEdge());
+}
+
 void
 TraceCPU::ElasticDataGen::addToSortedReadyList(NodeSeqNum seq_num,
                                                Tick exec_tick)
@@ -1279,6 +1327,9 @@ TraceCPU::ElasticDataGen::InputStream::read(GraphNode* element)
         else
             element->pc = 0;
 
+        element->syncEpoch = pkt_msg.sync_epoch();
+        element->syncWrite = pkt_msg.sync_write();
+
         // ROB occupancy number
         ++microOpCount;
         if (pkt_msg.has_weight()) {
@@ -43,6 +43,7 @@
 #include <queue>
 #include <set>
 #include <unordered_map>
+#include <vector>
 
 #include "base/statistics.hh"
 #include "cpu/base.hh"
@@ -57,6 +58,8 @@
 namespace gem5
 {
 
+class TraceSyncDomain;
+
 /**
  * The trace cpu replays traces generated using the elastic trace probe
  * attached to the O3 CPU model. The elastic trace is an execution trace with
@@ -590,6 +593,12 @@ class TraceCPU : public BaseCPU
             /** Instruction PC */
             Addr pc;
 
+            /** Synchronisation epoch of a load/store, zero if none */
+            uint64_t syncEpoch;
+
+            /** If the synchronising access is a write */
+            bool syncWrite;
+
             /** List of order dependencies. */
             RobDepList robDep;
 
@@ -945,6 +954,12 @@ class TraceCPU : public BaseCPU
         /** Get number of micro-ops modelled in the TraceCPU replay */
         uint64_t getMicroOpCount() const { return trace.getMicroOpCount(); }
 
+        /**
+         * Put the nodes held back for other cores back into the readyList
+         * once one of the synchronising writes they wait for is replayed.
+         */
+        void wakeSyncWaiters();
+
       private:
         /** Reference of the TraceCPU. */
         TraceCPU& owner;
@@ -1005,6 +1020,12 @@ class TraceCPU : public BaseCPU
         /** List of nodes that are ready to execute */
         std::list<ReadyNode> readyList;
 
+        /**
+         * Synchronising nodes taken out of the readyList as they have to
+         * wait for accesses of other cores.
+         */
+        std::vector<NodeSeqNum> syncWaitList;
+
       protected:
         // Defining the a stat group
         struct ElasticDataGenStatGroup : public statistics::Group
@@ -1022,6 +1043,8 @@ class TraceCPU : public BaseCPU
             statistics::Scalar numSplitReqs;
             statistics::Scalar numSOLoads;
             statistics::Scalar numSOStores;
+            /** Times a node waited for an access of another core */
+            statistics::Scalar numSyncStalls;
             /** Tick when ElasticDataGen completes execution */
             statistics::Scalar dataLastTick;
         } elasticStats;
@@ -1092,6 +1115,12 @@ class TraceCPU : public BaseCPU
      */
     const bool enableEarlyExit;
 
+    /**
+     * Domain ordering the synchronising accesses of this trace with those
+     * replayed by the other Trace CPUs, if replaying a multi-core trace.
+     */
+    TraceSyncDomain *syncDomain;
+
     /**
       * Interval of committed instructions specified by the user at which a
       * progress info message is printed
@@ -84,6 +84,16 @@ class CommMonitor(SimObject):
     latency_bins = Param.Unsigned("20", "# bins in latency histograms")
     disable_latency_hists = Param.Bool(False, "Disable latency histograms")
 
+    # log-linear (HDR style) latency histograms, with a fixed relative
+    # precision of 1 / 2^latency_log_sub_bits across the whole range
+    # rather than uniform bins that are rescaled to fit the largest value
+    latency_log_hists = Param.Bool(
+        False, "Use log-bucketed latency histograms"
+    )
+    latency_log_sub_bits = Param.Unsigned(
+        3, "log2 of buckets per power of two in log latency histograms"
+    )
+
     # inter transaction time (ITT) distributions in uniformly sized
     # bins up to the maximum, independently for read-to-read,
     # write-to-write and the combined request-to-request that does not
@@ -114,3 +124,17 @@ class CommMonitor(SimObject):
     read_addr_mask = Param.Addr(MaxAddr, "Address mask for read address")
     write_addr_mask = Param.Addr(MaxAddr, "Address mask for write address")
     disable_addr_dists = Param.Bool(True, "Disable address distributions")
+
+    # sample the per-request distributions (burst length, latency, ITT
+    # and address) to reduce the cost of leaving a monitor enabled. A
+    # read (write) is sampled once at least sample_every reads (writes)
+    # have been seen and sample_interval has passed since the last
+    # sampled read (write), and is weighted by the number of requests
+    # of its kind it stands for.
+    # Transaction, bandwidth and outstanding request counts stay exact
+    sample_every = Param.Unsigned(
+        1, "Sample one in this many requests for the distributions"
+    )
+    sample_interval = Param.Latency(
+        "0ns", "Minimum time between sampled requests"
+    )
@@ -70,6 +70,14 @@ class DRAMInterface(MemInterface):
     # performance being lower when enabled
     enable_dram_powerdown = Param.Bool(False, "Enable powerdown states")
 
+    # Account for DRAM energy by counting commands and the time spent in
+    # each power state rather than replaying every command through
+    # DRAMPower. This is faster, and matches DRAMPower closely but not
+    # exactly as commands are counted when issued
+    incremental_power = Param.Bool(
+        False, "Use incremental counters for DRAM energy"
+    )
+
     # For power modelling we need to know if the DRAM has a DLL or not
     dll = Param.Bool(True, "DRAM has DLL or not")
 
@@ -155,6 +155,13 @@ class SnoopFilter(SimObject):
     # Sanity check on max capacity to track, adjust if needed.
     max_capacity = Param.MemorySize("8MiB", "Maximum capacity of snoop filter")
 
+    # By default the snoop filter tracks any number of lines, and the
+    # capacity above is only a sanity check. With a non-zero
+    # associativity it is organised as max_capacity / line size
+    # entries in sets of this many ways, and evicting an entry
+    # back-invalidates the caches above that still hold the line.
+    assoc = Param.Unsigned(0, "Associativity (0 for an unbounded filter)")
+
 
 # We use a coherent crossbar to connect multiple requestors to the L2
 # caches. Normally this crossbar would be part of the cache itself.
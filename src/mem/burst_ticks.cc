@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2024 The University of Edinburgh
+ * All rights reserved
+ *
+ * The license below extends only to copyright in the software and shall
+ * not be construed as granting a license to any other intellectual
+ * property including but not limited to intellectual property relating
+ * to a hardware implementation of the functionality of the software
+ * licensed hereunder.  You may use the software subject to the license
+ * terms below provided that you ensure that this notice is replicated
+ * unmodified and in its entirety in all distributions of the software,
+ * modified or unmodified, in source code or in binary form.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "mem/burst_ticks.hh"
+
+#include <algorithm>
+#include <cassert>
+
+#include "base/intmath.hh"
+#include "base/logging.hh"
+
+namespace gem5
+{
+
+BurstTicks::BurstTicks(Tick window, size_t num_slots)
+    : window(window),
+      slots(size_t(1) << ceilLog2(std::max<size_t>(num_slots, 1))),
+      mask(slots.size() - 1)
+{
+    fatal_if(window == 0, "The command window must be non-zero.\n");
+}
+
+void
+BurstTicks::grow()
+{
+    std::vector<Slot> old(slots.size() * 2);
+    old.swap(slots);
+    mask = slots.size() - 1;
+    for (const auto &slot : old) {
+        if (slot.count) {
+            Slot &dst = slots[index(slot.tick)];
+            assert(dst.count == 0);
+            dst = slot;
+        }
+    }
+}
+
+void
+BurstTicks::insert(Tick tick)
+{
+    assert(tick % window == 0);
+    while (true) {
+        Slot &slot = slots[index(tick)];
+        if (slot.count == 0) {
+            slot.tick = tick;
+            slot.count = 1;
+            ++live;
+            oldest = std::min(oldest, tick);
+            return;
+        }
+        if (slot.tick == tick) {
+            ++slot.count;
+            return;
+        }
+        // Two live windows alias the same slot; widen the ring
+        grow();
+    }
+}
+
+size_t
+BurstTicks::prune(Tick before)
+{
+    if (live == 0 || oldest >= before)
+        return 0;
+
+    size_t removed = 0;
+    Tick new_oldest = MaxTick;
+    for (auto &slot : slots) {
+        if (!slot.count)
+            continue;
+        if (slot.tick < before) {
+            slot.count = 0;
+            ++removed;
+        } else {
+            new_oldest = std::min(new_oldest, slot.tick);
+        }
+    }
+    live -= removed;
+    oldest = new_oldest;
+    return removed;
+}
+
+} // namespace gem5
@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2024 The University of Edinburgh
+ * All rights reserved
+ *
+ * The license below extends only to copyright in the software and shall
+ * not be construed as granting a license to any other intellectual
+ * property including but not limited to intellectual property relating
+ * to a hardware implementation of the functionality of the software
+ * licensed hereunder.  You may use the software subject to the license
+ * terms below provided that you ensure that this notice is replicated
+ * unmodified and in its entirety in all distributions of the software,
+ * modified or unmodified, in source code or in binary form.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __MEM_BURST_TICKS_HH__
+#define __MEM_BURST_TICKS_HH__
+
+#include <cstddef>
+#include <vector>
+
+#include "base/types.hh"
+
+namespace gem5
+{
+
+/**
+ * Count of commands issued per command window, used by the memory
+ * controllers to limit the command bus bandwidth. Every tick handed to
+ * this class is aligned to the command window, and only a short span
+ * of windows is live at any time as the controller prunes the ones
+ * that have passed. The counts are therefore kept in a ring of slots
+ * indexed by window number rather than in a hashed multiset, which
+ * makes lookups and insertions a single indexed access. The ring
+ * doubles in size if two live windows ever map to the same slot.
+ */
+class BurstTicks
+{
+  private:
+    struct Slot
+    {
+        Tick tick = 0;
+        unsigned count = 0;
+    };
+
+    /** Size of a command window in ticks. */
+    const Tick window;
+
+    std::vector<Slot> slots;
+    size_t mask;
+
+    /** Number of slots holding a live window. */
+    size_t live = 0;
+
+    /** Lower bound on the oldest live window, used to skip pruning. */
+    Tick oldest = MaxTick;
+
+    size_t index(Tick tick) const { return (tick / window) & mask; }
+
+    void grow();
+
+  public:
+    /**
+     * @param window Command window in ticks.
+     * @param num_slots Initial number of slots, rounded up to a power
+     *                  of two.
+     */
+    BurstTicks(Tick window, size_t num_slots=64);
+
+    /** Number of commands recorded in the window starting at tick. */
+    unsigned
+    count(Tick tick) const
+    {
+        const Slot &slot = slots[index(tick)];
+        return (slot.count && slot.tick == tick) ? slot.count : 0;
+    }
+
+    /** Record one more command in the window starting at tick. */
+    void insert(Tick tick);
+
+    /**
+     * Drop all the windows starting before the given tick.
+     *
+     * @return Number of windows removed.
+     */
+    size_t prune(Tick before);
+
+    /** Number of windows with at least one command recorded. */
+    size_t size() const { return live; }
+};
+
+} // namespace gem5
+
+#endif // __MEM_BURST_TICKS_HH__
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2024 The University of Edinburgh
+ * All rights reserved
+ *
+ * The license below extends only to copyright in the software and shall
+ * not be construed as granting a license to any other intellectual
+ * property including but not limited to intellectual property relating
+ * to a hardware implementation of the functionality of the software
+ * licensed hereunder.  You may use the software subject to the license
+ * terms below provided that you ensure that this notice is replicated
+ * unmodified and in its entirety in all distributions of the software,
+ * modified or unmodified, in source code or in binary form.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "mem/burst_ticks.hh"
+
+using namespace gem5;
+
+TEST(BurstTicksTest, CountsPerWindow)
+{
+    BurstTicks ticks(1000);
+    EXPECT_EQ(ticks.count(0), 0);
+
+    ticks.insert(0);
+    ticks.insert(0);
+    ticks.insert(2000);
+    EXPECT_EQ(ticks.count(0), 2);
+    EXPECT_EQ(ticks.count(1000), 0);
+    EXPECT_EQ(ticks.count(2000), 1);
+    EXPECT_EQ(ticks.size(), 2);
+}
+
+TEST(BurstTicksTest, PruneRemovesPastWindows)
+{
+    BurstTicks ticks(1000);
+    for (Tick t = 0; t < 10000; t += 1000)
+        ticks.insert(t);
+
+    EXPECT_EQ(ticks.prune(5000), 5);
+    EXPECT_EQ(ticks.size(), 5);
+    EXPECT_EQ(ticks.count(4000), 0);
+    EXPECT_EQ(ticks.count(5000), 1);
+
+    // Nothing older is left, so a second prune is a no-op
+    EXPECT_EQ(ticks.prune(5000), 0);
+}
+
+TEST(BurstTicksTest, AliasedWindowsGrowTheRing)
+{
+    // Windows 0 and 4 share a slot in a four entry ring
+    BurstTicks ticks(10, 4);
+    ticks.insert(0);
+    ticks.insert(40);
+    ticks.insert(40);
+    EXPECT_EQ(ticks.count(0), 1);
+    EXPECT_EQ(ticks.count(40), 2);
+
+    // Slot reuse after the older window is pruned
+    ticks.prune(40);
+    ticks.insert(80);
+    EXPECT_EQ(ticks.count(0), 0);
+    EXPECT_EQ(ticks.count(80), 1);
+}
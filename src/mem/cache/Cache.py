@@ -136,6 +136,22 @@ class BaseCache(ClockedObject):
         False, "Whether to access tags and data sequentially"
     )
 
+    # By default the caches restart cold after a checkpoint restore.
+    # When the contents are checkpointed, the valid blocks are
+    # re-inserted on restore, oldest first, so that the replacement
+    # policy sees approximately the same recency order. Without their
+    # data, restored blocks are refilled from memory on startup, which
+    # requires that no cache holds dirty data when checkpointing. The
+    # snoop filters below learn about the restored blocks on startup.
+    # Contents found in a checkpoint are restored whatever the value of
+    # checkpoint_contents of the restoring cache.
+    checkpoint_contents = Param.Bool(
+        False, "Save the cache contents in checkpoints"
+    )
+    checkpoint_data = Param.Bool(
+        True, "Also save the data of the blocks when saving the contents"
+    )
+
     cpu_side = ResponsePort("Upstream port closer to the CPU and/or device")
     mem_side = RequestPort("Downstream port closer to memory")
 
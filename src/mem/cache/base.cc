@@ -45,6 +45,11 @@
 
 #include "mem/cache/base.hh"
 
+#include <zlib.h>
+
+#include <algorithm>
+#include <cstring>
+
 #include "base/compiler.hh"
 #include "base/logging.hh"
 #include "debug/Cache.hh"
@@ -52,6 +57,7 @@
 #include "debug/CachePort.hh"
 #include "debug/CacheRepl.hh"
 #include "debug/CacheVerbose.hh"
+#include "debug/Checkpoint.hh"
 #include "debug/HWPrefetch.hh"
 #include "mem/cache/compressors/base.hh"
 #include "mem/cache/mshr.hh"
@@ -105,6 +111,8 @@ BaseCache::BaseCache(const BaseCacheParams &p, unsigned blk_size)
       isReadOnly(p.is_read_only),
       replaceExpansions(p.replace_expansions),
       moveContractions(p.move_contractions),
+      checkpointContents(p.checkpoint_contents),
+      checkpointData(p.checkpoint_data),
       blocked(0),
       order(0),
       noTargetMSHR(nullptr),
@@ -198,6 +206,55 @@ BaseCache::init()
     forwardSnoops = cpuSidePort.isSnooping();
 }
 
+void
+BaseCache::startup()
+{
+    ClockedObject::startup();
+
+    // Blocks restored without their data are refilled now that the
+    // memories have been restored. This is only correct because such
+    // checkpoints are refused if any cache held dirty data.
+    for (auto blk : pendingRefills) {
+        // Blocks can be evicted by later restored blocks
+        if (!blk->isValid())
+            continue;
+
+        const Addr addr = regenerateBlkAddr(blk);
+        fatal_if(!system->isMemAddr(addr), "%s: cannot refill restored "
+                 "block %#x, it is not backed by memory\n", name(), addr);
+
+        RequestPtr req = std::make_shared<Request>(
+            addr, blkSize, 0, Request::funcRequestorId);
+        if (blk->isSecure())
+            req->setFlags(Request::SECURE);
+        Packet pkt(req, MemCmd::ReadReq);
+        pkt.dataStatic(blk->data);
+        system->getPhysMem().functionalAccess(&pkt);
+    }
+    pendingRefills.clear();
+
+    // The snoop filters below only learn about blocks through the
+    // requests and responses passing through them, so tell them about
+    // the restored ones before the first of them gets evicted
+    if (restoredBlks) {
+        std::vector<uint8_t> data(blkSize);
+        tags->forEachBlk([this, &data](CacheBlk &blk) {
+            if (!blk.isValid())
+                return;
+
+            RequestPtr req = std::make_shared<Request>(
+                regenerateBlkAddr(&blk), blkSize, 0,
+                Request::funcRequestorId);
+            if (blk.isSecure())
+                req->setFlags(Request::SECURE);
+            Packet pkt(req, MemCmd::ReadReq);
+            pkt.dataStatic(data.data());
+            pkt.setRestoredBlock();
+            memSidePort.sendFunctional(&pkt);
+        });
+    }
+}
+
 Port &
 BaseCache::getPort(const std::string &if_name, PortID idx)
 {
@@ -714,6 +771,14 @@ BaseCache::recvAtomic(PacketPtr pkt)
 void
 BaseCache::functionalAccess(PacketPtr pkt, bool from_cpu_side)
 {
+    if (pkt->isRestoredBlock()) {
+        // a cache above restored the block, the snoop filters below
+        // track it on our behalf
+        assert(from_cpu_side);
+        memSidePort.sendFunctional(pkt);
+        return;
+    }
+
     Addr blk_addr = pkt->getBlockAddr(blkSize);
     bool is_secure = pkt->isSecure();
     CacheBlk *blk = tags->findBlock(pkt->getAddr(), is_secure);
@@ -1994,20 +2059,26 @@ void
 BaseCache::serialize(CheckpointOut &cp) const
 {
     bool dirty(isDirty());
+    const bool save_data = checkpointContents && checkpointData;
 
-    if (dirty) {
+    if (dirty && !save_data) {
         warn("*** The cache still contains dirty data. ***\n");
         warn("    Make sure to drain the system using the correct flags.\n");
         warn("    This checkpoint will not restore correctly " \
              "and dirty data in the cache will be lost!\n");
     }
 
-    // Since we don't checkpoint the data in the cache, any dirty data
+    // Unless the data in the cache is checkpointed, any dirty data
     // will be lost when restoring from a checkpoint of a system that
     // wasn't drained properly. Flag the checkpoint as invalid if the
     // cache contains dirty data.
-    bool bad_checkpoint(dirty);
+    bool bad_checkpoint(dirty && !save_data);
     SERIALIZE_SCALAR(bad_checkpoint);
+
+    bool has_contents = checkpointContents;
+    SERIALIZE_SCALAR(has_contents);
+    if (has_contents)
+        serializeContents(cp);
 }
 
 void
@@ -2017,11 +2088,190 @@ BaseCache::unserialize(CheckpointIn &cp)
     UNSERIALIZE_SCALAR(bad_checkpoint);
     if (bad_checkpoint) {
         fatal("Restoring from checkpoints with dirty caches is not "
-              "supported in the classic memory system. Please remove any "
-              "caches or drain them properly before taking checkpoints.\n");
+              "supported in the classic memory system unless their data "
+              "is checkpointed. Please remove any caches, drain them "
+              "properly or set checkpoint_data before taking "
+              "checkpoints.\n");
+    }
+
+    // Older checkpoints do not have any contents. Contents that were
+    // saved are always restored, whether or not this cache saves its own,
+    // as they may hold dirty data that exists nowhere else.
+    bool has_contents = false;
+    UNSERIALIZE_OPT_SCALAR(has_contents);
+    if (has_contents)
+        unserializeContents(cp);
+}
+
+void
+BaseCache::serializeContents(CheckpointOut &cp) const
+{
+    std::vector<CacheBlk *> blks;
+    tags->forEachBlk([&blks](CacheBlk &blk) {
+        if (blk.isValid())
+            blks.push_back(&blk);
+    });
+    std::stable_sort(blks.begin(), blks.end(),
+        [](const CacheBlk *a, const CacheBlk *b) {
+            return a->getAge() > b->getAge();
+        });
+
+    std::vector<Addr> blk_addr;
+    std::vector<unsigned> blk_bits;
+    std::vector<RequestorID> blk_requestor;
+    for (auto blk : blks) {
+        blk_addr.push_back(tags->regenerateBlkAddr(blk));
+        // The coherence bits never use bit 0, which holds the secure bit
+        unsigned bits = (blk->isSecure() ? 1 : 0);
+        for (auto bit : {CacheBlk::WritableBit, CacheBlk::ReadableBit,
+                         CacheBlk::DirtyBit}) {
+            if (blk->isSet(bit))
+                bits |= bit;
+        }
+        blk_bits.push_back(bits);
+        blk_requestor.push_back(blk->getSrcRequestorId());
+    }
+
+    SERIALIZE_CONTAINER(blk_addr);
+    SERIALIZE_CONTAINER(blk_bits);
+    SERIALIZE_CONTAINER(blk_requestor);
+    SERIALIZE_SCALAR(blkSize);
+
+    bool has_data = checkpointData;
+    SERIALIZE_SCALAR(has_data);
+    if (!has_data)
+        return;
+
+    std::string filename = name() + ".blocks";
+    SERIALIZE_SCALAR(filename);
+
+    std::string filepath = CheckpointIn::dir() + "/" + filename;
+    gzFile compressed = gzopen(filepath.c_str(), "wb");
+    fatal_if(compressed == NULL,
+             "Can't open cache checkpoint file '%s'\n", filename);
+
+    for (auto blk : blks) {
+        if (gzwrite(compressed, blk->data, blkSize) != (int)blkSize) {
+            fatal("Write failed on cache checkpoint file '%s'\n",
+                  filename);
+        }
+    }
+
+    fatal_if(gzclose(compressed),
+             "Close failed on cache checkpoint file '%s'\n", filename);
+
+    DPRINTF(Checkpoint, "%s: saved %d blocks\n", name(), blks.size());
+}
+
+void
+BaseCache::unserializeContents(CheckpointIn &cp)
+{
+    std::vector<Addr> blk_addr;
+    std::vector<unsigned> blk_bits;
+    std::vector<RequestorID> blk_requestor;
+    unsigned cpt_blk_size;
+    UNSERIALIZE_CONTAINER(blk_addr);
+    UNSERIALIZE_CONTAINER(blk_bits);
+    UNSERIALIZE_CONTAINER(blk_requestor);
+    paramIn(cp, "blkSize", cpt_blk_size);
+
+    fatal_if(cpt_blk_size != blkSize, "%s: checkpointed block size (%d) "
+             "does not match the block size of the cache (%d)\n", name(),
+             cpt_blk_size, blkSize);
+
+    bool has_data;
+    UNSERIALIZE_SCALAR(has_data);
+
+    gzFile compressed = NULL;
+    std::string filename;
+    if (has_data) {
+        UNSERIALIZE_SCALAR(filename);
+        std::string filepath = cp.getCptDir() + "/" + filename;
+        compressed = gzopen(filepath.c_str(), "rb");
+        fatal_if(compressed == NULL,
+                 "Can't open cache checkpoint file '%s'\n", filename);
+    }
+
+    std::vector<uint8_t> data(blkSize);
+    for (size_t i = 0; i < blk_addr.size(); i++) {
+        if (has_data &&
+            gzread(compressed, data.data(), blkSize) != (int)blkSize) {
+            fatal("Read failed on cache checkpoint file '%s'\n", filename);
+        }
+
+        const unsigned bits = blk_bits[i];
+        CacheBlk *blk = restoreBlock(blk_addr[i], bits & 1,
+                                     bits & CacheBlk::AllBits,
+                                     blk_requestor[i]);
+        if (!blk)
+            continue;
+
+        if (has_data)
+            std::memcpy(blk->data, data.data(), blkSize);
+        else
+            pendingRefills.push_back(blk);
+    }
+
+    if (has_data) {
+        fatal_if(gzclose(compressed),
+                 "Close failed on cache checkpoint file '%s'\n", filename);
     }
+
+    DPRINTF(Checkpoint, "%s: restored %d of %d blocks\n", name(),
+            restoredBlks, blk_addr.size());
 }
 
+CacheBlk *
+BaseCache::restoreBlock(Addr addr, bool is_secure, unsigned bits,
+                        RequestorID requestor)
+{
+    fatal_if((bits & CacheBlk::DirtyBit) && isReadOnly,
+             "%s: cannot restore dirty block %#x in a read-only cache\n",
+             name(), addr);
+
+    // The requestors may be numbered differently if the checkpoint was
+    // taken with another configuration
+    if (requestor >= system->maxRequestors())
+        requestor = Request::wbRequestorId;
+
+    // The packet is only used to carry the attributes of the block to
+    // the tags
+    RequestPtr req = std::make_shared<Request>(addr, blkSize, 0, requestor);
+    if (is_secure)
+        req->setFlags(Request::SECURE);
+    Packet pkt(req, MemCmd::WritebackDirty);
+
+    std::vector<CacheBlk*> evict_blks;
+    CacheBlk *victim = tags->findVictim(addr, is_secure, blkSize * 8,
+                                        evict_blks);
+    if (!victim) {
+        warn_once("%s: could not allocate all checkpointed blocks\n",
+                  name());
+        droppedRestoredBlks++;
+        return nullptr;
+    }
+
+    // With a different geometry the restored blocks may conflict. The
+    // victims were themselves restored, so only the oldest contents get
+    // lost, unless they were dirty.
+    for (auto blk : evict_blks) {
+        if (blk->isValid()) {
+            warn_if_once(blk->isSet(CacheBlk::DirtyBit),
+                         "%s: dirty checkpointed blocks were dropped as "
+                         "they do not fit in the cache\n", name());
+            invalidateBlock(blk);
+            restoredBlks--;
+            droppedRestoredBlks++;
+        }
+    }
+
+    tags->insertBlock(&pkt, victim);
+    victim->setCoherenceBits(bits);
+    victim->whenReady = clockEdge();
+    restoredBlks++;
+
+    return victim;
+}
 
 BaseCache::CacheCmdStats::CacheCmdStats(BaseCache &c,
                                         const std::string &name)
@@ -2273,6 +2523,10 @@ BaseCache::CacheStats::CacheStats(BaseCache &c)
              "number of data expansions"),
     ADD_STAT(dataContractions, statistics::units::Count::get(),
              "number of data contractions"),
+    ADD_STAT(restoredBlocks, statistics::units::Count::get(),
+             "number of blocks restored from the checkpoint"),
+    ADD_STAT(droppedRestoredBlocks, statistics::units::Count::get(),
+             "number of checkpointed blocks that could not be restored"),
     cmd(MemCmd::NUM_MEM_CMDS)
 {
     for (int idx = 0; idx < MemCmd::NUM_MEM_CMDS; ++idx)
@@ -2502,6 +2756,12 @@ BaseCache::CacheStats::regStats()
 
     dataExpansions.flags(nozero | nonan);
     dataContractions.flags(nozero | nonan);
+
+    // set on restore, before the stats are reset
+    restoredBlocks.scalar(cache.restoredBlks);
+    restoredBlocks.flags(nozero);
+    droppedRestoredBlocks.scalar(cache.droppedRestoredBlks);
+    droppedRestoredBlocks.flags(nozero);
 }
 
 void
@@ -954,6 +954,27 @@ class BaseCache : public ClockedObject
      */
     const bool moveContractions;
 
+    /** Save and restore the cache contents in checkpoints. */
+    const bool checkpointContents;
+
+    /**
+     * Include the block data when checkpointing the contents. Without
+     * it, restored blocks are refilled from memory on startup.
+     */
+    const bool checkpointData;
+
+    /** Restored blocks waiting to be refilled from memory on startup. */
+    std::vector<CacheBlk *> pendingRefills;
+
+    /** Number of checkpointed blocks in the cache after the restore. */
+    Counter restoredBlks = 0;
+
+    /**
+     * Number of checkpointed blocks that did not fit in the cache, or
+     * were evicted by later ones.
+     */
+    Counter droppedRestoredBlks = 0;
+
     /**
      * Bit vector of the blocking reasons for the access path.
      * @sa #BlockedCause
@@ -1138,6 +1159,12 @@ class BaseCache : public ClockedObject
          */
         statistics::Scalar dataContractions;
 
+        /** Number of blocks restored from a checkpoint. */
+        statistics::Value restoredBlocks;
+
+        /** Number of checkpointed blocks that could not be restored. */
+        statistics::Value droppedRestoredBlocks;
+
         /** Per-command statistics */
         std::vector<std::unique_ptr<CacheCmdStats>> cmd;
     } stats;
@@ -1150,6 +1177,7 @@ class BaseCache : public ClockedObject
     ~BaseCache();
 
     void init() override;
+    void startup() override;
 
     Port &getPort(const std::string &if_name,
                   PortID idx=InvalidPortID) override;
@@ -1347,10 +1375,38 @@ class BaseCache : public ClockedObject
      */
     bool sendWriteQueuePacket(WriteQueueEntry* wq_entry);
 
+    /**
+     * Write the valid blocks of the cache to a checkpoint: their
+     * address, security and coherence state, and optionally their data,
+     * which is stored in a separate compressed file. Blocks are written
+     * from the oldest to the most recently inserted one.
+     */
+    void serializeContents(CheckpointOut &cp) const;
+
+    /**
+     * Re-insert the blocks of a checkpoint written by
+     * serializeContents(). Inserting them in their original order gives
+     * the replacement policy an approximation of the recency order
+     * they had when the checkpoint was taken.
+     */
+    void unserializeContents(CheckpointIn &cp);
+
+    /**
+     * Allocate a block for a restored line, evicting (without
+     * writeback) whatever the tags choose as victims.
+     *
+     * @return The restored block, or nullptr if it cannot be allocated.
+     */
+    CacheBlk *restoreBlock(Addr addr, bool is_secure, unsigned bits,
+                           RequestorID requestor);
+
     /**
      * Serialize the state of the caches
      *
-     * We currently don't support checkpointing cache state, so this panics.
+     * By default only whether the checkpoint can be restored is saved,
+     * and the cache restarts cold. With checkpoint_contents set, the
+     * blocks are saved as well. Saved blocks are restored regardless of
+     * checkpoint_contents.
      */
     void serialize(CheckpointOut &cp) const override;
     void unserialize(CheckpointIn &cp) override;
@@ -1066,6 +1066,8 @@ Cache::handleSnoop(PacketPtr pkt, CacheBlk *blk, bool is_timing,
             // there is a snoop hit in upper levels
             Packet snoopPkt(pkt, true, true);
             snoopPkt.setExpressSnoop();
+            if (pkt->isBackInvalidation())
+                snoopPkt.setBackInvalidation();
             // the snoop packet does not need to wait any additional
             // time
             snoopPkt.headerDelay = snoopPkt.payloadDelay = 0;
@@ -1320,8 +1322,14 @@ Cache::recvTimingSnoopReq(PacketPtr pkt)
         // the difference being that instead of querying the block
         // state to determine if it is dirty and writable, we use the
         // command and fields of the writeback packet
+        // a snoop filter back-invalidation only needs the dirty data
+        // to make its way below, which the writeback already takes
+        // care of, whereas cache maintenance operations have to wait
+        // for the data to reach their destination
+        const bool keep_writeback = pkt->isBackInvalidation() &&
+            wb_pkt->cmd == MemCmd::WritebackDirty;
         bool respond = wb_pkt->cmd == MemCmd::WritebackDirty &&
-            pkt->needsResponse();
+            pkt->needsResponse() && !keep_writeback;
         bool have_writable = !wb_pkt->hasSharers();
         bool invalidate = pkt->isInvalidate();
 
@@ -1342,7 +1350,8 @@ Cache::recvTimingSnoopReq(PacketPtr pkt)
                                    false, false);
         }
 
-        if (invalidate && wb_pkt->cmd != MemCmd::WriteClean) {
+        if (invalidate && wb_pkt->cmd != MemCmd::WriteClean &&
+            !keep_writeback) {
             // Invalidation trumps our writeback... discard here
             // Note: markInService will remove entry from writeback buffer.
             markInService(wb_entry);
@@ -201,6 +201,19 @@ CoherentXBar::recvTimingReq(PacketPtr pkt, PortID cpu_side_port_id)
     if (snoop_caches) {
         assert(pkt->snoopDelay == 0);
 
+        if (snoopFilter && !is_express_snoop &&
+            !snoopFilter->canAllocate(pkt, *src_port)) {
+            // every line in the snoop filter set has a request in
+            // flight, so wait for one of them to complete
+            DPRINTF(CoherentXBar, "%s: src %s packet %s SF RETRY\n",
+                    __func__, src_port->name(), pkt->print());
+
+            pkt->headerDelay = old_header_delay;
+            reqLayers[mem_side_port_id]->failedTiming(src_port,
+                                                    clockEdge(Cycles(1)));
+            return false;
+        }
+
         if (pkt->isClean() && !is_destination) {
             // before snooping we need to make sure that the memory
             // below is not busy and the cache clean request can be
@@ -305,6 +318,7 @@ CoherentXBar::recvTimingReq(PacketPtr pkt, PortID cpu_side_port_id)
     if (snoopFilter && snoop_caches) {
         // Let the snoop filter know about the success of the send operation
         snoopFilter->finishRequest(!success, addr, pkt->isSecure());
+        backInvalidate(true);
     }
 
     // check if we were successful in sending the packet onwards
@@ -696,6 +710,35 @@ CoherentXBar::recvTimingSnoopResp(PacketPtr pkt, PortID cpu_side_port_id)
 }
 
 
+void
+CoherentXBar::backInvalidate(bool is_timing)
+{
+    SnoopFilter::SnoopList holders;
+    RequestPtr req = snoopFilter->takeEviction(holders);
+    if (!req)
+        return;
+
+    // the caches respond to a clean and invalidate by writing any
+    // dirty data below with a WriteClean, so the snoop never needs a
+    // response and can live on the stack
+    Packet pkt(req, MemCmd::CleanInvalidReq);
+    pkt.setExpressSnoop();
+    pkt.setBackInvalidation();
+
+    for (const auto& p : holders) {
+        DPRINTF(CoherentXBar, "%s: back-invalidating %s via %s\n",
+                __func__, pkt.print(), p->name());
+        if (is_timing) {
+            p->sendTimingSnoopReq(&pkt);
+        } else {
+            p->sendAtomicSnoop(&pkt);
+        }
+        assert(!pkt.cacheResponding());
+    }
+
+    snoops += holders.size();
+}
+
 void
 CoherentXBar::forwardTiming(PacketPtr pkt, PortID exclude_cpu_side_port_id,
                            const std::vector<QueuedResponsePort*>& dests)
@@ -772,6 +815,7 @@ CoherentXBar::recvAtomicBackdoor(PacketPtr pkt, PortID cpu_side_port_id,
             // avoid situations where atomic upward snoops sneak in
             // between and change the filter state
             snoopFilter->finishRequest(false, pkt->getAddr(), pkt->isSecure());
+            backInvalidate(false);
 
             if (pkt->isEviction()) {
                 // for block-evicting packets, i.e. writebacks and
@@ -999,8 +1043,19 @@ CoherentXBar::forwardAtomic(PacketPtr pkt, PortID exclude_cpu_side_port_id,
 
 void
 CoherentXBar::recvMemBackdoorReq(const MemBackdoorReq &req,
-        MemBackdoorPtr &backdoor)
+        MemBackdoorPtr &backdoor, PortID cpu_side_port_id)
 {
+    // any other snooping requestor may have a cache holding newer data
+    // than the memory, or would miss out on the writes
+    for (auto *p : snoopPorts) {
+        if (p != cpuSidePorts[cpu_side_port_id]) {
+            DPRINTF(CoherentXBar, "%s: not passing on back door request "
+                    "for %s due to snooping requestor %s\n", __func__,
+                    req.range().to_string(), p->getPeer());
+            return;
+        }
+    }
+
     PortID dest_id = findPort(req.range());
     memSidePorts[dest_id]->sendMemBackdoorReq(req, backdoor);
 }
@@ -1014,6 +1069,21 @@ CoherentXBar::recvFunctional(PacketPtr pkt, PortID cpu_side_port_id)
                 cpuSidePorts[cpu_side_port_id]->name(), pkt->print());
     }
 
+    if (pkt->isRestoredBlock()) {
+        // a cache above restored the block from a checkpoint, track
+        // it as if it had been filled, and let the levels below know
+        // as they may hold it on behalf of this cache
+        fatal_if(snoopFilter &&
+                 !snoopFilter->addRestoredHolder(
+                     pkt, *cpuSidePorts[cpu_side_port_id]),
+                 "%s: the snoop filter cannot track all the blocks "
+                 "restored from the checkpoint, make it bigger or "
+                 "unbounded\n", name());
+        if (!pointOfCoherency)
+            memSidePorts[findPort(pkt->getAddrRange())]->sendFunctional(pkt);
+        return;
+    }
+
     if (!system->bypassCaches()) {
         // forward to all snoopers but the source
         forwardFunctional(pkt, cpu_side_port_id);
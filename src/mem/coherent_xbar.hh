@@ -140,7 +140,7 @@ class CoherentXBar : public BaseXBar
         recvMemBackdoorReq(const MemBackdoorReq &req,
                 MemBackdoorPtr &backdoor) override
         {
-            xbar.recvMemBackdoorReq(req, backdoor);
+            xbar.recvMemBackdoorReq(req, backdoor, id);
         }
 
         AddrRangeList
@@ -337,6 +337,15 @@ class CoherentXBar : public BaseXBar
     void forwardTiming(PacketPtr pkt, PortID exclude_cpu_side_port_id,
                        const std::vector<QueuedResponsePort*>& dests);
 
+    /**
+     * Back-invalidate the holders of any line the snoop filter evicted
+     * during the last request lookup, cleaning and invalidating their
+     * copies with an express snoop.
+     *
+     * @param is_timing Whether to send timing or atomic snoops
+     */
+    void backInvalidate(bool is_timing);
+
     Tick recvAtomicBackdoor(PacketPtr pkt, PortID cpu_side_port_id,
                             MemBackdoorPtr *backdoor=nullptr);
     Tick recvAtomicSnoop(PacketPtr pkt, PortID mem_side_port_id);
@@ -382,9 +391,10 @@ class CoherentXBar : public BaseXBar
     void recvFunctional(PacketPtr pkt, PortID cpu_side_port_id);
 
     /** Function called by the port when the crossbar receives a request for
-        a memory backdoor.*/
+        a memory backdoor. A backdoor bypasses the snooping requestors, so
+        it is only passed on when the request comes from the only one.*/
     void recvMemBackdoorReq(const MemBackdoorReq &req,
-            MemBackdoorPtr &backdoor);
+            MemBackdoorPtr &backdoor, PortID cpu_side_port_id);
 
     /** Function called by the port when the crossbar is receiving a functional
         snoop transaction.*/
@@ -39,6 +39,8 @@
 
 #include "mem/comm_monitor.hh"
 
+#include <string>
+
 #include "base/trace.hh"
 #include "debug/CommMonitor.hh"
 #include "sim/core.hh"
@@ -60,6 +62,9 @@ CommMonitor::CommMonitor(const Params &params)
     DPRINTF(CommMonitor,
             "Created monitor %s with sample period %d ticks (%f ms)\n",
             name(), samplePeriodTicks, samplePeriod * 1E3);
+
+    fatal_if(params.sample_every == 0,
+             "%s: sample_every must be at least 1.\n", name());
 }
 
 void
@@ -140,6 +145,12 @@ CommMonitor::MonitorStats::MonitorStats(statistics::Group *parent,
                "Read request-response latency"),
       ADD_STAT(writeLatencyHist, statistics::units::Tick::get(),
                "Write request-response latency"),
+      latencyLogHists(params.latency_log_hists),
+      latencyBuckets(params.latency_log_sub_bits),
+      ADD_STAT(readLatencyLogHist, statistics::units::Count::get(),
+               "Read request-response latency, by log bucket lower bound"),
+      ADD_STAT(writeLatencyLogHist, statistics::units::Count::get(),
+               "Write request-response latency, by log bucket lower bound"),
 
       disableITTDists(params.disable_itt_dists),
       ADD_STAT(ittReadRead, statistics::units::Tick::get(),
@@ -172,7 +183,10 @@ CommMonitor::MonitorStats::MonitorStats(statistics::Group *parent,
       ADD_STAT(readAddrDist, statistics::units::Count::get(),
                "Read address distribution"),
       ADD_STAT(writeAddrDist, statistics::units::Count::get(),
-               "Write address distribution")
+               "Write address distribution"),
+      sampler(params.sample_every, params.sample_interval),
+      ADD_STAT(sampledReqs, statistics::units::Count::get(),
+               "Number of requests sampled for the distributions")
 {
     using namespace statistics;
 
@@ -209,11 +223,24 @@ CommMonitor::MonitorStats::MonitorStats(statistics::Group *parent,
 
     readLatencyHist
         .init(params.latency_bins)
-        .flags(disableLatencyHists ? nozero : pdf);
+        .flags(disableLatencyHists || latencyLogHists ? nozero : pdf);
 
     writeLatencyHist
         .init(params.latency_bins)
-        .flags(disableLatencyHists ? nozero : pdf);
+        .flags(disableLatencyHists || latencyLogHists ? nozero : pdf);
+
+    fatal_if(params.latency_log_sub_bits > 8,
+             "Log latency histograms support at most 8 sub-bucket bits.\n");
+    if (latencyLogHists && !disableLatencyHists) {
+        readLatencyLogHist.init(latencyBuckets.size()).flags(nozero);
+        writeLatencyLogHist.init(latencyBuckets.size()).flags(nozero);
+        for (unsigned i = 0; i < latencyBuckets.size(); i++) {
+            const std::string bound =
+                std::to_string(latencyBuckets.lowerBound(i));
+            readLatencyLogHist.subname(i, bound);
+            writeLatencyLogHist.subname(i, bound);
+        }
+    }
 
     ittReadRead
         .init(1, params.itt_max_bin, params.itt_max_bin /
@@ -253,12 +280,38 @@ CommMonitor::MonitorStats::MonitorStats(statistics::Group *parent,
     writeAddrDist
         .init(0)
         .flags(disableAddrDists ? nozero : pdf);
+
+    sampledReqs.flags(nozero);
+}
+
+unsigned
+CommMonitor::MonitorStats::sampleRequest(const probing::PacketInfo& pkt_info)
+{
+    if (!pkt_info.cmd.isRead() && !pkt_info.cmd.isWrite())
+        return 0;
+
+    const unsigned weight =
+        sampler.sample(pkt_info.cmd.isRead(), curTick());
+    if (weight)
+        ++sampledReqs;
+    return weight;
+}
+
+void
+CommMonitor::MonitorStats::sampleLatency(statistics::Histogram &hist,
+                                         statistics::Vector &log_hist,
+                                         Tick latency, unsigned weight)
+{
+    if (latencyLogHists)
+        log_hist[latencyBuckets.index(latency)] += weight;
+    else
+        hist.sample(latency, weight);
 }
 
 void
 CommMonitor::MonitorStats::updateReqStats(
     const probing::PacketInfo& pkt_info, bool is_atomic,
-    bool expects_response)
+    bool expects_response, unsigned weight)
 {
     if (pkt_info.cmd.isRead()) {
         // Increment number of observed read transactions
@@ -266,22 +319,23 @@ CommMonitor::MonitorStats::updateReqStats(
             ++readTrans;
 
         // Get sample of burst length
-        if (!disableBurstLengthHists)
-            readBurstLengthHist.sample(pkt_info.size);
+        if (!disableBurstLengthHists && weight)
+            readBurstLengthHist.sample(pkt_info.size, weight);
 
         // Sample the masked address
-        if (!disableAddrDists)
-            readAddrDist.sample(pkt_info.addr & readAddrMask);
+        if (!disableAddrDists && weight)
+            readAddrDist.sample(pkt_info.addr & readAddrMask, weight);
 
         if (!disableITTDists) {
-            // Sample value of read-read inter transaction time
-            if (timeOfLastRead != 0)
-                ittReadRead.sample(curTick() - timeOfLastRead);
+            // Sample value of read-read inter transaction time, the
+            // time of the last request is tracked even when not sampling
+            if (timeOfLastRead != 0 && weight)
+                ittReadRead.sample(curTick() - timeOfLastRead, weight);
             timeOfLastRead = curTick();
 
             // Sample value of req-req inter transaction time
-            if (timeOfLastReq != 0)
-                ittReqReq.sample(curTick() - timeOfLastReq);
+            if (timeOfLastReq != 0 && weight)
+                ittReqReq.sample(curTick() - timeOfLastReq, weight);
             timeOfLastReq = curTick();
         }
         if (!is_atomic && !disableOutstandingHists && expects_response)
@@ -292,8 +346,8 @@ CommMonitor::MonitorStats::updateReqStats(
         if (!disableTransactionHists)
             ++writeTrans;
 
-        if (!disableBurstLengthHists)
-            writeBurstLengthHist.sample(pkt_info.size);
+        if (!disableBurstLengthHists && weight)
+            writeBurstLengthHist.sample(pkt_info.size, weight);
 
         // Update the bandwidth stats on the request
         if (!disableBandwidthHists) {
@@ -302,18 +356,18 @@ CommMonitor::MonitorStats::updateReqStats(
         }
 
         // Sample the masked write address
-        if (!disableAddrDists)
-            writeAddrDist.sample(pkt_info.addr & writeAddrMask);
+        if (!disableAddrDists && weight)
+            writeAddrDist.sample(pkt_info.addr & writeAddrMask, weight);
 
         if (!disableITTDists) {
             // Sample value of write-to-write inter transaction time
-            if (timeOfLastWrite != 0)
-                ittWriteWrite.sample(curTick() - timeOfLastWrite);
+            if (timeOfLastWrite != 0 && weight)
+                ittWriteWrite.sample(curTick() - timeOfLastWrite, weight);
             timeOfLastWrite = curTick();
 
             // Sample value of req-to-req inter transaction time
-            if (timeOfLastReq != 0)
-                ittReqReq.sample(curTick() - timeOfLastReq);
+            if (timeOfLastReq != 0 && weight)
+                ittReqReq.sample(curTick() - timeOfLastReq, weight);
             timeOfLastReq = curTick();
         }
 
@@ -324,7 +378,8 @@ CommMonitor::MonitorStats::updateReqStats(
 
 void
 CommMonitor::MonitorStats::updateRespStats(
-    const probing::PacketInfo& pkt_info, Tick latency, bool is_atomic)
+    const probing::PacketInfo& pkt_info, Tick latency, bool is_atomic,
+    unsigned weight)
 {
     if (pkt_info.cmd.isRead()) {
         // Decrement number of outstanding read requests
@@ -333,8 +388,9 @@ CommMonitor::MonitorStats::updateRespStats(
             --outstandingReadReqs;
         }
 
-        if (!disableLatencyHists)
-            readLatencyHist.sample(latency);
+        if (!disableLatencyHists && weight)
+            sampleLatency(readLatencyHist, readLatencyLogHist, latency,
+                          weight);
 
         // Update the bandwidth stats based on responses for reads
         if (!disableBandwidthHists) {
@@ -349,8 +405,9 @@ CommMonitor::MonitorStats::updateRespStats(
             --outstandingWriteReqs;
         }
 
-        if (!disableLatencyHists)
-            writeLatencyHist.sample(latency);
+        if (!disableLatencyHists && weight)
+            sampleLatency(writeLatencyHist, writeLatencyLogHist, latency,
+                          weight);
     }
 }
 
@@ -364,9 +421,10 @@ CommMonitor::recvAtomic(PacketPtr pkt)
 
     const Tick delay(memSidePort.sendAtomic(pkt));
 
-    stats.updateReqStats(req_pkt_info, true, expects_response);
+    const unsigned weight = stats.sampleRequest(req_pkt_info);
+    stats.updateReqStats(req_pkt_info, true, expects_response, weight);
     if (expects_response)
-        stats.updateRespStats(req_pkt_info, delay, true);
+        stats.updateRespStats(req_pkt_info, delay, true, weight);
 
     // Some packets, such as WritebackDirty, don't need response.
     assert(pkt->isResponse() || !expects_response);
@@ -397,16 +455,20 @@ CommMonitor::recvTimingReq(PacketPtr pkt)
     // If a cache miss is served by a cache, a monitor near the memory
     // would see a request which needs a response, but this response
     // would not come back from the memory. Therefore we additionally
-    // have to check the cacheResponding flag
-    if (expects_response && !stats.disableLatencyHists) {
-        pkt->pushSenderState(new CommMonitorSenderState(curTick()));
+    // have to check the cacheResponding flag. When sampling, only
+    // the sampled requests carry a sender state.
+    CommMonitorSenderState *state = nullptr;
+    if (expects_response && !stats.disableLatencyHists &&
+        (stats.sampleAll() || stats.sampleNext(pkt_info))) {
+        state = new CommMonitorSenderState(curTick(), this);
+        pkt->pushSenderState(state);
     }
 
     // Attempt to send the packet
     bool successful = memSidePort.sendTimingReq(pkt);
 
     // If not successful, restore the sender state
-    if (!successful && expects_response && !stats.disableLatencyHists) {
+    if (!successful && state) {
         delete pkt->popSenderState();
     }
 
@@ -417,7 +479,10 @@ CommMonitor::recvTimingReq(PacketPtr pkt)
     if (successful) {
         DPRINTF(CommMonitor, "Forwarded %s request\n", pkt->isRead() ? "read" :
                 pkt->isWrite() ? "write" : "non read/write");
-        stats.updateReqStats(pkt_info, false, expects_response);
+        const unsigned weight = stats.sampleRequest(pkt_info);
+        if (state)
+            state->weight = weight;
+        stats.updateReqStats(pkt_info, false, expects_response, weight);
     }
     return successful;
 }
@@ -433,26 +498,33 @@ CommMonitor::recvTimingResp(PacketPtr pkt)
     const probing::PacketInfo pkt_info(pkt);
 
     Tick latency = 0;
+    unsigned weight = 0;
     CommMonitorSenderState* received_state =
         dynamic_cast<CommMonitorSenderState*>(pkt->senderState);
 
+    // With sampling only the sampled requests carry our sender state
+    if (received_state && received_state->monitor != this)
+        received_state = nullptr;
+
     if (!stats.disableLatencyHists) {
         // Restore initial sender state
-        if (received_state == NULL)
+        if (received_state == NULL && stats.sampleAll())
             panic("Monitor got a response without monitor sender state\n");
 
         // Restore the sate
-        pkt->senderState = received_state->predecessor;
+        if (received_state)
+            pkt->senderState = received_state->predecessor;
     }
 
     // Attempt to send the packet
     bool successful = cpuSidePort.sendTimingResp(pkt);
 
-    if (!stats.disableLatencyHists) {
+    if (!stats.disableLatencyHists && received_state) {
         // If packet successfully send, sample value of latency,
         // afterwards delete sender state, otherwise restore state
         if (successful) {
             latency = curTick() - received_state->transmitTime;
+            weight = received_state->weight;
             DPRINTF(CommMonitor, "Latency: %d\n", latency);
             delete received_state;
         } else {
@@ -466,7 +538,7 @@ CommMonitor::recvTimingResp(PacketPtr pkt)
         ppPktResp->notify(pkt_info);
         DPRINTF(CommMonitor, "Received %s response\n", pkt->isRead() ? "read" :
                 pkt->isWrite() ?  "write" : "non read/write");
-        stats.updateRespStats(pkt_info, latency, false);
+        stats.updateRespStats(pkt_info, latency, false, weight);
     }
     return successful;
 }
@@ -40,9 +40,12 @@
 #ifndef __MEM_COMM_MONITOR_HH__
 #define __MEM_COMM_MONITOR_HH__
 
+#include "base/log_buckets.hh"
 #include "base/statistics.hh"
 #include "mem/port.hh"
+#include "mem/request_sampler.hh"
 #include "params/CommMonitor.hh"
+#include "sim/cur_tick.hh"
 #include "sim/probe/mem.hh"
 #include "sim/sim_object.hh"
 
@@ -99,9 +102,11 @@ class CommMonitor : public SimObject
          * calculate round-trip latency.
          *
          * @param _transmitTime Time of packet transmission
+         * @param _monitor Monitor that pushed the state
          */
-        CommMonitorSenderState(Tick _transmitTime)
-            : transmitTime(_transmitTime)
+        CommMonitorSenderState(Tick _transmitTime,
+                               const CommMonitor *_monitor)
+            : transmitTime(_transmitTime), monitor(_monitor), weight(1)
         { }
 
         /** Destructor */
@@ -110,6 +115,15 @@ class CommMonitor : public SimObject
         /** Tick when request is transmitted */
         Tick transmitTime;
 
+        /**
+         * Monitor that pushed the state, as with sampling a response
+         * may carry the state of another monitor further up instead
+         */
+        const CommMonitor *monitor;
+
+        /** Number of requests the sampled request stands for */
+        unsigned weight;
+
     };
 
     /**
@@ -311,6 +325,16 @@ class CommMonitor : public SimObject
         /** Histogram of write request-to-response latencies */
         statistics::Histogram writeLatencyHist;
 
+        /** Use log-bucketed rather than uniform latency histograms */
+        const bool latencyLogHists;
+
+        /** Bucketing of the log latency histograms */
+        const LogBuckets latencyBuckets;
+
+        /** Log-bucketed read and write latencies, one entry per bucket */
+        statistics::Vector readLatencyLogHist;
+        statistics::Vector writeLatencyLogHist;
+
         /** Disable flag for ITT distributions. */
         bool disableITTDists;
 
@@ -378,6 +402,12 @@ class CommMonitor : public SimObject
          */
         statistics::SparseHistogram writeAddrDist;
 
+        /** Selects the reads and writes sampled for the distributions */
+        RequestSampler sampler;
+
+        /** Number of requests sampled for the distributions */
+        statistics::Scalar sampledReqs;
+
         /**
          * Create the monitor stats and initialise all the members
          * that are not statistics themselves, but used to control the
@@ -386,10 +416,43 @@ class CommMonitor : public SimObject
         MonitorStats(statistics::Group *parent,
             const CommMonitorParams &params);
 
+        /** Are all requests sampled */
+        bool
+        sampleAll() const
+        {
+            return sampler.all();
+        }
+
+        /** Will the given request be sampled if it is forwarded */
+        bool
+        sampleNext(const probing::PacketInfo& pkt) const
+        {
+            return (pkt.cmd.isRead() || pkt.cmd.isWrite()) &&
+                sampler.next(pkt.cmd.isRead(), curTick());
+        }
+
+        /**
+         * Account for a forwarded request and decide if it is sampled.
+         *
+         * @return Number of requests the sample stands for, or 0 if the
+         *         request is not sampled
+         */
+        unsigned sampleRequest(const probing::PacketInfo& pkt);
+
+        /**
+         * @param weight Number of requests the packet stands for in the
+         *               sampled distributions, 0 to only update the
+         *               exact counters
+         */
         void updateReqStats(const probing::PacketInfo& pkt, bool is_atomic,
-                            bool expects_response);
+                            bool expects_response, unsigned weight);
         void updateRespStats(const probing::PacketInfo& pkt, Tick latency,
-                             bool is_atomic);
+                             bool is_atomic, unsigned weight);
+
+        /** Sample a latency into the configured histogram */
+        void sampleLatency(statistics::Histogram &hist,
+                           statistics::Vector &log_hist, Tick latency,
+                           unsigned weight);
     };
 
     /** This function is called periodically at the end of each time bin */
@@ -204,8 +204,7 @@ DRAMInterface::activateBank(Rank& rank_ref, Bank& bank_ref,
             "%d active\n", bank_ref.bank, rank_ref.rank, act_at,
             ranks[rank_ref.rank]->numBanksActive);
 
-    rank_ref.cmdList.push_back(Command(MemCommand::ACT, bank_ref.bank,
-                               act_at));
+    rank_ref.recordCommand(Command(MemCommand::ACT, bank_ref.bank, act_at));
 
     DPRINTF(DRAMPower, "%llu,ACT,%d,%d\n", divCeil(act_at, tCK) -
             timeStampOffset, bank_ref.bank, rank_ref.rank);
@@ -322,8 +321,7 @@ DRAMInterface::prechargeBank(Rank& rank_ref, Bank& bank, Tick pre_tick,
 
     if (trace) {
 
-        rank_ref.cmdList.push_back(Command(MemCommand::PRE, bank.bank,
-                                   pre_at));
+        rank_ref.recordCommand(Command(MemCommand::PRE, bank.bank, pre_at));
         DPRINTF(DRAMPower, "%llu,PRE,%d,%d\n", divCeil(pre_at, tCK) -
                 timeStampOffset, bank.bank, rank_ref.rank);
     }
@@ -555,7 +553,7 @@ DRAMInterface::doBurstAccess(MemPacket* mem_pkt, Tick next_burst_at,
     MemCommand::cmds command = (mem_cmd == "RD") ? MemCommand::RD :
                                                    MemCommand::WR;
 
-    rank_ref.cmdList.push_back(Command(command, mem_pkt->bank, cmd_at));
+    rank_ref.recordCommand(Command(command, mem_pkt->bank, cmd_at));
 
     DPRINTF(DRAMPower, "%llu,%s,%d,%d\n", divCeil(cmd_at, tCK) -
             timeStampOffset, mem_cmd, mem_pkt->bank, mem_pkt->rank);
@@ -657,6 +655,7 @@ DRAMInterface::DRAMInterface(const DRAMInterfaceParams &_p)
       maxAccessesPerRow(_p.max_accesses_per_row),
       timeStampOffset(0), activeRank(0),
       enableDRAMPowerdown(_p.enable_dram_powerdown),
+      incrementalPower(_p.incremental_power), incrementalEnergy(_p),
       lastStatsResetTick(0),
       stats(*this)
 {
@@ -1122,7 +1121,8 @@ DRAMInterface::Rank::Rank(const DRAMInterfaceParams &_p,
       pwrStateTick(0), refreshDueAt(0), pwrState(PWR_IDLE),
       refreshState(REF_IDLE), inLowPowerState(false), rank(_rank),
       readEntries(0), writeEntries(0), outstandingEvents(0),
-      wakeUpAllowedAt(0), power(_p, false), banks(_p.banks_per_rank),
+      wakeUpAllowedAt(0), power(_p, false), powerCounter(_p.tRP),
+      banks(_p.banks_per_rank),
       numBanksActive(0), actTicks(_p.activation_limit, 0), lastBurstTick(0),
       writeDoneEvent([this]{ processWriteDoneEvent(); }, name()),
       activateEvent([this]{ processActivateEvent(); }, name()),
@@ -1159,6 +1159,7 @@ DRAMInterface::Rank::startup(Tick ref_tick)
     assert(ref_tick > curTick());
 
     pwrStateTick = curTick();
+    powerCounter.start(curTick());
 
     // kick off the refresh, and give ourselves enough time to
     // precharge
@@ -1231,6 +1232,37 @@ DRAMInterface::Rank::flushCmdList()
     cmdList.assign(next_iter, cmdList.end());
 }
 
+void
+DRAMInterface::Rank::recordCommand(const Command &cmd, unsigned count)
+{
+    if (!dram.incrementalPower) {
+        cmdList.push_back(cmd);
+        return;
+    }
+
+    powerCounter.command(cmd.type, count);
+}
+
+DRAMPowerCounter::State
+DRAMInterface::Rank::counterState(PowerState pwr_state)
+{
+    switch (pwr_state) {
+      case PWR_IDLE:
+        return DRAMPowerCounter::Idle;
+      case PWR_REF:
+        return DRAMPowerCounter::Refresh;
+      case PWR_SREF:
+        return DRAMPowerCounter::SelfRefresh;
+      case PWR_PRE_PDN:
+        return DRAMPowerCounter::PrePowerDown;
+      case PWR_ACT:
+        return DRAMPowerCounter::Active;
+      case PWR_ACT_PDN:
+        return DRAMPowerCounter::ActPowerDown;
+    }
+    panic("Unknown power state %d\n", pwr_state);
+}
+
 void
 DRAMInterface::Rank::processActivateEvent()
 {
@@ -1354,9 +1386,11 @@ DRAMInterface::Rank::processRefreshEvent()
             // already are, update their availability
             Tick act_allowed_at = pre_at + dram.tRP;
 
+            unsigned open_banks = 0;
             for (auto &b : banks) {
                 if (b.openRow != Bank::NO_ROW) {
                     dram.prechargeBank(*this, b, pre_at, true, false);
+                    ++open_banks;
                 } else {
                     b.actAllowedAt = std::max(b.actAllowedAt, act_allowed_at);
                     b.preAllowedAt = std::max(b.preAllowedAt, pre_at);
@@ -1364,7 +1398,7 @@ DRAMInterface::Rank::processRefreshEvent()
             }
 
             // precharge all banks in rank
-            cmdList.push_back(Command(MemCommand::PREA, 0, pre_at));
+            recordCommand(Command(MemCommand::PREA, 0, pre_at), open_banks);
 
             DPRINTF(DRAMPower, "%llu,PREA,0,%d\n",
                     divCeil(pre_at, dram.tCK) -
@@ -1411,7 +1445,7 @@ DRAMInterface::Rank::processRefreshEvent()
         }
 
         // at the moment this affects all ranks
-        cmdList.push_back(Command(MemCommand::REF, 0, curTick()));
+        recordCommand(Command(MemCommand::REF, 0, curTick()));
 
         // Update the stats
         updatePowerStats();
@@ -1518,7 +1552,7 @@ DRAMInterface::Rank::powerDownSleep(PowerState pwr_state, Tick tick)
     if (pwr_state == PWR_ACT_PDN) {
         schedulePowerEvent(pwr_state, tick);
         // push command to DRAMPower
-        cmdList.push_back(Command(MemCommand::PDN_F_ACT, 0, tick));
+        recordCommand(Command(MemCommand::PDN_F_ACT, 0, tick));
         DPRINTF(DRAMPower, "%llu,PDN_F_ACT,0,%d\n", divCeil(tick,
                 dram.tCK) - dram.timeStampOffset, rank);
     } else if (pwr_state == PWR_PRE_PDN) {
@@ -1527,7 +1561,7 @@ DRAMInterface::Rank::powerDownSleep(PowerState pwr_state, Tick tick)
         // This is neglected here.
         schedulePowerEvent(pwr_state, tick);
         //push Command to DRAMPower
-        cmdList.push_back(Command(MemCommand::PDN_F_PRE, 0, tick));
+        recordCommand(Command(MemCommand::PDN_F_PRE, 0, tick));
         DPRINTF(DRAMPower, "%llu,PDN_F_PRE,0,%d\n", divCeil(tick,
                 dram.tCK) - dram.timeStampOffset, rank);
     } else if (pwr_state == PWR_REF) {
@@ -1537,7 +1571,7 @@ DRAMInterface::Rank::powerDownSleep(PowerState pwr_state, Tick tick)
         // this is not considered.
         schedulePowerEvent(PWR_PRE_PDN, tick);
         //push Command to DRAMPower
-        cmdList.push_back(Command(MemCommand::PDN_F_PRE, 0, tick));
+        recordCommand(Command(MemCommand::PDN_F_PRE, 0, tick));
         DPRINTF(DRAMPower, "%llu,PDN_F_PRE,0,%d\n", divCeil(tick,
                 dram.tCK) - dram.timeStampOffset, rank);
     } else if (pwr_state == PWR_SREF) {
@@ -1547,7 +1581,7 @@ DRAMInterface::Rank::powerDownSleep(PowerState pwr_state, Tick tick)
         // this is not considered.
         schedulePowerEvent(PWR_SREF, tick);
         // push Command to DRAMPower
-        cmdList.push_back(Command(MemCommand::SREN, 0, tick));
+        recordCommand(Command(MemCommand::SREN, 0, tick));
         DPRINTF(DRAMPower, "%llu,SREN,0,%d\n", divCeil(tick,
                 dram.tCK) - dram.timeStampOffset, rank);
     }
@@ -1597,16 +1631,16 @@ DRAMInterface::Rank::scheduleWakeUpEvent(Tick exit_delay)
     // use pwrStateTrans for cases where we have a power event scheduled
     // to enter low power that has not yet been processed
     if (pwrStateTrans == PWR_ACT_PDN) {
-        cmdList.push_back(Command(MemCommand::PUP_ACT, 0, wake_up_tick));
+        recordCommand(Command(MemCommand::PUP_ACT, 0, wake_up_tick));
         DPRINTF(DRAMPower, "%llu,PUP_ACT,0,%d\n", divCeil(wake_up_tick,
                 dram.tCK) - dram.timeStampOffset, rank);
 
     } else if (pwrStateTrans == PWR_PRE_PDN) {
-        cmdList.push_back(Command(MemCommand::PUP_PRE, 0, wake_up_tick));
+        recordCommand(Command(MemCommand::PUP_PRE, 0, wake_up_tick));
         DPRINTF(DRAMPower, "%llu,PUP_PRE,0,%d\n", divCeil(wake_up_tick,
                 dram.tCK) - dram.timeStampOffset, rank);
     } else if (pwrStateTrans == PWR_SREF) {
-        cmdList.push_back(Command(MemCommand::SREX, 0, wake_up_tick));
+        recordCommand(Command(MemCommand::SREX, 0, wake_up_tick));
         DPRINTF(DRAMPower, "%llu,SREX,0,%d\n", divCeil(wake_up_tick,
                 dram.tCK) - dram.timeStampOffset, rank);
     }
@@ -1640,6 +1674,8 @@ DRAMInterface::Rank::processPowerEvent()
 
     // update the accounting
     stats.pwrStateTime[prev_state] += duration;
+    if (dram.incrementalPower)
+        powerCounter.transition(counterState(pwrStateTrans), curTick());
 
     // track to total idle time
     if ((prev_state == PWR_PRE_PDN) || (prev_state == PWR_ACT_PDN) ||
@@ -1765,6 +1801,46 @@ DRAMInterface::Rank::processPowerEvent()
 
 void
 DRAMInterface::Rank::updatePowerStats()
+{
+    if (dram.incrementalPower) {
+        updateIncrementalPowerStats();
+    } else {
+        updateLibPowerStats();
+    }
+
+    // Average power must not be accumulated but calculated over the time
+    // since last stats reset. sim_clock::Frequency is tick period not tick
+    // frequency.
+    //              energy (pJ)     1e-9
+    // power (mW) = ----------- * ----------
+    //              time (tick)   tick_frequency
+    stats.averagePower = (stats.totalEnergy.value() /
+                    (curTick() - dram.lastStatsResetTick)) *
+                    (sim_clock::Frequency / 1000000000.0);
+}
+
+void
+DRAMInterface::Rank::updateIncrementalPowerStats()
+{
+    const auto energy =
+        dram.incrementalEnergy.energy(powerCounter.take(curTick()));
+    const unsigned devices = dram.devicesPerRank;
+
+    stats.actEnergy += energy.act * devices;
+    stats.preEnergy += energy.pre * devices;
+    stats.readEnergy += energy.read * devices;
+    stats.writeEnergy += energy.write * devices;
+    stats.refreshEnergy += energy.ref * devices;
+    stats.actBackEnergy += energy.actBack * devices;
+    stats.preBackEnergy += energy.preBack * devices;
+    stats.actPowerDownEnergy += energy.actPowerDown * devices;
+    stats.prePowerDownEnergy += energy.prePowerDown * devices;
+    stats.selfRefreshEnergy += energy.selfRefresh * devices;
+    stats.totalEnergy += energy.total() * devices;
+}
+
+void
+DRAMInterface::Rank::updateLibPowerStats()
 {
     // All commands up to refresh have completed
     // flush cmdList to DRAMPower
@@ -1795,15 +1871,6 @@ DRAMInterface::Rank::updatePowerStats()
 
     // Accumulate window energy into the total energy.
     stats.totalEnergy += energy.window_energy * dram.devicesPerRank;
-    // Average power must not be accumulated but calculated over the time
-    // since last stats reset. sim_clock::Frequency is tick period not tick
-    // frequency.
-    //              energy (pJ)     1e-9
-    // power (mW) = ----------- * ----------
-    //              time (tick)   tick_frequency
-    stats.averagePower = (stats.totalEnergy.value() /
-                    (curTick() - dram.lastStatsResetTick)) *
-                    (sim_clock::Frequency / 1000000000.0);
 }
 
 void
@@ -1821,6 +1888,14 @@ DRAMInterface::Rank::computeStats()
 
 void
 DRAMInterface::Rank::resetStats() {
+    if (dram.incrementalPower) {
+        // Drop the background time accumulated so far. Like the commands
+        // DRAMPower keeps pending in cmdList, the command counts are
+        // retained and accounted at the next update
+        powerCounter.resetTime(curTick());
+        return;
+    }
+
     // The only way to clear the counters in DRAMPower is to call
     // calcWindowEnergy function as that then calls clearCounters. The
     // clearCounters method itself is private.
@@ -261,6 +261,12 @@ class DRAMInterface : public MemInterface
          */
         void updatePowerStats();
 
+        /** Update the energy stats from the DRAMPower library */
+        void updateLibPowerStats();
+
+        /** Update the energy stats from the incremental counters */
+        void updateIncrementalPowerStats();
+
         /**
          * Schedule a power state transition in the future, and
          * potentially override an already scheduled transition.
@@ -327,6 +333,28 @@ class DRAMInterface : public MemInterface
          */
         std::vector<Command> cmdList;
 
+        /**
+         * Commands issued and time spent in each power state since the
+         * last power stats update. Used in place of cmdList and
+         * DRAMPower when incremental power accounting is enabled.
+         */
+        DRAMPowerCounter powerCounter;
+
+        /**
+         * Record a command for power accounting, either by queueing it
+         * for DRAMPower or by bumping the matching counter.
+         *
+         * @param cmd Command to record
+         * @param count Number of banks affected, used for PREA
+         */
+        void recordCommand(const Command &cmd, unsigned count = 1);
+
+        /**
+         * Power state of the incremental power accounting matching a
+         * rank power state.
+         */
+        static DRAMPowerCounter::State counterState(PowerState pwr_state);
+
         /**
          * Vector of Banks. Each rank is made of several devices which in
          * term are made from several banks.
@@ -544,6 +572,12 @@ class DRAMInterface : public MemInterface
     /** Enable or disable DRAM powerdown states. */
     bool enableDRAMPowerdown;
 
+    /** Account for energy with counters rather than with DRAMPower. */
+    const bool incrementalPower;
+
+    /** Command energies and state powers used for incremental accounting */
+    const IncrementalDRAMPower incrementalEnergy;
+
     /** The time when stats were last reset used to calculate average power */
     Tick lastStatsResetTick;
 
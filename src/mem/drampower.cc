@@ -37,6 +37,9 @@
 
 #include "mem/drampower.hh"
 
+#include <algorithm>
+#include <cassert>
+
 #include "base/intmath.hh"
 #include "sim/core.hh"
 
@@ -161,4 +164,164 @@ DRAMPower::getDataRate(const DRAMInterfaceParams &p)
     return data_rate;
 }
 
+IncrementalDRAMPower::IncrementalDRAMPower(const DRAMInterfaceParams &p)
+{
+    // Mirror the memSpec handed to DRAMPower, with timings in clock
+    // cycles, the clock in ns and currents in mA, so that the products
+    // below are in pJ
+    const double clk = p.tCK / (double)(sim_clock::as_int::ns);
+    assert(clk != 0);
+    const double ras = divCeil(p.tRAS, p.tCK);
+    const double rc = divCeil((p.tRAS + p.tRP), p.tCK);
+    const double rfc = divCeil(p.tRFC, p.tCK);
+    const double burst_cycles = p.burst_length / (double)p.beats_per_clock;
+    const bool two_vdd = p.VDD2 != 0;
+
+    auto energy = [&](double cycles, double idd, double idd_base,
+                      double idd2, double idd2_base) {
+        double e = cycles * clk * (idd - idd_base) * 1000 * p.VDD;
+        if (two_vdd)
+            e += cycles * clk * (idd2 - idd2_base) * 1000 * p.VDD2;
+        return e;
+    };
+
+    actEnergy = energy(ras, p.IDD0, p.IDD3N, p.IDD02, p.IDD3N2);
+    preEnergy = energy(rc - ras, p.IDD0, p.IDD2N, p.IDD02, p.IDD2N2);
+    readEnergy = energy(burst_cycles, p.IDD4R, p.IDD3N,
+                        p.IDD4R2, p.IDD3N2);
+    writeEnergy = energy(burst_cycles, p.IDD4W, p.IDD3N,
+                         p.IDD4W2, p.IDD3N2);
+    refEnergy = energy(rfc, p.IDD5, p.IDD3N, p.IDD52, p.IDD3N2);
+
+    // Background currents scaled to one tick
+    const double tick = 1.0 / sim_clock::as_int::ns;
+    auto power = [&](double idd, double idd2) {
+        double pw = tick * idd * 1000 * p.VDD;
+        if (two_vdd)
+            pw += tick * idd2 * 1000 * p.VDD2;
+        return pw;
+    };
+
+    preStandbyPower = power(p.IDD2N, p.IDD2N2);
+    actStandbyPower = power(p.IDD3N, p.IDD3N2);
+    prePowerDownPower = power(p.IDD2P1, p.IDD2P12);
+    actPowerDownPower = power(p.IDD3P1, p.IDD3P12);
+    selfRefreshPower = power(p.IDD6, p.IDD62);
+}
+
+IncrementalDRAMPower::Energy
+IncrementalDRAMPower::energy(const Counts &c) const
+{
+    Energy e;
+    e.act = c.acts * actEnergy;
+    e.pre = c.pres * preEnergy;
+    e.read = c.reads * readEnergy;
+    e.write = c.writes * writeEnergy;
+    e.ref = c.refs * refEnergy;
+    e.actBack = c.actTicks * actStandbyPower;
+    e.preBack = c.preTicks * preStandbyPower;
+    e.actPowerDown = c.actPowerDownTicks * actPowerDownPower;
+    e.prePowerDown = c.prePowerDownTicks * prePowerDownPower;
+    e.selfRefresh = c.selfRefreshTicks * selfRefreshPower;
+    return e;
+}
+
+void
+DRAMPowerCounter::command(Data::MemCommand::cmds type, unsigned count)
+{
+    switch (type) {
+      case Data::MemCommand::ACT:
+        counts.acts += count;
+        break;
+      case Data::MemCommand::PRE:
+      case Data::MemCommand::PREA:
+        counts.pres += count;
+        break;
+      case Data::MemCommand::RD:
+        counts.reads += count;
+        break;
+      case Data::MemCommand::WR:
+        counts.writes += count;
+        break;
+      case Data::MemCommand::REF:
+        counts.refs += count;
+        break;
+      default:
+        break;
+    }
+}
+
+void
+DRAMPowerCounter::start(Tick now)
+{
+    current = Idle;
+    stateTick = energyTick = now;
+}
+
+void
+DRAMPowerCounter::transition(State next, Tick now)
+{
+    account(now);
+
+    // DRAMPower considers the banks precharged from the PRE command
+    // onwards, and the last tRP of a refresh as precharged, while a
+    // rank only leaves the active or refresh state once they have
+    // completed. Move that time over.
+    if ((current == Active && next == Idle) || current == Refresh) {
+        Tick ticks = std::min({tRP, now - stateTick, counts.actTicks});
+        counts.actTicks -= ticks;
+        counts.preTicks += ticks;
+    }
+
+    current = next;
+    stateTick = now;
+}
+
+IncrementalDRAMPower::Counts
+DRAMPowerCounter::take(Tick now)
+{
+    account(now);
+    IncrementalDRAMPower::Counts c = counts;
+    counts = {};
+    return c;
+}
+
+void
+DRAMPowerCounter::resetTime(Tick now)
+{
+    energyTick = now;
+    counts.actTicks = counts.preTicks = 0;
+    counts.actPowerDownTicks = counts.prePowerDownTicks = 0;
+    counts.selfRefreshTicks = 0;
+}
+
+void
+DRAMPowerCounter::account(Tick now)
+{
+    const Tick since = std::max(stateTick, energyTick);
+    assert(now >= since);
+    const Tick duration = now - since;
+    energyTick = now;
+
+    switch (current) {
+      case Active:
+      case Refresh:
+        // As in DRAMPower, refresh cycles count as active standby
+        counts.actTicks += duration;
+        break;
+      case Idle:
+        counts.preTicks += duration;
+        break;
+      case ActPowerDown:
+        counts.actPowerDownTicks += duration;
+        break;
+      case PrePowerDown:
+        counts.prePowerDownTicks += duration;
+        break;
+      case SelfRefresh:
+        counts.selfRefreshTicks += duration;
+        break;
+    }
+}
+
 } // namespace gem5
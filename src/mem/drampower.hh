@@ -43,6 +43,9 @@
 #ifndef __MEM_DRAM_POWER_HH__
 #define __MEM_DRAM_POWER_HH__
 
+#include <algorithm>
+
+#include "base/types.hh"
 #include "libdrampower/LibDRAMPower.h"
 #include "params/DRAMInterface.hh"
 
@@ -101,6 +104,138 @@ class DRAMPower
 
 };
 
+/**
+ * Per-device command energies and state background powers derived
+ * from DRAMInterfaceParams with the same equations DRAMPower uses.
+ * This allows a rank to account for energy by counting commands and
+ * the time spent in each power state, rather than replaying every
+ * command through the DRAMPower library.
+ */
+class IncrementalDRAMPower
+{
+  public:
+
+    /** Commands issued and time spent in each power state */
+    struct Counts
+    {
+        uint64_t acts = 0;
+        uint64_t pres = 0;
+        uint64_t reads = 0;
+        uint64_t writes = 0;
+        uint64_t refs = 0;
+
+        /** Ticks with open banks, or refreshing as in DRAMPower */
+        Tick actTicks = 0;
+        /** Ticks with all banks precharged */
+        Tick preTicks = 0;
+        Tick actPowerDownTicks = 0;
+        Tick prePowerDownTicks = 0;
+        Tick selfRefreshTicks = 0;
+    };
+
+    /** Energy of one device in pJ, broken down like in DRAMPower */
+    struct Energy
+    {
+        double act = 0;
+        double pre = 0;
+        double read = 0;
+        double write = 0;
+        double ref = 0;
+        double actBack = 0;
+        double preBack = 0;
+        double actPowerDown = 0;
+        double prePowerDown = 0;
+        double selfRefresh = 0;
+
+        double
+        total() const
+        {
+            return act + pre + read + write + ref + actBack + preBack +
+                actPowerDown + prePowerDown + selfRefresh;
+        }
+    };
+
+    /** Energy per command in pJ */
+    double actEnergy;
+    double preEnergy;
+    double readEnergy;
+    double writeEnergy;
+    double refEnergy;
+
+    /** Background power per state in pJ per tick */
+    double preStandbyPower;
+    double actStandbyPower;
+    double prePowerDownPower;
+    double actPowerDownPower;
+    double selfRefreshPower;
+
+    IncrementalDRAMPower(const DRAMInterfaceParams &p);
+
+    /** Energy of one device for the given commands and state times */
+    Energy energy(const Counts &counts) const;
+};
+
+/**
+ * Counts the commands a rank issues and the time it spends in each
+ * power state, the way DRAMPower would account them, for
+ * IncrementalDRAMPower to turn into energy.
+ */
+class DRAMPowerCounter
+{
+  public:
+
+    /** Power states of a rank as far as the background power goes */
+    enum State
+    {
+        Idle,
+        Active,
+        Refresh,
+        ActPowerDown,
+        PrePowerDown,
+        SelfRefresh
+    };
+
+    DRAMPowerCounter(Tick t_rp) : tRP(t_rp) {}
+
+    /**
+     * Count a command. Power-down and self-refresh entry and exit are
+     * captured by the time spent in each power state instead.
+     *
+     * @param type Command issued
+     * @param count Number of banks affected, used for PREA
+     */
+    void command(Data::MemCommand::cmds type, unsigned count = 1);
+
+    /** Start accounting time, in the idle state */
+    void start(Tick now);
+
+    /** Account the time in the current state and move to another one */
+    void transition(State next, Tick now);
+
+    /** Hand out the counts up to a tick and start over */
+    IncrementalDRAMPower::Counts take(Tick now);
+
+    /** Drop the time accounted so far, keeping the command counts */
+    void resetTime(Tick now);
+
+  private:
+
+    /** Account the time in the current state up to a tick */
+    void account(Tick now);
+
+    const Tick tRP;
+
+    State current = Idle;
+
+    /** Tick the current state was entered */
+    Tick stateTick = 0;
+
+    /** Tick up to which the state time has been accounted */
+    Tick energyTick = 0;
+
+    IncrementalDRAMPower::Counts counts;
+};
+
 } // namespace gem5
 
 #endif //__MEM_DRAM_POWER_HH__
@@ -0,0 +1,369 @@
+/*
+ * Copyright (c) 2024 The University of Edinburgh
+ * All rights reserved
+ *
+ * The license below extends only to copyright in the software and shall
+ * not be construed as granting a license to any other intellectual
+ * property including but not limited to intellectual property relating
+ * to a hardware implementation of the functionality of the software
+ * licensed hereunder.  You may use the software subject to the license
+ * terms below provided that you ensure that this notice is replicated
+ * unmodified and in its entirety in all distributions of the software,
+ * modified or unmodified, in source code or in binary form.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "base/intmath.hh"
+#include "mem/drampower.hh"
+#include "sim/core.hh"
+
+using namespace gem5;
+
+// sim/core.cc is not linked in, so provide the tick resolution used to
+// convert the timing parameters, as set by the default 1 THz clock
+namespace gem5::sim_clock::as_int
+{
+Tick ns = 1000;
+} // namespace gem5::sim_clock::as_int
+
+namespace
+{
+
+using Data::MemCommand;
+
+/** DDR3_1600_8x8 as in DRAMInterface.py */
+DRAMInterfaceParams
+ddr3Params()
+{
+    DRAMInterfaceParams p{};
+    p.burst_length = 8;
+    p.device_bus_width = 8;
+    p.devices_per_rank = 8;
+    p.banks_per_rank = 8;
+    p.bank_groups_per_rank = 0;
+    p.beats_per_clock = 2;
+    p.dll = true;
+
+    const Tick ns = sim_clock::as_int::ns;
+    p.tCK = 1250 * ns / 1000;
+    p.tBURST_MAX = 5 * ns;
+    p.tCL = 13750 * ns / 1000;
+    p.tRCD = 13750 * ns / 1000;
+    p.tRP = 13750 * ns / 1000;
+    p.tRAS = 35 * ns;
+    p.tRFC = 260 * ns;
+    p.tWR = 15 * ns;
+    p.tRTP = 7500 * ns / 1000;
+    p.tXP = 6 * ns;
+    p.tXPDLL = 0;
+    p.tXS = 270 * ns;
+    p.tXSDLL = 0;
+
+    p.IDD0 = 55e-3;
+    p.IDD2N = 32e-3;
+    p.IDD3N = 38e-3;
+    p.IDD4W = 125e-3;
+    p.IDD4R = 157e-3;
+    p.IDD5 = 235e-3;
+    p.IDD3P1 = 38e-3;
+    p.IDD2P1 = 32e-3;
+    p.IDD6 = 20e-3;
+    p.VDD = 1.5;
+    p.VDD2 = 0;
+    return p;
+}
+
+struct TraceCommand
+{
+    MemCommand::cmds type;
+    unsigned bank;
+    /** Issue time in clock cycles */
+    int64_t cycle;
+};
+
+/**
+ * Replays a command trace through DRAMPower, and through the
+ * incremental model with the power state changes a rank would make,
+ * updating both at every refresh and at the end of the trace.
+ */
+class TraceReplay
+{
+  public:
+    TraceReplay(const DRAMInterfaceParams &p)
+        : p(p), power(p, false), incremental(p), counter(p.tRP),
+          rp(divCeil(p.tRP, p.tCK)), rfc(divCeil(p.tRFC, p.tCK))
+    {
+        counter.start(0);
+    }
+
+    void
+    run(const std::vector<TraceCommand> &trace, int64_t end)
+    {
+        for (const auto &cmd : trace) {
+            advance(cmd.cycle);
+            power.powerlib.doCommand(cmd.type, cmd.bank, cmd.cycle);
+            counter.command(cmd.type);
+            switch (cmd.type) {
+              case MemCommand::ACT:
+                ++openBanks;
+                transition(State::Active, cmd.cycle);
+                break;
+              case MemCommand::PRE:
+                // The rank becomes idle once the last precharge is done
+                if (--openBanks == 0)
+                    idleAt = cmd.cycle + rp;
+                break;
+              case MemCommand::REF:
+                transition(State::Refresh, cmd.cycle);
+                idleAt = cmd.cycle + rfc;
+                update(cmd.cycle);
+                break;
+              case MemCommand::PDN_F_ACT:
+                transition(State::ActPowerDown, cmd.cycle);
+                break;
+              case MemCommand::PUP_ACT:
+                transition(State::Active, cmd.cycle);
+                break;
+              case MemCommand::PDN_F_PRE:
+                transition(State::PrePowerDown, cmd.cycle);
+                break;
+              case MemCommand::SREN:
+                transition(State::SelfRefresh, cmd.cycle);
+                break;
+              case MemCommand::PUP_PRE:
+              case MemCommand::SREX:
+                transition(State::Idle, cmd.cycle);
+                break;
+              default:
+                break;
+            }
+        }
+        advance(end);
+        update(end);
+    }
+
+    /** Energy of one device accumulated by DRAMPower */
+    IncrementalDRAMPower::Energy lib;
+
+    /** Energy of one device accumulated by the incremental model */
+    IncrementalDRAMPower::Energy inc;
+
+  private:
+    using State = DRAMPowerCounter::State;
+
+    void
+    transition(State next, int64_t cycle)
+    {
+        if (next != state)
+            counter.transition(next, cycle * p.tCK);
+        state = next;
+    }
+
+    /** Leave the active or refresh state once the banks are closed */
+    void
+    advance(int64_t cycle)
+    {
+        if ((state == State::Active || state == State::Refresh) &&
+            openBanks == 0 && idleAt <= cycle) {
+            transition(State::Idle, idleAt);
+        }
+    }
+
+    void
+    update(int64_t cycle)
+    {
+        power.powerlib.calcWindowEnergy(cycle);
+        const auto &e = power.powerlib.getEnergy();
+        lib.act += e.act_energy;
+        lib.pre += e.pre_energy;
+        lib.read += e.read_energy;
+        lib.write += e.write_energy;
+        lib.ref += e.ref_energy;
+        lib.actBack += e.act_stdby_energy;
+        lib.preBack += e.pre_stdby_energy;
+        lib.actPowerDown += e.f_act_pd_energy;
+        lib.prePowerDown += e.f_pre_pd_energy;
+        lib.selfRefresh += e.sref_energy + e.sref_ref_energy;
+
+        const auto i = incremental.energy(counter.take(cycle * p.tCK));
+        inc.act += i.act;
+        inc.pre += i.pre;
+        inc.read += i.read;
+        inc.write += i.write;
+        inc.ref += i.ref;
+        inc.actBack += i.actBack;
+        inc.preBack += i.preBack;
+        inc.actPowerDown += i.actPowerDown;
+        inc.prePowerDown += i.prePowerDown;
+        inc.selfRefresh += i.selfRefresh;
+    }
+
+    const DRAMInterfaceParams &p;
+    DRAMPower power;
+    IncrementalDRAMPower incremental;
+    DRAMPowerCounter counter;
+
+    const int64_t rp;
+    const int64_t rfc;
+
+    State state = State::Idle;
+    unsigned openBanks = 0;
+    int64_t idleAt = 0;
+};
+
+/** Check every energy component but self-refresh */
+void
+expectMatchingEnergy(const IncrementalDRAMPower::Energy &inc,
+                     const IncrementalDRAMPower::Energy &lib)
+{
+    // Command energies follow the same equations
+    EXPECT_DOUBLE_EQ(inc.act, lib.act);
+    EXPECT_DOUBLE_EQ(inc.pre, lib.pre);
+    EXPECT_DOUBLE_EQ(inc.read, lib.read);
+    EXPECT_DOUBLE_EQ(inc.write, lib.write);
+    EXPECT_DOUBLE_EQ(inc.ref, lib.ref);
+
+    // Time spent in each state is the same once the precharge time
+    // at the end of the active and refresh states is moved over
+    EXPECT_DOUBLE_EQ(inc.actBack, lib.actBack);
+    EXPECT_DOUBLE_EQ(inc.preBack, lib.preBack);
+    EXPECT_DOUBLE_EQ(inc.actPowerDown, lib.actPowerDown);
+    EXPECT_DOUBLE_EQ(inc.prePowerDown, lib.prePowerDown);
+}
+
+} // anonymous namespace
+
+TEST(IncrementalDRAMPowerTest, MatchesDRAMPowerOverTrace)
+{
+    const DRAMInterfaceParams p = ddr3Params();
+
+    // Two banks opened back to back, an idle gap, a refresh and a
+    // second activity phase, issued at legal DDR3-1600 cycles
+    const std::vector<TraceCommand> trace = {
+        {MemCommand::ACT, 0, 10},
+        {MemCommand::ACT, 1, 15},
+        {MemCommand::RD, 0, 21},
+        {MemCommand::RD, 1, 26},
+        {MemCommand::WR, 0, 40},
+        {MemCommand::RD, 1, 44},
+        {MemCommand::PRE, 0, 70},
+        {MemCommand::PRE, 1, 72},
+        {MemCommand::REF, 0, 120},
+        {MemCommand::ACT, 2, 400},
+        {MemCommand::WR, 2, 411},
+        {MemCommand::WR, 2, 415},
+        {MemCommand::PRE, 2, 450},
+        {MemCommand::ACT, 2, 480},
+        {MemCommand::RD, 2, 491},
+        {MemCommand::PRE, 2, 510},
+    };
+
+    TraceReplay replay(p);
+    replay.run(trace, 700);
+    expectMatchingEnergy(replay.inc, replay.lib);
+    EXPECT_DOUBLE_EQ(replay.inc.selfRefresh, 0);
+    EXPECT_DOUBLE_EQ(replay.inc.total(), replay.lib.total());
+}
+
+TEST(IncrementalDRAMPowerTest, MatchesDRAMPowerWithPowerDown)
+{
+    const DRAMInterfaceParams p = ddr3Params();
+
+    // Active power-down with a bank open, then precharge power-down
+    // once it is closed, on either side of a refresh
+    const std::vector<TraceCommand> trace = {
+        {MemCommand::ACT, 0, 10},
+        {MemCommand::RD, 0, 21},
+        {MemCommand::PDN_F_ACT, 0, 40},
+        {MemCommand::PUP_ACT, 0, 140},
+        {MemCommand::WR, 0, 150},
+        {MemCommand::PRE, 0, 180},
+        {MemCommand::PDN_F_PRE, 0, 220},
+        {MemCommand::PUP_PRE, 0, 400},
+        {MemCommand::REF, 0, 420},
+        {MemCommand::PDN_F_PRE, 0, 700},
+        {MemCommand::PUP_PRE, 0, 900},
+        {MemCommand::ACT, 1, 920},
+        {MemCommand::PDN_F_ACT, 1, 940},
+        {MemCommand::PUP_ACT, 1, 1000},
+        {MemCommand::PRE, 1, 1010},
+    };
+
+    TraceReplay replay(p);
+    replay.run(trace, 1200);
+    expectMatchingEnergy(replay.inc, replay.lib);
+    EXPECT_GT(replay.inc.actPowerDown, 0);
+    EXPECT_GT(replay.inc.prePowerDown, 0);
+    EXPECT_DOUBLE_EQ(replay.inc.total(), replay.lib.total());
+}
+
+/**
+ * Self-refresh is charged at IDD6 throughout, while DRAMPower charges
+ * the auto-refresh done on entry at IDD5 less IDD3N, and its precharge
+ * part at the power-down currents. Everything else still matches.
+ */
+TEST(IncrementalDRAMPowerTest, SelfRefreshAtIDD6)
+{
+    DRAMInterfaceParams p = ddr3Params();
+    p.IDD3P0 = 30e-3;
+    p.IDD2P0 = 12e-3;
+
+    const int64_t sren = 200;
+    const int64_t srex = 2200;
+    const std::vector<TraceCommand> trace = {
+        {MemCommand::ACT, 0, 10},
+        {MemCommand::WR, 0, 21},
+        {MemCommand::PRE, 0, 60},
+        {MemCommand::SREN, 0, sren},
+        {MemCommand::SREX, 0, srex},
+        {MemCommand::ACT, 1, 2400},
+        {MemCommand::RD, 1, 2411},
+        {MemCommand::PRE, 1, 2440},
+    };
+
+    TraceReplay replay(p);
+    replay.run(trace, 2600);
+    expectMatchingEnergy(replay.inc, replay.lib);
+
+    // The whole of self-refresh at IDD6, in pJ
+    const double clk = p.tCK / (double)sim_clock::as_int::ns;
+    const double rfc = divCeil(p.tRFC, p.tCK);
+    const double rp = divCeil(p.tRP, p.tCK);
+    const double mw = 1000 * p.VDD;
+    EXPECT_DOUBLE_EQ(replay.inc.selfRefresh,
+                     (srex - sren) * clk * p.IDD6 * mw);
+
+    // DRAMPower swaps IDD6 for the refresh currents over tRFC
+    const double approx = clk * mw *
+        ((p.IDD5 - p.IDD3N - p.IDD6) * rfc + p.IDD3P0 * (rfc - rp) +
+         p.IDD2P0 * rp);
+    EXPECT_NEAR(replay.lib.selfRefresh - replay.inc.selfRefresh, approx,
+                1e-9 * replay.lib.selfRefresh);
+    EXPECT_NEAR(replay.lib.total() - replay.inc.total(), approx,
+                1e-9 * replay.lib.total());
+}
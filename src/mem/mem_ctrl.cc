@@ -65,6 +65,7 @@ MemCtrl::MemCtrl(const MemCtrlParams &p) :
                          respondEvent, nextReqEvent, retryWrReq);}, name()),
     respondEvent([this] {processRespondEvent(dram, respQueue,
                          respondEvent, retryRdReq); }, name()),
+    burstTicks(p.command_window),
     dram(p.dram),
     readBufferSize(dram->readBufferSize),
     writeBufferSize(dram->writeBufferSize),
@@ -661,14 +662,8 @@ MemCtrl::accessAndRespond(PacketPtr pkt, Tick static_latency,
 void
 MemCtrl::pruneBurstTick()
 {
-    auto it = burstTicks.begin();
-    while (it != burstTicks.end()) {
-        auto current_it = it++;
-        if (curTick() > *current_it) {
-            DPRINTF(MemCtrl, "Removing burstTick for %d\n", *current_it);
-            burstTicks.erase(current_it);
-        }
-    }
+    if (burstTicks.prune(curTick()))
+        DPRINTF(MemCtrl, "Removed burstTicks before %d\n", curTick());
 }
 
 Tick
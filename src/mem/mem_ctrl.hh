@@ -55,6 +55,7 @@
 #include "base/callback.hh"
 #include "base/statistics.hh"
 #include "enums/MemSched.hh"
+#include "mem/burst_ticks.hh"
 #include "mem/qos/mem_ctrl.hh"
 #include "mem/qport.hh"
 #include "params/MemCtrl.hh"
@@ -496,7 +497,7 @@ class MemCtrl : public qos::MemCtrl
      * defined Tick. This is used to ensure that the command bandwidth
      * does not exceed the allowable media constraints.
      */
-    std::unordered_multiset<Tick> burstTicks;
+    BurstTicks burstTicks;
 
     /**
 +    * Create pointer to interface of the actual memory media when connected
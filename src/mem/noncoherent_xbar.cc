@@ -45,6 +45,7 @@
 
 #include "mem/noncoherent_xbar.hh"
 
+#include "base/cast.hh"
 #include "base/logging.hh"
 #include "base/trace.hh"
 #include "debug/NoncoherentXBar.hh"
@@ -143,6 +144,10 @@ NoncoherentXBar::recvTimingReq(PacketPtr pkt, PortID cpu_side_port_id)
     const bool expect_response = pkt->needsResponse() &&
         !pkt->cacheResponding();
 
+    // remember where to route the response to
+    if (expect_response)
+        pkt->pushSenderState(new RouteState(cpu_side_port_id));
+
     // since it is a normal request, attempt to send the packet
     bool success = memSidePorts[mem_side_port_id]->sendTimingReq(pkt);
 
@@ -150,6 +155,9 @@ NoncoherentXBar::recvTimingReq(PacketPtr pkt, PortID cpu_side_port_id)
         DPRINTF(NoncoherentXBar, "recvTimingReq: src %s %s 0x%x RETRY\n",
                 src_port->name(), pkt->cmdString(), pkt->getAddr());
 
+        if (expect_response)
+            delete pkt->popSenderState();
+
         // restore the header delay as it is additive
         pkt->headerDelay = old_header_delay;
 
@@ -160,12 +168,6 @@ NoncoherentXBar::recvTimingReq(PacketPtr pkt, PortID cpu_side_port_id)
         return false;
     }
 
-    // remember where to route the response to
-    if (expect_response) {
-        assert(routeTo.find(pkt->req) == routeTo.end());
-        routeTo[pkt->req] = cpu_side_port_id;
-    }
-
     reqLayers[mem_side_port_id]->succeededTiming(packetFinishTime);
 
     // stats updates
@@ -183,9 +185,8 @@ NoncoherentXBar::recvTimingResp(PacketPtr pkt, PortID mem_side_port_id)
     RequestPort *src_port = memSidePorts[mem_side_port_id];
 
     // determine the destination
-    const auto route_lookup = routeTo.find(pkt->req);
-    assert(route_lookup != routeTo.end());
-    const PortID cpu_side_port_id = route_lookup->second;
+    auto route = safe_cast<RouteState *>(pkt->senderState);
+    const PortID cpu_side_port_id = route->port;
     assert(cpu_side_port_id != InvalidPortID);
     assert(cpu_side_port_id < respLayers.size());
 
@@ -214,6 +215,10 @@ NoncoherentXBar::recvTimingResp(PacketPtr pkt, PortID mem_side_port_id)
     // determine how long to be crossbar layer is busy
     Tick packetFinishTime = clockEdge(Cycles(1)) + pkt->payloadDelay;
 
+    // the route is not needed anymore
+    pkt->popSenderState();
+    delete route;
+
     // send the packet through the destination CPU-side port, and pay for
     // any outstanding latency
     Tick latency = pkt->headerDelay;
@@ -221,9 +226,6 @@ NoncoherentXBar::recvTimingResp(PacketPtr pkt, PortID mem_side_port_id)
     cpuSidePorts[cpu_side_port_id]->schedTimingResp(pkt,
                                         curTick() + latency);
 
-    // remove the request from the routing table
-    routeTo.erase(route_lookup);
-
     respLayers[cpu_side_port_id]->succeededTiming(packetFinishTime);
 
     // stats updates
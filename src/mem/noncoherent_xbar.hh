@@ -46,6 +46,7 @@
 #ifndef __MEM_NONCOHERENT_XBAR_HH__
 #define __MEM_NONCOHERENT_XBAR_HH__
 
+#include "base/pool_alloc.hh"
 #include "mem/xbar.hh"
 #include "params/NoncoherentXBar.hh"
 
@@ -70,6 +71,16 @@ class NoncoherentXBar : public BaseXBar
 
   protected:
 
+    /**
+     * Sender state remembering the CPU-side port a request came from,
+     * so that its response can be routed back without a lookup.
+     */
+    struct RouteState : public Packet::SenderState, public PoolAllocated
+    {
+        const PortID port;
+        RouteState(PortID _port) : port(_port) {}
+    };
+
     /**
      * Declare the layers of this crossbar, one vector for requests
      * and one for responses.
@@ -360,7 +360,15 @@ class Packet : public Printable, public Extensible<Packet>
 
         // Signal block present to squash prefetch and cache evict packets
         // through express snoop flag
-        BLOCK_CACHED          = 0x00010000
+        BLOCK_CACHED          = 0x00010000,
+
+        /// Functional notification that a cache restored this block
+        /// from a checkpoint, see setRestoredBlock below.
+        RESTORED_BLOCK        = 0x00020000,
+
+        /// Clean and invalidate snoop of a snoop filter evicting the
+        /// line, see setBackInvalidation below.
+        BACK_INVALIDATION     = 0x00040000
     };
 
     Flags flags;
@@ -760,6 +768,39 @@ class Packet : public Printable, public Extensible<Packet>
     bool isBlockCached() const     { return flags.isSet(BLOCK_CACHED); }
     void clearBlockCached()        { flags.clear(BLOCK_CACHED); }
 
+    /**
+     * Mark a functional read as the notification that a cache holds
+     * the block after restoring it from a checkpoint. It travels down
+     * like a functional access and lets the snoop filters on the way
+     * record the sender as a holder, as a fill would have. Caches
+     * and crossbars pass it on without looking up the block, and it
+     * stops at the point of coherency.
+     */
+    void setRestoredBlock()
+    {
+        assert(cmd == MemCmd::ReadReq);
+        flags.set(RESTORED_BLOCK);
+    }
+    bool isRestoredBlock() const { return flags.isSet(RESTORED_BLOCK); }
+
+    /**
+     * Mark a clean and invalidate snoop as the back-invalidation of a
+     * line evicted from a snoop filter. Unlike a cache maintenance
+     * operation, nobody waits for its completion, so a cache with the
+     * line in a dirty writeback lets the writeback go below instead of
+     * satisfying the snoop with a WriteClean. Caches forwarding the
+     * snoop upwards propagate the flag.
+     */
+    void setBackInvalidation()
+    {
+        assert(cmd == MemCmd::CleanInvalidReq);
+        flags.set(BACK_INVALIDATION);
+    }
+    bool isBackInvalidation() const
+    {
+        return flags.isSet(BACK_INVALIDATION);
+    }
+
     /**
      * QoS Value getter
      * Returns 0 if QoS value was never set (constructor default).
@@ -33,6 +33,8 @@
  */
 #include "mem/page_table.hh"
 
+#include <array>
+#include <atomic>
 #include <string>
 
 #include "base/compiler.hh"
@@ -44,6 +46,81 @@
 namespace gem5
 {
 
+namespace
+{
+
+/// Source of unique table generations, zero is never handed out
+std::atomic<uint64_t> nextGeneration(0);
+
+/// Cached translation of a page
+struct PageCacheEntry
+{
+    uint64_t generation;
+    Addr vaddr;
+    const EmulationPageTable::Entry *entry;
+};
+
+/// Cached translation of a huge page sized region
+struct HugeCacheEntry
+{
+    uint64_t generation;
+    Addr vaddr;
+    Addr delta;
+};
+
+/**
+ * Direct mapped translation caches of the simulation thread, shared
+ * by all the page tables it translates for.
+ * @{
+ */
+thread_local std::array<PageCacheEntry, 1024> pageCache;
+thread_local std::array<HugeCacheEntry, 64> hugeCache;
+/** @} */
+
+} // anonymous namespace
+
+EmulationPageTable::EmulationPageTable(
+        const std::string &__name, uint64_t _pid, Addr _pageSize) :
+        _pageSize(_pageSize), offsetMask(mask(floorLog2(_pageSize))),
+        pageShift(floorLog2(_pageSize)), _pid(_pid), _name(__name),
+        generation(++nextGeneration), hugePageSize(_pageSize << 9),
+        hugePageShift(pageShift + 9), _lookups(0), _pageHits(0),
+        _hugeHits(0), shared(false)
+{
+    assert(isPowerOf2(_pageSize));
+}
+
+void
+EmulationPageTable::invalidateCache()
+{
+    generation = ++nextGeneration;
+}
+
+void
+EmulationPageTable::insertPage(Addr vaddr, const Entry &entry)
+{
+    pTable.emplace(vaddr, entry);
+
+    HugeRegion &region = hugeRegions[vaddr & ~(hugePageSize - 1)];
+    if (region.pages++ == 0) {
+        region.delta = entry.paddr - vaddr;
+        region.contiguous = true;
+    } else if (region.delta != entry.paddr - vaddr) {
+        region.contiguous = false;
+    }
+}
+
+void
+EmulationPageTable::erasePage(PTableItr it)
+{
+    auto region = hugeRegions.find(it->first & ~(hugePageSize - 1));
+    assert(region != hugeRegions.end());
+    if (--region->second.pages == 0)
+        hugeRegions.erase(region);
+
+    pTable.erase(it);
+}
+
 void
 EmulationPageTable::map(Addr vaddr, Addr paddr, int64_t size, uint64_t flags)
 {
@@ -60,15 +137,16 @@ EmulationPageTable::map(Addr vaddr, Addr paddr, int64_t size, uint64_t flags)
             panic_if(!clobber,
                      "EmulationPageTable::allocate: addr %#x already mapped",
                      vaddr);
-            it->second = Entry(paddr, flags);
-        } else {
-            pTable.emplace(vaddr, Entry(paddr, flags));
+            erasePage(it);
         }
+        insertPage(vaddr, Entry(paddr, flags));
 
         size -= _pageSize;
         vaddr += _pageSize;
         paddr += _pageSize;
     }
+
+    invalidateCache();
 }
 
 void
@@ -85,12 +163,14 @@ EmulationPageTable::remap(Addr vaddr, int64_t size, Addr new_vaddr)
         auto old_it = pTable.find(vaddr);
         assert(old_it != pTable.end() && new_it == pTable.end());
 
-        pTable.emplace(new_vaddr, old_it->second);
-        pTable.erase(old_it);
+        insertPage(new_vaddr, old_it->second);
+        erasePage(old_it);
         size -= _pageSize;
         vaddr += _pageSize;
         new_vaddr += _pageSize;
     }
+
+    invalidateCache();
 }
 
 void
@@ -110,10 +190,12 @@ EmulationPageTable::unmap(Addr vaddr, int64_t size)
     while (size > 0) {
         auto it = pTable.find(vaddr);
         assert(it != pTable.end());
-        pTable.erase(it);
+        erasePage(it);
         size -= _pageSize;
         vaddr += _pageSize;
     }
+
+    invalidateCache();
 }
 
 bool
@@ -132,21 +214,65 @@ EmulationPageTable::isUnmapped(Addr vaddr, int64_t size)
 const EmulationPageTable::Entry *
 EmulationPageTable::lookup(Addr vaddr)
 {
+    ++_lookups;
+
     Addr page_addr = pageAlign(vaddr);
+    PageCacheEntry &cached =
+        pageCache[(page_addr >> pageShift) % pageCache.size()];
+    if (cached.generation == generation && cached.vaddr == page_addr) {
+        ++_pageHits;
+        return cached.entry;
+    }
+
     PTableItr iter = pTable.find(page_addr);
     if (iter == pTable.end())
         return nullptr;
+
+    cached = PageCacheEntry{generation, page_addr, &(iter->second)};
     return &(iter->second);
 }
 
 bool
 EmulationPageTable::translate(Addr vaddr, Addr &paddr)
 {
-    const Entry *entry = lookup(vaddr);
-    if (!entry) {
+    ++_lookups;
+
+    Addr page_addr = pageAlign(vaddr);
+    PageCacheEntry &cached =
+        pageCache[(page_addr >> pageShift) % pageCache.size()];
+    if (cached.generation == generation && cached.vaddr == page_addr) {
+        ++_pageHits;
+        paddr = pageOffset(vaddr) + cached.entry->paddr;
+        DPRINTF(MMU, "Translating: %#x->%#x\n", vaddr, paddr);
+        return true;
+    }
+
+    // a huge region only lacks a page translation if it was displaced
+    Addr huge_addr = vaddr & ~(hugePageSize - 1);
+    HugeCacheEntry &huge =
+        hugeCache[(huge_addr >> hugePageShift) % hugeCache.size()];
+    if (huge.generation == generation && huge.vaddr == huge_addr) {
+        ++_hugeHits;
+        paddr = vaddr + huge.delta;
+        DPRINTF(MMU, "Translating: %#x->%#x\n", vaddr, paddr);
+        return true;
+    }
+
+    PTableItr iter = pTable.find(page_addr);
+    if (iter == pTable.end()) {
         DPRINTF(MMU, "Couldn't Translate: %#x\n", vaddr);
         return false;
     }
+
+    const Entry *entry = &(iter->second);
+    cached = PageCacheEntry{generation, page_addr, entry};
+
+    auto region = hugeRegions.find(huge_addr);
+    if (region != hugeRegions.end() && region->second.contiguous &&
+        region->second.pages == hugePageSize / _pageSize) {
+        huge = HugeCacheEntry{generation, huge_addr, region->second.delta};
+    }
+
     paddr = pageOffset(vaddr) + entry->paddr;
     DPRINTF(MMU, "Translating: %#x->%#x\n", vaddr, paddr);
     return true;
@@ -216,8 +342,10 @@ EmulationPageTable::unserialize(CheckpointIn &cp)
         UNSERIALIZE_SCALAR(paddr);
         UNSERIALIZE_SCALAR(flags);
 
-        pTable.emplace(vaddr, Entry(paddr, flags));
+        insertPage(vaddr, Entry(paddr, flags));
     }
+
+    invalidateCache();
 }
 
 const std::string
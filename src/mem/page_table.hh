@@ -69,19 +69,64 @@ class EmulationPageTable : public Serializable
 
     const Addr _pageSize;
     const Addr offsetMask;
+    const unsigned pageShift;
 
     const uint64_t _pid;
     const std::string _name;
 
+    /**
+     * Translations are cached per simulation thread in front of
+     * pTable, by page and by huge page sized region. Cached entries
+     * are tagged with the generation of the table they came from,
+     * which changes whenever the mappings do. Generations are unique
+     * across all tables, so the caches can be shared between them.
+     */
+    uint64_t generation;
+
+    /**
+     * Mapping state of a huge page sized, aligned region. Once all its
+     * pages are mapped to physically contiguous memory, the region is
+     * translated as a whole.
+     */
+    struct HugeRegion
+    {
+        /// Physical minus virtual address of the first page mapped
+        Addr delta;
+        /// Number of pages currently mapped in the region
+        Addr pages;
+        /// Whether all pages were mapped consistently
+        bool contiguous;
+    };
+    std::unordered_map<Addr, HugeRegion> hugeRegions;
+
+    const Addr hugePageSize;
+    const unsigned hugePageShift;
+
+    /**
+     * Counters of the translation cache.
+     * @{
+     */
+    uint64_t _lookups;
+    uint64_t _pageHits;
+    uint64_t _hugeHits;
+    /** @} */
+
+    /**
+     * Add and remove pages, keeping track of the huge regions. The
+     * caller has to invalidate the cached translations.
+     * @{
+     */
+    void insertPage(Addr vaddr, const Entry &entry);
+    void erasePage(PTableItr it);
+    /** @} */
+
+    /** Drop all the cached translations of this table. */
+    void invalidateCache();
+
   public:
 
     EmulationPageTable(
-            const std::string &__name, uint64_t _pid, Addr _pageSize) :
-            _pageSize(_pageSize), offsetMask(mask(floorLog2(_pageSize))),
-            _pid(_pid), _name(__name), shared(false)
-    {
-        assert(isPowerOf2(_pageSize));
-    }
+            const std::string &__name, uint64_t _pid, Addr _pageSize);
 
     uint64_t pid() const { return _pid; };
 
@@ -149,6 +194,18 @@ class EmulationPageTable : public Serializable
      */
     bool translate(Addr vaddr, Addr &paddr);
 
+    /**
+     * Statistics of the translation cache in front of the table.
+     * @{
+     */
+    /** Number of lookups and translations requested */
+    uint64_t lookups() const { return _lookups; }
+    /** Number of them served from cached page translations */
+    uint64_t pageHits() const { return _pageHits; }
+    /** Number of them served from cached huge page translations */
+    uint64_t hugeHits() const { return _hugeHits; }
+    /** @} */
+
     /**
      * Simplified translate function (just check for translation)
      * @param vaddr The virtual address.
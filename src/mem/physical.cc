@@ -39,15 +39,24 @@
 
 #include <fcntl.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/user.h>
 #include <unistd.h>
 #include <zlib.h>
 
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
+
+#include <algorithm>
 #include <cerrno>
 #include <climits>
 #include <cstdio>
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <limits>
 #include <string>
 
 #include "base/intmath.hh"
@@ -76,14 +85,50 @@ namespace gem5
 namespace memory
 {
 
+namespace
+{
+
+/**
+ * Size of the default huge pages of the host, as reported by the
+ * kernel, or zero if it has none.
+ */
+uint64_t
+hostHugePageSize()
+{
+    std::ifstream meminfo("/proc/meminfo");
+    std::string key;
+    while (meminfo >> key) {
+        if (key == "Hugepagesize:") {
+            uint64_t kib;
+            if (meminfo >> kib)
+                return kib * 1024;
+            break;
+        }
+        meminfo.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    }
+    return 0;
+}
+
+bool
+isZero(const uint8_t* data, uint64_t size)
+{
+    return size == 0 ||
+        (data[0] == 0 && std::memcmp(data, data + 1, size - 1) == 0);
+}
+
+} // anonymous namespace
+
 PhysicalMemory::PhysicalMemory(const std::string& _name,
                                const std::vector<AbstractMemory*>& _memories,
                                bool mmap_using_noreserve,
                                const std::string& shared_backstore,
-                               bool auto_unlink_shared_backstore) :
+                               bool auto_unlink_shared_backstore,
+                               BackstoreHugePages huge_pages,
+                               int numa_node, bool compress_checkpoint) :
     _name(_name), size(0), mmapUsingNoReserve(mmap_using_noreserve),
     sharedBackstore(shared_backstore), sharedBackstoreSize(0),
-    pageSize(sysconf(_SC_PAGE_SIZE))
+    pageSize(sysconf(_SC_PAGE_SIZE)), hugePages(huge_pages),
+    numaNode(numa_node), compressCheckpoint(compress_checkpoint)
 {
     // Register cleanup callback if requested.
     if (auto_unlink_shared_backstore && !sharedBackstore.empty()) {
@@ -238,9 +283,21 @@ PhysicalMemory::createBackingStore(
         map_flags |= MAP_NORESERVE;
     }
 
-    uint8_t* pmem = (uint8_t*) mmap(NULL, range.size(),
-                                    PROT_READ | PROT_WRITE,
-                                    map_flags, shm_fd, map_offset);
+    uint8_t* pmem;
+    if (shm_fd == -1) {
+        pmem = mapAnonymous(range.size(), map_flags);
+    } else {
+        pmem = (uint8_t*) mmap(NULL, range.size(), PROT_READ | PROT_WRITE,
+                               map_flags, shm_fd, map_offset);
+        // the shared memory may still be backed by transparent huge
+        // pages if the host allows it for shmem
+        if (pmem != (uint8_t*) MAP_FAILED &&
+            hugePages != BackstoreHugePages::none) {
+#if defined(MADV_HUGEPAGE)
+            madvise(pmem, range.size(), MADV_HUGEPAGE);
+#endif
+        }
+    }
 
     if (pmem == (uint8_t*) MAP_FAILED) {
         perror("mmap");
@@ -248,6 +305,8 @@ PhysicalMemory::createBackingStore(
               range.to_string());
     }
 
+    bindBackingStore(pmem, range.size());
+
     // remember this backing store so we can checkpoint it and unmap
     // it appropriately
     backingStore.emplace_back(range, pmem,
@@ -262,6 +321,137 @@ PhysicalMemory::createBackingStore(
     }
 }
 
+uint8_t*
+PhysicalMemory::mapAnonymous(uint64_t size, int map_flags) const
+{
+    if (hugePages == BackstoreHugePages::none) {
+        return (uint8_t*) mmap(NULL, size, PROT_READ | PROT_WRITE,
+                               map_flags, -1, 0);
+    }
+
+    const uint64_t huge_page_size = hostHugePageSize();
+
+#if defined(MAP_HUGETLB)
+    // huge pages from the reserved pool have to cover the store
+    // exactly, as it is unmapped using its size
+    if (hugePages == BackstoreHugePages::hugetlb) {
+        if (huge_page_size && size % huge_page_size == 0) {
+            void* pmem = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                              map_flags | MAP_HUGETLB, -1, 0);
+            if (pmem != MAP_FAILED) {
+                DPRINTF(AddrRanges, "Backing store mapped with %d byte "
+                        "huge pages\n", huge_page_size);
+                return (uint8_t*)pmem;
+            }
+            warn("Could not map %d bytes of huge pages (%s), falling "
+                 "back to transparent huge pages\n", size, strerror(errno));
+        } else {
+            warn("Backing store of %d bytes is not a multiple of the huge "
+                 "page size, falling back to transparent huge pages\n",
+                 size);
+        }
+    }
+#else
+    warn_once("Explicit huge pages are not supported on this host, "
+              "falling back to transparent huge pages\n");
+#endif
+
+    // transparent huge pages can only be used for naturally aligned
+    // parts of the mapping, so over-allocate and trim the excess
+    uint64_t align = std::max<uint64_t>(huge_page_size, pageSize);
+    uint8_t* base = (uint8_t*) mmap(NULL, size + align,
+                                    PROT_READ | PROT_WRITE,
+                                    map_flags, -1, 0);
+    if (base == (uint8_t*) MAP_FAILED)
+        return base;
+
+    uint8_t* pmem = (uint8_t*) roundUp((uintptr_t)base, align);
+    if (pmem != base)
+        munmap(base, pmem - base);
+    uint64_t mapped = roundUp(size, pageSize);
+    munmap(pmem + mapped, base + size + align - (pmem + mapped));
+
+#if defined(MADV_HUGEPAGE)
+    if (madvise(pmem, size, MADV_HUGEPAGE))
+        warn("Could not advise huge pages for the backing store (%s)\n",
+             strerror(errno));
+#else
+    warn_once("Transparent huge pages are not supported on this host\n");
+#endif
+
+    return pmem;
+}
+
+void
+PhysicalMemory::bindBackingStore(uint8_t* pmem, uint64_t size) const
+{
+    if (numaNode < 0)
+        return;
+
+#if defined(__linux__) && defined(SYS_mbind)
+    // bind the pages rather than the thread, so that they end up on
+    // the node no matter which thread touches them first, use the
+    // system call directly to avoid depending on libnuma
+    const int mpol_bind = 2;
+    const unsigned bits = sizeof(unsigned long) * CHAR_BIT;
+    std::vector<unsigned long> node_mask(numaNode / bits + 1, 0);
+    node_mask[numaNode / bits] = 1UL << (numaNode % bits);
+    if (syscall(SYS_mbind, pmem, size, mpol_bind, node_mask.data(),
+                node_mask.size() * bits + 1, 0)) {
+        warn("Could not bind the backing store to NUMA node %d (%s)\n",
+             numaNode, strerror(errno));
+    }
+#else
+    warn_once("NUMA binding of the backing store is not supported on "
+              "this host\n");
+#endif
+}
+
+bool
+PhysicalMemory::mapImage(const std::string& filepath,
+                         const BackingStoreEntry& store) const
+{
+    // shared backing stores are visible to other processes, so their
+    // contents have to be written rather than remapped
+    if (store.shmFd != -1)
+        return false;
+
+    int fd = open(filepath.c_str(), O_RDONLY);
+    if (fd == -1)
+        return false;
+
+    // only map images of the right size
+    struct stat st;
+    bool mappable = fstat(fd, &st) == 0 &&
+        (uint64_t)st.st_size == store.range.size();
+
+    void* pmem = MAP_FAILED;
+    if (mappable) {
+        // replace the anonymous memory at the same address, so that
+        // the memories and KVM keep using the pointers they have
+        int map_flags = MAP_PRIVATE | MAP_FIXED;
+        if (mmapUsingNoReserve)
+            map_flags |= MAP_NORESERVE;
+        pmem = mmap(store.pmem, store.range.size(), PROT_READ | PROT_WRITE,
+                    map_flags, fd, 0);
+        // a failed MAP_FIXED leaves the old mapping in place
+        if (pmem == MAP_FAILED)
+            warn("Could not map memory image '%s' (%s), reading it\n",
+                 filepath, strerror(errno));
+    }
+
+    // the mapping keeps the file open
+    close(fd);
+
+    if (pmem == MAP_FAILED)
+        return false;
+
+    // pages written to after restoring are copied into anonymous
+    // memory, which is subject to the binding like before
+    bindBackingStore(store.pmem, store.range.size());
+    return true;
+}
+
 PhysicalMemory::~PhysicalMemory()
 {
     // unmap the backing store
@@ -368,6 +558,7 @@ PhysicalMemory::serializeStore(CheckpointOut &cp, unsigned int store_id,
     std::string filename =
         name() + ".store" + std::to_string(store_id) + ".pmem";
     long range_size = range.size();
+    std::string store_format = compressCheckpoint ? "gzip" : "raw";
 
     DPRINTF(Checkpoint, "Serializing physical memory %s with size %d\n",
             filename, range_size);
@@ -375,9 +566,56 @@ PhysicalMemory::serializeStore(CheckpointOut &cp, unsigned int store_id,
     SERIALIZE_SCALAR(store_id);
     SERIALIZE_SCALAR(filename);
     SERIALIZE_SCALAR(range_size);
+    SERIALIZE_SCALAR(store_format);
 
     // write memory file
     std::string filepath = CheckpointIn::dir() + "/" + filename.c_str();
+
+    // the file may be mapped as the memory of this or another
+    // simulation restored from it, and truncating it would pull the
+    // pages from under their feet, so replace it instead
+    unlink(filepath.c_str());
+
+    if (!compressCheckpoint) {
+        int fd = open(filepath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+        if (fd == -1)
+            fatal("Can't open physical memory checkpoint file '%s'\n",
+                  filename);
+
+        // only write the pages that are not zero, and leave holes in
+        // the file for the rest
+        uint64_t pos = 0;
+        while (pos < range.size()) {
+            uint64_t len = std::min<uint64_t>(pageSize, range.size() - pos);
+            if (isZero(pmem + pos, len)) {
+                pos += len;
+                continue;
+            }
+
+            uint64_t end = pos + len;
+            while (end < range.size() && end - pos < INT_MAX) {
+                uint64_t next = std::min<uint64_t>(pageSize,
+                                                   range.size() - end);
+                if (isZero(pmem + end, next))
+                    break;
+                end += next;
+            }
+
+            while (pos < end) {
+                ssize_t written = pwrite(fd, pmem + pos, end - pos, pos);
+                if (written <= 0)
+                    fatal("Write failed on physical memory checkpoint "
+                          "file '%s'\n", filename);
+                pos += written;
+            }
+        }
+
+        if (ftruncate(fd, range.size()) || close(fd))
+            fatal("Close failed on physical memory checkpoint file '%s'\n",
+                  filename);
+        return;
+    }
+
     gzFile compressed_mem = gzopen(filepath.c_str(), "wb");
     if (compressed_mem == NULL)
         fatal("Can't open physical memory checkpoint file '%s'\n",
@@ -443,11 +681,6 @@ PhysicalMemory::unserializeStore(CheckpointIn &cp)
     UNSERIALIZE_SCALAR(filename);
     std::string filepath = cp.getCptDir() + "/" + filename;
 
-    // mmap memoryfile
-    gzFile compressed_mem = gzopen(filepath.c_str(), "rb");
-    if (compressed_mem == NULL)
-        fatal("Can't open physical memory checkpoint file '%s'", filename);
-
     // we've already got the actual backing store mapped
     uint8_t* pmem = backingStore[store_id].pmem;
     AddrRange range = backingStore[store_id].range;
@@ -462,6 +695,54 @@ PhysicalMemory::unserializeStore(CheckpointIn &cp)
         fatal("Memory range size has changed! Saw %lld, expected %lld\n",
               range_size, range.size());
 
+    // checkpoints that do not record the format predate uncompressed
+    // images
+    std::string store_format = "gzip";
+    UNSERIALIZE_OPT_SCALAR(store_format);
+    if (store_format != "gzip" && store_format != "raw")
+        fatal("Unknown format '%s' of physical memory checkpoint file "
+              "'%s'\n", store_format, filename);
+
+    if (store_format == "raw") {
+        // uncompressed images are mapped rather than read when possible
+        if (mapImage(filepath, backingStore[store_id])) {
+            DPRINTF(Checkpoint, "Mapped physical memory %s copy-on-write\n",
+                    filename);
+            return;
+        }
+
+        // gzread would take an image that happens to start like a
+        // gzip stream for one, so read it as it is
+        int fd = open(filepath.c_str(), O_RDONLY);
+        if (fd == -1)
+            fatal("Can't open physical memory checkpoint file '%s'",
+                  filename);
+
+        std::vector<uint8_t> chunk(chunk_size);
+        uint64_t curr_size = 0;
+        while (curr_size < range.size()) {
+            ssize_t bytes_read = pread(fd, chunk.data(),
+                std::min<uint64_t>(chunk_size, range.size() - curr_size),
+                curr_size);
+            if (bytes_read <= 0)
+                break;
+
+            // as below, leave the pages of zeroes untouched
+            if (!isZero(chunk.data(), bytes_read))
+                std::memcpy(pmem + curr_size, chunk.data(), bytes_read);
+            curr_size += bytes_read;
+        }
+
+        if (close(fd))
+            fatal("Close failed on physical memory checkpoint file '%s'\n",
+                  filename);
+        return;
+    }
+
+    gzFile compressed_mem = gzopen(filepath.c_str(), "rb");
+    if (compressed_mem == NULL)
+        fatal("Can't open physical memory checkpoint file '%s'", filename);
+
     uint64_t curr_size = 0;
     long* temp_page = new long[chunk_size];
     long* pmem_current;
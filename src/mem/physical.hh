@@ -44,6 +44,7 @@
 
 #include "base/addr_range.hh"
 #include "base/addr_range_map.hh"
+#include "enums/BackstoreHugePages.hh"
 #include "mem/packet.hh"
 #include "sim/serialize.hh"
 
@@ -158,6 +159,15 @@ class PhysicalMemory : public Serializable
 
     long pageSize;
 
+    // Host huge pages to back the memory with
+    const BackstoreHugePages hugePages;
+
+    // Host NUMA node to bind the backing store to, if not negative
+    const int numaNode;
+
+    // Compress the memory images written to checkpoints
+    const bool compressCheckpoint;
+
     // The physical memory used to provide the memory in the simulated
     // system
     std::vector<BackingStoreEntry> backingStore;
@@ -182,6 +192,36 @@ class PhysicalMemory : public Serializable
                             bool conf_table_reported,
                             bool in_addr_map, bool kvm_map);
 
+    /**
+     * Map a private anonymous backing store, honouring the huge page
+     * setting.
+     *
+     * @param size Size of the backing store
+     * @param map_flags Additional flags to pass to mmap
+     * @return The mapping, or MAP_FAILED
+     */
+    uint8_t* mapAnonymous(uint64_t size, int map_flags) const;
+
+    /**
+     * Apply the NUMA binding to a freshly mapped backing store before
+     * it is touched.
+     */
+    void bindBackingStore(uint8_t* pmem, uint64_t size) const;
+
+    /**
+     * Map an uncompressed memory image copy-on-write over a private
+     * backing store, replacing its contents without reading the
+     * image. Pages are populated from the page cache on first touch.
+     * The checkpoint records whether an image is compressed, as the
+     * contents of an uncompressed one may start like a gzip stream.
+     *
+     * @param filepath Path to the memory image
+     * @param store Backing store to replace the contents of
+     * @return False if the image cannot be mapped and has to be read
+     */
+    bool mapImage(const std::string& filepath,
+                  const BackingStoreEntry& store) const;
+
   public:
 
     /**
@@ -191,7 +231,9 @@ class PhysicalMemory : public Serializable
                    const std::vector<AbstractMemory*>& _memories,
                    bool mmap_using_noreserve,
                    const std::string& shared_backstore,
-                   bool auto_unlink_shared_backstore);
+                   bool auto_unlink_shared_backstore,
+                   BackstoreHugePages huge_pages = BackstoreHugePages::none,
+                   int numa_node = -1, bool compress_checkpoint = true);
 
     /**
      * Unmap all the backing store we have used.
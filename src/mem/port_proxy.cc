@@ -37,6 +37,11 @@
 
 #include "mem/port_proxy.hh"
 
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
 #include "base/chunk_generator.hh"
 #include "cpu/thread_context.hh"
 #include "mem/port.hh"
@@ -44,20 +49,109 @@
 namespace gem5
 {
 
+namespace
+{
+
+/**
+ * Back doors of all the requestors proxies were created for. Proxies
+ * are often created for a single access, so the back doors are kept
+ * here for as long as the simulation runs instead.
+ */
+PortProxy::BackdoorCache &
+backdoorCache(const void *requestor)
+{
+    static std::mutex mutex;
+    static std::unordered_map<const void *,
+                              std::unique_ptr<PortProxy::BackdoorCache>>
+        caches;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto &cache = caches[requestor];
+    if (!cache)
+        cache = std::make_unique<PortProxy::BackdoorCache>();
+    return *cache;
+}
+
+} // anonymous namespace
+
+std::atomic<uint64_t> PortProxy::_backdoorWrites(0);
+
+PortProxy::PortProxy(SendFunctionalFunc func,
+                     SendMemBackdoorReqFunc backdoor_func,
+                     const void *requestor, unsigned int cache_line_size) :
+    sendFunctional(func), sendBackdoorReq(backdoor_func),
+    backdoors(&backdoorCache(requestor)), _cacheLineSize(cache_line_size)
+{}
+
 PortProxy::PortProxy(ThreadContext *tc, unsigned int cache_line_size) :
     PortProxy([tc](PacketPtr pkt)->void { tc->sendFunctional(pkt); },
-        cache_line_size)
+        [tc](const MemBackdoorReq &req, MemBackdoorPtr &backdoor)->void {
+            tc->sendMemBackdoorReq(req, backdoor);
+        }, tc, cache_line_size)
 {}
 
 PortProxy::PortProxy(const RequestPort &port, unsigned int cache_line_size) :
     PortProxy([&port](PacketPtr pkt)->void { port.sendFunctional(pkt); },
-        cache_line_size)
+        [&port](const MemBackdoorReq &req, MemBackdoorPtr &backdoor)->void {
+            port.sendMemBackdoorReq(req, backdoor);
+        }, &port, cache_line_size)
 {}
 
+uint8_t *
+PortProxy::backdoorPtr(Addr addr, Request::Flags flags, int size,
+                       bool write) const
+{
+    // flags may change how the address is interpreted, leave those
+    // accesses to the memory system
+    if (!backdoors || flags != 0 || size <= 0)
+        return nullptr;
+
+    AddrRange range = RangeSize(addr, size);
+    MemBackdoorPtr backdoor = nullptr;
+
+    auto it = backdoors->contains(range);
+    if (it != backdoors->end()) {
+        backdoor = it->second;
+    } else {
+        sendBackdoorReq(MemBackdoorReq(range, write ?
+                    MemBackdoor::Writeable : MemBackdoor::Readable),
+                backdoor);
+        if (!backdoor || !backdoor->ptr() ||
+            !range.isSubset(backdoor->range())) {
+            return nullptr;
+        }
+
+        // keep it until it is invalidated, unless it overlaps one we
+        // already know about
+        if (backdoors->insert(backdoor->range(), backdoor) !=
+            backdoors->end()) {
+            BackdoorCache *cache = backdoors;
+            backdoor->addInvalidationCallback(
+                [cache](const MemBackdoor &invalidated) {
+                    for (auto i = cache->begin(); i != cache->end(); ++i) {
+                        if (i->second == &invalidated) {
+                            cache->erase(i);
+                            break;
+                        }
+                    }
+                });
+        }
+    }
+
+    if (write ? !backdoor->writeable() : !backdoor->readable())
+        return nullptr;
+
+    return backdoor->ptr() + (addr - backdoor->range().start());
+}
+
 void
 PortProxy::readBlobPhys(Addr addr, Request::Flags flags,
                         void *p, int size) const
 {
+    if (uint8_t *host = backdoorPtr(addr, flags, size, false)) {
+        std::memcpy(p, host, size);
+        return;
+    }
+
     for (ChunkGenerator gen(addr, size, _cacheLineSize); !gen.done();
          gen.next()) {
 
@@ -75,6 +169,12 @@ void
 PortProxy::writeBlobPhys(Addr addr, Request::Flags flags,
                          const void *p, int size) const
 {
+    if (uint8_t *host = backdoorPtr(addr, flags, size, true)) {
+        std::memcpy(host, p, size);
+        _backdoorWrites.fetch_add(1, std::memory_order_release);
+        return;
+    }
+
     for (ChunkGenerator gen(addr, size, _cacheLineSize); !gen.done();
          gen.next()) {
 
@@ -92,6 +192,12 @@ void
 PortProxy::memsetBlobPhys(Addr addr, Request::Flags flags,
                           uint8_t v, int size) const
 {
+    if (uint8_t *host = backdoorPtr(addr, flags, size, true)) {
+        std::memset(host, v, size);
+        _backdoorWrites.fetch_add(1, std::memory_order_release);
+        return;
+    }
+
     // quick and dirty...
     uint8_t *buf = new uint8_t[size];
 
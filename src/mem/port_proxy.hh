@@ -57,9 +57,13 @@
 #ifndef __MEM_PORT_PROXY_HH__
 #define __MEM_PORT_PROXY_HH__
 
+#include <atomic>
+#include <cstdint>
 #include <functional>
 #include <limits>
 
+#include "base/addr_range_map.hh"
+#include "mem/backdoor.hh"
 #include "mem/protocol/functional.hh"
 #include "sim/byteswap.hh"
 
@@ -80,6 +84,13 @@ class ThreadContext;
  *
  * The addresses are interpreted as physical addresses.
  *
+ * Proxies for a port or thread context ask the memory for back doors,
+ * and access the memory directly through them where possible. The
+ * back doors are shared by all the proxies for the same requestor and
+ * dropped once invalidated. Anything on the way to the memory that
+ * may hold newer data, like a cache, refuses to pass on the request,
+ * in which case the proxy falls back to functional accesses.
+ *
  * @sa SETranslatingProxy
  * @sa FSTranslatingProxy
  */
@@ -87,10 +98,24 @@ class PortProxy : FunctionalRequestProtocol
 {
   public:
     typedef std::function<void(PacketPtr pkt)> SendFunctionalFunc;
+    typedef std::function<void(const MemBackdoorReq &req,
+                               MemBackdoorPtr &backdoor)>
+        SendMemBackdoorReqFunc;
+
+    /** Back doors obtained so far, by the range they cover. */
+    typedef AddrRangeMap<MemBackdoorPtr, 1> BackdoorCache;
 
   private:
     SendFunctionalFunc sendFunctional;
 
+    SendMemBackdoorReqFunc sendBackdoorReq;
+
+    /** Back doors of the requestor, or nullptr if not using any. */
+    BackdoorCache *backdoors;
+
+    /** Number of writes made through back doors by any proxy. */
+    static std::atomic<uint64_t> _backdoorWrites;
+
     /** Granularity of any transactions issued through this proxy. */
     const unsigned int _cacheLineSize;
 
@@ -102,17 +127,50 @@ class PortProxy : FunctionalRequestProtocol
         panic("Port proxies should never receive snoops.");
     }
 
+    /**
+     * Get a host pointer to a physical address range through a back
+     * door, requesting one if none is known yet.
+     *
+     * @param write Whether the range is going to be written
+     * @return The host pointer, or nullptr to access the range
+     *         functionally
+     */
+    uint8_t *backdoorPtr(Addr addr, Request::Flags flags, int size,
+                         bool write) const;
+
   public:
     PortProxy(SendFunctionalFunc func, unsigned int cache_line_size) :
-        sendFunctional(func), _cacheLineSize(cache_line_size)
+        sendFunctional(func), backdoors(nullptr),
+        _cacheLineSize(cache_line_size)
     {}
 
+    /**
+     * Create a proxy that also uses back doors. The back doors are
+     * cached for the requestor, and reused by all its proxies.
+     *
+     * @param requestor Identity of the object the requests come from
+     */
+    PortProxy(SendFunctionalFunc func, SendMemBackdoorReqFunc backdoor_func,
+              const void *requestor, unsigned int cache_line_size);
+
     // Helpers which create typical SendFunctionalFunc-s from other objects.
     PortProxy(ThreadContext *tc, unsigned int cache_line_size);
     PortProxy(const RequestPort &port, unsigned int cache_line_size);
 
     virtual ~PortProxy() {}
 
+    /**
+     * Number of writes made through back doors so far. Such writes are
+     * not snooped, so objects keeping anything derived from the
+     * contents of memory, like decoded instructions, compare this
+     * count to tell whether memory may have changed under them.
+     */
+    static uint64_t
+    backdoorWrites()
+    {
+        return _backdoorWrites.load(std::memory_order_acquire);
+    }
+
 
     /** Fixed functionality for use in base classes. */
 
@@ -49,3 +49,13 @@ class MemFootprintProbe(BaseMemProbe):
         Parent.any, "System pointer to get cache line and mem size"
     )
     page_size = Param.Unsigned(4096, "Page size for page-level footprint")
+    # Estimate the footprint with HyperLogLog sketches rather than sets
+    # of every address seen. The sketches use a fixed 2^hll_precision
+    # bytes each and have a relative standard error of about
+    # 1.04 / sqrt(2^hll_precision)
+    estimate = Param.Bool(
+        False, "Estimate footprint with HyperLogLog instead of exact sets"
+    )
+    hll_precision = Param.Unsigned(
+        12, "log2 of the number of registers per HyperLogLog sketch"
+    )
@@ -46,6 +46,10 @@ class MemTraceProbe(BaseMemProbe):
     # Boolean to compress the trace or not.
     trace_compress = Param.Bool(True, "Enable trace compression")
 
+    # Write an indexed trace that trace players can start replaying
+    # from any tick without decoding everything before it
+    trace_indexed = Param.Bool(False, "Write an indexed, seekable trace")
+
     # For requests with a valid PC, include the PC in the trace
     with_pc = Param.Bool(False, "Include PC info in the trace")
 
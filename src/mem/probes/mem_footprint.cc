@@ -38,6 +38,8 @@
 
 #include "mem/probes/mem_footprint.hh"
 
+#include <cmath>
+
 #include "base/intmath.hh"
 #include "params/MemFootprintProbe.hh"
 
@@ -50,10 +52,15 @@ MemFootprintProbe::MemFootprintProbe(const MemFootprintProbeParams &p)
       pageSizeLg2(floorLog2(p.page_size)),
       totalCacheLinesInMem(p.system->memSize() / p.system->cacheLineSize()),
       totalPagesInMem(p.system->memSize() / p.page_size),
+      estimate(p.estimate),
       cacheLines(),
       cacheLinesAll(),
       pages(),
       pagesAll(),
+      cacheLinesEst(p.hll_precision),
+      cacheLinesAllEst(p.hll_precision),
+      pagesEst(p.hll_precision),
+      pagesAllEst(p.hll_precision),
       system(p.system),
       stats(this)
 {
@@ -102,6 +109,11 @@ MemFootprintProbe::handleRequest(const probing::PacketInfo &pi)
 
     const Addr cl_addr = (pi.addr >> cacheLineSizeLg2) << cacheLineSizeLg2;
     const Addr page_addr = (pi.addr >> pageSizeLg2) << pageSizeLg2;
+    if (estimate) {
+        handleEstimate(cl_addr, page_addr);
+        return;
+    }
+
     insertAddr(cl_addr, &cacheLines, totalCacheLinesInMem);
     insertAddr(cl_addr, &cacheLinesAll, totalCacheLinesInMem);
     insertAddr(page_addr, &pages, totalPagesInMem);
@@ -116,11 +128,31 @@ MemFootprintProbe::handleRequest(const probing::PacketInfo &pi)
     stats.pageTotal = pagesAll.size() << pageSizeLg2;
 }
 
+void
+MemFootprintProbe::handleEstimate(Addr cl_addr, Addr page_addr)
+{
+    cacheLinesEst.insert(cl_addr);
+    cacheLinesAllEst.insert(cl_addr);
+    pagesEst.insert(page_addr);
+    pagesAllEst.insert(page_addr);
+
+    // The sketches keep their estimates up to date, so reading them
+    // back is cheap
+    stats.cacheLine = std::llround(cacheLinesEst.estimate()) <<
+        cacheLineSizeLg2;
+    stats.cacheLineTotal = std::llround(cacheLinesAllEst.estimate()) <<
+        cacheLineSizeLg2;
+    stats.page = std::llround(pagesEst.estimate()) << pageSizeLg2;
+    stats.pageTotal = std::llround(pagesAllEst.estimate()) << pageSizeLg2;
+}
+
 void
 MemFootprintProbe::statReset()
 {
     cacheLines.clear();
     pages.clear();
+    cacheLinesEst.clear();
+    pagesEst.clear();
 }
 
 } // namespace gem5
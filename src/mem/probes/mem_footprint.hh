@@ -42,6 +42,7 @@
 #include <unordered_set>
 
 #include "base/callback.hh"
+#include "base/hyperloglog.hh"
 #include "mem/packet.hh"
 #include "mem/probes/base.hh"
 #include "sim/stats.hh"
@@ -71,7 +72,11 @@ class MemFootprintProbe : public BaseMemProbe
     const uint64_t totalCacheLinesInMem;
     const uint64_t totalPagesInMem;
 
+    /// Estimate the footprint with HyperLogLog sketches
+    const bool estimate;
+
     void insertAddr(Addr addr, AddrSet *set, uint64_t limit);
+    void handleEstimate(Addr cl_addr, Addr page_addr);
     void handleRequest(const probing::PacketInfo &pkt_info) override;
 
     struct MemFootprintProbeStats : public statistics::Group
@@ -96,6 +101,12 @@ class MemFootprintProbe : public BaseMemProbe
     AddrSet pages;
     // Addr set to track unique pages accessed since simulation begin
     AddrSet pagesAll;
+
+    // Sketches replacing the sets above when estimating
+    HyperLogLog cacheLinesEst;
+    HyperLogLog cacheLinesAllEst;
+    HyperLogLog pagesEst;
+    HyperLogLog pagesAllEst;
     System *system;
 
     MemFootprintProbeStats stats;
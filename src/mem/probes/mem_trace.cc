@@ -74,7 +74,7 @@ MemTraceProbe::MemTraceProbe(const MemTraceProbeParams &p)
                                   (p.trace_compress ? ".gz" : ""));
     }
 
-    traceStream = new ProtoOutputStream(filename);
+    traceStream = new ProtoOutputStream(filename, p.trace_indexed);
 
     // Register a callback to compensate for the destructor not
     // being called. The callback forces the stream to flush and
@@ -121,7 +121,7 @@ MemTraceProbe::handleRequest(const probing::PacketInfo &pkt_info)
         pkt_msg.set_pc(pkt_info.pc);
     pkt_msg.set_pkt_id(pkt_info.id);
 
-    traceStream->write(pkt_msg);
+    traceStream->write(pkt_msg, curTick());
 }
 
 } // namespace gem5
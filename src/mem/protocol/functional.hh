@@ -76,7 +76,7 @@ class FunctionalRequestProtocol
      *        caller have direct access to the requested range.
      */
     void sendMemBackdoorReq(FunctionalResponseProtocol *peer,
-            const MemBackdoorReq &req, MemBackdoorPtr &backdoor);
+            const MemBackdoorReq &req, MemBackdoorPtr &backdoor) const;
 };
 
 class FunctionalResponseProtocol
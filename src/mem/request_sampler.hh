@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2024 The University of Edinburgh
+ * All rights reserved
+ *
+ * The license below extends only to copyright in the software and shall
+ * not be construed as granting a license to any other intellectual
+ * property including but not limited to intellectual property relating
+ * to a hardware implementation of the functionality of the software
+ * licensed hereunder.  You may use the software subject to the license
+ * terms below provided that you ensure that this notice is replicated
+ * unmodified and in its entirety in all distributions of the software,
+ * modified or unmodified, in source code or in binary form.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __MEM_REQUEST_SAMPLER_HH__
+#define __MEM_REQUEST_SAMPLER_HH__
+
+#include "base/types.hh"
+
+namespace gem5
+{
+
+/**
+ * Decides which requests a monitor samples for its per-request
+ * distributions. A request is sampled once at least sampleEvery
+ * requests of its class have been seen and sampleInterval has passed
+ * since the last sample of that class, and stands for all the
+ * requests of the class skipped since. Reads and writes are sampled
+ * independently so that a mix dominated by one class does not starve
+ * the other, or skew its weights.
+ */
+class RequestSampler
+{
+  private:
+    struct Class
+    {
+        /** Requests seen since the last sample */
+        unsigned unsampled = 0;
+
+        /** Earliest tick of the next sample */
+        Tick nextTick = 0;
+    };
+
+    /** Minimum number of requests between samples */
+    const unsigned sampleEvery;
+
+    /** Minimum time between samples */
+    const Tick sampleInterval;
+
+    /** Sampling state of reads and writes */
+    Class reads;
+    Class writes;
+
+  public:
+    RequestSampler(unsigned sample_every, Tick sample_interval)
+        : sampleEvery(sample_every), sampleInterval(sample_interval)
+    {}
+
+    /** Are all requests sampled */
+    bool all() const { return sampleEvery <= 1 && sampleInterval == 0; }
+
+    /** Will the next request of the given class be sampled */
+    bool
+    next(bool is_read, Tick now) const
+    {
+        const Class &c = is_read ? reads : writes;
+        return c.unsampled + 1 >= sampleEvery && now >= c.nextTick;
+    }
+
+    /**
+     * Account for a request and decide if it is sampled.
+     *
+     * @param is_read Whether the request is a read or a write
+     * @param now Current tick
+     * @return Number of requests the sample stands for, or 0 if the
+     *         request is not sampled
+     */
+    unsigned
+    sample(bool is_read, Tick now)
+    {
+        Class &c = is_read ? reads : writes;
+        ++c.unsampled;
+        if (c.unsampled < sampleEvery || now < c.nextTick)
+            return 0;
+
+        // The sample stands for all the requests skipped since the last
+        // one, which keeps the weighted counts and means unbiased
+        const unsigned weight = c.unsampled;
+        c.unsampled = 0;
+        c.nextTick = now + sampleInterval;
+        return weight;
+    }
+};
+
+} // namespace gem5
+
+#endif // __MEM_REQUEST_SAMPLER_HH__
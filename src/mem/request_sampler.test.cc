@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2024 The University of Edinburgh
+ * All rights reserved
+ *
+ * The license below extends only to copyright in the software and shall
+ * not be construed as granting a license to any other intellectual
+ * property including but not limited to intellectual property relating
+ * to a hardware implementation of the functionality of the software
+ * licensed hereunder.  You may use the software subject to the license
+ * terms below provided that you ensure that this notice is replicated
+ * unmodified and in its entirety in all distributions of the software,
+ * modified or unmodified, in source code or in binary form.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "mem/request_sampler.hh"
+
+using namespace gem5;
+
+TEST(RequestSamplerTest, SamplesEveryRequest)
+{
+    RequestSampler sampler(1, 0);
+    EXPECT_TRUE(sampler.all());
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(sampler.next(i % 2, i));
+        EXPECT_EQ(sampler.sample(i % 2, i), 1);
+    }
+}
+
+TEST(RequestSamplerTest, InterleavedReadsAndWritesSampledApart)
+{
+    RequestSampler sampler(4, 0);
+    EXPECT_FALSE(sampler.all());
+
+    // Alternate reads and writes: with a shared count every fourth
+    // request would be sampled, always a write, standing for two
+    // writes and two reads. Each class is sampled every fourth
+    // request of its own instead, standing for four of them.
+    unsigned reads = 0, writes = 0;
+    for (int i = 0; i < 16; ++i) {
+        const bool is_read = i % 2 == 0;
+        const bool expected = i % 8 >= 6;
+        EXPECT_EQ(sampler.next(is_read, i), expected) << "request " << i;
+        const unsigned weight = sampler.sample(is_read, i);
+        EXPECT_EQ(weight, expected ? 4 : 0) << "request " << i;
+        (is_read ? reads : writes) += weight;
+    }
+
+    // The weights add up to the number of requests of each class
+    EXPECT_EQ(reads, 8);
+    EXPECT_EQ(writes, 8);
+}
+
+TEST(RequestSamplerTest, RareClassNotStarved)
+{
+    RequestSampler sampler(4, 0);
+
+    // One write in every eight requests: the writes are sampled every
+    // fourth write however many reads are in between
+    unsigned reads = 0, writes = 0;
+    for (int i = 0; i < 64; ++i) {
+        const bool is_read = i % 8 != 7;
+        const unsigned weight = sampler.sample(is_read, i);
+        if (!is_read) {
+            EXPECT_EQ(weight, i % 32 == 31 ? 4 : 0) << "request " << i;
+        }
+        (is_read ? reads : writes) += weight;
+    }
+    EXPECT_EQ(reads, 56);
+    EXPECT_EQ(writes, 8);
+}
+
+TEST(RequestSamplerTest, IntervalPerClass)
+{
+    RequestSampler sampler(1, 100);
+
+    // A read and a write at the same tick are both sampled
+    EXPECT_EQ(sampler.sample(true, 0), 1);
+    EXPECT_EQ(sampler.sample(false, 0), 1);
+
+    // Until the interval has passed for each class, requests are
+    // skipped and then accounted by the next sample
+    EXPECT_EQ(sampler.sample(true, 50), 0);
+    EXPECT_EQ(sampler.sample(true, 60), 0);
+    EXPECT_EQ(sampler.sample(false, 90), 0);
+    EXPECT_FALSE(sampler.next(false, 99));
+    EXPECT_TRUE(sampler.next(true, 100));
+    EXPECT_EQ(sampler.sample(true, 100), 3);
+    EXPECT_EQ(sampler.sample(false, 150), 2);
+    EXPECT_EQ(sampler.sample(false, 200), 0);
+    EXPECT_EQ(sampler.sample(false, 250), 2);
+}
@@ -46,6 +46,8 @@ namespace gem5
 namespace ruby
 {
 
+thread_local Consumer::DeferredWakeups *Consumer::deferred = nullptr;
+
 Consumer::Consumer(ClockedObject *_em, Event::Priority ev_prio)
     : m_wakeup_event([this]{ processCurrentEvent(); },
                     "Consumer Event", false, ev_prio),
@@ -55,18 +57,35 @@ Consumer::Consumer(ClockedObject *_em, Event::Priority ev_prio)
 void
 Consumer::scheduleEvent(Cycles timeDelta)
 {
-    m_wakeup_ticks.insert(em->clockEdge(timeDelta));
-    scheduleNextWakeup();
+    scheduleWakeupAt(em->clockEdge(timeDelta));
 }
 
 void
 Consumer::scheduleEventAbsolute(Tick evt_time)
 {
-    m_wakeup_ticks.insert(
+    scheduleWakeupAt(
         divCeil(evt_time, em->clockPeriod()) * em->clockPeriod());
+}
+
+void
+Consumer::scheduleWakeupAt(Tick when)
+{
+    if (deferred) {
+        deferred->push_back({this, when});
+        return;
+    }
+    m_wakeup_ticks.insert(when);
     scheduleNextWakeup();
 }
 
+void
+Consumer::replayWakeups(const DeferredWakeups &list)
+{
+    assert(!deferred);
+    for (const auto &wakeup : list)
+        wakeup.consumer->scheduleWakeupAt(wakeup.when);
+}
+
 void
 Consumer::scheduleNextWakeup()
 {
@@ -49,6 +49,7 @@
 
 #include <iostream>
 #include <set>
+#include <vector>
 
 #include "sim/clocked_object.hh"
 
@@ -58,6 +59,8 @@ namespace gem5
 namespace ruby
 {
 
+class MessageBuffer;
+
 class Consumer
 {
   public:
@@ -72,6 +75,14 @@ class Consumer
     virtual void print(std::ostream& out) const = 0;
     virtual void storeEventInfo(int info) {}
 
+    /**
+     * Called by an input buffer of this consumer whenever a message is
+     * added to it. ready_time is the tick from which the message can be
+     * dequeued. Consumers with many input buffers can use this to track
+     * which of them hold work instead of scanning all of them on wakeup.
+     */
+    virtual void bufferEnqueued(MessageBuffer *buf, Tick ready_time) {}
+
     bool
     alreadyScheduled(Tick time)
     {
@@ -87,7 +98,29 @@ class Consumer
     void scheduleEventAbsolute(Tick timeAbs);
     void scheduleEvent(Cycles timeDelta);
 
+    /** A wakeup requested while scheduling was deferred. */
+    struct DeferredWakeup
+    {
+        Consumer *consumer;
+        Tick when;
+    };
+    typedef std::vector<DeferredWakeup> DeferredWakeups;
+
+    /**
+     * While a list is set, wakeups requested from the calling thread are
+     * appended to it instead of being scheduled. This lets worker threads
+     * evaluate consumers in parallel without touching the event queue;
+     * the owner of the list schedules the wakeups afterwards with
+     * replayWakeups(). Pass nullptr to schedule directly again.
+     */
+    static void deferWakeups(DeferredWakeups *list) { deferred = list; }
+    static void replayWakeups(const DeferredWakeups &list);
+
   private:
+    static thread_local DeferredWakeups *deferred;
+
+    void scheduleWakeupAt(Tick when);
+
     std::set<Tick> m_wakeup_ticks;
     EventFunctionWrapper m_wakeup_event;
     ClockedObject *em;
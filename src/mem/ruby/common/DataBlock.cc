@@ -49,36 +49,92 @@ namespace gem5
 namespace ruby
 {
 
+DataBlock::Buffer *
+DataBlock::newBuffer()
+{
+    const uint32_t size = RubySystem::getBlockSizeBytes();
+    Buffer *buf = static_cast<Buffer *>(
+        SizeClassPool::allocate(headerSize + size));
+    buf->refs = 1;
+    buf->size = size;
+    return buf;
+}
+
+void
+DataBlock::freeBuffer(Buffer *buf)
+{
+    SizeClassPool::deallocate(buf, headerSize + buf->size);
+}
+
 DataBlock::DataBlock(const DataBlock &cp)
 {
-    m_data = new uint8_t[RubySystem::getBlockSizeBytes()];
-    memcpy(m_data, cp.m_data, RubySystem::getBlockSizeBytes());
-    m_alloc = true;
+    if (cp.m_buf) {
+        share(cp.m_buf);
+    } else {
+        // The storage of cp is not ours to share
+        m_buf = newBuffer();
+        m_data = m_buf->bytes();
+        memcpy(m_data, cp.m_data, RubySystem::getBlockSizeBytes());
+    }
 }
 
 void
 DataBlock::alloc()
 {
-    m_data = new uint8_t[RubySystem::getBlockSizeBytes()];
-    m_alloc = true;
-    clear();
+    // Blocks start zeroed, so fresh blocks all share a zero buffer
+    // until they are written to. The buffer is replaced if the block
+    // size changes, which only happens before the simulation starts.
+    static Buffer *zero = nullptr;
+    if (!zero || zero->size != RubySystem::getBlockSizeBytes()) {
+        if (zero)
+            release(zero);
+        zero = newBuffer();
+        memset(zero->bytes(), 0, zero->size);
+    }
+    share(zero);
+}
+
+void
+DataBlock::share(Buffer *buf)
+{
+    buf->refs++;
+    m_buf = buf;
+    m_data = buf->bytes();
+}
+
+void
+DataBlock::unshare()
+{
+    Buffer *buf = newBuffer();
+    memcpy(buf->bytes(), m_data, RubySystem::getBlockSizeBytes());
+    release(m_buf);
+    m_buf = buf;
+    m_data = buf->bytes();
 }
 
 void
 DataBlock::clear()
 {
+    if (m_buf && m_buf->refs > 1) {
+        // No need to copy data that is about to be overwritten
+        release(m_buf);
+        alloc();
+        return;
+    }
     memset(m_data, 0, RubySystem::getBlockSizeBytes());
 }
 
 bool
 DataBlock::equal(const DataBlock& obj) const
 {
-    return !memcmp(m_data, obj.m_data, RubySystem::getBlockSizeBytes());
+    return m_data == obj.m_data ||
+        !memcmp(m_data, obj.m_data, RubySystem::getBlockSizeBytes());
 }
 
 void
 DataBlock::copyPartial(const DataBlock &dblk, const WriteMask &mask)
 {
+    makeWritable();
     for (int i = 0; i < RubySystem::getBlockSizeBytes(); i++) {
         if (mask.getMask(i, 1)) {
             m_data[i] = dblk.m_data[i];
@@ -89,6 +145,7 @@ DataBlock::copyPartial(const DataBlock &dblk, const WriteMask &mask)
 void
 DataBlock::atomicPartial(const DataBlock &dblk, const WriteMask &mask)
 {
+    makeWritable();
     for (int i = 0; i < RubySystem::getBlockSizeBytes(); i++) {
         m_data[i] = dblk.m_data[i];
     }
@@ -117,12 +174,14 @@ DataBlock::getData(int offset, int len) const
 uint8_t*
 DataBlock::getDataMod(int offset)
 {
+    makeWritable();
     return &m_data[offset];
 }
 
 void
 DataBlock::setData(const uint8_t *data, int offset, int len)
 {
+    makeWritable();
     memcpy(&m_data[offset], data, len);
 }
 
@@ -131,13 +190,24 @@ DataBlock::setData(PacketPtr pkt)
 {
     int offset = getOffset(pkt->getAddr());
     assert(offset + pkt->getSize() <= RubySystem::getBlockSizeBytes());
+    makeWritable();
     pkt->writeData(&m_data[offset]);
 }
 
 DataBlock &
 DataBlock::operator=(const DataBlock & obj)
 {
-    memcpy(m_data, obj.m_data, RubySystem::getBlockSizeBytes());
+    if (m_buf && obj.m_buf) {
+        if (m_buf != obj.m_buf) {
+            release(m_buf);
+            share(obj.m_buf);
+        }
+    } else if (m_data != obj.m_data) {
+        // Either block uses storage provided by assign(), which must
+        // keep receiving the data written to this block
+        makeWritable();
+        memcpy(m_data, obj.m_data, RubySystem::getBlockSizeBytes());
+    }
     return *this;
 }
 
@@ -47,6 +47,7 @@
 #include <iomanip>
 #include <iostream>
 
+#include "base/pool_alloc.hh"
 #include "mem/packet.hh"
 
 namespace gem5
@@ -57,6 +58,16 @@ namespace ruby
 
 class WriteMask;
 
+/**
+ * The data of a cache block. Copies of a DataBlock share their storage,
+ * which is reference counted and only duplicated when one of the copies
+ * is written to, so that messages carrying a block (including the
+ * clones made for multicast) do not each allocate and copy it.
+ *
+ * Accessors that modify the block make it private first; a pointer
+ * returned by getDataMod() must therefore not be kept across a copy of
+ * the block.
+ */
 class DataBlock
 {
   public:
@@ -69,8 +80,8 @@ class DataBlock
 
     ~DataBlock()
     {
-        if (m_alloc)
-            delete [] m_data;
+        if (m_buf)
+            release(m_buf);
     }
 
     DataBlock& operator=(const DataBlock& obj);
@@ -91,20 +102,62 @@ class DataBlock
     void print(std::ostream& out) const;
 
   private:
+    /**
+     * Reference counted block storage, allocated from the size-class
+     * pool. The bytes of the block follow the header in the same chunk.
+     * The count is not atomic: a block is only ever accessed by the
+     * thread simulating the Ruby system.
+     */
+    struct Buffer
+    {
+        uint32_t refs;
+        uint32_t size;
+
+        uint8_t *
+        bytes()
+        {
+            return reinterpret_cast<uint8_t *>(this) + headerSize;
+        }
+    };
+    static constexpr size_t headerSize = SizeClassPool::Granularity;
+    static_assert(sizeof(Buffer) <= headerSize);
+
+    static Buffer *newBuffer();
+    static void freeBuffer(Buffer *buf);
+
+    static void
+    release(Buffer *buf)
+    {
+        if (--buf->refs == 0)
+            freeBuffer(buf);
+    }
+
     void alloc();
+    void share(Buffer *buf);
+
+    /** Give this block its own copy of the data before writing to it. */
+    void
+    makeWritable()
+    {
+        if (m_buf && m_buf->refs > 1)
+            unshare();
+    }
+    void unshare();
+
     uint8_t *m_data;
-    bool m_alloc;
+    // Storage of m_data, or nullptr if m_data was provided by assign()
+    Buffer *m_buf;
 };
 
 inline void
 DataBlock::assign(uint8_t *data)
 {
     assert(data != NULL);
-    if (m_alloc) {
-        delete [] m_data;
+    if (m_buf) {
+        release(m_buf);
     }
     m_data = data;
-    m_alloc = false;
+    m_buf = nullptr;
 }
 
 inline uint8_t
@@ -116,6 +169,7 @@ DataBlock::getByte(int whichByte) const
 inline void
 DataBlock::setByte(int whichByte, uint8_t data)
 {
+    makeWritable();
     m_data[whichByte] = data;
 }
 
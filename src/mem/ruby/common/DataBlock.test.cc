@@ -0,0 +1,216 @@
+/*
+ * Copyright (c) 2024 The University of Edinburgh
+ * All rights reserved
+ *
+ * The license below extends only to copyright in the software and shall
+ * not be construed as granting a license to any other intellectual
+ * property including but not limited to intellectual property relating
+ * to a hardware implementation of the functionality of the software
+ * licensed hereunder.  You may use the software subject to the license
+ * terms below provided that you ensure that this notice is replicated
+ * unmodified and in its entirety in all distributions of the software,
+ * modified or unmodified, in source code or in binary form.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "mem/ruby/common/DataBlock.hh"
+#include "mem/ruby/common/WriteMask.hh"
+#include "mem/ruby/system/RubySystem.hh"
+
+using namespace gem5;
+using namespace gem5::ruby;
+
+// RubySystem.cc is not linked in, the block size is all that is needed
+uint32_t RubySystem::m_block_size_bytes = 64;
+uint32_t RubySystem::m_block_size_bits = 6;
+
+namespace
+{
+
+const int blockSize = 64;
+
+/** Whether two blocks use the same storage */
+bool
+shared(const DataBlock &a, const DataBlock &b)
+{
+    return a.getData(0, blockSize) == b.getData(0, blockSize);
+}
+
+DataBlock
+pattern(uint8_t seed)
+{
+    DataBlock blk;
+    for (int i = 0; i < blockSize; i++)
+        blk.setByte(i, seed + i);
+    return blk;
+}
+
+void
+expectPattern(const DataBlock &blk, uint8_t seed)
+{
+    for (int i = 0; i < blockSize; i++)
+        EXPECT_EQ(blk.getByte(i), (uint8_t)(seed + i)) << "byte " << i;
+}
+
+} // anonymous namespace
+
+TEST(DataBlockTest, FreshBlocksAreZero)
+{
+    DataBlock a, b;
+    EXPECT_TRUE(shared(a, b));
+    for (int i = 0; i < blockSize; i++)
+        EXPECT_EQ(a.getByte(i), 0);
+
+    a.setByte(3, 7);
+    EXPECT_FALSE(shared(a, b));
+    EXPECT_EQ(b.getByte(3), 0);
+
+    // A new block is still zero after another one was written
+    DataBlock c;
+    EXPECT_EQ(c.getByte(3), 0);
+}
+
+TEST(DataBlockTest, CopiesShareStorage)
+{
+    DataBlock a = pattern(1);
+    DataBlock b(a);
+    EXPECT_TRUE(shared(a, b));
+
+    DataBlock c;
+    c = a;
+    EXPECT_TRUE(shared(a, c));
+    EXPECT_TRUE(a == c);
+}
+
+/**
+ * A write through either copy gives it its own storage, and leaves the
+ * other copy untouched. Every modifying accessor is checked, writing
+ * once through the copy and once through the original.
+ */
+class DataBlockWriteTest : public ::testing::TestWithParam<int>
+{
+  protected:
+    void
+    write(DataBlock &blk)
+    {
+        switch (GetParam()) {
+          case 0:
+            blk.setByte(5, 0xff);
+            break;
+          case 1: {
+            const uint8_t data[4] = {0xff, 0xff, 0xff, 0xff};
+            blk.setData(data, 4, sizeof(data));
+            break;
+          }
+          case 2:
+            blk.copyPartial(pattern(0x80), 8, 8);
+            break;
+          case 3: {
+            WriteMask mask;
+            mask.setMask(16, 4);
+            blk.copyPartial(pattern(0x80), mask);
+            break;
+          }
+          case 4: {
+            WriteMask mask;
+            blk.atomicPartial(pattern(0x80), mask);
+            break;
+          }
+          case 5:
+            *blk.getDataMod(0) = 0xff;
+            break;
+          case 6:
+            blk.clear();
+            break;
+        }
+    }
+};
+
+TEST_P(DataBlockWriteTest, WriteToCopyDetaches)
+{
+    DataBlock a = pattern(1);
+    DataBlock b(a);
+    ASSERT_TRUE(shared(a, b));
+
+    write(b);
+    EXPECT_FALSE(shared(a, b));
+    EXPECT_FALSE(a == b);
+    expectPattern(a, 1);
+}
+
+TEST_P(DataBlockWriteTest, WriteToOriginalDetaches)
+{
+    DataBlock a = pattern(1);
+    DataBlock b;
+    b = a;
+    ASSERT_TRUE(shared(a, b));
+
+    write(a);
+    EXPECT_FALSE(shared(a, b));
+    EXPECT_FALSE(a == b);
+    expectPattern(b, 1);
+}
+
+INSTANTIATE_TEST_SUITE_P(Writers, DataBlockWriteTest, ::testing::Range(0, 7));
+
+/** A block that is not shared is written in place. */
+TEST(DataBlockTest, PrivateBlockWrittenInPlace)
+{
+    DataBlock a = pattern(1);
+    const uint8_t *storage = a.getData(0, blockSize);
+    a.setByte(0, 0xff);
+    EXPECT_EQ(a.getData(0, blockSize), storage);
+
+    // The storage goes back to private once the other copy is gone
+    {
+        DataBlock b(a);
+        EXPECT_TRUE(shared(a, b));
+    }
+    a.setByte(1, 0xff);
+    EXPECT_EQ(a.getData(0, blockSize), storage);
+}
+
+/** Blocks backed by external storage never share it. */
+TEST(DataBlockTest, AssignedStorageIsNotShared)
+{
+    std::vector<uint8_t> backing(blockSize, 0x11);
+    DataBlock a;
+    a.assign(backing.data());
+
+    DataBlock b(a);
+    EXPECT_FALSE(shared(a, b));
+    EXPECT_EQ(b.getByte(0), 0x11);
+
+    // Data assigned to the block lands in the external storage
+    a = pattern(1);
+    EXPECT_EQ(a.getData(0, blockSize), backing.data());
+    EXPECT_EQ(backing[2], 3);
+    EXPECT_EQ(b.getByte(2), 0x11);
+}
@@ -293,6 +293,7 @@ MessageBuffer::enqueue(MsgPtr message, Tick current_time, Tick delta)
     assert(m_consumer != NULL);
     m_consumer->scheduleEventAbsolute(arrival_time);
     m_consumer->storeEventInfo(m_vnet_id);
+    m_consumer->bufferEnqueued(this, arrival_time);
 }
 
 Tick
@@ -377,6 +378,7 @@ MessageBuffer::recycle(Tick current_time, Tick recycle_latency)
     m_prio_heap.back() = node;
     push_heap(m_prio_heap.begin(), m_prio_heap.end(), std::greater<MsgPtr>());
     m_consumer->scheduleEventAbsolute(future_time);
+    m_consumer->bufferEnqueued(this, future_time);
 }
 
 void
@@ -391,6 +393,7 @@ MessageBuffer::reanalyzeList(std::list<MsgPtr> &lt, Tick schdTick)
                   std::greater<MsgPtr>());
 
         m_consumer->scheduleEventAbsolute(schdTick);
+        m_consumer->bufferEnqueued(this, m->getLastEnqueueTime());
 
         DPRINTF(RubyQueue, "Requeue arrival_time: %lld, Message: %s\n",
             schdTick, *(m.get()));
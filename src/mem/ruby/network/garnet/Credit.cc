@@ -60,7 +60,7 @@ Credit::serialize(int ser_id, int parts, uint32_t bWidth)
     if ((ser_id+1 == parts) && m_is_free_signal) {
         new_free = true;
     }
-    Credit *new_credit_flit = new Credit(m_vc, new_free, m_time);
+    Credit *new_credit_flit = new (pool()) Credit(m_vc, new_free, m_time);
     return new_credit_flit;
 }
 
@@ -72,10 +72,10 @@ Credit::deserialize(int des_id, int num_flits, uint32_t bWidth)
     if (m_is_free_signal) {
         // We are not going to get anymore credits for this vc
         // So send a credit in any case
-        return new Credit(m_vc, true, m_time);
+        return new (pool()) Credit(m_vc, true, m_time);
     }
 
-    return new Credit(m_vc, false, m_time);
+    return new (pool()) Credit(m_vc, false, m_time);
 }
 
 void
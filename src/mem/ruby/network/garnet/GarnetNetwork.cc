@@ -43,6 +43,7 @@
 #include "mem/ruby/network/garnet/GarnetLink.hh"
 #include "mem/ruby/network/garnet/NetworkInterface.hh"
 #include "mem/ruby/network/garnet/NetworkLink.hh"
+#include "mem/ruby/network/garnet/ParallelEvaluator.hh"
 #include "mem/ruby/network/garnet/Router.hh"
 #include "mem/ruby/system/RubySystem.hh"
 
@@ -70,6 +71,7 @@ GarnetNetwork::GarnetNetwork(const Params &p)
     m_buffers_per_data_vc = p.buffers_per_data_vc;
     m_buffers_per_ctrl_vc = p.buffers_per_ctrl_vc;
     m_routing_algorithm = p.routing_algorithm;
+    m_parallel_threads = p.parallel_threads;
     m_next_packet_id = 0;
 
     m_enable_fault_model = p.enable_fault_model;
@@ -150,6 +152,22 @@ GarnetNetwork::init()
             router->printFaultVector(std::cout);
         }
     }
+
+    if (m_parallel_threads > 0) {
+        // Routers evaluated in the same tick must not be able to observe
+        // each other's output, which holds as long as every link takes
+        // at least one cycle. Links are the synchronization quantum.
+        Cycles min_latency = Cycles(MaxTick);
+        for (auto link : m_networklinks)
+            min_latency = std::min(min_latency, link->getLatency());
+        for (auto link : m_creditlinks)
+            min_latency = std::min(min_latency, link->getLatency());
+        fatal_if(min_latency < 1, "Parallel Garnet evaluation requires "
+                 "link latencies of at least one cycle.");
+
+        m_parallel_evaluator.reset(
+            new ParallelEvaluator(this, m_routers, m_parallel_threads));
+    }
 }
 
 /*
@@ -33,11 +33,14 @@
 #define __MEM_RUBY_NETWORK_GARNET_0_GARNETNETWORK_HH__
 
 #include <iostream>
+#include <memory>
 #include <vector>
 
+#include "base/pool_alloc.hh"
 #include "mem/ruby/network/Network.hh"
 #include "mem/ruby/network/fault_model/FaultModel.hh"
 #include "mem/ruby/network/garnet/CommonTypes.hh"
+#include "mem/ruby/network/garnet/ParallelEvaluator.hh"
 #include "params/GarnetNetwork.hh"
 
 namespace gem5
@@ -82,6 +85,18 @@ class GarnetNetwork : public Network
     int getRoutingAlgorithm() const { return m_routing_algorithm; }
 
     bool isFaultModelEnabled() const { return m_enable_fault_model; }
+
+    // Routers are evaluated on host worker threads, nullptr otherwise
+    ParallelEvaluator *
+    getParallelEvaluator() const
+    {
+        return m_parallel_evaluator.get();
+    }
+    bool isParallel() const { return m_parallel_threads > 0; }
+
+    // Storage of the flits and credits of this network
+    SizeClassPool::Domain &flitPool() { return m_flit_pool; }
+
     FaultModel* fault_model;
 
 
@@ -167,6 +182,7 @@ class GarnetNetwork : public Network
     uint32_t m_buffers_per_data_vc;
     int m_routing_algorithm;
     bool m_enable_fault_model;
+    uint32_t m_parallel_threads;
 
     // Statistical variables
     statistics::Vector m_packets_received;
@@ -214,6 +230,10 @@ class GarnetNetwork : public Network
     std::vector<CreditLink *> m_creditlinks; // All credit links in the network
     std::vector<NetworkInterface *> m_nis;   // All NI's in Network
     int m_next_packet_id; // static vairable for packet id allocation
+
+    std::unique_ptr<ParallelEvaluator> m_parallel_evaluator;
+
+    SizeClassPool::Domain m_flit_pool;
 };
 
 inline std::ostream&
@@ -35,6 +35,10 @@ from m5.objects.BasicRouter import BasicRouter
 from m5.objects.ClockedObject import ClockedObject
 
 
+class GarnetSwitchAllocator(Enum):
+    vals = ["Separable", "ISLIP"]
+
+
 class GarnetNetwork(RubyNetwork):
     type = "GarnetNetwork"
     cxx_header = "mem/ruby/network/garnet/GarnetNetwork.hh"
@@ -51,6 +55,26 @@ class GarnetNetwork(RubyNetwork):
     garnet_deadlock_threshold = Param.UInt32(
         50000, "network-level deadlock threshold"
     )
+    parallel_threads = Param.UInt32(
+        0,
+        "Number of host threads evaluating the routers. 0 evaluates each "
+        "router from its own event. With 1 or more, the routers woken up "
+        "in a cycle are evaluated together, which requires link latencies "
+        "of at least one cycle. Results do not depend on the number of "
+        "threads, and match those with 0 unless routes have several "
+        "equally weighted output links, which are then picked from "
+        "per-router generators instead of rand(). Debug tracing of the "
+        "routers is not thread safe in this mode.",
+    )
+    sa_policy = Param.GarnetSwitchAllocator(
+        "Separable",
+        "Switch allocator of the routers. Separable: one input VC per "
+        "input port requests its output port, with independent round "
+        "robin arbiters at the output ports. ISLIP: input ports request "
+        "every output port they have a flit for, and are matched by "
+        "iSLIP over sa_iterations iterations.",
+    )
+    sa_iterations = Param.UInt32(1, "Number of iSLIP iterations per cycle")
 
 
 class GarnetNetworkInterface(ClockedObject):
@@ -83,3 +107,9 @@ class GarnetRouter(BasicRouter):
     width = Param.UInt32(
         Parent.ni_flit_size, "bit width supported by the router"
     )
+    sa_policy = Param.GarnetSwitchAllocator(
+        Parent.sa_policy, "Switch allocator of the router"
+    )
+    sa_iterations = Param.UInt32(
+        Parent.sa_iterations, "Number of iSLIP iterations per cycle"
+    )
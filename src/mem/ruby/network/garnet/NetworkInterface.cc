@@ -248,8 +248,8 @@ NetworkInterface::wakeup()
 
                     // Simply send a credit back since we are not buffering
                     // this flit in the NI
-                    Credit *cFlit = new Credit(t_flit->get_vc(),
-                                               true, curTick());
+                    Credit *cFlit = new (m_net_ptr->flitPool())
+                        Credit(t_flit->get_vc(), true, curTick());
                     iPort->sendCredit(cFlit);
                     // Update stats and delete flit pointer
                     incrementStats(t_flit);
@@ -267,8 +267,8 @@ NetworkInterface::wakeup()
                 }
             } else {
                 // Non-tail flit. Send back a credit but not VC free signal.
-                Credit *cFlit = new Credit(t_flit->get_vc(), false,
-                                               curTick());
+                Credit *cFlit = new (m_net_ptr->flitPool())
+                    Credit(t_flit->get_vc(), false, curTick());
                 // Simply send a credit back since we are not buffering
                 // this flit in the NI
                 iPort->sendCredit(cFlit);
@@ -336,8 +336,8 @@ NetworkInterface::checkStallQueue()
 
                     // Send back a credit with free signal now that the
                     // VC is no longer stalled.
-                    Credit *cFlit = new Credit(stallFlit->get_vc(), true,
-                                                   curTick());
+                    Credit *cFlit = new (m_net_ptr->flitPool())
+                        Credit(stallFlit->get_vc(), true, curTick());
                     iPort->sendCredit(cFlit);
 
                     // Update Stats
@@ -439,7 +439,7 @@ NetworkInterface::flitisizeMessage(MsgPtr msg_ptr, int vnet)
         int packet_id = m_net_ptr->getNextPacketID();
         for (int i = 0; i < num_flits; i++) {
             m_net_ptr->increment_injected_flits(vnet);
-            flit *fl = new flit(packet_id,
+            flit *fl = new (m_net_ptr->flitPool()) flit(packet_id,
                 i, vc, vnet, route, num_flits, new_msg_ptr,
                 m_net_ptr->MessageSizeType_to_int(
                 net_msg_ptr->getMessageSize()),
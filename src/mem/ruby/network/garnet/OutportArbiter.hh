@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2024 The University of Edinburgh
+ * All rights reserved
+ *
+ * The license below extends only to copyright in the software and shall
+ * not be construed as granting a license to any other intellectual
+ * property including but not limited to intellectual property relating
+ * to a hardware implementation of the functionality of the software
+ * licensed hereunder.  You may use the software subject to the license
+ * terms below provided that you ensure that this notice is replicated
+ * unmodified and in its entirety in all distributions of the software,
+ * modified or unmodified, in source code or in binary form.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __MEM_RUBY_NETWORK_GARNET_0_OUTPORTARBITER_HH__
+#define __MEM_RUBY_NETWORK_GARNET_0_OUTPORTARBITER_HH__
+
+#include <cassert>
+#include <vector>
+
+#include "base/ready_mask.hh"
+
+namespace gem5
+{
+
+namespace ruby
+{
+
+namespace garnet
+{
+
+/**
+ * Second stage (SA-II) of the separable switch allocator: each
+ * requested outport is granted to the first requesting inport at or
+ * after its round-robin pointer, and the pointer then moves past the
+ * winner. This picks the same winners as scanning every inport from the
+ * pointer, but only visits the requested outports.
+ *
+ * @param requests Inports requesting each outport.
+ * @param requested Outports with at least one request.
+ * @param round_robin Round-robin pointer of each outport.
+ * @param grant Called as grant(outport, inport), by increasing outport.
+ */
+template <class Grant>
+void
+arbitrate_outports_rr(const std::vector<ReadyMask> &requests,
+                      const ReadyMask &requested,
+                      std::vector<int> &round_robin, Grant grant)
+{
+    requested.forEach([&](int outport) {
+        const ReadyMask &inports = requests[outport];
+        int inport = inports.nextWrapped(round_robin[outport]);
+        assert(inport >= 0);
+
+        grant(outport, inport);
+
+        round_robin[outport] = inport + 1;
+        if (round_robin[outport] >= inports.size())
+            round_robin[outport] = 0;
+    });
+}
+
+} // namespace garnet
+} // namespace ruby
+} // namespace gem5
+
+#endif // __MEM_RUBY_NETWORK_GARNET_0_OUTPORTARBITER_HH__
@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2024 The University of Edinburgh
+ * All rights reserved
+ *
+ * The license below extends only to copyright in the software and shall
+ * not be construed as granting a license to any other intellectual
+ * property including but not limited to intellectual property relating
+ * to a hardware implementation of the functionality of the software
+ * licensed hereunder.  You may use the software subject to the license
+ * terms below provided that you ensure that this notice is replicated
+ * unmodified and in its entirety in all distributions of the software,
+ * modified or unmodified, in source code or in binary form.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "mem/ruby/network/garnet/ParallelEvaluator.hh"
+
+#include "base/logging.hh"
+#include "base/trace.hh"
+#include "debug/RubyNetwork.hh"
+#include "mem/ruby/network/garnet/GarnetNetwork.hh"
+#include "mem/ruby/network/garnet/Router.hh"
+
+namespace gem5
+{
+
+namespace ruby
+{
+
+namespace garnet
+{
+
+ParallelEvaluator::ParallelEvaluator(GarnetNetwork *network,
+                                     const std::vector<Router *> &routers,
+                                     unsigned num_threads)
+    : m_network(network),
+      m_num_threads(std::max(1u, std::min<unsigned>(num_threads,
+                                                    routers.size()))),
+      m_eventq(network->eventQueue()),
+      m_pending(m_num_threads),
+      m_is_pending(routers.size(), 0),
+      m_deferred(routers.size()),
+      m_eval_event([this]{ evaluate(); },
+                   network->name() + ".parallelEval", false),
+      m_start_barrier(m_num_threads), m_done_barrier(m_num_threads),
+      m_stopping(false)
+{
+    // contiguous blocks of router ids keep neighbouring routers of a
+    // mesh in the same partition
+    m_partition_of.resize(routers.size());
+    for (int i = 0; i < routers.size(); i++) {
+        assert(routers[i]->get_id() == i);
+        m_partition_of[i] = (uint64_t)i * m_num_threads / routers.size();
+    }
+
+    for (unsigned p = 1; p < m_num_threads; p++)
+        m_workers.emplace_back([this, p]{ workerLoop(p); });
+
+    inform("%s: evaluating %d routers on %d threads\n", network->name(),
+           routers.size(), m_num_threads);
+}
+
+ParallelEvaluator::~ParallelEvaluator()
+{
+    if (m_workers.empty())
+        return;
+
+    m_stopping = true;
+    m_start_barrier.wait();
+    for (auto &worker : m_workers)
+        worker.join();
+}
+
+void
+ParallelEvaluator::schedule(Router *router)
+{
+    int id = router->get_id();
+    if (m_is_pending[id])
+        return;
+
+    m_is_pending[id] = 1;
+    m_pending[m_partition_of[id]].push_back(router);
+
+    if (!m_eval_event.scheduled())
+        m_network->schedule(m_eval_event, curTick());
+}
+
+void
+ParallelEvaluator::evaluate()
+{
+    DPRINTF(RubyNetwork, "Evaluating routers on %d threads\n",
+            m_num_threads);
+
+    if (m_num_threads > 1)
+        m_start_barrier.wait();
+    evaluatePartition(0);
+    if (m_num_threads > 1)
+        m_done_barrier.wait();
+
+    for (auto &wakeups : m_deferred) {
+        if (!wakeups.empty()) {
+            Consumer::replayWakeups(wakeups);
+            wakeups.clear();
+        }
+    }
+}
+
+void
+ParallelEvaluator::evaluatePartition(unsigned partition)
+{
+    for (Router *router : m_pending[partition]) {
+        int id = router->get_id();
+        Consumer::deferWakeups(&m_deferred[id]);
+        router->evaluate();
+        m_is_pending[id] = 0;
+    }
+    Consumer::deferWakeups(nullptr);
+    m_pending[partition].clear();
+}
+
+void
+ParallelEvaluator::workerLoop(unsigned partition)
+{
+    // curTick() and the clock edges of the routers are read through the
+    // current event queue of the calling thread
+    curEventQueue(m_eventq);
+
+    while (true) {
+        m_start_barrier.wait();
+        if (m_stopping)
+            return;
+        evaluatePartition(partition);
+        m_done_barrier.wait();
+    }
+}
+
+} // namespace garnet
+} // namespace ruby
+} // namespace gem5
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2024 The University of Edinburgh
+ * All rights reserved
+ *
+ * The license below extends only to copyright in the software and shall
+ * not be construed as granting a license to any other intellectual
+ * property including but not limited to intellectual property relating
+ * to a hardware implementation of the functionality of the software
+ * licensed hereunder.  You may use the software subject to the license
+ * terms below provided that you ensure that this notice is replicated
+ * unmodified and in its entirety in all distributions of the software,
+ * modified or unmodified, in source code or in binary form.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __MEM_RUBY_NETWORK_GARNET_0_PARALLELEVALUATOR_HH__
+#define __MEM_RUBY_NETWORK_GARNET_0_PARALLELEVALUATOR_HH__
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "base/barrier.hh"
+#include "mem/ruby/common/Consumer.hh"
+#include "sim/eventq.hh"
+
+namespace gem5
+{
+
+namespace ruby
+{
+
+namespace garnet
+{
+
+class GarnetNetwork;
+class Router;
+
+/**
+ * Evaluates the routers of a GarnetNetwork on a pool of host threads.
+ *
+ * A router woken up by its own event does not run its pipeline right
+ * away; it is queued here instead, and a single evaluation event, at the
+ * same priority as the router events, runs all queued routers once the
+ * router events already due in this tick have fired. The routers are
+ * statically partitioned into contiguous blocks of router ids, one per
+ * thread.
+ *
+ * This is safe because routers only communicate through links and credit
+ * links, whose latency is at least one cycle: a flit or credit produced
+ * in this tick can not be consumed by another router before the next
+ * one. Routers therefore only touch their own state while being
+ * evaluated, with one exception, event scheduling. Wakeups requested by
+ * a router (its own, or those of the links it feeds) are recorded per
+ * router and scheduled by the main thread once all partitions are done,
+ * in router id order. The outcome of a tick is therefore independent of
+ * the number of threads and of the partitioning, and the same as with
+ * serial evaluation, where the order of the routers within a tick is
+ * equally unobservable. Random route choices come from per-router
+ * generators in this mode for the same reason, so they only match
+ * serial runs, which use rand(), where routes have a single candidate.
+ */
+class ParallelEvaluator
+{
+  public:
+    ParallelEvaluator(GarnetNetwork *network,
+                      const std::vector<Router *> &routers,
+                      unsigned num_threads);
+    ~ParallelEvaluator();
+
+    /** Queue a router for evaluation later in the current tick. */
+    void schedule(Router *router);
+
+    unsigned numThreads() const { return m_num_threads; }
+
+  private:
+    void evaluate();
+    void evaluatePartition(unsigned partition);
+    void workerLoop(unsigned partition);
+
+    GarnetNetwork *m_network;
+    const unsigned m_num_threads;
+    EventQueue *m_eventq;
+
+    // partition of each router; indexed by router id
+    std::vector<unsigned> m_partition_of;
+    // routers queued in the current tick; indexed by partition
+    std::vector<std::vector<Router *>> m_pending;
+    std::vector<uint8_t> m_is_pending;
+    // wakeups requested during evaluation; indexed by router id
+    std::vector<Consumer::DeferredWakeups> m_deferred;
+
+    EventFunctionWrapper m_eval_event;
+
+    std::vector<std::thread> m_workers;
+    Barrier m_start_barrier;
+    Barrier m_done_barrier;
+    bool m_stopping;
+};
+
+} // namespace garnet
+} // namespace ruby
+} // namespace gem5
+
+#endif // __MEM_RUBY_NETWORK_GARNET_0_PARALLELEVALUATOR_HH__
@@ -38,6 +38,7 @@
 #include "mem/ruby/network/garnet/InputUnit.hh"
 #include "mem/ruby/network/garnet/NetworkLink.hh"
 #include "mem/ruby/network/garnet/OutputUnit.hh"
+#include "mem/ruby/network/garnet/ParallelEvaluator.hh"
 
 namespace gem5
 {
@@ -52,6 +53,7 @@ Router::Router(const Params &p)
   : BasicRouter(p), Consumer(this), m_latency(p.latency),
     m_virtual_networks(p.virt_nets), m_vc_per_vnet(p.vcs_per_vnet),
     m_num_vcs(m_virtual_networks * m_vc_per_vnet), m_bit_width(p.width),
+    m_sa_policy(p.sa_policy), m_sa_iterations(p.sa_iterations),
     m_network_ptr(nullptr), routingUnit(this), switchAllocator(this),
     crossbarSwitch(this)
 {
@@ -70,6 +72,20 @@ Router::init()
 
 void
 Router::wakeup()
+{
+    // With parallel evaluation the pipeline runs later in this tick,
+    // together with the other routers woken up in this tick
+    ParallelEvaluator *evaluator = m_network_ptr->getParallelEvaluator();
+    if (evaluator) {
+        evaluator->schedule(this);
+        return;
+    }
+
+    evaluate();
+}
+
+void
+Router::evaluate()
 {
     DPRINTF(RubyNetwork, "Router %d woke up\n", m_id);
     assert(clockEdge() == curTick());
@@ -72,6 +72,8 @@ class Router : public BasicRouter, public Consumer
     ~Router() = default;
 
     void wakeup();
+    // Run one cycle of the router pipeline
+    void evaluate();
     void print(std::ostream& out) const {};
 
     void init();
@@ -89,6 +91,8 @@ class Router : public BasicRouter, public Consumer
     int get_num_inports()   { return m_input_unit.size(); }
     int get_num_outports()  { return m_output_unit.size(); }
     int get_id()            { return m_id; }
+    enums::GarnetSwitchAllocator get_sa_policy() { return m_sa_policy; }
+    int get_sa_iterations() { return m_sa_iterations; }
 
     void init_net_ptr(GarnetNetwork* net_ptr)
     {
@@ -146,6 +150,8 @@ class Router : public BasicRouter, public Consumer
     Cycles m_latency;
     uint32_t m_virtual_networks, m_vc_per_vnet, m_num_vcs;
     uint32_t m_bit_width;
+    enums::GarnetSwitchAllocator m_sa_policy;
+    int m_sa_iterations;
     GarnetNetwork *m_network_ptr;
 
     RoutingUnit routingUnit;
@@ -31,6 +31,7 @@
 #ifndef __MEM_RUBY_NETWORK_GARNET_0_ROUTINGUNIT_HH__
 #define __MEM_RUBY_NETWORK_GARNET_0_ROUTINGUNIT_HH__
 
+#include "base/random.hh"
 #include "mem/ruby/common/Consumer.hh"
 #include "mem/ruby/common/NetDest.hh"
 #include "mem/ruby/network/garnet/CommonTypes.hh"
@@ -86,6 +87,11 @@ class RoutingUnit
   private:
     Router *m_router;
 
+    // Per-router generator for route selection when the routers are
+    // evaluated in parallel, where a shared generator would make the
+    // choice depend on the evaluation order
+    Random m_rng;
+
     // Routing Table
     std::vector<std::vector<NetDest>> m_routing_table;
     std::vector<int> m_weight_table;
@@ -31,10 +31,12 @@
 
 #include "mem/ruby/network/garnet/SwitchAllocator.hh"
 
+#include "base/logging.hh"
 #include "debug/RubyNetwork.hh"
 #include "mem/ruby/network/garnet/GarnetNetwork.hh"
 #include "mem/ruby/network/garnet/InputUnit.hh"
 #include "mem/ruby/network/garnet/OutputUnit.hh"
+#include "mem/ruby/network/garnet/OutportArbiter.hh"
 #include "mem/ruby/network/garnet/Router.hh"
 
 namespace gem5
@@ -62,6 +64,8 @@ SwitchAllocator::init()
 {
     m_num_inports = m_router->get_num_inports();
     m_num_outports = m_router->get_num_outports();
+    m_policy = m_router->get_sa_policy();
+    m_iterations = m_router->get_sa_iterations();
     m_round_robin_inport.resize(m_num_outports);
     m_round_robin_invc.resize(m_num_inports);
     m_port_requests.resize(m_num_inports);
@@ -76,6 +80,31 @@ SwitchAllocator::init()
     for (int i = 0; i < m_num_outports; i++) {
         m_round_robin_inport[i] = 0;
     }
+
+    m_outport_requests.resize(m_num_outports);
+    for (auto &mask : m_outport_requests)
+        mask.resize(m_num_inports);
+    m_requested_outports.resize(m_num_outports);
+
+    // Only used by iSLIP, but clear_request_vector() walks it
+    m_requesting_inports.resize(m_num_inports);
+
+    if (m_policy == enums::ISLIP) {
+        fatal_if(m_iterations < 1, "Router %d: the iSLIP switch allocator "
+                 "needs at least one iteration\n", m_router->get_id());
+
+        m_inport_requests.resize(m_num_inports);
+        m_grants.resize(m_num_inports);
+        for (int i = 0; i < m_num_inports; i++) {
+            m_inport_requests[i].resize(m_num_outports);
+            m_grants[i].resize(m_num_outports);
+        }
+        m_granted_inports.resize(m_num_inports);
+        m_matched_outports.resize(m_num_outports);
+        m_matched_inport.assign(m_num_outports, -1);
+        m_request_vc.assign(m_num_inports * m_num_outports, -1);
+        m_round_robin_accept.assign(m_num_inports, 0);
+    }
 }
 
 /*
@@ -90,8 +119,13 @@ SwitchAllocator::init()
 void
 SwitchAllocator::wakeup()
 {
-    arbitrate_inports(); // First stage of allocation
-    arbitrate_outports(); // Second stage of allocation
+    if (m_policy == enums::ISLIP) {
+        islip_request();
+        islip_match();
+    } else {
+        arbitrate_inports(); // First stage of allocation
+        arbitrate_outports(); // Second stage of allocation
+    }
 
     clear_request_vector();
     check_for_wakeup();
@@ -133,6 +167,8 @@ SwitchAllocator::arbitrate_inports()
                     m_input_arbiter_activity++;
                     m_port_requests[inport] = outport;
                     m_vc_winners[inport] = invc;
+                    m_outport_requests[outport].set(inport);
+                    m_requested_outports.set(outport);
 
                     break; // got one vc winner for this port
                 }
@@ -164,106 +200,220 @@ SwitchAllocator::arbitrate_outports()
 {
     // Now there are a set of input vc requests for output vcs.
     // Again do round robin arbitration on these requests
-    // Independent arbiter at each output port
-    for (int outport = 0; outport < m_num_outports; outport++) {
-        int inport = m_round_robin_inport[outport];
+    // Independent arbiter at each output port. Only the outports that
+    // were requested are visited, and each arbiter picks the first
+    // requesting inport at or after its round robin pointer.
+    arbitrate_outports_rr(m_outport_requests, m_requested_outports,
+                          m_round_robin_inport,
+                          [&](int outport, int inport) {
+        assert(m_port_requests[inport] == outport);
+
+        // grant this outport to this inport
+        grant(outport, inport, m_vc_winners[inport]);
+
+        // remove this request
+        m_port_requests[inport] = -1;
+    });
+}
 
-        for (int inport_iter = 0; inport_iter < m_num_inports;
-                 inport_iter++) {
+/*
+ * Grants outport to the flit at the head of invc in inport.
+ *      - For HEAD/HEAD_TAIL flits, performs simplified outvc allocation.
+ *        (i.e., select a free VC from the output port).
+ *      - For BODY/TAIL flits, decrement a credit in the output vc.
+ * The winning flit is read out from the input VC and sent to the
+ * CrossbarSwitch.
+ * An increment_credit signal is sent from the InputUnit
+ * to the upstream router. For HEAD_TAIL/TAIL flits, is_free_signal in the
+ * credit is set to true.
+ */
 
-            // inport has a request this cycle for outport
-            if (m_port_requests[inport] == outport) {
-                auto output_unit = m_router->getOutputUnit(outport);
-                auto input_unit = m_router->getInputUnit(inport);
+void
+SwitchAllocator::grant(int outport, int inport, int invc)
+{
+    auto output_unit = m_router->getOutputUnit(outport);
+    auto input_unit = m_router->getInputUnit(inport);
 
-                // grant this outport to this inport
-                int invc = m_vc_winners[inport];
+    int outvc = input_unit->get_outvc(invc);
+    if (outvc == -1) {
+        // VC Allocation - select any free VC from outport
+        outvc = vc_allocate(outport, inport, invc);
+    }
 
+    // remove flit from Input VC
+    flit *t_flit = input_unit->getTopFlit(invc);
+
+    DPRINTF(RubyNetwork, "SwitchAllocator at Router %d "
+                         "granted outvc %d at outport %d "
+                         "to invc %d at inport %d to flit %s at "
+                         "cycle: %lld\n",
+            m_router->get_id(), outvc,
+            m_router->getPortDirectionName(
+                output_unit->get_direction()),
+            invc,
+            m_router->getPortDirectionName(
+                input_unit->get_direction()),
+                *t_flit,
+            m_router->curCycle());
+
+
+    // Update outport field in the flit since this is
+    // used by CrossbarSwitch code to send it out of
+    // correct outport.
+    // Note: post route compute in InputUnit,
+    // outport is updated in VC, but not in flit
+    t_flit->set_outport(outport);
+
+    // set outvc (i.e., invc for next hop) in flit
+    // (This was updated in VC by vc_allocate, but not in flit)
+    t_flit->set_vc(outvc);
+
+    // decrement credit in outvc
+    output_unit->decrement_credit(outvc);
+
+    // flit ready for Switch Traversal
+    t_flit->advance_stage(ST_, curTick());
+    m_router->grant_switch(inport, t_flit);
+    m_output_arbiter_activity++;
+
+    if ((t_flit->get_type() == TAIL_) ||
+        t_flit->get_type() == HEAD_TAIL_) {
+
+        // This Input VC should now be empty
+        assert(!(input_unit->isReady(invc, curTick())));
+
+        // Free this VC
+        input_unit->set_vc_idle(invc, curTick());
+
+        // Send a credit back
+        // along with the information that this VC is now idle
+        input_unit->increment_credit(invc, true, curTick());
+    } else {
+        // Send a credit back
+        // but do not indicate that the VC is idle
+        input_unit->increment_credit(invc, false, curTick());
+    }
+
+    // Update Round Robin pointer to the next VC
+    // We do it here to keep it fair.
+    // Only the VC which got switch traversal
+    // is updated.
+    m_round_robin_invc[inport] = invc + 1;
+    if (m_round_robin_invc[inport] >= m_num_vcs)
+        m_round_robin_invc[inport] = 0;
+}
+
+/*
+ * iSLIP request stage. Unlike SA-I, an input port is not limited to a
+ * single request: it requests every output port for which one of its
+ * input VCs is allowed to send. The first such VC in round robin order
+ * is the one that uses the output port if the two ports get matched.
+ */
+
+void
+SwitchAllocator::islip_request()
+{
+    for (int inport = 0; inport < m_num_inports; inport++) {
+        auto input_unit = m_router->getInputUnit(inport);
+        int invc = m_round_robin_invc[inport];
+
+        for (int invc_iter = 0; invc_iter < m_num_vcs; invc_iter++) {
+            if (input_unit->need_stage(invc, SA_, curTick())) {
+                int outport = input_unit->get_outport(invc);
                 int outvc = input_unit->get_outvc(invc);
-                if (outvc == -1) {
-                    // VC Allocation - select any free VC from outport
-                    outvc = vc_allocate(outport, inport, invc);
-                }
 
-                // remove flit from Input VC
-                flit *t_flit = input_unit->getTopFlit(invc);
-
-                DPRINTF(RubyNetwork, "SwitchAllocator at Router %d "
-                                     "granted outvc %d at outport %d "
-                                     "to invc %d at inport %d to flit %s at "
-                                     "cycle: %lld\n",
-                        m_router->get_id(), outvc,
-                        m_router->getPortDirectionName(
-                            output_unit->get_direction()),
-                        invc,
-                        m_router->getPortDirectionName(
-                            input_unit->get_direction()),
-                            *t_flit,
-                        m_router->curCycle());
-
-
-                // Update outport field in the flit since this is
-                // used by CrossbarSwitch code to send it out of
-                // correct outport.
-                // Note: post route compute in InputUnit,
-                // outport is updated in VC, but not in flit
-                t_flit->set_outport(outport);
-
-                // set outvc (i.e., invc for next hop) in flit
-                // (This was updated in VC by vc_allocate, but not in flit)
-                t_flit->set_vc(outvc);
-
-                // decrement credit in outvc
-                output_unit->decrement_credit(outvc);
-
-                // flit ready for Switch Traversal
-                t_flit->advance_stage(ST_, curTick());
-                m_router->grant_switch(inport, t_flit);
-                m_output_arbiter_activity++;
-
-                if ((t_flit->get_type() == TAIL_) ||
-                    t_flit->get_type() == HEAD_TAIL_) {
-
-                    // This Input VC should now be empty
-                    assert(!(input_unit->isReady(invc, curTick())));
-
-                    // Free this VC
-                    input_unit->set_vc_idle(invc, curTick());
-
-                    // Send a credit back
-                    // along with the information that this VC is now idle
-                    input_unit->increment_credit(invc, true, curTick());
-                } else {
-                    // Send a credit back
-                    // but do not indicate that the VC is idle
-                    input_unit->increment_credit(invc, false, curTick());
+                if (!m_inport_requests[inport].test(outport) &&
+                    send_allowed(inport, invc, outport, outvc)) {
+                    m_input_arbiter_activity++;
+                    m_inport_requests[inport].set(outport);
+                    m_request_vc[inport * m_num_outports + outport] = invc;
+                    m_requesting_inports.set(inport);
+                    m_outport_requests[outport].set(inport);
+                    m_requested_outports.set(outport);
                 }
+            }
 
-                // remove this request
-                m_port_requests[inport] = -1;
+            invc++;
+            if (invc >= m_num_vcs)
+                invc = 0;
+        }
+    }
+}
 
-                // Update Round Robin pointer
-                m_round_robin_inport[outport] = inport + 1;
-                if (m_round_robin_inport[outport] >= m_num_inports)
-                    m_round_robin_inport[outport] = 0;
+/*
+ * iSLIP matching. In each iteration every unmatched output port grants
+ * the first requesting unmatched input port after its round robin
+ * pointer, and every input port accepts the first granting output port
+ * after its accept pointer. The pointers only move past grants accepted
+ * in the first iteration, which keeps the output arbiters from staying
+ * synchronised under load. The matched flits are then switched in
+ * output port order.
+ */
 
-                // Update Round Robin pointer to the next VC
-                // We do it here to keep it fair.
-                // Only the VC which got switch traversal
-                // is updated.
-                m_round_robin_invc[inport] = invc + 1;
-                if (m_round_robin_invc[inport] >= m_num_vcs)
-                    m_round_robin_invc[inport] = 0;
+void
+SwitchAllocator::islip_match()
+{
+    for (int iter = 0; iter < m_iterations; iter++) {
+        // Grant
+        bool granted = false;
+        for (int outport = m_requested_outports.next(0, m_num_outports);
+             outport < m_num_outports;
+             outport = m_requested_outports.next(outport + 1,
+                                                 m_num_outports)) {
+            int inport = m_outport_requests[outport].nextWrapped(
+            m_round_robin_inport[outport]);
+            if (inport < 0)
+                continue;
+            m_grants[inport].set(outport);
+            m_granted_inports.set(inport);
+            granted = true;
+        }
 
+        if (!granted)
+            break;
 
-                break; // got a input winner for this outport
+        // Accept
+        for (int inport = m_granted_inports.next(0, m_num_inports);
+             inport < m_num_inports;
+             inport = m_granted_inports.next(inport + 1, m_num_inports)) {
+            int outport = m_grants[inport].nextWrapped(
+                m_round_robin_accept[inport]);
+            m_grants[inport].reset();
+
+            m_vc_winners[inport] =
+                m_request_vc[inport * m_num_outports + outport];
+            m_matched_inport[outport] = inport;
+            m_matched_outports.set(outport);
+
+            if (iter == 0) {
+                m_round_robin_inport[outport] = inport + 1;
+                if (m_round_robin_inport[outport] >= m_num_inports)
+                    m_round_robin_inport[outport] = 0;
+                m_round_robin_accept[inport] = outport + 1;
+                if (m_round_robin_accept[inport] >= m_num_outports)
+                    m_round_robin_accept[inport] = 0;
             }
 
-            inport++;
-            if (inport >= m_num_inports)
-                inport = 0;
+            // Neither port takes part in the following iterations
+            auto &requested = m_inport_requests[inport];
+            for (int o = requested.next(0, m_num_outports);
+                 o < m_num_outports;
+                 o = requested.next(o + 1, m_num_outports)) {
+                m_outport_requests[o].clear(inport);
+            }
+            m_outport_requests[outport].reset();
+            m_requested_outports.clear(outport);
         }
+        m_granted_inports.reset();
+    }
+
+    for (int outport = m_matched_outports.next(0, m_num_outports);
+         outport < m_num_outports;
+         outport = m_matched_outports.next(outport + 1, m_num_outports)) {
+        int inport = m_matched_inport[outport];
+        grant(outport, inport, m_vc_winners[inport]);
     }
+    m_matched_outports.reset();
 }
 
 /*
@@ -387,6 +537,20 @@ void
 SwitchAllocator::clear_request_vector()
 {
     std::fill(m_port_requests.begin(), m_port_requests.end(), -1);
+
+    for (int outport = m_requested_outports.next(0, m_num_outports);
+         outport < m_num_outports;
+         outport = m_requested_outports.next(outport + 1, m_num_outports)) {
+        m_outport_requests[outport].reset();
+    }
+    m_requested_outports.reset();
+
+    for (int inport = m_requesting_inports.next(0, m_num_inports);
+         inport < m_num_inports;
+         inport = m_requesting_inports.next(inport + 1, m_num_inports)) {
+        m_inport_requests[inport].reset();
+    }
+    m_requesting_inports.reset();
 }
 
 void
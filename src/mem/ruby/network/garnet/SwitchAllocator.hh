@@ -32,9 +32,12 @@
 #ifndef __MEM_RUBY_NETWORK_GARNET_0_SWITCHALLOCATOR_HH__
 #define __MEM_RUBY_NETWORK_GARNET_0_SWITCHALLOCATOR_HH__
 
+#include <cstdint>
 #include <iostream>
 #include <vector>
 
+#include "base/ready_mask.hh"
+#include "enums/GarnetSwitchAllocator.hh"
 #include "mem/ruby/common/Consumer.hh"
 #include "mem/ruby/network/garnet/CommonTypes.hh"
 
@@ -63,6 +66,8 @@ class SwitchAllocator : public Consumer
     void print(std::ostream& out) const {};
     void arbitrate_inports();
     void arbitrate_outports();
+    void islip_request();
+    void islip_match();
     bool send_allowed(int inport, int invc, int outport, int outvc);
     int vc_allocate(int outport, int inport, int invc);
 
@@ -80,9 +85,15 @@ class SwitchAllocator : public Consumer
     void resetStats();
 
   private:
+    void grant(int outport, int inport, int invc);
+
     int m_num_inports, m_num_outports;
     int m_num_vcs, m_vc_per_vnet;
 
+    // Allocation policy and number of iSLIP iterations
+    enums::GarnetSwitchAllocator m_policy;
+    int m_iterations;
+
     double m_input_arbiter_activity, m_output_arbiter_activity;
 
     Router *m_router;
@@ -90,6 +101,22 @@ class SwitchAllocator : public Consumer
     std::vector<int> m_round_robin_inport;
     std::vector<int> m_port_requests;
     std::vector<int> m_vc_winners;
+
+    // Inports requesting each outport, and outports with any request.
+    // Populated by SA-I and consumed by SA-II.
+    std::vector<ReadyMask> m_outport_requests;
+    ReadyMask m_requested_outports;
+
+    // iSLIP only: outports requested by each inport and the input VC
+    // making that request, indexed by inport * m_num_outports + outport.
+    std::vector<ReadyMask> m_inport_requests;
+    ReadyMask m_requesting_inports;
+    std::vector<int> m_request_vc;
+    std::vector<ReadyMask> m_grants;
+    ReadyMask m_granted_inports;
+    ReadyMask m_matched_outports;
+    std::vector<int> m_matched_inport;
+    std::vector<int> m_round_robin_accept;
 };
 
 } // namespace garnet
@@ -83,8 +83,8 @@ flit::serialize(int ser_id, int parts, uint32_t bWidth)
     int new_size = (int)divCeil((float)msgSize, (float)bWidth);
     assert(new_id < new_size);
 
-    flit *fl = new flit(m_packet_id, new_id, m_vc, m_vnet, m_route,
-                    new_size, m_msg_ptr, msgSize, bWidth, m_time);
+    flit *fl = new (pool()) flit(m_packet_id, new_id, m_vc, m_vnet,
+                    m_route, new_size, m_msg_ptr, msgSize, bWidth, m_time);
     fl->set_enqueue_time(m_enqueue_time);
     fl->set_src_delay(src_delay);
     return fl;
@@ -98,8 +98,8 @@ flit::deserialize(int des_id, int num_flits, uint32_t bWidth)
     int new_size = (int)divCeil((float)msgSize, (float)bWidth);
     assert(new_id < new_size);
 
-    flit *fl = new flit(m_packet_id, new_id, m_vc, m_vnet, m_route,
-                    new_size, m_msg_ptr, msgSize, bWidth, m_time);
+    flit *fl = new (pool()) flit(m_packet_id, new_id, m_vc, m_vnet,
+                    m_route, new_size, m_msg_ptr, msgSize, bWidth, m_time);
     fl->set_enqueue_time(m_enqueue_time);
     fl->set_src_delay(src_delay);
     return fl;
@@ -34,6 +34,7 @@
 #include <cassert>
 #include <iostream>
 
+#include "base/pool_alloc.hh"
 #include "base/types.hh"
 #include "mem/ruby/network/garnet/CommonTypes.hh"
 #include "mem/ruby/slicc_interface/Message.hh"
@@ -47,7 +48,16 @@ namespace ruby
 namespace garnet
 {
 
-class flit
+/**
+ * Flits and credits are created and destroyed at a very high rate, so
+ * their storage is recycled through the pool of their network, see
+ * GarnetNetwork::flitPool(), rather than going back to the general
+ * purpose allocator on every hop. They are created with
+ * new (pool) flit(...). With parallel router evaluation they are often
+ * freed by another thread than the one that created them; the pool
+ * returns them to their owner.
+ */
+class flit : public DomainPoolAllocated
 {
   public:
     flit() {}
@@ -116,6 +126,13 @@ class flit
     uint32_t m_width;
     int msgSize;
   protected:
+    /** Pool this flit came from, for the flits derived from it */
+    SizeClassPool::Domain &
+    pool() const
+    {
+        return *SizeClassPool::Domain::of(this);
+    }
+
     int m_packet_id;
     int m_id;
     int m_vnet;
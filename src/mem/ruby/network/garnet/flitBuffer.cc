@@ -40,26 +40,42 @@ namespace ruby
 namespace garnet
 {
 
+// Initial capacity of the ring, a power of two
+static const size_t initialCapacity = 8;
+
 flitBuffer::flitBuffer()
+    : flitBuffer(INFINITE_)
 {
-    max_size = INFINITE_;
 }
 
 flitBuffer::flitBuffer(int maximum_size)
+    : m_ring(initialCapacity, nullptr), m_mask(initialCapacity - 1),
+      m_head(0), m_count(0)
 {
     max_size = maximum_size;
 }
 
+void
+flitBuffer::grow()
+{
+    std::vector<flit *> ring(2 * m_ring.size(), nullptr);
+    for (size_t i = 0; i < m_count; ++i)
+        ring[i] = at(i);
+    m_ring.swap(ring);
+    m_mask = m_ring.size() - 1;
+    m_head = 0;
+}
+
 bool
 flitBuffer::isEmpty()
 {
-    return (m_buffer.size() == 0);
+    return (m_count == 0);
 }
 
 bool
 flitBuffer::isReady(Tick curTime)
 {
-    if (m_buffer.size() != 0 ) {
+    if (m_count != 0 ) {
         flit *t_flit = peekTopFlit();
         if (t_flit->get_time() <= curTime)
             return true;
@@ -70,13 +86,13 @@ flitBuffer::isReady(Tick curTime)
 void
 flitBuffer::print(std::ostream& out) const
 {
-    out << "[flitBuffer: " << m_buffer.size() << "] " << std::endl;
+    out << "[flitBuffer: " << m_count << "] " << std::endl;
 }
 
 bool
 flitBuffer::isFull()
 {
-    return (m_buffer.size() >= max_size);
+    return (m_count >= max_size);
 }
 
 void
@@ -89,8 +105,8 @@ bool
 flitBuffer::functionalRead(Packet *pkt, WriteMask &mask)
 {
     bool read = false;
-    for (unsigned int i = 0; i < m_buffer.size(); ++i) {
-        if (m_buffer[i]->functionalRead(pkt, mask)) {
+    for (size_t i = 0; i < m_count; ++i) {
+        if (at(i)->functionalRead(pkt, mask)) {
             read = true;
         }
     }
@@ -103,8 +119,8 @@ flitBuffer::functionalWrite(Packet *pkt)
 {
     uint32_t num_functional_writes = 0;
 
-    for (unsigned int i = 0; i < m_buffer.size(); ++i) {
-        if (m_buffer[i]->functionalWrite(pkt)) {
+    for (size_t i = 0; i < m_count; ++i) {
+        if (at(i)->functionalWrite(pkt)) {
             num_functional_writes++;
         }
     }
@@ -32,6 +32,7 @@
 #define __MEM_RUBY_NETWORK_GARNET_0_FLITBUFFER_HH__
 
 #include <algorithm>
+#include <cassert>
 #include <iostream>
 #include <vector>
 
@@ -58,33 +59,48 @@ class flitBuffer
     void print(std::ostream& out) const;
     bool isFull();
     void setMaxSize(int maximum);
-    int getSize() const { return m_buffer.size(); }
+    int getSize() const { return m_count; }
 
     flit *
     getTopFlit()
     {
-        flit *f = m_buffer.front();
-        m_buffer.pop_front();
+        assert(m_count > 0);
+        flit *f = m_ring[m_head];
+        m_head = (m_head + 1) & m_mask;
+        m_count--;
         return f;
     }
 
     flit *
     peekTopFlit()
     {
-        return m_buffer.front();
+        assert(m_count > 0);
+        return m_ring[m_head];
     }
 
     void
     insert(flit *flt)
     {
-        m_buffer.push_back(flt);
+        if (m_count == m_ring.size())
+            grow();
+        m_ring[(m_head + m_count) & m_mask] = flt;
+        m_count++;
     }
 
     bool functionalRead(Packet *pkt, WriteMask &mask);
     uint32_t functionalWrite(Packet *pkt);
 
   private:
-    std::deque<flit *> m_buffer;
+    flit *at(size_t idx) const { return m_ring[(m_head + idx) & m_mask]; }
+    void grow();
+
+    // Flits are kept in a ring whose capacity is a power of two. It only
+    // grows, by doubling, so once a buffer has seen its peak occupancy
+    // inserting and removing flits never allocates.
+    std::vector<flit *> m_ring;
+    size_t m_mask;
+    size_t m_head;
+    size_t m_count;
     int max_size;
 };
 
@@ -61,7 +61,7 @@ const int PRIORITY_SWITCH_LIMIT = 128;
 
 PerfectSwitch::PerfectSwitch(SwitchID sid, Switch *sw, uint32_t virt_nets)
     : Consumer(sw, Switch::PERFECTSWITCH_EV_PRI),
-      m_switch_id(sid), m_switch(sw)
+      m_switch_id(sid), m_switch(sw), perfectSwitchStats(sw)
 {
     m_wakeups_wo_switch = 0;
     m_virtual_networks = virt_nets;
@@ -116,6 +116,27 @@ PerfectSwitch::updatePriorityGroups(int vnet, MessageBuffer* in_buf)
             m_in_prio_groups[vnet].emplace_back();
         m_in_prio_groups[vnet].back().push_back(buf);
     }
+
+    // reset the ready tracking of the groups, ports are only added
+    // before any message is sent
+    while (m_in_pending.size() <= vnet)
+        m_in_pending.emplace_back();
+    m_in_pending[vnet].clear();
+    for (int prio_lv = 0; prio_lv < m_in_prio_groups[vnet].size();
+         ++prio_lv) {
+        const auto &group = m_in_prio_groups[vnet][prio_lv];
+        m_in_pending[vnet].emplace_back();
+        m_in_pending[vnet].back().ready.resize(group.size());
+        for (int i = 0; i < group.size(); ++i) {
+            MessageBuffer *buf = group[i];
+            int port = buf->getIncomingLink();
+            while (m_in_slot.size() <= port)
+                m_in_slot.emplace_back();
+            while (m_in_slot[port].size() <= vnet)
+                m_in_slot[port].emplace_back(-1, -1);
+            m_in_slot[port][vnet] = std::make_pair(prio_lv, i);
+        }
+    }
 }
 
 void
@@ -155,30 +176,55 @@ PerfectSwitch::operateVnet(int vnet)
     if (m_pending_message_count[vnet] == 0)
         return;
 
-    for (auto &in : m_in_prio_groups[vnet]) {
+    Tick current_time = m_switch->clockEdge();
+
+    for (int prio_lv = 0; prio_lv < m_in_prio_groups[vnet].size();
+         ++prio_lv) {
+        auto &in = m_in_prio_groups[vnet][prio_lv];
+        PendingBuffers &pending = m_in_pending[vnet][prio_lv];
+        const int num_in = in.size();
+
+        // none of the messages in this group can be dequeued yet
+        if (pending.nextReady > current_time) {
+            perfectSwitchStats.groupsSkipped++;
+            perfectSwitchStats.bufferScansAvoided += num_in;
+            continue;
+        }
+
         // first check the port with the oldest message
         unsigned start_in_port = 0;
         Tick lowest_tick = MaxTick;
-        for (int i = 0; i < in.size(); ++i) {
-            MessageBuffer *buffer = in[i];
-            if (buffer) {
-                Tick ready_time = buffer->readyTime();
-                if (ready_time < lowest_tick){
-                    lowest_tick = ready_time;
-                    start_in_port = i;
-                }
+        pending.ready.forEach([&](int i) {
+            Tick ready_time = in[i]->readyTime();
+            if (ready_time < lowest_tick){
+                lowest_tick = ready_time;
+                start_in_port = i;
             }
-        }
+        });
         DPRINTF(RubyNetwork, "vnet %d: %d pending msgs. "
                             "Checking port %d first\n",
                 vnet, m_pending_message_count[vnet], start_in_port);
-        // check all ports starting with the one with the oldest message
-        for (int i = 0; i < in.size(); ++i) {
-            int in_port = (i + start_in_port) % in.size();
-            MessageBuffer *buffer = in[in_port];
-            if (buffer)
-                operateMessageBuffer(buffer, vnet);
-        }
+        // check all ports holding messages starting with the one with the
+        // oldest message. Empty buffers are skipped, visiting them would
+        // not route anything.
+        int visited = 0;
+        pending.ready.forEachFrom(start_in_port, [&](int i) {
+            operateMessageBuffer(in[i], vnet);
+            visited++;
+        });
+        perfectSwitchStats.bufferScans += visited;
+        perfectSwitchStats.bufferScansAvoided += num_in - visited;
+
+        // drop the buffers we drained and update the earliest ready tick
+        pending.nextReady = MaxTick;
+        pending.ready.forEach([&](int i) {
+            if (in[i]->isEmpty()) {
+                pending.ready.clear(i);
+            } else {
+                pending.nextReady = std::min(pending.nextReady,
+                                             in[i]->readyTime());
+            }
+        });
     }
 }
 
@@ -304,6 +350,16 @@ PerfectSwitch::storeEventInfo(int info)
     m_pending_message_count[info]++;
 }
 
+void
+PerfectSwitch::bufferEnqueued(MessageBuffer *buf, Tick ready_time)
+{
+    const auto &slot = m_in_slot[buf->getIncomingLink()][buf->getVnet()];
+    assert(slot.first >= 0);
+    PendingBuffers &pending = m_in_pending[buf->getVnet()][slot.first];
+    pending.ready.set(slot.second);
+    pending.nextReady = std::min(pending.nextReady, ready_time);
+}
+
 void
 PerfectSwitch::clearStats()
 {
@@ -320,5 +376,19 @@ PerfectSwitch::print(std::ostream& out) const
     out << "[PerfectSwitch " << m_switch_id << "]";
 }
 
+PerfectSwitch::
+PerfectSwitchStats::PerfectSwitchStats(Switch *parent)
+    : statistics::Group(parent, "perfect_switch"),
+      ADD_STAT(bufferScans, statistics::units::Count::get(),
+               "Number of input buffers visited on wakeups"),
+      ADD_STAT(bufferScansAvoided, statistics::units::Count::get(),
+               "Number of input buffer visits skipped because the buffer "
+               "held no message ready to be routed"),
+      ADD_STAT(groupsSkipped, statistics::units::Count::get(),
+               "Number of priority groups skipped on wakeups because none "
+               "of their messages was ready")
+{
+}
+
 } // namespace ruby
 } // namespace gem5
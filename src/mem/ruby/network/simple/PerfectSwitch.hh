@@ -52,6 +52,8 @@
 #include <string>
 #include <vector>
 
+#include "base/ready_mask.hh"
+#include "base/statistics.hh"
 #include "mem/ruby/common/Consumer.hh"
 #include "mem/ruby/common/TypeDefines.hh"
 
@@ -88,6 +90,7 @@ class PerfectSwitch : public Consumer
 
     void wakeup();
     void storeEventInfo(int info);
+    void bufferEnqueued(MessageBuffer *buf, Tick ready_time) override;
 
     void clearStats();
     void collateStats();
@@ -122,6 +125,24 @@ class PerfectSwitch : public Consumer
 
     void updatePriorityGroups(int vnet, MessageBuffer* buf);
 
+    /**
+     * Input buffers of one priority group that may hold messages, as a
+     * bitmap over their position in the group, together with a lower
+     * bound on the tick at which the earliest of those messages becomes
+     * ready. A wakeup only visits the buffers flagged here and skips the
+     * group entirely if none of its messages can be ready yet.
+     */
+    struct PendingBuffers
+    {
+        ReadyMask ready;
+        Tick nextReady = MaxTick;
+    };
+    // indexed by vnet,prio_lv; mirrors m_in_prio_groups
+    std::vector<std::vector<PendingBuffers>> m_in_pending;
+
+    // (prio_lv, position) of each input buffer; indexed by in_port,vnet
+    std::vector<std::vector<std::pair<int, int>>> m_in_slot;
+
     uint32_t m_virtual_networks;
     int m_wakeups_wo_switch;
 
@@ -129,6 +150,15 @@ class PerfectSwitch : public Consumer
     std::vector<int> m_pending_message_count;
 
     MessageBuffer* inBuffer(int in_port, int vnet) const;
+
+    struct PerfectSwitchStats : public statistics::Group
+    {
+        PerfectSwitchStats(Switch *parent);
+
+        statistics::Scalar bufferScans;
+        statistics::Scalar bufferScansAvoided;
+        statistics::Scalar groupsSkipped;
+    } perfectSwitchStats;
 };
 
 inline std::ostream&
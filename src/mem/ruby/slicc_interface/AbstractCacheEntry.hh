@@ -48,6 +48,7 @@
 #include <iostream>
 
 #include "base/logging.hh"
+#include "base/pool_alloc.hh"
 #include "mem/cache/replacement_policies/replaceable_entry.hh"
 #include "mem/ruby/common/Address.hh"
 #include "mem/ruby/common/DataBlock.hh"
@@ -59,7 +60,13 @@ namespace gem5
 namespace ruby
 {
 
-class AbstractCacheEntry : public ReplaceableEntry
+/**
+ * Cache entries are created with new in the SLICC generated actions and
+ * deleted by CacheMemory on deallocation. Drawing them from the size-class
+ * pool keeps that churn away from the system allocator without requiring
+ * any change to the protocol sources.
+ */
+class AbstractCacheEntry : public ReplaceableEntry, public PoolAllocated
 {
   private:
     // The last access tick for the cache entry.
@@ -106,6 +106,12 @@ AbstractController::init()
         }
         downstreamDestinations.add(mid);
     }
+    for (const auto &i : downstreamAddrMap) {
+        if (!downstreamAddrDecoder[i.first].build(i.second.begin(),
+                                                  i.second.end())) {
+            downstreamAddrDecoder.erase(i.first);
+        }
+    }
     // Initialize the addr->upstream machine list.
     // We do not need to map address -> upstream machine,
     // so we don't examine the address ranges
@@ -413,6 +419,22 @@ AbstractController::mapAddressToMachine(Addr addr, MachineType mtype) const
     return mach;
 }
 
+const MachineID *
+AbstractController::findDownstreamMachine(Addr addr, MachineType mtype) const
+{
+    const auto d = downstreamAddrDecoder.find(mtype);
+    if (d != downstreamAddrDecoder.end())
+        return d->second.find(addr);
+
+    const auto i = downstreamAddrMap.find(mtype);
+    if (i != downstreamAddrMap.end()) {
+        const auto mapping = i->second.contains(addr);
+        if (mapping != i->second.end())
+            return &mapping->second;
+    }
+    return nullptr;
+}
+
 MachineID
 AbstractController::mapAddressToDownstreamMachine(Addr addr, MachineType mtype)
 const
@@ -420,18 +442,13 @@ const
     if (mtype == MachineType_NUM) {
         // map to the first match
         for (const auto &i : downstreamAddrMap) {
-            const auto mapping = i.second.contains(addr);
-            if (mapping != i.second.end())
-                return mapping->second;
+            if (const MachineID *mid = findDownstreamMachine(addr, i.first))
+                return *mid;
         }
     }
     else {
-        const auto i = downstreamAddrMap.find(mtype);
-        if (i != downstreamAddrMap.end()) {
-            const auto mapping = i->second.contains(addr);
-            if (mapping != i->second.end())
-                return mapping->second;
-        }
+        if (const MachineID *mid = findDownstreamMachine(addr, mtype))
+            return *mid;
     }
     fatal("%s: couldn't find mapping for address %x mtype=%s\n",
         name(), addr, mtype);
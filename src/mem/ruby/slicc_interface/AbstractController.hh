@@ -47,6 +47,7 @@
 #include <unordered_map>
 
 #include "base/addr_range.hh"
+#include "base/addr_range_decoder.hh"
 #include "base/addr_range_map.hh"
 #include "base/callback.hh"
 #include "mem/packet.hh"
@@ -408,6 +409,13 @@ class AbstractController : public ClockedObject, public Consumer
     std::unordered_map<MachineType, AddrRangeMap<MachineID, 3>>
       downstreamAddrMap;
 
+    // Flattened copies of downstreamAddrMap used for the lookups
+    std::unordered_map<MachineType, AddrRangeDecoder<MachineID>>
+      downstreamAddrDecoder;
+
+    const MachineID *findDownstreamMachine(Addr addr,
+                                           MachineType mtype) const;
+
     NetDest downstreamDestinations;
     NetDest upstreamDestinations;
 
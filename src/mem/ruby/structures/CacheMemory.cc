@@ -97,16 +97,17 @@ CacheMemory::init()
     m_cache_num_set_bits = floorLog2(m_cache_num_sets);
     assert(m_cache_num_set_bits > 0);
 
-    m_cache.resize(m_cache_num_sets,
-                    std::vector<AbstractCacheEntry*>(m_cache_assoc, nullptr));
-    replacement_data.resize(m_cache_num_sets,
-                               std::vector<ReplData>(m_cache_assoc, nullptr));
+    const size_t num_lines = (size_t)m_cache_num_sets * m_cache_assoc;
+    m_cache.assign(num_lines, nullptr);
+    m_tags.assign(num_lines, invalidTag);
+    m_use_tag_index = m_cache_assoc > maxScannedAssoc;
+    if (m_use_tag_index)
+        m_tag_index.reserve(num_lines);
+
+    replacement_data.resize(num_lines);
     // instantiate all the replacement_data here
-    for (int i = 0; i < m_cache_num_sets; i++) {
-        for ( int j = 0; j < m_cache_assoc; j++) {
-            replacement_data[i][j] =
-                                m_replacementPolicy_ptr->instantiateEntry();
-        }
+    for (auto &repl_data : replacement_data) {
+        repl_data = m_replacementPolicy_ptr->instantiateEntry();
     }
 }
 
@@ -114,10 +115,8 @@ CacheMemory::~CacheMemory()
 {
     if (m_replacementPolicy_ptr)
         delete m_replacementPolicy_ptr;
-    for (int i = 0; i < m_cache_num_sets; i++) {
-        for (int j = 0; j < m_cache_assoc; j++) {
-            delete m_cache[i][j];
-        }
+    for (auto entry : m_cache) {
+        delete entry;
     }
 }
 
@@ -135,13 +134,10 @@ CacheMemory::addressToCacheSet(Addr address) const
 int
 CacheMemory::findTagInSet(int64_t cacheSet, Addr tag) const
 {
-    assert(tag == makeLineAddress(tag));
-    // search the set for the tags
-    auto it = m_tag_index.find(tag);
-    if (it != m_tag_index.end())
-        if (m_cache[cacheSet][it->second]->m_Permission !=
-            AccessPermission_NotPresent)
-            return it->second;
+    int loc = findTagInSetIgnorePermissions(cacheSet, tag);
+    if (loc != -1 &&
+        entryAt(cacheSet, loc)->m_Permission != AccessPermission_NotPresent)
+        return loc;
     return -1; // Not found
 }
 
@@ -152,13 +148,43 @@ CacheMemory::findTagInSetIgnorePermissions(int64_t cacheSet,
                                            Addr tag) const
 {
     assert(tag == makeLineAddress(tag));
+    if (m_use_tag_index) {
+        const int *way = m_tag_index.find(tag);
+        if (way)
+            return *way;
+        return -1; // Not found
+    }
+
     // search the set for the tags
-    auto it = m_tag_index.find(tag);
-    if (it != m_tag_index.end())
-        return it->second;
+    const Addr *tags = &m_tags[lineIndex(cacheSet, 0)];
+    for (int i = 0; i < m_cache_assoc; i++) {
+        if (tags[i] == tag)
+            return i;
+    }
     return -1; // Not found
 }
 
+void
+CacheMemory::setTag(int64_t cacheSet, int way, Addr tag)
+{
+    clearTag(cacheSet, way);
+    m_tags[lineIndex(cacheSet, way)] = tag;
+    if (m_use_tag_index)
+        m_tag_index.assign(tag, way);
+}
+
+void
+CacheMemory::clearTag(int64_t cacheSet, int way)
+{
+    Addr &tag = m_tags[lineIndex(cacheSet, way)];
+    if (m_use_tag_index && tag != invalidTag) {
+        const int *indexed_way = m_tag_index.find(tag);
+        if (indexed_way && *indexed_way == way)
+            m_tag_index.erase(tag);
+    }
+    tag = invalidTag;
+}
+
 // Given an unique cache block identifier (idx): return the valid address
 // stored by the cache block.  If the block is invalid/notpresent, the
 // function returns the 0 address
@@ -173,7 +199,7 @@ CacheMemory::getAddressAtIdx(int idx) const
     int way = idx - set * m_cache_assoc;
     assert (way < m_cache_assoc);
 
-    AbstractCacheEntry* entry = m_cache[set][way];
+    AbstractCacheEntry* entry = entryAt(set, way);
     if (entry == NULL ||
         entry->m_Permission == AccessPermission_Invalid ||
         entry->m_Permission == AccessPermission_NotPresent) {
@@ -251,7 +277,7 @@ CacheMemory::cacheAvail(Addr address) const
     int64_t cacheSet = addressToCacheSet(address);
 
     for (int i = 0; i < m_cache_assoc; i++) {
-        AbstractCacheEntry* entry = m_cache[cacheSet][i];
+        AbstractCacheEntry* entry = entryAt(cacheSet, i);
         if (entry != NULL) {
             if (entry->m_Address == address ||
                 entry->m_Permission == AccessPermission_NotPresent) {
@@ -275,7 +301,7 @@ CacheMemory::allocate(Addr address, AbstractCacheEntry *entry)
 
     // Find the first open slot
     int64_t cacheSet = addressToCacheSet(address);
-    std::vector<AbstractCacheEntry*> &set = m_cache[cacheSet];
+    AbstractCacheEntry** set = &entryAt(cacheSet, 0);
     for (int i = 0; i < m_cache_assoc; i++) {
         if (!set[i] || set[i]->m_Permission == AccessPermission_NotPresent) {
             if (set[i] && (set[i] != entry)) {
@@ -291,9 +317,10 @@ CacheMemory::allocate(Addr address, AbstractCacheEntry *entry)
             DPRINTF(RubyCache, "Allocate clearing lock for addr: %x\n",
                     address);
             set[i]->m_locked = -1;
-            m_tag_index[address] = i;
+            setTag(cacheSet, i, address);
             set[i]->setPosition(cacheSet, i);
-            set[i]->replacementData = replacement_data[cacheSet][i];
+            set[i]->replacementData =
+                replacement_data[lineIndex(cacheSet, i)];
             set[i]->setLastAccess(curTick());
 
             // Call reset function here to set initial value for different
@@ -316,8 +343,8 @@ CacheMemory::deallocate(Addr address)
     uint32_t cache_set = entry->getSet();
     uint32_t way = entry->getWay();
     delete entry;
-    m_cache[cache_set][way] = NULL;
-    m_tag_index.erase(address);
+    entryAt(cache_set, way) = NULL;
+    clearTag(cache_set, way);
 }
 
 // Returns with the physical address of the conflicting cache line
@@ -329,12 +356,13 @@ CacheMemory::cacheProbe(Addr address) const
 
     int64_t cacheSet = addressToCacheSet(address);
     std::vector<ReplaceableEntry*> candidates;
+    candidates.reserve(m_cache_assoc);
     for (int i = 0; i < m_cache_assoc; i++) {
         candidates.push_back(static_cast<ReplaceableEntry*>(
-                                                       m_cache[cacheSet][i]));
+                                                       entryAt(cacheSet, i)));
     }
-    return m_cache[cacheSet][m_replacementPolicy_ptr->
-                        getVictim(candidates)->getWay()]->m_Address;
+    return entryAt(cacheSet, m_replacementPolicy_ptr->
+                        getVictim(candidates)->getWay())->m_Address;
 }
 
 // looks an address up in the cache
@@ -345,7 +373,7 @@ CacheMemory::lookup(Addr address)
     int64_t cacheSet = addressToCacheSet(address);
     int loc = findTagInSet(cacheSet, address);
     if (loc == -1) return NULL;
-    return m_cache[cacheSet][loc];
+    return entryAt(cacheSet, loc);
 }
 
 // looks an address up in the cache
@@ -356,7 +384,7 @@ CacheMemory::lookup(Addr address) const
     int64_t cacheSet = addressToCacheSet(address);
     int loc = findTagInSet(cacheSet, address);
     if (loc == -1) return NULL;
-    return m_cache[cacheSet][loc];
+    return entryAt(cacheSet, loc);
 }
 
 // Sets the most recently used bit for a cache block
@@ -403,8 +431,8 @@ CacheMemory::getReplacementWeight(int64_t set, int64_t loc)
     assert(set < m_cache_num_sets);
     assert(loc < m_cache_assoc);
     int ret = 0;
-    if (m_cache[set][loc] != NULL) {
-        ret = m_cache[set][loc]->getNumValidBlocks();
+    if (entryAt(set, loc) != NULL) {
+        ret = entryAt(set, loc)->getNumValidBlocks();
         assert(ret >= 0);
     }
 
@@ -420,8 +448,9 @@ CacheMemory::recordCacheContents(int cntrl, CacheRecorder* tr) const
 
     for (int i = 0; i < m_cache_num_sets; i++) {
         for (int j = 0; j < m_cache_assoc; j++) {
-            if (m_cache[i][j] != NULL) {
-                AccessPermission perm = m_cache[i][j]->m_Permission;
+            AbstractCacheEntry* entry = entryAt(i, j);
+            if (entry != NULL) {
+                AccessPermission perm = entry->m_Permission;
                 RubyRequestType request_type = RubyRequestType_NULL;
                 if (perm == AccessPermission_Read_Only) {
                     if (m_is_instruction_only_cache) {
@@ -435,10 +464,10 @@ CacheMemory::recordCacheContents(int cntrl, CacheRecorder* tr) const
 
                 if (request_type != RubyRequestType_NULL) {
                     Tick lastAccessTick;
-                    lastAccessTick = m_cache[i][j]->getLastAccess();
-                    tr->addRecord(cntrl, m_cache[i][j]->m_Address,
+                    lastAccessTick = entry->getLastAccess();
+                    tr->addRecord(cntrl, entry->m_Address,
                                   0, request_type, lastAccessTick,
-                                  m_cache[i][j]->getDataBlk());
+                                  entry->getDataBlk());
                     warmedUpBlocks++;
                 }
             }
@@ -456,10 +485,10 @@ CacheMemory::print(std::ostream& out) const
     out << "Cache dump: " << name() << std::endl;
     for (int i = 0; i < m_cache_num_sets; i++) {
         for (int j = 0; j < m_cache_assoc; j++) {
-            if (m_cache[i][j] != NULL) {
+            if (entryAt(i, j) != NULL) {
                 out << "  Index: " << i
                     << " way: " << j
-                    << " entry: " << *m_cache[i][j] << std::endl;
+                    << " entry: " << *entryAt(i, j) << std::endl;
             } else {
                 out << "  Index: " << i
                     << " way: " << j
@@ -497,15 +526,11 @@ void
 CacheMemory::clearLockedAll(int context)
 {
     // iterate through every set and way to get a cache line
-    for (auto i = m_cache.begin(); i != m_cache.end(); ++i) {
-        std::vector<AbstractCacheEntry*> set = *i;
-        for (auto j = set.begin(); j != set.end(); ++j) {
-            AbstractCacheEntry *line = *j;
-            if (line && line->isLocked(context)) {
-                DPRINTF(RubyCache, "Clear Lock for addr: %#x\n",
-                    line->m_Address);
-                line->clearLocked();
-            }
+    for (AbstractCacheEntry *line : m_cache) {
+        if (line && line->isLocked(context)) {
+            DPRINTF(RubyCache, "Clear Lock for addr: %#x\n",
+                line->m_Address);
+            line->clearLocked();
         }
     }
 }
@@ -672,13 +697,13 @@ CacheMemory::checkResourceAvailable(CacheResourceType res, Addr addr)
 bool
 CacheMemory::isBlockInvalid(int64_t cache_set, int64_t loc)
 {
-  return (m_cache[cache_set][loc]->m_Permission == AccessPermission_Invalid);
+  return (entryAt(cache_set, loc)->m_Permission == AccessPermission_Invalid);
 }
 
 bool
 CacheMemory::isBlockNotBusy(int64_t cache_set, int64_t loc)
 {
-  return (m_cache[cache_set][loc]->m_Permission != AccessPermission_Busy);
+  return (entryAt(cache_set, loc)->m_Permission != AccessPermission_Busy);
 }
 
 /* hardware transactional memory */
@@ -690,24 +715,16 @@ CacheMemory::htmAbortTransaction()
     uint64_t htmWriteSetSize = 0;
 
     // iterate through every set and way to get a cache line
-    for (auto i = m_cache.begin(); i != m_cache.end(); ++i)
-    {
-        std::vector<AbstractCacheEntry*> set = *i;
-
-        for (auto j = set.begin(); j != set.end(); ++j)
-        {
-            AbstractCacheEntry *line = *j;
-
-            if (line != nullptr) {
-                htmReadSetSize += (line->getInHtmReadSet() ? 1 : 0);
-                htmWriteSetSize += (line->getInHtmWriteSet() ? 1 : 0);
-                if (line->getInHtmWriteSet()) {
-                    line->invalidateEntry();
-                }
-                line->setInHtmWriteSet(false);
-                line->setInHtmReadSet(false);
-                line->clearLocked();
+    for (AbstractCacheEntry *line : m_cache) {
+        if (line != nullptr) {
+            htmReadSetSize += (line->getInHtmReadSet() ? 1 : 0);
+            htmWriteSetSize += (line->getInHtmWriteSet() ? 1 : 0);
+            if (line->getInHtmWriteSet()) {
+                line->invalidateEntry();
             }
+            line->setInHtmWriteSet(false);
+            line->setInHtmReadSet(false);
+            line->clearLocked();
         }
     }
 
@@ -724,20 +741,13 @@ CacheMemory::htmCommitTransaction()
     uint64_t htmWriteSetSize = 0;
 
     // iterate through every set and way to get a cache line
-    for (auto i = m_cache.begin(); i != m_cache.end(); ++i)
-    {
-        std::vector<AbstractCacheEntry*> set = *i;
-
-        for (auto j = set.begin(); j != set.end(); ++j)
-        {
-            AbstractCacheEntry *line = *j;
-            if (line != nullptr) {
-                htmReadSetSize += (line->getInHtmReadSet() ? 1 : 0);
-                htmWriteSetSize += (line->getInHtmWriteSet() ? 1 : 0);
-                line->setInHtmWriteSet(false);
-                line->setInHtmReadSet(false);
-                line->clearLocked();
-             }
+    for (AbstractCacheEntry *line : m_cache) {
+        if (line != nullptr) {
+            htmReadSetSize += (line->getInHtmReadSet() ? 1 : 0);
+            htmWriteSetSize += (line->getInHtmWriteSet() ? 1 : 0);
+            line->setInHtmWriteSet(false);
+            line->setInHtmReadSet(false);
+            line->clearLocked();
         }
     }
 
@@ -43,9 +43,9 @@
 #define __MEM_RUBY_STRUCTURES_CACHEMEMORY_HH__
 
 #include <string>
-#include <unordered_map>
 #include <vector>
 
+#include "base/flat_addr_map.hh"
 #include "base/statistics.hh"
 #include "mem/cache/replacement_policies/base.hh"
 #include "mem/cache/replacement_policies/replaceable_entry.hh"
@@ -173,13 +173,57 @@ class CacheMemory : public SimObject
     CacheMemory& operator=(const CacheMemory& obj);
 
   private:
+    // Flat index of a (set, way) pair into the per-line arrays below
+    size_t
+    lineIndex(int64_t cacheSet, int way) const
+    {
+        return cacheSet * m_cache_assoc + way;
+    }
+
+    AbstractCacheEntry*&
+    entryAt(int64_t cacheSet, int way)
+    {
+        return m_cache[lineIndex(cacheSet, way)];
+    }
+
+    AbstractCacheEntry*
+    entryAt(int64_t cacheSet, int way) const
+    {
+        return m_cache[lineIndex(cacheSet, way)];
+    }
+
+    // Record/forget the tag held by a way in both the tag array and, for
+    // highly associative caches, the tag index
+    void setTag(int64_t cacheSet, int way, Addr tag);
+    void clearTag(int64_t cacheSet, int way);
+
+  private:
+    /**
+     * Caches with an associativity above this threshold keep a tag index
+     * on top of the tag array, as scanning a whole set would be more
+     * expensive than a hash lookup.
+     */
+    static constexpr int maxScannedAssoc = 32;
+
+    /** Tag value stored for ways that do not hold a block. */
+    static constexpr Addr invalidTag = MaxAddr;
+
     // Data Members (m_prefix)
     bool m_is_instruction_only_cache;
 
-    // The first index is the # of cache lines.
-    // The second index is the the amount associativity.
-    std::unordered_map<Addr, int> m_tag_index;
-    std::vector<std::vector<AbstractCacheEntry*> > m_cache;
+    /**
+     * The entries, tags and replacement data are kept in flat arrays of
+     * m_cache_num_sets * m_cache_assoc elements, with the ways of a set
+     * stored contiguously. A lookup therefore only walks the few cache
+     * lines that hold the tags of one set and the position of a matching
+     * tag directly gives its way.
+     */
+    std::vector<AbstractCacheEntry*> m_cache;
+    std::vector<Addr> m_tags;
+
+    // Tag to way map, only populated when m_cache_assoc > maxScannedAssoc
+    bool m_use_tag_index;
+    FlatAddrMap<int> m_tag_index;
 
     /** We use the replacement policies from the Classic memory system. */
     replacement_policy::Base *m_replacementPolicy_ptr;
@@ -196,14 +240,14 @@ class CacheMemory : public SimObject
     int m_block_size;
 
     /**
-     * We store all the ReplacementData in a 2-dimensional array. By doing
+     * We store all the ReplacementData in a flat (set, way) array. By doing
      * this, we can use all replacement policies from Classic system. Ruby
      * cache will deallocate cache entry every time we evict the cache block
      * so we cannot store the ReplacementData inside the cache entry.
      * Instantiate ReplacementData for multiple times will break replacement
      * policy like TreePLRU.
      */
-    std::vector<std::vector<ReplData> > replacement_data;
+    std::vector<ReplData> replacement_data;
 
     /**
      * Set to true when using WeightedLRU replacement policy, otherwise, set to
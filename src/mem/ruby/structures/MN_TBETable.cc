@@ -54,14 +54,15 @@ MN_TBETable::chooseNewDistributor()
     std::vector<MiscNode_TBE*> potential_sync_dependency_tbes;
     bool has_waiting_sync = false;
     int waiting_count = 0;
-    for (auto& keyValuePair : m_map) {
-        MiscNode_TBE& tbe = keyValuePair.second;
-
+    MiscNode_TBE* distributing = nullptr;
+    forEachEntry([&](Addr addr, MiscNode_TBE& tbe) {
         switch (tbe.getstate()) {
             case MiscNode_State_DvmSync_Distributing:
             case MiscNode_State_DvmNonSync_Distributing:
                 // If something is still distributing, just return it
-                return &tbe;
+                if (!distributing)
+                    distributing = &tbe;
+                break;
             case MiscNode_State_DvmSync_ReadyToDist:
                 ready_sync_tbes.push_back(&tbe);
                 break;
@@ -82,6 +83,10 @@ MN_TBETable::chooseNewDistributor()
             default:
                 break;
         }
+    });
+
+    if (distributing) {
+        return distributing;
     }
 
     // At most ~4 pending snoops at the RN-F
@@ -41,9 +41,13 @@
 #ifndef __MEM_RUBY_STRUCTURES_TBETABLE_HH__
 #define __MEM_RUBY_STRUCTURES_TBETABLE_HH__
 
+#include <cstdint>
+#include <deque>
 #include <iostream>
-#include <unordered_map>
+#include <vector>
 
+#include "base/flat_addr_map.hh"
+#include "base/logging.hh"
 #include "mem/ruby/common/Address.hh"
 
 namespace gem5
@@ -52,12 +56,28 @@ namespace gem5
 namespace ruby
 {
 
+/**
+ * Table of transaction buffer entries indexed by line address.
+ *
+ * The entries live in a pool that only grows, and freed entries are
+ * recycled, so once the table has reached its working set allocating
+ * and deallocating a TBE never touches the host allocator. Entries are
+ * only constructed when first needed, rather than number_of_TBEs of
+ * them up front. The pool is a std::deque, which never moves existing
+ * entries when it grows, therefore pointers returned by lookup() stay
+ * valid until the entry is deallocated, as they did when the table was
+ * backed by a node-based map. The address to entry mapping is a flat
+ * open-addressing hash map.
+ *
+ * Protocols are expected to check areNSlotsAvailable() before
+ * allocating. Allocating beyond number_of_TBEs is a protocol error.
+ */
 template<class ENTRY>
 class TBETable
 {
   public:
     TBETable(int number_of_TBEs)
-        : m_number_of_TBEs(number_of_TBEs)
+        : m_index(number_of_TBEs), m_number_of_TBEs(number_of_TBEs)
     {
     }
 
@@ -67,7 +87,7 @@ class TBETable
     bool
     areNSlotsAvailable(int n, Tick current_time) const
     {
-        return (m_number_of_TBEs - m_map.size()) >= n;
+        return (m_number_of_TBEs - (int)m_index.size()) >= n;
     }
 
     ENTRY *getNullEntry();
@@ -81,10 +101,22 @@ class TBETable
     TBETable(const TBETable& obj);
     TBETable& operator=(const TBETable& obj);
 
-    // Data Members (m_prefix)
-    std::unordered_map<Addr, ENTRY> m_map;
+    /** Calls func(address, entry) for every allocated entry. */
+    template<class FUNC>
+    void
+    forEachEntry(FUNC func)
+    {
+        m_index.forEach([&](Addr address, uint32_t slot) {
+            func(address, m_entries[slot]);
+        });
+    }
 
   private:
+    // Data Members (m_prefix)
+    std::deque<ENTRY> m_entries;
+    std::vector<uint32_t> m_free_slots;
+    FlatAddrMap<uint32_t> m_index;
+
     int m_number_of_TBEs;
 };
 
@@ -102,8 +134,8 @@ inline bool
 TBETable<ENTRY>::isPresent(Addr address) const
 {
     assert(address == makeLineAddress(address));
-    assert(m_map.size() <= m_number_of_TBEs);
-    return !!m_map.count(address);
+    assert(m_index.size() <= m_number_of_TBEs);
+    return m_index.contains(address);
 }
 
 template<class ENTRY>
@@ -111,8 +143,19 @@ inline void
 TBETable<ENTRY>::allocate(Addr address)
 {
     assert(!isPresent(address));
-    assert(m_map.size() < m_number_of_TBEs);
-    m_map[address] = ENTRY();
+    panic_if(m_index.size() >= m_number_of_TBEs,
+             "Allocating TBE for %#x beyond the %d TBEs available.\n",
+             address, m_number_of_TBEs);
+
+    uint32_t slot;
+    if (m_free_slots.empty()) {
+        slot = m_entries.size();
+        m_entries.emplace_back();
+    } else {
+        slot = m_free_slots.back();
+        m_free_slots.pop_back();
+    }
+    m_index.assign(address, slot);
 }
 
 template<class ENTRY>
@@ -120,8 +163,13 @@ inline void
 TBETable<ENTRY>::deallocate(Addr address)
 {
     assert(isPresent(address));
-    assert(m_map.size() > 0);
-    m_map.erase(address);
+
+    const uint32_t slot = *m_index.find(address);
+    m_index.erase(address);
+
+    // Reset the entry now so that a later allocation finds it pristine
+    m_entries[slot] = ENTRY();
+    m_free_slots.push_back(slot);
 }
 
 template<class ENTRY>
@@ -136,8 +184,9 @@ template<class ENTRY>
 inline ENTRY*
 TBETable<ENTRY>::lookup(Addr address)
 {
-  if (m_map.find(address) != m_map.end()) return &(m_map.find(address)->second);
-  return NULL;
+    const uint32_t *slot = m_index.find(address);
+    if (slot) return &m_entries[*slot];
+    return NULL;
 }
 
 
@@ -81,6 +81,9 @@ Sequencer::Sequencer(const Params &p)
     assert(m_max_outstanding_requests > 0);
     assert(m_deadlock_threshold > 0);
 
+    // Size the request table up front so it never rehashes at runtime
+    m_RequestTable.reserve(m_max_outstanding_requests);
+
     m_unaddressedTransactionCnt = 0;
 
     m_runningGarnetStandalone = p.garnet_standalone;
@@ -936,9 +939,10 @@ Sequencer::issueRequest(PacketPtr pkt, RubyRequestType secondary_type)
     m_mandatory_q_ptr->enqueue(msg, clockEdge(), latency);
 }
 
-template <class KEY, class VALUE>
+template <class KEY, class VALUE, class... ARGS>
 std::ostream &
-operator<<(std::ostream &out, const std::unordered_map<KEY, VALUE> &map)
+operator<<(std::ostream &out,
+           const std::unordered_map<KEY, VALUE, ARGS...> &map)
 {
     for (const auto &table_entry : map) {
         out << "[ " << table_entry.first << " =";
@@ -45,6 +45,7 @@
 #include <list>
 #include <unordered_map>
 
+#include "base/pool_alloc.hh"
 #include "mem/ruby/common/Address.hh"
 #include "mem/ruby/protocol/MachineType.hh"
 #include "mem/ruby/protocol/RubyRequestType.hh"
@@ -83,6 +84,18 @@ struct SequencerRequest
 
 std::ostream& operator<<(std::ostream& out, const SequencerRequest& obj);
 
+/**
+ * Outstanding requests to a line, in arrival order. The list nodes and the
+ * nodes of the request table itself are drawn from the size-class pool, so
+ * once the pool has warmed up a miss no longer reaches the host allocator.
+ */
+typedef std::list<SequencerRequest, PoolAllocator<SequencerRequest>>
+    SequencerRequestList;
+typedef std::unordered_map<Addr, SequencerRequestList, std::hash<Addr>,
+    std::equal_to<Addr>,
+    PoolAllocator<std::pair<const Addr, SequencerRequestList>>>
+    SequencerRequestTable;
+
 class Sequencer : public RubyPort
 {
   public:
@@ -221,7 +234,7 @@ class Sequencer : public RubyPort
 
   protected:
     // RequestTable contains both read and write requests, handles aliasing
-    std::unordered_map<Addr, std::list<SequencerRequest>> m_RequestTable;
+    SequencerRequestTable m_RequestTable;
     // UnadressedRequestTable contains "unaddressed" requests,
     // guaranteed not to alias each other
     std::unordered_map<uint64_t, SequencerRequest> m_UnaddressedRequestTable;
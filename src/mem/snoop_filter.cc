@@ -42,6 +42,9 @@
 
 #include "mem/snoop_filter.hh"
 
+#include <algorithm>
+
+#include "base/intmath.hh"
 #include "base/logging.hh"
 #include "base/trace.hh"
 #include "debug/SnoopFilter.hh"
@@ -52,17 +55,250 @@ namespace gem5
 
 const int SnoopFilter::SNOOP_MASK_SIZE;
 
+SnoopFilter::SnoopFilter(const SnoopFilterParams &p) :
+    SimObject(p), assoc(p.assoc), numSets(0), useCounter(0), maskWords(1),
+    numEntries(0), slotMask(0), hashShift(0), lineShift(0),
+    evictedLine(InvalidTag),
+    requestorId(p.assoc ? p.system->getRequestorId(this) :
+                Request::invldRequestorId),
+    linesize(p.system->cacheLineSize()), lookupLatency(p.lookup_latency),
+    maxEntryCount(p.max_capacity / p.system->cacheLineSize()),
+    stats(this)
+{
+    lineShift = floorLog2(linesize);
+    if (assoc) {
+        numSets = maxEntryCount / assoc;
+        fatal_if(numSets == 0 || numSets * assoc != maxEntryCount ||
+                 !isPowerOf2(numSets),
+                 "%s: max_capacity must hold a power of two number of "
+                 "%d-way sets\n", name(), assoc);
+    }
+}
+
+void
+SnoopFilter::allocateStorage(size_t num_slots)
+{
+    tags.assign(num_slots, InvalidTag);
+    masks.assign(num_slots * 2 * maskWords, 0);
+    if (assoc)
+        lastUse.assign(num_slots, 0);
+    numEntries = 0;
+    slotMask = num_slots - 1;
+    hashShift = 64 - floorLog2(num_slots);
+}
+
+size_t
+SnoopFilter::homeSlot(Addr line_addr) const
+{
+    // the secure bit is shifted out, so both copies of a line share
+    // a home slot and only differ in their tags
+    const uint64_t line = line_addr >> lineShift;
+    if (assoc)
+        return (line & (numSets - 1)) * assoc;
+
+    // Fibonacci hashing, to spread strided lines across the table
+    return (line * 0x9e3779b97f4a7c15ULL) >> hashShift;
+}
+
+size_t
+SnoopFilter::findSlot(Addr line_addr) const
+{
+    size_t slot = homeSlot(line_addr);
+    if (assoc) {
+        for (size_t way = slot; way < slot + assoc; ++way) {
+            if (tags[way] == line_addr)
+                return way;
+        }
+        return NoSlot;
+    }
+
+    // linear probing, the table is never more than half full so
+    // there always is an empty slot terminating the search
+    for (; tags[slot] != InvalidTag; slot = (slot + 1) & slotMask) {
+        if (tags[slot] == line_addr)
+            return slot;
+    }
+    return NoSlot;
+}
+
+size_t
+SnoopFilter::findVictim(size_t first_way) const
+{
+    size_t victim = NoSlot;
+    for (size_t way = first_way; way < first_way + assoc; ++way) {
+        if (tags[way] == InvalidTag)
+            return way;
+
+        // lines with requests in flight have to stay, or the
+        // responses would fill a line we no longer track
+        const uint64_t *requested = &masks[way * 2 * maskWords];
+        if (std::any_of(requested, requested + maskWords,
+                        [](uint64_t w) { return w != 0; }))
+            continue;
+
+        if (victim == NoSlot || lastUse[way] < lastUse[victim])
+            victim = way;
+    }
+    return victim;
+}
+
+void
+SnoopFilter::grow()
+{
+    std::vector<Addr> old_tags;
+    std::vector<uint64_t> old_masks;
+    old_tags.swap(tags);
+    old_masks.swap(masks);
+
+    const size_t words = 2 * maskWords;
+    allocateStorage(2 * old_tags.size());
+    for (size_t i = 0; i < old_tags.size(); ++i) {
+        if (old_tags[i] == InvalidTag)
+            continue;
+        size_t slot = homeSlot(old_tags[i]);
+        while (tags[slot] != InvalidTag)
+            slot = (slot + 1) & slotMask;
+        tags[slot] = old_tags[i];
+        std::copy_n(&old_masks[i * words], words, &masks[slot * words]);
+        ++numEntries;
+    }
+}
+
+size_t
+SnoopFilter::allocateSlot(Addr line_addr)
+{
+    size_t slot;
+    if (assoc) {
+        slot = findVictim(homeSlot(line_addr));
+        panic_if(slot == NoSlot, "no way to evict for line %#x, every "
+                 "line in the set has a request in flight\n", line_addr);
+
+        if (tags[slot] != InvalidTag) {
+            const SnoopItem victim = loadItem(slot);
+            DPRINTF(SnoopFilter, "%s:   evicting %#x SF value %x.%x\n",
+                    __func__, tags[slot], victim.requested, victim.holder);
+            stats.evictions++;
+            if (victim.holder.any()) {
+                // only one eviction per lookupRequest, and the caller
+                // must have collected the previous one
+                assert(evictedLine == InvalidTag);
+                evictedLine = tags[slot];
+                evictedHolders = victim.holder;
+            }
+            eraseSlot(slot);
+        }
+        lastUse[slot] = ++useCounter;
+    } else {
+        // keep the load factor at or below one half
+        if (2 * (numEntries + 1) > tags.size())
+            grow();
+        slot = homeSlot(line_addr);
+        while (tags[slot] != InvalidTag)
+            slot = (slot + 1) & slotMask;
+    }
+
+    tags[slot] = line_addr;
+    ++numEntries;
+    return slot;
+}
+
+void
+SnoopFilter::eraseSlot(size_t slot)
+{
+    const size_t words = 2 * maskWords;
+    --numEntries;
+    if (!assoc) {
+        // backward-shift deletion: move later members of the probe
+        // chain into the hole, so that lookups need no tombstones
+        for (size_t next = (slot + 1) & slotMask; tags[next] != InvalidTag;
+             next = (next + 1) & slotMask) {
+            const size_t home = homeSlot(tags[next]);
+            if (((next - home) & slotMask) < ((next - slot) & slotMask))
+                continue;
+            tags[slot] = tags[next];
+            std::copy_n(&masks[next * words], words, &masks[slot * words]);
+            slot = next;
+        }
+    }
+    tags[slot] = InvalidTag;
+    std::fill_n(&masks[slot * words], words, 0);
+}
+
+SnoopFilter::SnoopItem
+SnoopFilter::loadItem(size_t slot) const
+{
+    const uint64_t *words = &masks[slot * 2 * maskWords];
+    SnoopItem item{0, 0};
+    for (unsigned i = maskWords; i-- > 0; ) {
+        item.requested = (item.requested << 64) | SnoopMask(words[i]);
+        item.holder = (item.holder << 64) |
+            SnoopMask(words[maskWords + i]);
+    }
+    return item;
+}
+
+void
+SnoopFilter::storeItem(size_t slot, const SnoopItem& item)
+{
+    uint64_t *words = &masks[slot * 2 * maskWords];
+    const SnoopMask low_word(~0ULL);
+    for (unsigned i = 0; i < maskWords; ++i) {
+        words[i] = ((item.requested >> (64 * i)) & low_word).to_ullong();
+        words[maskWords + i] =
+            ((item.holder >> (64 * i)) & low_word).to_ullong();
+    }
+}
+
 void
-SnoopFilter::eraseIfNullEntry(SnoopFilterCache::iterator& sf_it)
+SnoopFilter::updateOrErase(size_t slot, const SnoopItem& sf_item)
 {
-    SnoopItem& sf_item = sf_it->second;
     if ((sf_item.requested | sf_item.holder).none()) {
-        cachedLocations.erase(sf_it);
+        eraseSlot(slot);
         DPRINTF(SnoopFilter, "%s:   Removed SF entry.\n",
                 __func__);
+    } else {
+        storeItem(slot, sf_item);
     }
 }
 
+bool
+SnoopFilter::canAllocate(const Packet* cpkt,
+                         const ResponsePort& cpu_side_port)
+{
+    if (!assoc || cpkt->req->isUncacheable() ||
+        !cpu_side_port.isSnooping() || !cpkt->fromCache() ||
+        cpkt->isEviction())
+        return true;
+
+    const Addr line_addr = lineAddress(cpkt);
+    if (findSlot(line_addr) != NoSlot ||
+        findVictim(homeSlot(line_addr)) != NoSlot)
+        return true;
+
+    DPRINTF(SnoopFilter, "%s: no way to evict for packet %s\n",
+            __func__, cpkt->print());
+    stats.allocationStalls++;
+    return false;
+}
+
+RequestPtr
+SnoopFilter::takeEviction(SnoopList& holders)
+{
+    if (evictedLine == InvalidTag)
+        return nullptr;
+
+    holders = maskToPortList(evictedHolders);
+    stats.backInvalidations += holders.size();
+
+    Request::Flags flags = Request::CLEAN | Request::INVALIDATE;
+    if (evictedLine & LineSecure)
+        flags.set(Request::SECURE);
+    auto req = std::make_shared<Request>(evictedLine & ~Addr(LineSecure),
+                                         linesize, flags, requestorId);
+    evictedLine = InvalidTag;
+    return req;
+}
+
 std::pair<SnoopFilter::SnoopList, Cycles>
 SnoopFilter::lookupRequest(const Packet* cpkt, const ResponsePort&
                            cpu_side_port)
@@ -73,26 +309,30 @@ SnoopFilter::lookupRequest(const Packet* cpkt, const ResponsePort&
     // check if the packet came from a cache
     bool allocate = !cpkt->req->isUncacheable() && cpu_side_port.isSnooping()
         && cpkt->fromCache();
-    Addr line_addr = cpkt->getBlockAddr(linesize);
-    if (cpkt->isSecure()) {
-        line_addr |= LineSecure;
-    }
+    Addr line_addr = lineAddress(cpkt);
     SnoopMask req_port = portToMask(cpu_side_port);
-    reqLookupResult.it = cachedLocations.find(line_addr);
-    bool is_hit = (reqLookupResult.it != cachedLocations.end());
+    size_t slot = findSlot(line_addr);
+    bool is_hit = (slot != NoSlot);
 
     // If the snoop filter has no entry, and we should not allocate,
     // do not create a new snoop filter entry, simply return a NULL
-    // portlist.
-    if (!is_hit && !allocate)
+    // portlist. A bounded filter also lets evictions of lines it
+    // has already back-invalidated pass through untracked.
+    if (!is_hit && (!allocate || (assoc && cpkt->isEviction()))) {
+        reqLookupResult.slot = NoSlot;
         return snoopDown(lookupLatency);
+    }
 
-    // If no hit in snoop filter create a new element and update iterator
+    // If no hit in snoop filter create a new element
     if (!is_hit) {
-        reqLookupResult.it =
-            cachedLocations.emplace(line_addr, SnoopItem()).first;
+        slot = allocateSlot(line_addr);
+    } else if (assoc) {
+        lastUse[slot] = ++useCounter;
     }
-    SnoopItem& sf_item = reqLookupResult.it->second;
+    reqLookupResult.slot = slot;
+    reqLookupResult.lineAddr = line_addr;
+
+    SnoopItem sf_item = loadItem(slot);
     SnoopMask interested = sf_item.holder | sf_item.requested;
 
     // Store unmodified value of snoop filter item in temp storage in
@@ -140,10 +380,11 @@ SnoopFilter::lookupRequest(const Packet* cpkt, const ResponsePort&
         }
     } else { // if (!cpkt->needsResponse())
         assert(cpkt->isEviction());
-        // make sure that the sender actually had the line
-        panic_if((sf_item.holder & req_port).none(), "requestor %x is not a " \
-                 "holder :( SF value %x.%x\n", req_port,
-                 sf_item.requested, sf_item.holder);
+        // make sure that the sender actually had the line, unless it
+        // lost it to a back-invalidation while the eviction was queued
+        panic_if(!assoc && (sf_item.holder & req_port).none(),
+                 "requestor %x is not a holder :( SF value %x.%x\n",
+                 req_port, sf_item.requested, sf_item.holder);
         // CleanEvicts and Writebacks -> the sender and all caches above
         // it may not have the line anymore.
         if (!cpkt->isBlockCached()) {
@@ -152,31 +393,71 @@ SnoopFilter::lookupRequest(const Packet* cpkt, const ResponsePort&
                     __func__,  sf_item.requested, sf_item.holder);
         }
     }
+    storeItem(slot, sf_item);
 
     return snoopSelected(maskToPortList(interested & ~req_port), lookupLatency);
 }
 
+bool
+SnoopFilter::addRestoredHolder(const Packet* cpkt,
+                               const ResponsePort& cpu_side_port)
+{
+    DPRINTF(SnoopFilter, "%s: src %s packet %s\n", __func__,
+            cpu_side_port.name(), cpkt->print());
+
+    if (!cpu_side_port.isSnooping())
+        return true;
+
+    const Addr line_addr = lineAddress(cpkt);
+    size_t slot = findSlot(line_addr);
+    if (slot == NoSlot) {
+        if (assoc) {
+            const size_t way = findVictim(homeSlot(line_addr));
+            if (way == NoSlot || tags[way] != InvalidTag)
+                return false;
+        }
+        slot = allocateSlot(line_addr);
+    } else if (assoc) {
+        lastUse[slot] = ++useCounter;
+    }
+
+    SnoopItem sf_item = loadItem(slot);
+    sf_item.holder |= portToMask(cpu_side_port);
+    storeItem(slot, sf_item);
+    DPRINTF(SnoopFilter, "%s:   new SF value %x.%x\n",
+            __func__, sf_item.requested, sf_item.holder);
+    return true;
+}
+
 void
 SnoopFilter::finishRequest(bool will_retry, Addr addr, bool is_secure)
 {
-    if (reqLookupResult.it != cachedLocations.end()) {
+    if (reqLookupResult.slot != NoSlot) {
         // since we rely on the caller, do a basic check to ensure
         // that finishRequest is being called following lookupRequest
-        assert(reqLookupResult.it->first == \
+        assert(reqLookupResult.lineAddr == \
                 (is_secure ? ((addr & ~(Addr(linesize - 1))) | LineSecure) : \
                  (addr & ~(Addr(linesize - 1)))));
+
+        // erasing other lines may have moved the entry since
+        size_t slot = reqLookupResult.slot;
+        if (tags[slot] != reqLookupResult.lineAddr)
+            slot = findSlot(reqLookupResult.lineAddr);
+        assert(slot != NoSlot);
+
+        SnoopItem sf_item = loadItem(slot);
         if (will_retry) {
-            SnoopItem retry_item = reqLookupResult.retryItem;
             // Undo any changes made in lookupRequest to the snoop filter
             // entry if the request will come again. retryItem holds
             // the previous value of the snoopfilter entry.
-            reqLookupResult.it->second = retry_item;
+            sf_item = reqLookupResult.retryItem;
 
             DPRINTF(SnoopFilter, "%s:   restored SF value %x.%x\n",
-                    __func__,  retry_item.requested, retry_item.holder);
+                    __func__,  sf_item.requested, sf_item.holder);
         }
 
-        eraseIfNullEntry(reqLookupResult.it);
+        updateOrErase(slot, sf_item);
+        reqLookupResult.slot = NoSlot;
     }
 }
 
@@ -187,14 +468,10 @@ SnoopFilter::lookupSnoop(const Packet* cpkt)
 
     assert(cpkt->isRequest());
 
-    Addr line_addr = cpkt->getBlockAddr(linesize);
-    if (cpkt->isSecure()) {
-        line_addr |= LineSecure;
-    }
-    auto sf_it = cachedLocations.find(line_addr);
-    bool is_hit = (sf_it != cachedLocations.end());
+    size_t slot = findSlot(lineAddress(cpkt));
+    bool is_hit = (slot != NoSlot);
 
-    panic_if(!is_hit && (cachedLocations.size() >= maxEntryCount),
+    panic_if(!assoc && !is_hit && (numEntries >= maxEntryCount),
              "snoop filter exceeded capacity of %d cache blocks\n",
              maxEntryCount);
 
@@ -204,7 +481,7 @@ SnoopFilter::lookupSnoop(const Packet* cpkt)
     if (!is_hit)
         return snoopDown(lookupLatency);
 
-    SnoopItem& sf_item = sf_it->second;
+    SnoopItem sf_item = loadItem(slot);
 
     SnoopMask interested = (sf_item.holder | sf_item.requested);
 
@@ -234,7 +511,7 @@ SnoopFilter::lookupSnoop(const Packet* cpkt)
         sf_item.holder = 0;
         DPRINTF(SnoopFilter, "%s:   new SF value %x.%x\n",
                 __func__, sf_item.requested, sf_item.holder);
-        eraseIfNullEntry(sf_it);
+        updateOrErase(slot, sf_item);
     }
 
     return snoopSelected(maskToPortList(interested), lookupLatency);
@@ -258,13 +535,10 @@ SnoopFilter::updateSnoopResponse(const Packet* cpkt,
         return;
     }
 
-    Addr line_addr = cpkt->getBlockAddr(linesize);
-    if (cpkt->isSecure()) {
-        line_addr |= LineSecure;
-    }
     SnoopMask rsp_mask = portToMask(rsp_port);
     SnoopMask req_mask = portToMask(req_port);
-    SnoopItem& sf_item = cachedLocations[line_addr];
+    size_t slot = findSlot(lineAddress(cpkt));
+    SnoopItem sf_item = slot != NoSlot ? loadItem(slot) : SnoopItem{0, 0};
 
     DPRINTF(SnoopFilter, "%s:   old SF value %x.%x\n",
             __func__,  sf_item.requested, sf_item.holder);
@@ -293,6 +567,7 @@ SnoopFilter::updateSnoopResponse(const Packet* cpkt,
     sf_item.holder |=  req_mask;
     sf_item.requested &= ~req_mask;
     assert((sf_item.requested | sf_item.holder).any());
+    storeItem(slot, sf_item);
     DPRINTF(SnoopFilter, "%s:   new SF value %x.%x\n",
             __func__, sf_item.requested, sf_item.holder);
 }
@@ -307,12 +582,8 @@ SnoopFilter::updateSnoopForward(const Packet* cpkt,
     assert(cpkt->isResponse());
     assert(cpkt->cacheResponding());
 
-    Addr line_addr = cpkt->getBlockAddr(linesize);
-    if (cpkt->isSecure()) {
-        line_addr |= LineSecure;
-    }
-    auto sf_it = cachedLocations.find(line_addr);
-    bool is_hit = sf_it != cachedLocations.end();
+    size_t slot = findSlot(lineAddress(cpkt));
+    bool is_hit = slot != NoSlot;
 
     // Nothing to do if it is not a hit
     if (!is_hit)
@@ -322,7 +593,7 @@ SnoopFilter::updateSnoopForward(const Packet* cpkt,
     // Modified state, and we know that there are no other copies, or
     // they will all be invalidated imminently
     if (!cpkt->hasSharers()) {
-        SnoopItem& sf_item = sf_it->second;
+        SnoopItem sf_item = loadItem(slot);
 
         DPRINTF(SnoopFilter, "%s:   old SF value %x.%x\n",
                 __func__, sf_item.requested, sf_item.holder);
@@ -330,7 +601,7 @@ SnoopFilter::updateSnoopForward(const Packet* cpkt,
         DPRINTF(SnoopFilter, "%s:   new SF value %x.%x\n",
                 __func__, sf_item.requested, sf_item.holder);
 
-        eraseIfNullEntry(sf_it);
+        updateOrErase(slot, sf_item);
     }
 }
 
@@ -349,16 +620,12 @@ SnoopFilter::updateResponse(const Packet* cpkt, const ResponsePort&
         return;
 
     // next check if we actually allocated an entry
-    Addr line_addr = cpkt->getBlockAddr(linesize);
-    if (cpkt->isSecure()) {
-        line_addr |= LineSecure;
-    }
-    auto sf_it = cachedLocations.find(line_addr);
-    if (sf_it == cachedLocations.end())
+    size_t slot = findSlot(lineAddress(cpkt));
+    if (slot == NoSlot)
         return;
 
     SnoopMask response_mask = portToMask(cpu_side_port);
-    SnoopItem& sf_item = sf_it->second;
+    SnoopItem sf_item = loadItem(slot);
 
     DPRINTF(SnoopFilter, "%s:   old SF value %x.%x\n",
             __func__,  sf_item.requested, sf_item.holder);
@@ -377,7 +644,6 @@ SnoopFilter::updateResponse(const Packet* cpkt, const ResponsePort&
         if (cpkt->isInvalidate()) {
             sf_item.holder &= ~response_mask;
         }
-        eraseIfNullEntry(sf_it);
     } else {
         // Any other response implies that a cache above will have the
         // block.
@@ -386,6 +652,7 @@ SnoopFilter::updateResponse(const Packet* cpkt, const ResponsePort&
     }
     DPRINTF(SnoopFilter, "%s:   new SF value %x.%x\n",
             __func__, sf_item.requested, sf_item.holder);
+    updateOrErase(slot, sf_item);
 }
 
 SnoopFilter::SnoopFilterStats::SnoopFilterStats(statistics::Group *parent)
@@ -405,7 +672,15 @@ SnoopFilter::SnoopFilterStats::SnoopFilterStats(statistics::Group *parent)
                "holder of the requested data."),
       ADD_STAT(hitMultiSnoops, statistics::units::Count::get(),
                "Number of snoops hitting in the snoop filter with multiple "
-               "(>1) holders of the requested data.")
+               "(>1) holders of the requested data."),
+      ADD_STAT(evictions, statistics::units::Count::get(),
+               "Number of entries evicted to make room for new lines."),
+      ADD_STAT(backInvalidations, statistics::units::Count::get(),
+               "Number of back-invalidation snoops sent to the holders of "
+               "evicted lines."),
+      ADD_STAT(allocationStalls, statistics::units::Count::get(),
+               "Number of requests stalled because every line in their "
+               "set had a request in flight.")
 {}
 
 void
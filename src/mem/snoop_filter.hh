@@ -43,13 +43,16 @@
 #ifndef __MEM_SNOOP_FILTER_HH__
 #define __MEM_SNOOP_FILTER_HH__
 
+#include <algorithm>
 #include <bitset>
-#include <unordered_map>
+#include <cstdint>
 #include <utility>
+#include <vector>
 
 #include "mem/packet.hh"
 #include "mem/port.hh"
 #include "mem/qport.hh"
+#include "mem/request.hh"
 #include "params/SnoopFilter.hh"
 #include "sim/sim_object.hh"
 #include "sim/system.hh"
@@ -85,6 +88,15 @@ namespace gem5
  *     upper cache dropped a line, making the snoop filter pessimistic for now
  * (4) ordering: there is no single point of order in the system.  Instead,
  *     requesting MSHRs track order between local requests and remote snoops
+ *
+ * By default the filter tracks an unbounded number of lines and the
+ * capacity is merely a sanity check. With a non-zero associativity it
+ * instead models a finite, set-associative directory: allocating into
+ * a full set evicts the least recently used entry without outstanding
+ * requests, and the crossbar back-invalidates the caches that still
+ * hold the victim. In both modes the entries live in flat arrays
+ * (open addressing when unbounded) with the sharer vectors packed to
+ * the number of snooping ports actually connected.
  */
 class SnoopFilter : public SimObject
 {
@@ -95,13 +107,7 @@ class SnoopFilter : public SimObject
 
     typedef std::vector<QueuedResponsePort*> SnoopList;
 
-    SnoopFilter (const SnoopFilterParams &p) :
-        SimObject(p), reqLookupResult(cachedLocations.end()),
-        linesize(p.system->cacheLineSize()), lookupLatency(p.lookup_latency),
-        maxEntryCount(p.max_capacity / p.system->cacheLineSize()),
-        stats(this)
-    {
-    }
+    SnoopFilter(const SnoopFilterParams &p);
 
     /**
      * Init a new snoop filter and tell it about all the cpu_sideports
@@ -125,6 +131,11 @@ class SnoopFilter : public SimObject
         fatal_if(id > SNOOP_MASK_SIZE,
                  "Snoop filter only supports %d snooping ports, got %d\n",
                  SNOOP_MASK_SIZE, id);
+
+        // size the storage now that we know how wide the sharer
+        // vectors need to be
+        maskWords = std::max<PortID>(1, (id + 63) / 64);
+        allocateStorage(assoc ? maxEntryCount : InitialSlots);
     }
 
     /**
@@ -142,6 +153,43 @@ class SnoopFilter : public SimObject
     std::pair<SnoopList, Cycles> lookupRequest(const Packet* cpkt,
                                         const ResponsePort& cpu_side_port);
 
+    /**
+     * Check if a request could allocate an entry if it was looked up
+     * now. This is only ever false for a set-associative filter whose
+     * set is full of lines with outstanding requests, in which case
+     * the request has to wait until one of them completes.
+     *
+     * @param cpkt          Pointer to the request packet. Not changed.
+     * @param cpu_side_port Response port where the request came from.
+     * @return True if lookupRequest can go ahead.
+     */
+    bool canAllocate(const Packet* cpkt, const ResponsePort& cpu_side_port);
+
+    /**
+     * Collect the line, if any, that the preceding lookupRequest
+     * evicted to make room for its own entry. The caller is
+     * responsible for back-invalidating the returned holders before
+     * handling any other request.
+     *
+     * @param holders Filled in with the ports still holding the victim.
+     * @return A clean-and-invalidate request for the victim line, or
+     *         nullptr if nothing with holders was evicted.
+     */
+    RequestPtr takeEviction(SnoopList& holders);
+
+    /**
+     * Record a CPU-side port as a holder of a line that a cache above
+     * it restored from a checkpoint. This is the functional equivalent
+     * of the fill that brought the line in before the checkpoint.
+     *
+     * @param cpkt          Restored block notification. Not changed.
+     * @param cpu_side_port Response port where the notification came from.
+     * @return False if a set-associative filter has no free way for
+     *         the line, as a functional access cannot back-invalidate.
+     */
+    bool addRestoredHolder(const Packet* cpkt,
+                           const ResponsePort& cpu_side_port);
+
     /**
      * For an un-successful request, revert the change to the snoop
      * filter. Also take care of erasing any null entries. This method
@@ -220,11 +268,6 @@ class SnoopFilter : public SimObject
         SnoopMask requested;
         SnoopMask holder;
     };
-    /**
-     * HashMap of SnoopItems indexed by line address
-     */
-    typedef std::unordered_map<Addr, SnoopItem> SnoopFilterCache;
-
     /**
      * Simple factory methods for standard return values.
      */
@@ -258,13 +301,107 @@ class SnoopFilter : public SimObject
 
   private:
 
+    /** Marker for "no slot", both for lookups and reqLookupResult. */
+    static constexpr size_t NoSlot = SIZE_MAX;
+
+    /** Tag of an unused slot, never a valid (aligned) line address. */
+    static constexpr Addr InvalidTag = MaxAddr;
+
+    /** Initial number of slots of an unbounded filter. */
+    static constexpr size_t InitialSlots = 1024;
+
+    /** Line address, including the LineSecure bit, of a packet. */
+    Addr
+    lineAddress(const Packet* cpkt) const
+    {
+        Addr line_addr = cpkt->getBlockAddr(linesize);
+        if (cpkt->isSecure()) {
+            line_addr |= LineSecure;
+        }
+        return line_addr;
+    }
+
+    /** (Re)allocate empty storage for the given number of slots. */
+    void allocateStorage(size_t num_slots);
+
+    /** Home slot of a line in the unbounded table, first way if not. */
+    size_t homeSlot(Addr line_addr) const;
+
+    /** Slot holding a line, NoSlot if it is not tracked. */
+    size_t findSlot(Addr line_addr) const;
+
+    /**
+     * Allocate an empty entry for a line that is known not to be
+     * tracked. This may grow an unbounded table, or evict a victim
+     * from a set-associative one.
+     */
+    size_t allocateSlot(Addr line_addr);
+
+    /** Double the size of an unbounded table and rehash its entries. */
+    void grow();
+
+    /** Way of a set that allocateSlot would evict, NoSlot if none. */
+    size_t findVictim(size_t first_way) const;
+
+    /** Drop the entry in a slot, compacting probe chains if unbounded. */
+    void eraseSlot(size_t slot);
+
+    /** Unpack the sharer vectors of a slot. */
+    SnoopItem loadItem(size_t slot) const;
+
+    /** Pack the sharer vectors of a slot. */
+    void storeItem(size_t slot, const SnoopItem& item);
+
     /**
-     * Removes snoop filter items which have no requestors and no holders.
+     * Write back an updated item and remove the entry if it has no
+     * requestors and no holders.
      */
-    void eraseIfNullEntry(SnoopFilterCache::iterator& sf_it);
+    void updateOrErase(size_t slot, const SnoopItem& item);
+
+    /** Associativity, zero for an unbounded filter. */
+    const unsigned assoc;
+
+    /** Number of sets of a set-associative filter. */
+    size_t numSets;
 
-    /** Simple hash set of cached addresses. */
-    SnoopFilterCache cachedLocations;
+    /** Line address tracked by each slot, InvalidTag if unused. */
+    std::vector<Addr> tags;
+
+    /**
+     * Requested and holder vectors of each slot, maskWords words each,
+     * one after the other.
+     */
+    std::vector<uint64_t> masks;
+
+    /** Last use of each slot, for replacement in a set-associative filter. */
+    std::vector<uint64_t> lastUse;
+
+    /** Running counter used to stamp lastUse. */
+    uint64_t useCounter;
+
+    /** Number of 64-bit words per sharer vector. */
+    unsigned maskWords;
+
+    /** Number of tracked lines. */
+    size_t numEntries;
+
+    /** Number of slots minus one, for an unbounded filter. */
+    size_t slotMask;
+
+    /** Shift turning a hashed line address into a home slot. */
+    unsigned hashShift;
+
+    /** Log2 of the cache line size. */
+    unsigned lineShift;
+
+    /** Line evicted by the last lookupRequest, InvalidTag if none. */
+    Addr evictedLine;
+
+    /** Holders of the evicted line. */
+    SnoopMask evictedHolders;
+
+    /** Requestor used for back-invalidations. */
+    const RequestorID requestorId;
 
     /**
      * A request lookup must be followed by a call to finishRequest to inform
@@ -274,27 +411,21 @@ class SnoopFilter : public SimObject
      */
     struct ReqLookupResult
     {
-        /** Iterator used to store the result from lookupRequest. */
-        SnoopFilterCache::iterator it;
+        /** Slot used to store the result from lookupRequest. */
+        size_t slot = NoSlot;
 
         /**
-         * Variable to temporarily store value of snoopfilter entry
-         * in case finishRequest needs to undo changes made in lookupRequest
-         * (because of crossbar retry)
+         * Line address of the entry, as erasing other entries may
+         * move it to a different slot in an unbounded filter.
          */
-        SnoopItem retryItem;
+        Addr lineAddr = InvalidTag;
 
         /**
-         * The constructor must be informed of the internal cache's end
-         * iterator, so do not allow the compiler to implictly define it.
-         *
-         * @param end_it Iterator to the end of the internal cache.
+         * Variable to temporarily store value of snoopfilter entry
+         * in case finishRequest needs to undo changes made in lookupRequest
+         * (because of crossbar retry)
          */
-        ReqLookupResult(SnoopFilterCache::iterator end_it)
-            : it(end_it), retryItem{0, 0}
-        {
-        }
-        ReqLookupResult() = delete;
+        SnoopItem retryItem{0, 0};
     } reqLookupResult;
 
     /** List of all attached snooping CPU-side ports. */
@@ -305,7 +436,10 @@ class SnoopFilter : public SimObject
     const unsigned linesize;
     /** Latency for doing a lookup in the filter */
     const Cycles lookupLatency;
-    /** Max capacity in terms of cache blocks tracked, for sanity checking */
+    /**
+     * Max capacity in terms of cache blocks tracked, for sanity checking
+     * or as the actual size of a set-associative filter
+     */
     const unsigned maxEntryCount;
 
     /**
@@ -329,6 +463,10 @@ class SnoopFilter : public SimObject
         statistics::Scalar totSnoops;
         statistics::Scalar hitSingleSnoops;
         statistics::Scalar hitMultiSnoops;
+
+        statistics::Scalar evictions;
+        statistics::Scalar backInvalidations;
+        statistics::Scalar allocationStalls;
     } stats;
 };
 
@@ -61,6 +61,7 @@ BaseXBar::BaseXBar(const BaseXBarParams &p)
       responseLatency(p.response_latency),
       headerLatency(p.header_latency),
       width(p.width),
+      usePortDecoder(false),
       gotAddrRanges(p.port_default_connection_count +
                           p.port_mem_side_ports_connection_count, false),
       gotAllAddrRanges(false), defaultPortID(InvalidPortID),
@@ -71,7 +72,14 @@ BaseXBar::BaseXBar(const BaseXBarParams &p)
       ADD_STAT(pktCount, statistics::units::Count::get(),
                "Packet count per connected requestor and responder"),
       ADD_STAT(pktSize, statistics::units::Byte::get(),
-               "Cumulative packet size per connected requestor and responder")
+               "Cumulative packet size per connected requestor and responder"),
+      ADD_STAT(decodeHits, statistics::units::Count::get(),
+               "Address lookups that matched the range of a port"),
+      ADD_STAT(decodeCachedHits, statistics::units::Count::get(),
+               "Address lookups that matched the range of the previous "
+               "lookup"),
+      ADD_STAT(decodeDefault, statistics::units::Count::get(),
+               "Address lookups sent to the default port")
 {
 }
 
@@ -334,10 +342,22 @@ BaseXBar::findPort(AddrRange addr_range)
     // ranges of all connected CPU-side-port modules
     assert(gotAllAddrRanges);
 
-    // Check the address map interval tree
-    auto i = portMap.contains(addr_range);
-    if (i != portMap.end()) {
-        return i->second;
+    if (usePortDecoder) {
+        bool cached;
+        const PortID *port = portDecoder.find(addr_range, &cached);
+        if (port) {
+            decodeHits++;
+            if (cached)
+                decodeCachedHits++;
+            return *port;
+        }
+    } else {
+        // Check the address map interval tree
+        auto i = portMap.contains(addr_range);
+        if (i != portMap.end()) {
+            decodeHits++;
+            return i->second;
+        }
     }
 
     // Check if this matches the default range
@@ -345,11 +365,13 @@ BaseXBar::findPort(AddrRange addr_range)
         if (addr_range.isSubset(defaultRange)) {
             DPRINTF(AddrRanges, "  found addr %s on default\n",
                     addr_range.to_string());
+            decodeDefault++;
             return defaultPortID;
         }
     } else if (defaultPortID != InvalidPortID) {
         DPRINTF(AddrRanges, "Unable to find destination for %s, "
                 "will use default port\n", addr_range.to_string());
+        decodeDefault++;
         return defaultPortID;
     }
 
@@ -431,6 +453,12 @@ BaseXBar::recvRangeChange(PortID mem_side_port_id)
                       memSidePorts[conflict_id]->getPeer());
             }
         }
+
+        usePortDecoder = portDecoder.build(portMap.begin(), portMap.end());
+        if (!usePortDecoder) {
+            DPRINTF(AddrRanges, "Ranges cannot be flattened, decoding "
+                    "through the range map\n");
+        }
     }
 
     // if we have received ranges from all our neighbouring CPU-side-port
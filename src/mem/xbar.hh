@@ -49,6 +49,7 @@
 #include <deque>
 #include <unordered_map>
 
+#include "base/addr_range_decoder.hh"
 #include "base/addr_range_map.hh"
 #include "base/types.hh"
 #include "mem/qport.hh"
@@ -318,6 +319,14 @@ class BaseXBar : public ClockedObject
 
     AddrRangeMap<PortID, 3> portMap;
 
+    /**
+     * Flat copy of portMap used to decode the packet addresses,
+     * rebuilt whenever a range changes. If the ranges cannot be
+     * represented by the decoder, portMap is used instead.
+     */
+    AddrRangeDecoder<PortID> portDecoder;
+    bool usePortDecoder;
+
     /**
      * Remember where request packets came from so that we can route
      * responses to the appropriate port. This relies on the fact that
@@ -403,6 +412,15 @@ class BaseXBar : public ClockedObject
     statistics::Vector2d pktCount;
     statistics::Vector2d pktSize;
 
+    /**
+     * Address decoding statistics: lookups that matched the range of a
+     * port, the part of them that hit the range of the previous
+     * lookup, and lookups that fell through to the default port.
+     */
+    statistics::Scalar decodeHits;
+    statistics::Scalar decodeCachedHits;
+    statistics::Scalar decodeDefault;
+
   public:
 
     virtual ~BaseXBar();
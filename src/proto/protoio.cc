@@ -37,133 +37,711 @@
 
 #include "proto/protoio.hh"
 
+#include <fcntl.h>
+#include <google/protobuf/io/coded_stream.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include <algorithm>
+#include <cstring>
 #include <string>
+#include <vector>
 
 #include "base/logging.hh"
+#include "config/have_zstd.hh"
+
+#if HAVE_ZSTD
+#include <zstd.h>
+#endif
 
 using namespace google::protobuf;
 
-ProtoOutputStream::ProtoOutputStream(const std::string& filename) :
+/**
+ * Compresses blocks of data on their way to the output file.
+ */
+class ProtoEncoder
+{
+  public:
+    virtual ~ProtoEncoder() {}
+
+    /**
+     * Compress and write a block of data.
+     */
+    virtual void write(const char* data, size_t size) = 0;
+
+    /**
+     * Write out anything still buffered and end the compressed stream.
+     */
+    virtual void finish() {}
+
+    /**
+     * End the compressed stream and start a new one, so that the data
+     * that follows can be decompressed without what came before.
+     */
+    virtual void endBlock() {}
+};
+
+/**
+ * Decompresses the input file into blocks of data.
+ */
+class ProtoDecoder
+{
+  public:
+    /**
+     * @param in File to read, positioned at the start of the data
+     * @param limit Amount of file data to read at most
+     */
+    ProtoDecoder(std::ifstream& in, uint64_t limit) : in(in), limit(limit)
+    {}
+
+    virtual ~ProtoDecoder() {}
+
+    /**
+     * Read and decompress as much data as fits the buffer.
+     *
+     * @return Number of bytes produced, less than size only at the
+     *         end of the file
+     */
+    virtual size_t read(char* data, size_t size) = 0;
+
+  protected:
+    /**
+     * Read raw data from the file, stopping at the limit.
+     */
+    size_t readFile(char* data, size_t size)
+    {
+        in.read(data, std::min<uint64_t>(size, limit));
+        limit -= in.gcount();
+        return in.gcount();
+    }
+
+  private:
+    std::ifstream& in;
+    uint64_t limit;
+};
+
+namespace
+{
+
+class PlainEncoder : public ProtoEncoder
+{
+  public:
+    PlainEncoder(std::ofstream& out) : out(out) {}
+
+    void write(const char* data, size_t size) override
+    {
+        out.write(data, size);
+    }
+
+  private:
+    std::ofstream& out;
+};
+
+class PlainDecoder : public ProtoDecoder
+{
+  public:
+    using ProtoDecoder::ProtoDecoder;
+
+    size_t read(char* data, size_t size) override
+    {
+        return readFile(data, size);
+    }
+};
+
+class GzipEncoder : public ProtoEncoder
+{
+  public:
+    GzipEncoder(std::ofstream& out) : out(out), zs(), chunk(bufferSize)
+    {
+        // adding 16 to the window bits selects a gzip rather than a
+        // zlib wrapper, keeping the files readable by gzip tools
+        if (deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+                         16 + MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+            panic("Could not initialise gzip compression\n");
+    }
+
+    ~GzipEncoder() { deflateEnd(&zs); }
+
+    void write(const char* data, size_t size) override
+    {
+        zs.next_in = (Bytef*)data;
+        zs.avail_in = size;
+        deflateAll(Z_NO_FLUSH);
+    }
+
+    void finish() override
+    {
+        zs.next_in = nullptr;
+        zs.avail_in = 0;
+        deflateAll(Z_FINISH);
+    }
+
+    void endBlock() override
+    {
+        // every block becomes a gzip member of its own
+        finish();
+        deflateReset(&zs);
+    }
+
+  private:
+    void deflateAll(int flush)
+    {
+        do {
+            zs.next_out = (Bytef*)chunk.data();
+            zs.avail_out = chunk.size();
+            if (deflate(&zs, flush) == Z_STREAM_ERROR)
+                panic("Gzip compression failed\n");
+            out.write(chunk.data(), chunk.size() - zs.avail_out);
+        } while (zs.avail_out == 0);
+    }
+
+    static constexpr size_t bufferSize = 1 << 16;
+
+    std::ofstream& out;
+    z_stream zs;
+    std::vector<char> chunk;
+};
+
+class GzipDecoder : public ProtoDecoder
+{
+  public:
+    GzipDecoder(std::ifstream& in, uint64_t limit, const std::string& name)
+        : ProtoDecoder(in, limit), name(name), zs(), chunk(bufferSize)
+    {
+        if (inflateInit2(&zs, 16 + MAX_WBITS) != Z_OK)
+            panic("Could not initialise gzip decompression\n");
+    }
+
+    ~GzipDecoder() { inflateEnd(&zs); }
+
+    size_t read(char* data, size_t size) override
+    {
+        zs.next_out = (Bytef*)data;
+        zs.avail_out = size;
+        while (zs.avail_out) {
+            if (zs.avail_in == 0) {
+                zs.next_in = (Bytef*)chunk.data();
+                zs.avail_in = readFile(chunk.data(), chunk.size());
+                if (zs.avail_in == 0)
+                    break;
+            }
+            int ret = inflate(&zs, Z_NO_FLUSH);
+            if (ret == Z_STREAM_END) {
+                // carry on with any further gzip member
+                inflateReset(&zs);
+            } else if (ret != Z_OK && ret != Z_BUF_ERROR) {
+                panic("Corrupt gzip data in %s\n", name);
+            }
+        }
+        return size - zs.avail_out;
+    }
+
+  private:
+    static constexpr size_t bufferSize = 1 << 16;
+
+    const std::string& name;
+    z_stream zs;
+    std::vector<char> chunk;
+};
+
+#if HAVE_ZSTD
+class ZstdEncoder : public ProtoEncoder
+{
+  public:
+    ZstdEncoder(std::ofstream& out)
+        : out(out), cctx(ZSTD_createCCtx()), chunk(ZSTD_CStreamOutSize())
+    {
+        if (!cctx)
+            panic("Could not initialise zstd compression\n");
+    }
+
+    ~ZstdEncoder() { ZSTD_freeCCtx(cctx); }
+
+    void write(const char* data, size_t size) override
+    {
+        compress(data, size, ZSTD_e_continue);
+    }
+
+    void finish() override { compress(nullptr, 0, ZSTD_e_end); }
+
+    // ending a frame also starts a new one for what follows
+    void endBlock() override { finish(); }
+
+  private:
+    void compress(const char* data, size_t size, ZSTD_EndDirective mode)
+    {
+        ZSTD_inBuffer input = { data, size, 0 };
+        bool done;
+        do {
+            ZSTD_outBuffer output = { chunk.data(), chunk.size(), 0 };
+            size_t remaining =
+                ZSTD_compressStream2(cctx, &output, &input, mode);
+            if (ZSTD_isError(remaining))
+                panic("Zstd compression failed: %s\n",
+                      ZSTD_getErrorName(remaining));
+            out.write(chunk.data(), output.pos);
+            done = mode == ZSTD_e_end ? remaining == 0 :
+                input.pos == input.size;
+        } while (!done);
+    }
+
+    std::ofstream& out;
+    ZSTD_CCtx* cctx;
+    std::vector<char> chunk;
+};
+
+class ZstdDecoder : public ProtoDecoder
+{
+  public:
+    ZstdDecoder(std::ifstream& in, uint64_t limit, const std::string& name)
+        : ProtoDecoder(in, limit), name(name), dctx(ZSTD_createDCtx()),
+          chunk(ZSTD_DStreamInSize()), input{ chunk.data(), 0, 0 }
+    {
+        if (!dctx)
+            panic("Could not initialise zstd decompression\n");
+    }
+
+    ~ZstdDecoder() { ZSTD_freeDCtx(dctx); }
+
+    size_t read(char* data, size_t size) override
+    {
+        ZSTD_outBuffer output = { data, size, 0 };
+        while (output.pos < output.size) {
+            if (input.pos == input.size) {
+                input.size = readFile(chunk.data(), chunk.size());
+                input.pos = 0;
+                if (input.size == 0)
+                    break;
+            }
+            size_t ret = ZSTD_decompressStream(dctx, &output, &input);
+            if (ZSTD_isError(ret))
+                panic("Corrupt zstd data in %s: %s\n", name,
+                      ZSTD_getErrorName(ret));
+        }
+        return output.pos;
+    }
+
+  private:
+    const std::string& name;
+    ZSTD_DCtx* dctx;
+    std::vector<char> chunk;
+    ZSTD_inBuffer input;
+};
+#endif
+
+bool
+hasSuffix(const std::string& filename, const std::string& suffix)
+{
+    return filename.size() >= suffix.size() &&
+        filename.compare(filename.size() - suffix.size(), suffix.size(),
+                         suffix) == 0;
+}
+
+uint32_t
+readLE32(const void* data)
+{
+    const uint8_t* bytes = (const uint8_t*)data;
+    return bytes[0] | bytes[1] << 8 | bytes[2] << 16 |
+        (uint32_t)bytes[3] << 24;
+}
+
+uint64_t
+readLE64(const void* data)
+{
+    return readLE32(data) |
+        (uint64_t)readLE32((const uint8_t*)data + 4) << 32;
+}
+
+} // anonymous namespace
+
+
+ProtoOutputStream::ProtoOutputStream(const std::string& filename,
+                                     bool indexed) :
     fileStream(filename.c_str(),
             std::ios::out | std::ios::binary | std::ios::trunc),
-    wrappedFileStream(NULL), gzipStream(NULL), zeroCopyStream(NULL)
+    drainPending(false), closing(false), indexed(indexed),
+    blockSize(indexed ? indexBlockSize : bufferSize), numRecords(0),
+    timed(false), fillEntry(), fillTimed(false), drainEntry(),
+    drainTimed(false)
 {
     if (!fileStream.good())
         panic("Could not open %s for writing\n", filename);
 
-    // Wrap the output file in a zero copy stream, that in turn is
-    // wrapped in a gzip stream if the filename ends with .gz. The
-    // latter stream is in turn wrapped in a coded stream
-    wrappedFileStream = new io::OstreamOutputStream(&fileStream);
-    if (filename.find_last_of('.') != std::string::npos &&
-        filename.substr(filename.find_last_of('.') + 1) == "gz") {
-        gzipStream = new io::GzipOutputStream(wrappedFileStream);
-        zeroCopyStream = gzipStream;
+    // Compress the output if the file name asks for it
+    Codec codec = Codec::None;
+    if (hasSuffix(filename, ".gz")) {
+        codec = Codec::Gzip;
+        encoder.reset(new GzipEncoder(fileStream));
+    } else if (hasSuffix(filename, ".zst")) {
+#if HAVE_ZSTD
+        codec = Codec::Zstd;
+        encoder.reset(new ZstdEncoder(fileStream));
+#else
+        fatal("Cannot write %s, gem5 was built without zstd support\n",
+              filename);
+#endif
     } else {
-        zeroCopyStream = wrappedFileStream;
+        encoder.reset(new PlainEncoder(fileStream));
     }
 
-    // Write the magic number to the file
-    io::CodedOutputStream codedStream(zeroCopyStream);
-    codedStream.WriteLittleEndian32(magicNumber);
+    fillBuffer.reserve(blockSize);
+
+    if (indexed) {
+        // The header of an indexed file stays uncompressed so that
+        // readers can tell the format and codec up front
+        uint8_t header[indexHeaderSize] = {};
+        io::CodedOutputStream::WriteLittleEndian32ToArray(indexMagic,
+                                                          header);
+        io::CodedOutputStream::WriteLittleEndian32ToArray(indexVersion,
+                                                          header + 4);
+        io::CodedOutputStream::WriteLittleEndian32ToArray(
+            static_cast<uint32_t>(codec), header + 8);
+        fileStream.write((const char*)header, sizeof(header));
+    } else {
+        // Write the magic number to the file
+        uint8_t magic[sizeof(magicNumber)];
+        io::CodedOutputStream::WriteLittleEndian32ToArray(magicNumber,
+                                                          magic);
+        fillBuffer.append((const char*)magic, sizeof(magic));
+    }
 
     // Note that each type of stream (packet, instruction etc) should
     // add its own header and perform the appropriate checks
+
+    thread = std::thread(&ProtoOutputStream::ioThread, this);
 }
 
 ProtoOutputStream::~ProtoOutputStream()
 {
-    // As the compression is optional, see if the stream exists
-    if (gzipStream != NULL)
-        delete gzipStream;
-    delete wrappedFileStream;
+    if (!fillBuffer.empty())
+        handOver();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        closing = true;
+    }
+    cond.notify_all();
+    thread.join();
+
+    // the blocks of an indexed file are complete streams already
+    if (indexed)
+        writeIndex();
+    else
+        encoder->finish();
     fileStream.close();
 }
 
 void
 ProtoOutputStream::write(const Message& msg)
 {
-    // Due to the byte limit of the coded stream we create it for
-    // every single mesage (based on forum discussions around the size
-    // limitation)
-    io::CodedOutputStream codedStream(zeroCopyStream);
-
-    // Write the size of the message to the stream
+    // Get the size of the message, which also caches the sizes of
+    // any nested messages for the serialisation below
 #   if GOOGLE_PROTOBUF_VERSION < 3001000
         auto msg_size = msg.ByteSize();
 #   else
         auto msg_size = msg.ByteSizeLong();
 #   endif
-    codedStream.WriteVarint32(msg_size);
 
-    // Write the message itself to the stream
-    msg.SerializeWithCachedSizes(&codedStream);
+    // Encode the size followed by the message straight into the
+    // buffer, compression and I/O are left to the I/O thread
+    const size_t offset = fillBuffer.size();
+    fillBuffer.resize(offset + io::CodedOutputStream::VarintSize32(msg_size) +
+                      msg_size);
+    uint8_t* dst = (uint8_t*)&fillBuffer[offset];
+    dst = io::CodedOutputStream::WriteVarint32ToArray(msg_size, dst);
+    msg.SerializeWithCachedSizesToArray(dst);
+    ++numRecords;
+
+    if (fillBuffer.size() >= blockSize)
+        handOver();
+}
+
+void
+ProtoOutputStream::write(const Message& msg, uint64_t tick)
+{
+    if (indexed && !fillTimed) {
+        // Keep the records preceding the first timed one in a block
+        // of their own, which the index leaves out
+        if (!timed && !fillBuffer.empty())
+            handOver();
+        fillEntry.tick = tick;
+        fillTimed = timed = true;
+    }
+    write(msg);
+}
+
+void
+ProtoOutputStream::handOver()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    cond.wait(lock, [this] { return !drainPending; });
+    fillBuffer.swap(drainBuffer);
+    drainEntry = fillEntry;
+    drainTimed = fillTimed;
+    drainPending = true;
+    lock.unlock();
+    cond.notify_all();
+
+    // the buffer we got back has been drained, but keeps its capacity
+    fillBuffer.clear();
+    fillEntry.record = numRecords;
+    fillTimed = false;
+}
+
+void
+ProtoOutputStream::ioThread()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        cond.wait(lock, [this] { return drainPending || closing; });
+        if (!drainPending)
+            break;
+
+        // the simulation thread leaves drainBuffer and drainEntry
+        // alone until we clear drainPending, so there is no need to
+        // hold the lock
+        lock.unlock();
+        const uint64_t offset = fileStream.tellp();
+        encoder->write(drainBuffer.data(), drainBuffer.size());
+        drainBuffer.clear();
+        if (indexed) {
+            encoder->endBlock();
+            if (drainTimed) {
+                drainEntry.offset = offset;
+                drainEntry.size = (uint64_t)fileStream.tellp() - offset;
+                index.push_back(drainEntry);
+            }
+        }
+        lock.lock();
+
+        drainPending = false;
+        cond.notify_all();
+    }
+}
+
+void
+ProtoOutputStream::writeIndex()
+{
+    const uint64_t index_offset = fileStream.tellp();
+
+    std::vector<uint8_t> data(index.size() * indexEntrySize +
+                              indexTrailerSize);
+    uint8_t* dst = data.data();
+    for (const auto& entry : index) {
+        dst = io::CodedOutputStream::WriteLittleEndian64ToArray(entry.tick,
+                                                                dst);
+        dst = io::CodedOutputStream::WriteLittleEndian64ToArray(
+            entry.record, dst);
+        dst = io::CodedOutputStream::WriteLittleEndian64ToArray(
+            entry.offset, dst);
+        dst = io::CodedOutputStream::WriteLittleEndian64ToArray(entry.size,
+                                                                dst);
+    }
+    dst = io::CodedOutputStream::WriteLittleEndian64ToArray(index_offset, dst);
+    dst = io::CodedOutputStream::WriteLittleEndian64ToArray(index.size(),
+                                                            dst);
+    dst = io::CodedOutputStream::WriteLittleEndian32ToArray(magicNumber, dst);
+    io::CodedOutputStream::WriteLittleEndian32ToArray(indexMagic, dst);
+
+    fileStream.write((const char*)data.data(), data.size());
 }
 
 ProtoInputStream::ProtoInputStream(const std::string& filename) :
     fileStream(filename.c_str(), std::ios::in | std::ios::binary),
-    fileName(filename), useGzip(false),
-    wrappedFileStream(NULL), gzipStream(NULL), zeroCopyStream(NULL)
+    fileName(filename), codec(Codec::None), indexed(false), dataBegin(0),
+    dataEnd(0), mapping(nullptr), mappingSize(0), mapPos(0), windowPos(0),
+    readPos(0), readLast(false), nextReady(false), nextLast(false),
+    stopping(false)
 {
     if (!fileStream.good())
         panic("Could not open %s for reading\n", filename);
 
-    // check the magic number to see if this is a gzip stream
-    unsigned char bytes[2];
-    fileStream.read((char*) bytes, 2);
-    useGzip = fileStream.good() && bytes[0] == 0x1f && bytes[1] == 0x8b;
+    fileStream.seekg(0, std::ifstream::end);
+    dataEnd = fileStream.tellg();
+    fileStream.seekg(0, std::ifstream::beg);
+
+    // check the first bytes to see if this is an indexed file, or a
+    // gzip or zstd stream
+    unsigned char bytes[4];
+    fileStream.read((char*) bytes, 4);
+    if (fileStream.gcount() == 4 && readLE32(bytes) == indexMagic) {
+        readIndex();
+    } else if (fileStream.gcount() >= 2 && bytes[0] == 0x1f &&
+               bytes[1] == 0x8b) {
+        codec = Codec::Gzip;
+    } else if (fileStream.gcount() == 4 && bytes[0] == 0x28 &&
+               bytes[1] == 0xb5 && bytes[2] == 0x2f && bytes[3] == 0xfd) {
+        codec = Codec::Zstd;
+    }
+
+#if !HAVE_ZSTD
+    if (codec == Codec::Zstd)
+        fatal("Cannot read %s, gem5 was built without zstd support\n",
+              filename);
+#endif
+
+    if (codec == Codec::None)
+        mapFile();
 
-    // seek to the start of the input file and clear any flags
+    createStreams(dataBegin);
+}
+
+void
+ProtoInputStream::readIndex()
+{
+    indexed = true;
+
+    uint8_t header[indexHeaderSize];
     fileStream.clear();
     fileStream.seekg(0, std::ifstream::beg);
+    fileStream.read((char*)header, sizeof(header));
+    if (fileStream.gcount() != sizeof(header) ||
+        dataEnd < indexHeaderSize + indexTrailerSize)
+        panic("Indexed file %s is truncated\n", fileName);
+    if (readLE32(header + 4) != indexVersion)
+        panic("Indexed file %s has unsupported version %d\n", fileName,
+              readLE32(header + 4));
+    const uint32_t codec_id = readLE32(header + 8);
+    if (codec_id > static_cast<uint32_t>(Codec::Zstd))
+        panic("Indexed file %s has unknown compression %d\n", fileName,
+              codec_id);
+    codec = static_cast<Codec>(codec_id);
+
+    uint8_t trailer[indexTrailerSize];
+    fileStream.seekg(dataEnd - indexTrailerSize, std::ifstream::beg);
+    fileStream.read((char*)trailer, sizeof(trailer));
+    if (readLE32(trailer + 16) != magicNumber ||
+        readLE32(trailer + 20) != indexMagic)
+        panic("Indexed file %s is truncated\n", fileName);
+    const uint64_t index_offset = readLE64(trailer);
+    const uint64_t num_entries = readLE64(trailer + 8);
+    if (index_offset < indexHeaderSize ||
+        index_offset + num_entries * indexEntrySize !=
+        dataEnd - indexTrailerSize)
+        panic("Indexed file %s has a corrupt index\n", fileName);
 
-    createStreams();
+    std::vector<uint8_t> data(num_entries * indexEntrySize);
+    fileStream.seekg(index_offset, std::ifstream::beg);
+    fileStream.read((char*)data.data(), data.size());
+    index.resize(num_entries);
+    for (uint64_t i = 0; i < num_entries; ++i) {
+        const uint8_t* src = &data[i * indexEntrySize];
+        index[i].tick = readLE64(src);
+        index[i].record = readLE64(src + 8);
+        index[i].offset = readLE64(src + 16);
+        index[i].size = readLE64(src + 24);
+    }
+
+    dataBegin = indexHeaderSize;
+    dataEnd = index_offset;
 }
 
 void
-ProtoInputStream::createStreams()
-{
-    // All streams should be NULL at this point
-    assert(wrappedFileStream == NULL && gzipStream == NULL &&
-           zeroCopyStream == NULL);
-
-    // Wrap the input file in a zero copy stream, that in turn is
-    // wrapped in a gzip stream if the filename ends with .gz. The
-    // latter stream is in turn wrapped in a coded stream
-    wrappedFileStream = new io::IstreamInputStream(&fileStream);
-    if (useGzip) {
-        gzipStream = new io::GzipInputStream(wrappedFileStream);
-        zeroCopyStream = gzipStream;
-    } else {
-        zeroCopyStream = wrappedFileStream;
+ProtoInputStream::mapFile()
+{
+    const int fd = open(fileName.c_str(), O_RDONLY);
+    if (fd < 0)
+        return;
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        void* addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd,
+                          0);
+        if (addr != MAP_FAILED) {
+            madvise(addr, st.st_size, MADV_SEQUENTIAL);
+            mapping = (const char*)addr;
+            mappingSize = st.st_size;
+        }
+    }
+    // the mapping stays valid without the descriptor, and if mapping
+    // failed we simply fall back to reading the file
+    close(fd);
+}
+
+void
+ProtoInputStream::createStreams(uint64_t offset)
+{
+    // The decoder should not exist at this point
+    assert(!decoder && !thread.joinable());
+
+    // Files without an index start with the magic number
+    const bool check_magic = !indexed && offset == 0;
+
+    if (mapping) {
+        mapPos = offset;
+        if (check_magic) {
+            if (dataEnd < sizeof(magicNumber) ||
+                readLE32(mapping) != magicNumber)
+                panic("Input file %s is not a valid gem5 proto format.\n",
+                      fileName);
+            mapPos += sizeof(magicNumber);
+        }
+        return;
+    }
+
+    // seek to the first record and clear any flags
+    fileStream.clear();
+    fileStream.seekg(offset, std::ifstream::beg);
+
+    const uint64_t limit = dataEnd - offset;
+    switch (codec) {
+      case Codec::Gzip:
+        decoder.reset(new GzipDecoder(fileStream, limit, fileName));
+        break;
+#if HAVE_ZSTD
+      case Codec::Zstd:
+        decoder.reset(new ZstdDecoder(fileStream, limit, fileName));
+        break;
+#endif
+      default:
+        decoder.reset(new PlainDecoder(fileStream, limit));
+        break;
     }
 
-    uint32_t magic_check;
-    io::CodedInputStream codedStream(zeroCopyStream);
-    if (!codedStream.ReadLittleEndian32(&magic_check) ||
-        magic_check != magicNumber)
-        panic("Input file %s is not a valid gem5 proto format.\n",
-              fileName);
+    window.clear();
+    windowPos = 0;
+
+    if (check_magic) {
+        if (!fill(sizeof(magicNumber)) ||
+            readLE32(&window[windowPos]) != magicNumber)
+            panic("Input file %s is not a valid gem5 proto format.\n",
+                  fileName);
+        windowPos += sizeof(magicNumber);
+    }
+
+    readBuffer.clear();
+    readPos = 0;
+    readLast = false;
+    nextReady = false;
+    nextLast = false;
+    stopping = false;
+
+    thread = std::thread(&ProtoInputStream::ioThread, this);
 }
 
 void
 ProtoInputStream::destroyStreams()
 {
-    // As the compression is optional, see if the stream exists
-    if (gzipStream != NULL) {
-        delete gzipStream;
-        gzipStream = NULL;
+    if (thread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        cond.notify_all();
+        thread.join();
     }
-    delete wrappedFileStream;
-    wrappedFileStream = NULL;
 
-    zeroCopyStream = NULL;
+    decoder.reset();
 }
 
 
 ProtoInputStream::~ProtoInputStream()
 {
     destroyStreams();
+    if (mapping)
+        munmap((void*)mapping, mappingSize);
     fileStream.close();
 }
 
@@ -172,35 +750,158 @@ void
 ProtoInputStream::reset()
 {
     destroyStreams();
-    // seek to the start of the input file and clear any flags
-    fileStream.clear();
-    fileStream.seekg(0, std::ifstream::beg);
-    createStreams();
+    createStreams(dataBegin);
 }
 
 bool
-ProtoInputStream::read(Message& msg)
+ProtoInputStream::seek(uint64_t tick)
 {
-    // Read a message from the stream by getting the size, using it as
-    // a limit when parsing the message, then popping the limit again
-    uint32_t size;
+    if (!indexed)
+        return false;
+
+    // Records of the tick may spill over from the block before the
+    // first one starting at or after it, so start from there
+    auto it = std::lower_bound(index.begin(), index.end(), tick,
+        [](const IndexEntry& entry, uint64_t t) { return entry.tick < t; });
+    if (it != index.begin())
+        --it;
+
+    destroyStreams();
+    createStreams(it == index.end() ? dataEnd : it->offset);
+    return true;
+}
+
+bool
+ProtoInputStream::fill(size_t size)
+{
+    while (window.size() - windowPos < size) {
+        // drop what has been consumed before growing the window
+        window.erase(0, windowPos);
+        windowPos = 0;
+
+        const size_t old_size = window.size();
+        window.resize(old_size + std::max(size, bufferSize));
+        const size_t got = decoder->read(&window[old_size],
+                                         window.size() - old_size);
+        window.resize(old_size + got);
+        if (got == 0)
+            return false;
+    }
+    return true;
+}
 
-    // Due to the byte limit of the coded stream we create it for
-    // every single mesage (based on forum discussions around the size
-    // limitation)
-    io::CodedInputStream codedStream(zeroCopyStream);
-    if (codedStream.ReadVarint32(&size)) {
-        io::CodedInputStream::Limit limit = codedStream.PushLimit(size);
-        if (msg.ParseFromCodedStream(&codedStream)) {
-            codedStream.PopLimit(limit);
-            // All went well, the message is parsed and the limit is
-            // popped again
+bool
+ProtoInputStream::readSize(uint32_t& size)
+{
+    // sizes are encoded as base 128 varints of at most five bytes
+    size = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (!fill(1)) {
+            if (shift != 0)
+                panic("Unable to read message from coded stream %s\n",
+                      fileName);
+            return false;
+        }
+        const uint8_t byte = window[windowPos++];
+        size |= uint32_t(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
             return true;
-        } else {
+    }
+    panic("Unable to read message from coded stream %s\n", fileName);
+}
+
+void
+ProtoInputStream::ioThread()
+{
+    std::string batch;
+    bool last = false;
+    while (!last) {
+        // Split off whole records, each stored as its size followed
+        // by the encoded message, until the batch is full or the
+        // file ends
+        batch.clear();
+        uint32_t size;
+        while (batch.size() < bufferSize) {
+            if (!readSize(size)) {
+                last = true;
+                break;
+            }
+            if (!fill(size))
+                panic("Unable to read message from coded stream %s\n",
+                      fileName);
+            batch.append((const char*)&size, sizeof(size));
+            batch.append(window, windowPos, size);
+            windowPos += size;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        cond.wait(lock, [this] { return !nextReady || stopping; });
+        if (stopping)
+            return;
+        nextBuffer.swap(batch);
+        nextReady = true;
+        nextLast = last;
+        lock.unlock();
+        cond.notify_all();
+    }
+}
+
+bool
+ProtoInputStream::readMapped(Message& msg)
+{
+    if (mapPos == dataEnd)
+        return false;
+
+    // sizes are encoded as base 128 varints of at most five bytes
+    uint32_t size = 0;
+    for (int shift = 0; ; shift += 7) {
+        if (mapPos == dataEnd || shift == 35)
             panic("Unable to read message from coded stream %s\n",
                   fileName);
-        }
+        const uint8_t byte = mapping[mapPos++];
+        size |= uint32_t(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+            break;
+    }
+
+    if (dataEnd - mapPos < size ||
+        !msg.ParseFromArray(mapping + mapPos, size))
+        panic("Unable to read message from coded stream %s\n", fileName);
+    mapPos += size;
+    return true;
+}
+
+bool
+ProtoInputStream::read(Message& msg)
+{
+    if (mapping)
+        return readMapped(msg);
+
+    if (readPos == readBuffer.size()) {
+        if (readLast)
+            return false;
+
+        // Swap in the records the I/O thread has prepared in the
+        // meantime, letting it go ahead with the next batch
+        std::unique_lock<std::mutex> lock(mutex);
+        cond.wait(lock, [this] { return nextReady; });
+        readBuffer.swap(nextBuffer);
+        readPos = 0;
+        readLast = nextLast;
+        nextReady = false;
+        lock.unlock();
+        cond.notify_all();
+
+        // only the final batch can be empty
+        if (readBuffer.empty())
+            return false;
     }
 
-    return false;
+    uint32_t size;
+    std::memcpy(&size, &readBuffer[readPos], sizeof(size));
+    readPos += sizeof(size);
+    if (!msg.ParseFromArray(&readBuffer[readPos], size))
+        panic("Unable to read message from coded stream %s\n", fileName);
+    readPos += size;
+    return true;
 }
@@ -44,16 +44,23 @@
 #ifndef __PROTO_PROTOIO_HH__
 #define __PROTO_PROTOIO_HH__
 
-#include <google/protobuf/io/coded_stream.h>
-#include <google/protobuf/io/gzip_stream.h>
-#include <google/protobuf/io/zero_copy_stream_impl.h>
 #include <google/protobuf/message.h>
 
+#include <condition_variable>
 #include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class ProtoEncoder;
+class ProtoDecoder;
 
 /**
  * A ProtoStream provides the shared functionality of the input and
- * output streams. At the moment this is limited to magic number.
+ * output streams, that is the magic number, the compression formats
+ * and the buffering between the simulation and the I/O thread.
  */
 class ProtoStream
 {
@@ -63,6 +70,60 @@ class ProtoStream
     /// Use the ASCII characters gem5 as our magic number
     static const uint32_t magicNumber = 0x356d6567;
 
+    /**
+     * Compression applied to the whole file. The output stream picks
+     * it from the file name, and the input stream from the leading
+     * bytes of the file, so any reader accepts any format it was
+     * built with.
+     */
+    enum class Codec
+    {
+        None,
+        Gzip,
+        Zstd
+    };
+
+    /**
+     * Amount of encoded records handed between the simulation thread
+     * and the I/O thread in one go.
+     */
+    static constexpr size_t bufferSize = 1 << 20;
+
+    /**
+     * An indexed file starts with a raw header holding the ASCII
+     * characters g5ix, the format version and the codec. It is
+     * followed by blocks of records that are each compressed on their
+     * own, an index locating every block and a raw trailer pointing
+     * at the index, so a reader can start decoding at any block.
+     * @{
+     */
+    static const uint32_t indexMagic = 0x78693567;
+    static const uint32_t indexVersion = 1;
+    static constexpr size_t indexHeaderSize = 16;
+    static constexpr size_t indexEntrySize = 32;
+    static constexpr size_t indexTrailerSize = 24;
+    /** @} */
+
+    /// Amount of encoded records in one block of an indexed file
+    static constexpr size_t indexBlockSize = 1 << 18;
+
+    /**
+     * Index entry locating a block of an indexed file. Records written
+     * before the first timed one, such as the stream header, are kept
+     * out of the index so that seeking never lands on them.
+     */
+    struct IndexEntry
+    {
+        /// Tick of the first timed record in the block
+        uint64_t tick;
+        /// Number of records written before the block
+        uint64_t record;
+        /// Offset of the block in the file
+        uint64_t offset;
+        /// Size of the block in the file
+        uint64_t size;
+    };
+
     /**
      * Create a ProtoStream.
      */
@@ -80,12 +141,16 @@ class ProtoStream
 };
 
 /**
- * A ProtoOutputStream wraps a coded stream, potentially with
- * compression, based on looking at the file name. Writing to the
- * stream is done to enable interaction with the file on a per-message
- * basis to avoid having to deal with huge data structures. The latter
- * is made possible by encoding the length of each message in the
- * stream.
+ * A ProtoOutputStream writes length-prefixed messages to a file,
+ * potentially with compression, based on looking at the file
+ * name. Writing to the stream is done to enable interaction with the
+ * file on a per-message basis to avoid having to deal with huge data
+ * structures. The latter is made possible by encoding the length of
+ * each message in the stream.
+ *
+ * Messages are only serialised on the calling thread. They are
+ * collected in a buffer that, once full, is handed to a background
+ * thread which compresses and writes it while the next one fills up.
  */
 class ProtoOutputStream : public ProtoStream
 {
@@ -94,15 +159,17 @@ class ProtoOutputStream : public ProtoStream
 
     /**
      * Create an output stream for a given file name. If the filename
-     * ends with .gz then the file will be compressed accordinly.
+     * ends with .gz the file will be compressed with gzip, and if it
+     * ends with .zst with zstd.
      *
      * @param filename Path to the file to create or truncate
+     * @param indexed Write an indexed file that readers can seek in
      */
-    ProtoOutputStream(const std::string& filename);
+    ProtoOutputStream(const std::string& filename, bool indexed = false);
 
     /**
      * Destruct the output stream, and also flush and close the
-     * underlying file streams and coded streams.
+     * underlying file stream.
      */
     ~ProtoOutputStream();
 
@@ -114,28 +181,98 @@ class ProtoOutputStream : public ProtoStream
      */
     void write(const google::protobuf::Message& msg);
 
+    /**
+     * Write a message that belongs to a given tick. In an indexed
+     * file this lets readers seek to the message by its tick, the
+     * ticks passed in must therefore never decrease.
+     *
+     * @param msg Message to write to the stream
+     * @param tick Tick the message belongs to
+     */
+    void write(const google::protobuf::Message& msg, uint64_t tick);
+
   private:
 
+    /**
+     * Pass the fill buffer on to the I/O thread, waiting for it to
+     * finish with the previous one if needed.
+     */
+    void handOver();
+
+    /**
+     * Append the index and trailer to an indexed file.
+     */
+    void writeIndex();
+
+    /**
+     * Main loop of the I/O thread.
+     */
+    void ioThread();
+
     /// Underlying file output stream
     std::ofstream fileStream;
 
-    /// Zero Copy stream wrapping the STL output stream
-    google::protobuf::io::OstreamOutputStream* wrappedFileStream;
+    /// Compression applied before writing to the file
+    std::unique_ptr<ProtoEncoder> encoder;
+
+    /// Buffer the simulation thread is encoding messages into
+    std::string fillBuffer;
+
+    /// Buffer the I/O thread is compressing and writing
+    std::string drainBuffer;
+
+    /// Set while drainBuffer holds data for the I/O thread
+    bool drainPending;
+
+    /// Set to stop the I/O thread once it is done with drainBuffer
+    bool closing;
+
+    /// Protects the hand over between the two threads
+    std::mutex mutex;
+
+    /// Signals changes of drainPending and closing
+    std::condition_variable cond;
+
+    /// Thread compressing and writing the data
+    std::thread thread;
+
+    /// Set when writing an indexed file
+    const bool indexed;
+
+    /// Amount of encoded records that is handed over in one go
+    const size_t blockSize;
+
+    /// Number of records written so far
+    uint64_t numRecords;
+
+    /// Set once a timed record has been written
+    bool timed;
 
-    /// Optional Gzip stream to wrap the Zero Copy stream
-    google::protobuf::io::GzipOutputStream* gzipStream;
+    /// Index entry of the block in fillBuffer, valid once timed
+    IndexEntry fillEntry;
+    bool fillTimed;
 
-    /// Top-level zero-copy stream, either with compression or not
-    google::protobuf::io::ZeroCopyOutputStream* zeroCopyStream;
+    /// Index entry of the block in drainBuffer, valid once timed
+    IndexEntry drainEntry;
+    bool drainTimed;
+
+    /// Index of the blocks written so far, owned by the I/O thread
+    std::vector<IndexEntry> index;
 
 };
 
 /**
- * A ProtoInputStream wraps a coded stream, potentially with
- * decompression, based on looking at the file name. Reading from the
- * stream is done on a per-message basis to avoid having to deal with
- * huge data structures. The latter assumes the length of each message
- * is encoded in the stream when it is written.
+ * A ProtoInputStream reads length-prefixed messages from a file,
+ * potentially with decompression, based on looking at the first bytes
+ * of the file. Reading from the stream is done on a per-message basis
+ * to avoid having to deal with huge data structures. The latter
+ * assumes the length of each message is encoded in the stream when it
+ * is written.
+ *
+ * A background thread decompresses the file and splits it into
+ * records ahead of the reader, so that only parsing the messages is
+ * left to the calling thread. Uncompressed files are instead mapped
+ * into memory and the messages parsed in place.
  */
 class ProtoInputStream : public ProtoStream
 {
@@ -143,8 +280,8 @@ class ProtoInputStream : public ProtoStream
   public:
 
     /**
-     * Create an input stream for a given file name. If the filename
-     * ends with .gz then the file will be decompressed accordingly.
+     * Create an input stream for a given file name. If the file is
+     * compressed it will be decompressed accordingly.
      *
      * @param filename Path to the file to read from
      */
@@ -152,7 +289,7 @@ class ProtoInputStream : public ProtoStream
 
     /**
      * Destruct the input stream, and also close the underlying file
-     * streams and coded streams.
+     * stream.
      */
     ~ProtoInputStream();
 
@@ -169,35 +306,134 @@ class ProtoInputStream : public ProtoStream
      */
     void reset();
 
+    /**
+     * Position an indexed stream ahead of the first record at or after
+     * a tick, skipping the records written before the first timed
+     * one. The stream may end up a number of records before that, the
+     * caller is left to skip them.
+     *
+     * @param tick Tick to look for
+     * @return False if the file is not indexed and nothing was done
+     */
+    bool seek(uint64_t tick);
+
   private:
 
     /**
-     * Create the internal streams that are wrapping the input file.
+     * Read the header, trailer and index of an indexed file.
      */
-    void createStreams();
+    void readIndex();
 
     /**
-     * Destroy the internal streams that are wrapping the input file.
+     * Try to map an uncompressed file into memory.
+     */
+    void mapFile();
+
+    /**
+     * Set up decompression of the input file, check the magic number
+     * if starting at the beginning of the file and start the I/O
+     * thread. Mapped files need neither of the two.
+     *
+     * @param offset File offset of the first record to read
+     */
+    void createStreams(uint64_t offset);
+
+    /**
+     * Stop the I/O thread and tear down decompression.
      */
     void destroyStreams();
 
+    /**
+     * Main loop of the I/O thread.
+     */
+    void ioThread();
+
+    /**
+     * Make sure the window holds at least a number of unconsumed
+     * bytes, decompressing more of the file as needed.
+     *
+     * @param size Number of bytes needed
+     * @return False if the file ends before that
+     */
+    bool fill(size_t size);
+
+    /**
+     * Read the size of the next record from the window.
+     *
+     * @param size Record size
+     * @return False at the end of the file
+     */
+    bool readSize(uint32_t& size);
+
+    /**
+     * Read a message from a mapped file.
+     */
+    bool readMapped(google::protobuf::Message& msg);
+
     /// Underlying file input stream
     std::ifstream fileStream;
 
     /// Hold on to the file name for debug messages
     const std::string fileName;
 
-    /// Boolean flag to remember whether we use gzip or not
-    bool useGzip;
+    /// Compression detected from the start of the file
+    Codec codec;
+
+    /// Set when reading an indexed file
+    bool indexed;
+
+    /// Index of the blocks of an indexed file
+    std::vector<IndexEntry> index;
+
+    /// File offsets of the first and past the last record byte
+    uint64_t dataBegin;
+    uint64_t dataEnd;
+
+    /// Memory mapping of an uncompressed file, if any
+    const char* mapping;
+    size_t mappingSize;
+
+    /// Offset of the next record in the mapping
+    uint64_t mapPos;
+
+    /// Decompression applied to the file
+    std::unique_ptr<ProtoDecoder> decoder;
+
+    /// Decompressed data not yet split into records
+    std::string window;
+
+    /// Start of the unconsumed part of the window
+    size_t windowPos;
+
+    /// Records the simulation thread is currently parsing
+    std::string readBuffer;
+
+    /// Position of the next record in readBuffer
+    size_t readPos;
+
+    /// Set once readBuffer holds the final records of the file
+    bool readLast;
+
+    /// Records the I/O thread has prepared next
+    std::string nextBuffer;
+
+    /// Set while nextBuffer is ready for the simulation thread
+    bool nextReady;
+
+    /// Set when nextBuffer holds the final records of the file
+    bool nextLast;
+
+    /// Set to stop the I/O thread
+    bool stopping;
 
-    /// Zero Copy stream wrapping the STL input stream
-    google::protobuf::io::IstreamInputStream* wrappedFileStream;
+    /// Protects the hand over between the two threads
+    std::mutex mutex;
 
-    /// Optional Gzip stream to wrap the Zero Copy stream
-    google::protobuf::io::GzipInputStream* gzipStream;
+    /// Signals changes of nextReady and stopping
+    std::condition_variable cond;
 
-    /// Top-level zero-copy stream, either with compression or not
-    google::protobuf::io::ZeroCopyInputStream* zeroCopyStream;
+    /// Thread decompressing the file and splitting it into records
+    std::thread thread;
 
 };
 
@@ -0,0 +1,380 @@
+/*
+ * Copyright (c) 2024 The University of Edinburgh
+ * All rights reserved
+ *
+ * The license below extends only to copyright in the software and shall
+ * not be construed as granting a license to any other intellectual
+ * property including but not limited to intellectual property relating
+ * to a hardware implementation of the functionality of the software
+ * licensed hereunder.  You may use the software subject to the license
+ * terms below provided that you ensure that this notice is replicated
+ * unmodified and in its entirety in all distributions of the software,
+ * modified or unmodified, in source code or in binary form.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <tuple>
+
+#include "base/gtest/logging.hh"
+#include "config/have_zstd.hh"
+#include "proto/packet.pb.h"
+#include "proto/protoio.hh"
+
+using namespace gem5;
+
+namespace
+{
+
+/// Number of packets in a trace, enough for several buffers and blocks
+const uint64_t numPackets = 200000;
+
+/// Ticks between the packets in a trace
+const uint64_t tickStep = 10;
+
+/**
+ * Create an empty temporary file with a given suffix and return its
+ * name, so that the streams pick the codec from it.
+ */
+std::string
+tempName(const std::string& suffix)
+{
+    std::string name = "protoio-XXXXXX" + suffix;
+    int fd = mkstemps(&name[0], suffix.size());
+    EXPECT_NE(-1, fd);
+    close(fd);
+    return name;
+}
+
+ProtoMessage::Packet
+makePacket(uint64_t i)
+{
+    ProtoMessage::Packet pkt;
+    pkt.set_tick(i * tickStep);
+    pkt.set_cmd(i % 3);
+    pkt.set_addr(0x1000 + i * 64);
+    pkt.set_size(64);
+    pkt.set_pkt_id(i);
+    return pkt;
+}
+
+/**
+ * Write a packet trace made of a header followed by numPackets
+ * packets, with the packets passed on as timed records.
+ */
+void
+writeTrace(const std::string& name, bool indexed,
+           const std::string& obj_id = "protoio.test")
+{
+    ProtoOutputStream out(name, indexed);
+
+    ProtoMessage::PacketHeader header;
+    header.set_obj_id(obj_id);
+    header.set_tick_freq(1000000000000ULL);
+    out.write(header);
+
+    for (uint64_t i = 0; i < numPackets; ++i) {
+        const ProtoMessage::Packet pkt = makePacket(i);
+        out.write(pkt, pkt.tick());
+    }
+}
+
+/**
+ * Read packets up to the end of a stream, checking that they follow
+ * on from a given packet.
+ */
+void
+expectPackets(ProtoInputStream& in, uint64_t first)
+{
+    ProtoMessage::Packet pkt;
+    uint64_t i = first;
+    while (in.read(pkt)) {
+        ASSERT_LT(i, numPackets);
+        ASSERT_EQ(pkt.pkt_id(), i);
+        ASSERT_EQ(pkt.tick(), i * tickStep);
+        ASSERT_EQ(pkt.addr(), 0x1000 + i * 64);
+        ++i;
+    }
+    EXPECT_EQ(i, numPackets);
+}
+
+void
+expectHeader(ProtoInputStream& in, const std::string& obj_id)
+{
+    ProtoMessage::PacketHeader header;
+    ASSERT_TRUE(in.read(header));
+    EXPECT_EQ(header.obj_id(), obj_id);
+    EXPECT_EQ(header.tick_freq(), 1000000000000ULL);
+}
+
+/**
+ * Cut a file down to a given size.
+ */
+void
+truncateFile(const std::string& name, off_t size)
+{
+    ASSERT_EQ(0, truncate(name.c_str(), size));
+}
+
+off_t
+fileSize(const std::string& name)
+{
+    std::ifstream file(name, std::ios::binary | std::ios::ate);
+    return file.tellg();
+}
+
+/**
+ * Fixture running each test on a trace file of every codec, both with
+ * and without an index.
+ */
+class ProtoIOTest
+    : public testing::TestWithParam<std::tuple<std::string, bool>>
+{
+  protected:
+    std::string name;
+    bool indexed;
+
+    void
+    SetUp() override
+    {
+        const std::string suffix = std::get<0>(GetParam());
+        indexed = std::get<1>(GetParam());
+#if !HAVE_ZSTD
+        if (suffix == ".zst")
+            GTEST_SKIP() << "Skipping as gem5 is built without zstd";
+#endif
+        name = tempName(suffix);
+    }
+
+    void
+    TearDown() override
+    {
+        if (!name.empty())
+            unlink(name.c_str());
+    }
+};
+
+} // anonymous namespace
+
+/**
+ * Records go through the double-buffered writer and reader, or the
+ * mapped reader for uncompressed files, unchanged and in order.
+ */
+TEST_P(ProtoIOTest, RoundTrip)
+{
+    writeTrace(name, indexed);
+
+    ProtoInputStream in(name);
+    expectHeader(in, "protoio.test");
+    expectPackets(in, 0);
+
+    // the end of the stream is sticky
+    ProtoMessage::Packet pkt;
+    EXPECT_FALSE(in.read(pkt));
+}
+
+/**
+ * A record larger than the buffers handed between the threads still
+ * comes through in one piece.
+ */
+TEST_P(ProtoIOTest, RecordLargerThanBuffer)
+{
+    const std::string obj_id(3 << 20, 'x');
+    writeTrace(name, indexed, obj_id);
+
+    ProtoInputStream in(name);
+    expectHeader(in, obj_id);
+    expectPackets(in, 0);
+}
+
+/**
+ * Resetting a stream part way through starts it over from the header.
+ */
+TEST_P(ProtoIOTest, Reset)
+{
+    writeTrace(name, indexed);
+
+    ProtoInputStream in(name);
+    expectHeader(in, "protoio.test");
+    ProtoMessage::Packet pkt;
+    for (int i = 0; i < 1000; ++i)
+        ASSERT_TRUE(in.read(pkt));
+
+    in.reset();
+    expectHeader(in, "protoio.test");
+    expectPackets(in, 0);
+}
+
+/**
+ * Seeking an indexed file lands on or before the first packet at the
+ * tick, past the header, while a file without an index stays put.
+ */
+TEST_P(ProtoIOTest, Seek)
+{
+    writeTrace(name, indexed);
+
+    ProtoInputStream in(name);
+    if (!indexed) {
+        EXPECT_FALSE(in.seek(numPackets / 2 * tickStep));
+        expectHeader(in, "protoio.test");
+        expectPackets(in, 0);
+        return;
+    }
+
+    for (uint64_t target : {numPackets - 1, numPackets / 2, uint64_t(0),
+                            uint64_t(12345), uint64_t(1)}) {
+        ASSERT_TRUE(in.seek(target * tickStep));
+
+        // the stream resumes with packets, never the header
+        ProtoMessage::Packet pkt;
+        ASSERT_TRUE(in.read(pkt));
+        const uint64_t first = pkt.pkt_id();
+        EXPECT_LE(first, target);
+        expectPackets(in, first + 1);
+    }
+
+    // a tick past the end leaves at most the last block to skip
+    ASSERT_TRUE(in.seek(numPackets * tickStep));
+    ProtoMessage::Packet pkt;
+    ASSERT_TRUE(in.read(pkt));
+    EXPECT_GT(pkt.pkt_id(), numPackets / 2);
+    expectPackets(in, pkt.pkt_id() + 1);
+
+    // and the stream can be started over afterwards
+    in.reset();
+    expectHeader(in, "protoio.test");
+    expectPackets(in, 0);
+}
+
+INSTANTIATE_TEST_SUITE_P(Codecs, ProtoIOTest,
+    testing::Combine(testing::Values("", ".gz", ".zst"), testing::Bool()),
+    [](const testing::TestParamInfo<ProtoIOTest::ParamType>& info) {
+        const std::string suffix = std::get<0>(info.param);
+        return std::string(suffix == ".gz" ? "Gzip" :
+                           suffix == ".zst" ? "Zstd" : "Plain") +
+            (std::get<1>(info.param) ? "Indexed" : "");
+    });
+
+/**
+ * A file that does not start with the magic number is rejected.
+ */
+TEST(ProtoIOCorruptTest, BadMagic)
+{
+    const std::string name = tempName("");
+    {
+        std::ofstream file(name, std::ios::binary);
+        file << "not a trace";
+    }
+
+    gtestLogOutput.str("");
+    EXPECT_THROW(ProtoInputStream in(name), GTestException);
+    EXPECT_NE(gtestLogOutput.str().find("not a valid gem5 proto format"),
+              std::string::npos);
+    unlink(name.c_str());
+}
+
+/**
+ * A mapped file cut off in the middle of a record panics once the
+ * reader gets there, after handing out the records before it.
+ */
+TEST(ProtoIOCorruptTest, TruncatedMapped)
+{
+    const std::string name = tempName("");
+    writeTrace(name, false);
+    truncateFile(name, fileSize(name) - 3);
+
+    ProtoInputStream in(name);
+    expectHeader(in, "protoio.test");
+    ProtoMessage::Packet pkt;
+    for (uint64_t i = 0; i < numPackets - 1; ++i)
+        ASSERT_TRUE(in.read(pkt));
+
+    gtestLogOutput.str("");
+    EXPECT_THROW(in.read(pkt), GTestException);
+    EXPECT_NE(gtestLogOutput.str().find("Unable to read message"),
+              std::string::npos);
+    unlink(name.c_str());
+}
+
+/**
+ * A compressed file cut off in the middle of a record makes the I/O
+ * thread panic, which takes the process down.
+ */
+TEST(ProtoIOCorruptTest, TruncatedGzip)
+{
+    const std::string name = tempName(".gz");
+    writeTrace(name, false);
+    truncateFile(name, fileSize(name) / 2);
+
+    EXPECT_DEATH({
+        ProtoInputStream in(name);
+        ProtoMessage::Packet pkt;
+        expectHeader(in, "protoio.test");
+        while (in.read(pkt));
+    }, "Unable to read message from coded stream");
+    unlink(name.c_str());
+}
+
+/**
+ * An indexed file missing its trailer is caught up front.
+ */
+TEST(ProtoIOCorruptTest, TruncatedIndex)
+{
+    const std::string name = tempName("");
+    writeTrace(name, true);
+    truncateFile(name, fileSize(name) - 8);
+
+    gtestLogOutput.str("");
+    EXPECT_THROW(ProtoInputStream in(name), GTestException);
+    EXPECT_NE(gtestLogOutput.str().find("is truncated"), std::string::npos);
+    unlink(name.c_str());
+}
+
+/**
+ * An indexed file whose trailer does not add up is caught up front.
+ */
+TEST(ProtoIOCorruptTest, CorruptIndex)
+{
+    const std::string name = tempName("");
+    writeTrace(name, true);
+    {
+        // bump the number of index entries in the trailer
+        std::fstream file(name,
+                          std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(fileSize(name) - 16);
+        file.put(0x7f);
+    }
+
+    gtestLogOutput.str("");
+    EXPECT_THROW(ProtoInputStream in(name), GTestException);
+    EXPECT_NE(gtestLogOutput.str().find("has a corrupt index"),
+              std::string::npos);
+    unlink(name.c_str());
+}
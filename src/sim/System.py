@@ -50,6 +50,10 @@ class MemoryMode(Enum):
     vals = ["invalid", "atomic", "timing", "atomic_noncaching"]
 
 
+class BackstoreHugePages(ScopedEnum):
+    vals = ["none", "transparent", "hugetlb"]
+
+
 class System(SimObject):
     type = "System"
     cxx_header = "sim/system.hh"
@@ -105,6 +109,28 @@ class System(SimObject):
         "shared_backstore is non-empty.",
     )
 
+    # Large memories suffer from host TLB misses when backed by base
+    # pages. The backing store can either be advised to use transparent
+    # huge pages, or be mapped from the explicitly reserved huge page
+    # pool, falling back to the former if the pool is too small.
+    backstore_huge_pages = Param.BackstoreHugePages(
+        "none", "Host huge pages used for the backing store"
+    )
+    # When several systems are simulated on their own threads, binding
+    # each one's backing store to the node its thread runs on keeps
+    # the memory accesses local on the host.
+    backstore_numa_node = Param.Int(
+        -1,
+        "Host NUMA node to bind the backing store to, "
+        "-1 leaves the placement to the host",
+    )
+    # Uncompressed memory images are not read on restore, but mapped
+    # copy-on-write, so restoring is independent of the memory size and
+    # simulations restoring from the same checkpoint share page cache.
+    checkpoint_compress_memory = Param.Bool(
+        True, "Compress the memory images written to checkpoints"
+    )
+
     cache_line_size = Param.Unsigned(64, "Cache line size in bytes")
 
     redirect_paths = VectorParam.RedirectPath([], "Path redirections")
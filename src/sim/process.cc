@@ -132,8 +132,28 @@ Process::Process(const ProcessParams &params, EmulationPageTable *pTable,
                   params.input, params.output, params.errout)),
       childClearTID(0),
       ADD_STAT(numSyscalls, statistics::units::Count::get(),
-               "Number of system calls")
+               "Number of system calls"),
+      ADD_STAT(ptLookups, statistics::units::Count::get(),
+               "Number of page table lookups and translations"),
+      ADD_STAT(ptCacheHits, statistics::units::Count::get(),
+               "Number of page table lookups served by cached page "
+               "translations"),
+      ADD_STAT(ptHugeCacheHits, statistics::units::Count::get(),
+               "Number of page table lookups served by cached huge page "
+               "translations"),
+      ADD_STAT(ptCacheHitRate, statistics::units::Ratio::get(),
+               "Hit rate of the page table translation cache",
+               (ptCacheHits + ptHugeCacheHits) / ptLookups),
+      ADD_STAT(ptLookupsSaved, statistics::units::Count::get(),
+               "Number of lookups in the page table itself saved by its "
+               "translation cache",
+               ptCacheHits + ptHugeCacheHits)
 {
+    // the page table may be replaced by a shared one on clone
+    ptLookups.functor([this]() { return this->pTable->lookups(); });
+    ptCacheHits.functor([this]() { return this->pTable->pageHits(); });
+    ptHugeCacheHits.functor([this]() { return this->pTable->hugeHits(); });
+
     fatal_if(!seWorkload, "Couldn't find appropriate workload object.");
     fatal_if(_pid >= System::maxPID, "_pid is too large: %d", _pid);
 
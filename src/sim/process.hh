@@ -302,6 +302,14 @@ class Process : public SimObject
 
     // Track how many system calls are executed
     statistics::Scalar numSyscalls;
+
+    // Translations of the page table and how many its translation
+    // cache saved from being looked up in the table itself
+    statistics::Value ptLookups;
+    statistics::Value ptCacheHits;
+    statistics::Value ptHugeCacheHits;
+    statistics::Formula ptCacheHitRate;
+    statistics::Formula ptLookupsSaved;
 };
 
 } // namespace gem5
@@ -0,0 +1,379 @@
+# Copyright (c) 2024 The University of Edinburgh
+# All rights reserved
+#
+# The license below extends only to copyright in the software and shall
+# not be construed as granting a license to any other intellectual
+# property including but not limited to intellectual property relating
+# to a hardware implementation of the functionality of the software
+# licensed hereunder.  You may use the software subject to the license
+# terms below provided that you ensure that this notice is replicated
+# unmodified and in its entirety in all distributions of the software,
+# modified or unmodified, in source code or in binary form.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+"""
+Run a small RISC-V program, built here, that rewrites one of its own
+functions while it is cached by the atomic CPU's decoded block replay,
+and checks that every call sees the latest code:
+
+- the thread stores to the function itself;
+- a thread on the other CPU stores to it (skipped with --noncoherent,
+  as the store is then not snooped);
+- a thread on the other CPU read()s the new code into it, so that the
+  system call writes memory through a port proxy.
+
+With --noncoherent the CPUs are connected by a non-coherent crossbar,
+which hands out back doors to the port proxies, so the last write is not
+snooped at all. The program exits with a non-zero status if any call
+returns stale code.
+"""
+
+import argparse
+import os
+import struct
+
+import m5
+from m5.objects import *
+
+parser = argparse.ArgumentParser()
+parser.add_argument(
+    "--noncoherent",
+    action="store_true",
+    help="Connect the CPUs with a non-coherent crossbar",
+)
+args = parser.parse_args()
+
+base = 0x10000
+mem_size = 0x4000
+
+zero, ra, sp = 0, 1, 2
+t0, s0, s1 = 5, 8, 9
+a0, a1, a2, a3, a4, a7 = 10, 11, 12, 13, 14, 17
+s2, s3 = 18, 19
+
+SYS_READ, SYS_EXIT, SYS_EXIT_GROUP, SYS_CLONE = 63, 93, 94, 220
+CLONE_THREAD_FLAGS = 0x10F00  # VM, FS, FILES, SIGHAND and THREAD
+
+
+class Assembler:
+    """Just enough of an RV64I assembler for the program below"""
+
+    def __init__(self, origin):
+        self.origin = origin
+        self.labels = {}
+        self.code = []
+
+    def pc(self):
+        return self.origin + 4 * len(self.code)
+
+    def label(self, name):
+        self.labels[name] = self.pc()
+
+    def emit(self, encode):
+        # Encoded once all the labels are known
+        pc = self.pc()
+        self.code.append(lambda: encode(pc))
+
+    def assemble(self):
+        return b"".join(struct.pack("<I", c()) for c in self.code)
+
+    def target(self, label, pc):
+        return self.labels[label] - pc
+
+    def i_type(self, op, f3, rd, rs1, imm):
+        assert -2048 <= imm < 2048
+        self.emit(
+            lambda pc: (imm & 0xFFF) << 20
+            | rs1 << 15
+            | f3 << 12
+            | rd << 7
+            | op
+        )
+
+    def addi(self, rd, rs1, imm):
+        self.i_type(0x13, 0, rd, rs1, imm)
+
+    def ld(self, rd, rs1, imm):
+        self.i_type(0x03, 3, rd, rs1, imm)
+
+    def jalr(self, rd, rs1, imm):
+        self.i_type(0x67, 0, rd, rs1, imm)
+
+    def sw(self, rs2, rs1, imm):
+        self.emit(
+            lambda pc: (imm >> 5 & 0x7F) << 25
+            | rs2 << 20
+            | rs1 << 15
+            | 2 << 12
+            | (imm & 0x1F) << 7
+            | 0x23
+        )
+
+    def li(self, rd, value):
+        assert 0 <= value < 0x7FFFF800
+        hi = (value + 0x800) >> 12
+        if hi:
+            self.emit(lambda pc: hi << 12 | rd << 7 | 0x37)
+            self.addi(rd, rd, value - (hi << 12))
+        else:
+            self.addi(rd, zero, value)
+
+    def la(self, rd, label):
+        hi = lambda: (self.labels[label] + 0x800) >> 12
+        self.emit(lambda pc: hi() << 12 | rd << 7 | 0x37)
+        self.emit(
+            lambda pc: (self.labels[label] - (hi() << 12) & 0xFFF) << 20
+            | rd << 15
+            | rd << 7
+            | 0x13
+        )
+
+    def branch(self, f3, rs1, rs2, label):
+        def encode(pc):
+            off = self.target(label, pc)
+            return (
+                (off >> 12 & 1) << 31
+                | (off >> 5 & 0x3F) << 25
+                | rs2 << 20
+                | rs1 << 15
+                | f3 << 12
+                | (off >> 1 & 0xF) << 8
+                | (off >> 11 & 1) << 7
+                | 0x63
+            )
+
+        self.emit(encode)
+
+    def beq(self, rs1, rs2, label):
+        self.branch(0, rs1, rs2, label)
+
+    def bne(self, rs1, rs2, label):
+        self.branch(1, rs1, rs2, label)
+
+    def blt(self, rs1, rs2, label):
+        self.branch(4, rs1, rs2, label)
+
+    def jal(self, rd, label):
+        def encode(pc):
+            off = self.target(label, pc)
+            return (
+                (off >> 20 & 1) << 31
+                | (off >> 1 & 0x3FF) << 21
+                | (off >> 11 & 1) << 20
+                | (off >> 12 & 0xFF) << 12
+                | rd << 7
+                | 0x6F
+            )
+
+        self.emit(encode)
+
+    def ecall(self):
+        self.emit(lambda pc: 0x73)
+
+    def fence_i(self):
+        self.emit(lambda pc: 0x100F)
+
+    def syscall(self, num, *regs):
+        for reg, value in zip((a0, a1, a2, a3, a4), regs):
+            self.li(reg, value)
+        self.li(a7, num)
+        self.ecall()
+
+
+def returns(value):
+    """Encoding of the first instruction of the function returning value"""
+    return value << 20 | a0 << 7 | 0x13
+
+
+# The ELF and program headers come first in the only segment
+code_start = base + 0x80
+stack1 = base + 0x3000
+stack2 = base + 0x4000
+
+asm = Assembler(code_start)
+
+# s0 holds the address of the function, s2 the argument count
+asm.label("entry")
+asm.la(s0, "func")
+asm.ld(s2, sp, 0)
+asm.jal(ra, "func")
+asm.jal(ra, "func")
+asm.li(t0, 1)
+asm.bne(a0, t0, "fail")
+
+# Self-modifying code
+asm.li(t0, returns(2))
+asm.sw(t0, s0, 0)
+asm.fence_i()
+asm.jal(ra, "func")
+asm.li(t0, 2)
+asm.bne(a0, t0, "fail")
+
+# A store from the other CPU, unless any argument is passed
+asm.li(t0, 1)
+asm.bne(s2, t0, "proxy_write")
+asm.syscall(SYS_CLONE, CLONE_THREAD_FLAGS, stack1, 0, 0, 0)
+asm.beq(a0, zero, "store_thread")
+asm.blt(a0, zero, "fail")
+asm.li(a1, 3)
+asm.jal(ra, "wait")
+
+# A write by a system call made on the other CPU. The first thread may
+# still be exiting, so retry until there is a free context.
+asm.label("proxy_write")
+asm.syscall(SYS_CLONE, CLONE_THREAD_FLAGS, stack2, 0, 0, 0)
+asm.beq(a0, zero, "read_thread")
+asm.blt(a0, zero, "proxy_write")
+asm.li(a1, 4)
+asm.jal(ra, "wait")
+asm.syscall(SYS_EXIT_GROUP, 0)
+
+asm.label("fail")
+asm.syscall(SYS_EXIT_GROUP, 1)
+
+# Call the function until it returns a1, or fail after a while
+asm.label("wait")
+asm.addi(s3, ra, 0)
+asm.li(s1, 100000)
+asm.label("wait_loop")
+asm.jal(ra, "func")
+asm.beq(a0, a1, "wait_done")
+asm.addi(s1, s1, -1)
+asm.bne(s1, zero, "wait_loop")
+asm.jal(zero, "fail")
+asm.label("wait_done")
+asm.jalr(zero, s3, 0)
+
+asm.label("store_thread")
+asm.li(t0, returns(3))
+asm.sw(t0, s0, 0)
+asm.syscall(SYS_EXIT, 0)
+
+asm.label("read_thread")
+asm.li(a0, 0)
+asm.addi(a1, s0, 0)
+asm.li(a2, 4)
+asm.li(a7, SYS_READ)
+asm.ecall()
+asm.syscall(SYS_EXIT, 0)
+
+asm.label("func")
+asm.emit(lambda pc: returns(1))
+asm.jalr(zero, ra, 0)
+
+
+code = asm.assemble()
+
+ehdr = struct.pack(
+    "<4sBBBBB7xHHIQQQIHHHHHH",
+    b"\x7fELF",
+    2,  # ELFCLASS64
+    1,  # ELFDATA2LSB
+    1,  # EV_CURRENT
+    3,  # ELFOSABI_LINUX
+    0,
+    2,  # ET_EXEC
+    243,  # EM_RISCV
+    1,
+    asm.labels["entry"],
+    64,  # e_phoff
+    0,  # e_shoff
+    0,  # e_flags
+    64,  # e_ehsize
+    56,  # e_phentsize
+    1,  # e_phnum
+    64,  # e_shentsize
+    0,  # e_shnum
+    0,  # e_shstrndx
+)
+image_size = code_start - base + len(code)
+phdr = struct.pack(
+    "<IIQQQQQQ",
+    1,  # PT_LOAD
+    7,  # PF_R | PF_W | PF_X
+    0,
+    base,
+    base,
+    image_size,
+    mem_size,
+    0x1000,
+)
+header = ehdr + phdr
+header += bytes(code_start - base - len(header))
+
+binary = os.path.join(m5.options.outdir, "code-write")
+with open(binary, "wb") as f:
+    f.write(header + code)
+
+# What the read() system call writes into the function
+code_input = os.path.join(m5.options.outdir, "code-write.in")
+with open(code_input, "wb") as f:
+    f.write(struct.pack("<I", returns(4)))
+
+system = System()
+system.workload = SEWorkload.init_compatible(binary)
+system.clk_domain = SrcClockDomain()
+system.clk_domain.clock = "1GHz"
+system.clk_domain.voltage_domain = VoltageDomain()
+system.mem_mode = "atomic"
+system.mem_ranges = [AddrRange("512MB")]
+
+if args.noncoherent:
+    system.membus = NoncoherentXBar(
+        frontend_latency=1,
+        forward_latency=0,
+        response_latency=1,
+        width=16,
+    )
+else:
+    system.membus = SystemXBar()
+
+cmd = [binary] + (["noncoherent"] if args.noncoherent else [])
+process = Process(executable=binary, cmd=cmd, input=code_input)
+
+system.cpu = [RiscvAtomicSimpleCPU(cpu_id=i) for i in range(2)]
+for cpu in system.cpu:
+    cpu.block_execution = True
+    cpu.icache_port = system.membus.cpu_side_ports
+    cpu.dcache_port = system.membus.cpu_side_ports
+    cpu.workload = process
+    cpu.createThreads()
+    cpu.createInterruptController()
+
+system.mem_ctrl = SimpleMemory(range=system.mem_ranges[0])
+system.mem_ctrl.port = system.membus.mem_side_ports
+system.system_port = system.membus.cpu_side_ports
+
+root = Root(full_system=False, system=system)
+m5.instantiate()
+
+exit_event = m5.simulate()
+print(f"Exiting @ tick {m5.curTick()}: {exit_event.getCause()}")
+
+if exit_event.getCause() != "exiting with last active thread context":
+    exit(1)
+if exit_event.getCode() != 0:
+    print("Stale code was executed")
+    exit(1)
@@ -117,6 +117,11 @@ parser = argparse.ArgumentParser()
 parser.add_argument("binary", type=str)
 parser.add_argument("--cpu")
 parser.add_argument("--mem", choices=valid_mem.keys(), default="SimpleMemory")
+parser.add_argument(
+    "--block-execution",
+    action="store_true",
+    help="Replay decoded basic blocks in the atomic CPU",
+)
 
 args = parser.parse_args()
 
@@ -138,6 +143,8 @@ if args.cpu not in (
 system.mem_ranges = [AddrRange("512MB")]
 
 system.cpu = valid_cpu[args.cpu]()
+if args.block_execution:
+    system.cpu.block_execution = True
 
 if args.cpu in (
     "X86AtomicSimpleCPU",
@@ -95,3 +95,34 @@ for isa in valid_isas:
                 valid_isas=(constants.all_compiled_tag,),
                 fixtures=[workload_binary],
             )
+
+            # Replaying decoded blocks must not change what is executed
+            if "AtomicSimpleCPU" in cpu:
+                gem5_verify_config(
+                    name=f"cpu_test_{cpu}_{workload}_block_execution",
+                    verifiers=verifiers
+                    + (
+                        verifier.MatchStatsOfRun(
+                            joinpath(getcwd(), "run.py"),
+                            [f"--cpu={cpu}", binary],
+                            r"^(simInsts|simOps|system\.cpu\.numCycles|"
+                            r"system\.cpu\.commitStats0\.num(Insts|Ops))$",
+                        ),
+                    ),
+                    config=joinpath(getcwd(), "run.py"),
+                    config_args=[f"--cpu={cpu}", "--block-execution", binary],
+                    valid_isas=(constants.all_compiled_tag,),
+                    fixtures=[workload_binary],
+                )
+
+# Code written by the CPU itself, by another CPU and by a system call
+# through a port proxy must not be replayed from stale decoded blocks
+for noncoherent in (False, True):
+    gem5_verify_config(
+        name="cpu_test_block_execution_code_writes"
+        + ("_noncoherent" if noncoherent else ""),
+        verifiers=(),
+        config=joinpath(getcwd(), "code-write-run.py"),
+        config_args=["--noncoherent"] if noncoherent else [],
+        valid_isas=(constants.all_compiled_tag,),
+    )
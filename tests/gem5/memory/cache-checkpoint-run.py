@@ -0,0 +1,137 @@
+# Copyright (c) 2024 The University of Edinburgh
+# All rights reserved
+#
+# The license below extends only to copyright in the software and shall
+# not be construed as granting a license to any other intellectual
+# property including but not limited to intellectual property relating
+# to a hardware implementation of the functionality of the software
+# licensed hereunder.  You may use the software subject to the license
+# terms below provided that you ensure that this notice is replicated
+# unmodified and in its entirety in all distributions of the software,
+# modified or unmodified, in source code or in binary form.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+"""
+Checkpoint the contents of a two-level cache hierarchy with snoop
+filters, restore it and keep running on a different address range, so
+that the restored blocks, many of them dirty, get evicted through the
+snoop filters.
+
+With --restore-without-contents, the caches of the restored system do not
+save contents of their own. They must still restore those found in the
+checkpoint.
+"""
+
+import argparse
+from multiprocessing import Process
+import os
+import sys
+
+import m5
+from m5.objects import *
+
+m5.util.addToPath("../../../configs/")
+from common.Caches import *
+
+parser = argparse.ArgumentParser()
+parser.add_argument("--restore-without-contents", action="store_true")
+args = parser.parse_args()
+
+nb_cores = 4
+cpus = [
+    MemTest(max_loads=0, percent_uncacheable=0, progress_interval=0)
+    for i in range(nb_cores)
+]
+
+system = System(cpu=cpus, physmem=SimpleMemory(), membus=SystemXBar())
+system.voltage_domain = VoltageDomain()
+system.clk_domain = SrcClockDomain(
+    clock="1GHz", voltage_domain=system.voltage_domain
+)
+system.cpu_clk_domain = SrcClockDomain(
+    clock="2GHz", voltage_domain=system.voltage_domain
+)
+
+system.toL2Bus = L2XBar(clk_domain=system.cpu_clk_domain)
+system.l2c = L2Cache(
+    clk_domain=system.cpu_clk_domain,
+    size="64kB",
+    assoc=8,
+    checkpoint_contents=True,
+)
+system.l2c.cpu_side = system.toL2Bus.mem_side_ports
+system.l2c.mem_side = system.membus.cpu_side_ports
+
+for cpu in cpus:
+    cpu.clk_domain = system.cpu_clk_domain
+    cpu.l1c = L1Cache(size="16kB", assoc=4, checkpoint_contents=True)
+    cpu.l1c.cpu_side = cpu.port
+    cpu.l1c.mem_side = system.toL2Bus.cpu_side_ports
+
+system.system_port = system.membus.cpu_side_ports
+system.physmem.port = system.membus.mem_side_ports
+
+root = Root(full_system=False, system=system)
+
+cpt_dir = os.path.join(m5.options.outdir, "cache.cpt")
+
+
+def populate():
+    """
+    Fill the caches with atomic accesses and checkpoint them. This runs
+    in a child process as a process can only instantiate once.
+    """
+    root.system.mem_mode = "atomic"
+    m5.instantiate()
+    m5.simulate(m5.ticks.fromSeconds(50e-6))
+    m5.checkpoint(cpt_dir)
+    sys.exit(0)
+
+
+p = Process(target=populate)
+p.start()
+p.join()
+if p.exitcode != 0:
+    print("Failed to create the checkpoint.", file=sys.stderr)
+    sys.exit(1)
+
+# Touch other lines than before the checkpoint, the reference data of
+# the testers is not checkpointed, and evict the restored ones
+for cpu in cpus:
+    cpu.base_addr_1 = 0x1000000
+    cpu.base_addr_2 = 0x1400000
+    cpu.max_loads = 1e4
+
+if args.restore_without_contents:
+    system.l2c.checkpoint_contents = False
+    for cpu in cpus:
+        cpu.l1c.checkpoint_contents = False
+
+root.system.mem_mode = "timing"
+m5.instantiate(cpt_dir)
+exit_event = m5.simulate()
+if exit_event.getCause() != "maximum number of loads reached":
+    print(f"Unexpected exit cause: {exit_event.getCause()}", file=sys.stderr)
+    sys.exit(1)
@@ -0,0 +1,154 @@
+# Copyright (c) 2024 The University of Edinburgh
+# All rights reserved
+#
+# The license below extends only to copyright in the software and shall
+# not be construed as granting a license to any other intellectual
+# property including but not limited to intellectual property relating
+# to a hardware implementation of the functionality of the software
+# licensed hereunder.  You may use the software subject to the license
+# terms below provided that you ensure that this notice is replicated
+# unmodified and in its entirety in all distributions of the software,
+# modified or unmodified, in source code or in binary form.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+"""
+Checkpoint the memory of a system uncompressed, restore it, which maps
+the memory image, and checkpoint it again compressed. Then restore that
+checkpoint, which reads the compressed image, and checkpoint it
+uncompressed once more. All three images must hold the same contents.
+
+The uncompressed image is made to start like a gzip stream, so that the
+restore has to go by the format recorded in the checkpoint rather than
+by the contents of the image.
+"""
+
+import gzip
+from multiprocessing import Process
+import os
+import sys
+
+import m5
+from m5.objects import *
+
+mem_size = "16MB"
+image_name = "system.physmem.store0.pmem"
+
+
+def make_root(testers):
+    system = System(
+        physmem=SimpleMemory(range=AddrRange(mem_size)),
+        membus=SystemXBar(),
+        mem_ranges=[AddrRange(mem_size)],
+    )
+    system.voltage_domain = VoltageDomain()
+    system.clk_domain = SrcClockDomain(
+        clock="1GHz", voltage_domain=system.voltage_domain
+    )
+    if testers:
+        system.cpu = [
+            MemTest(
+                max_loads=0,
+                percent_uncacheable=0,
+                progress_interval=0,
+                port=system.membus.cpu_side_ports,
+            )
+            for i in range(2)
+        ]
+    system.system_port = system.membus.cpu_side_ports
+    system.physmem.port = system.membus.mem_side_ports
+    return Root(full_system=False, system=system)
+
+
+def image_mapped(cpt_dir):
+    image = os.path.realpath(os.path.join(cpt_dir, image_name))
+    with open("/proc/self/maps") as maps:
+        return any(line.rstrip().endswith(image) for line in maps)
+
+
+def run(target, *args):
+    # a process can only instantiate once
+    p = Process(target=target, args=args)
+    p.start()
+    p.join()
+    if p.exitcode != 0:
+        sys.exit(p.exitcode)
+
+
+def read_image(cpt_dir, compressed):
+    path = os.path.join(cpt_dir, image_name)
+    with (gzip.open if compressed else open)(path, "rb") as image:
+        return image.read()
+
+
+outdir = m5.options.outdir
+raw_dir = os.path.join(outdir, "raw.cpt")
+gzip_dir = os.path.join(outdir, "gzip.cpt")
+raw_again_dir = os.path.join(outdir, "raw-again.cpt")
+
+
+def populate():
+    root = make_root(testers=True)
+    root.system.checkpoint_compress_memory = False
+    root.system.mem_mode = "atomic"
+    m5.instantiate()
+    m5.simulate(m5.ticks.fromSeconds(50e-6))
+    m5.checkpoint(raw_dir)
+    sys.exit(0)
+
+
+def restore(from_dir, to_dir, compress, mapped):
+    root = make_root(testers=False)
+    root.system.checkpoint_compress_memory = compress
+    m5.instantiate(from_dir)
+    if image_mapped(from_dir) != mapped:
+        print(
+            f"Memory image of {from_dir} was "
+            f"{'not ' if mapped else ''}mapped on restore",
+            file=sys.stderr,
+        )
+        sys.exit(1)
+    m5.checkpoint(to_dir)
+    sys.exit(0)
+
+
+run(populate)
+
+# Make the uncompressed image start with the gzip magic number
+with open(os.path.join(raw_dir, image_name), "r+b") as image:
+    image.write(b"\x1f\x8b")
+expected = read_image(raw_dir, compressed=False)
+if expected.count(0) == len(expected) - 2:
+    print("The testers left the memory empty", file=sys.stderr)
+    sys.exit(1)
+
+run(restore, raw_dir, gzip_dir, True, True)
+if read_image(gzip_dir, compressed=True) != expected:
+    print("Mapped restore changed the memory contents", file=sys.stderr)
+    sys.exit(1)
+
+run(restore, gzip_dir, raw_again_dir, False, False)
+if read_image(raw_again_dir, compressed=False) != expected:
+    print("Compressed restore changed the memory contents", file=sys.stderr)
+    sys.exit(1)
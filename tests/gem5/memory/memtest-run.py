@@ -24,15 +24,40 @@
 # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
+import argparse
+
 import m5
 from m5.objects import *
 
 m5.util.addToPath("../../../configs/")
 from common.Caches import *
 
+parser = argparse.ArgumentParser()
+parser.add_argument(
+    "--percent-cleans",
+    type=int,
+    default=0,
+    help="Percentage of cache cleans to the point of coherency",
+)
+parser.add_argument(
+    "--snoop-filter-assoc",
+    type=int,
+    default=0,
+    help="Model a small snoop filter of this associativity in the L2 "
+    "crossbar, which back-invalidates the L1s",
+)
+args = parser.parse_args()
+
 # MAX CORES IS 8 with the fals sharing method
 nb_cores = 8
-cpus = [MemTest(max_loads=1e5, progress_interval=1e4) for i in range(nb_cores)]
+cpus = [
+    MemTest(
+        max_loads=1e5,
+        progress_interval=1e4,
+        percent_cleans=args.percent_cleans,
+    )
+    for i in range(nb_cores)
+]
 
 # system simulated
 system = System(cpu=cpus, physmem=SimpleMemory(), membus=SystemXBar())
@@ -49,6 +74,9 @@ system.cpu_clk_domain = SrcClockDomain(
 )
 
 system.toL2Bus = L2XBar(clk_domain=system.cpu_clk_domain)
+if args.snoop_filter_assoc:
+    system.toL2Bus.snoop_filter.max_capacity = "32KiB"
+    system.toL2Bus.snoop_filter.assoc = args.snoop_filter_assoc
 system.l2c = L2Cache(clk_domain=system.cpu_clk_domain, size="64kB", assoc=8)
 system.l2c.cpu_side = system.toL2Bus.mem_side_ports
 
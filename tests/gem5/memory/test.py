@@ -31,6 +31,8 @@ TODO: Add stats checking
 
 from testlib import *
 
+import re
+
 gem5_verify_config(
     name="simple_mem_default",
     verifiers=(),  # No need for verfiers this will return non-zero on fail
@@ -70,6 +72,67 @@ gem5_verify_config(
     length=constants.long_tag,
 )
 
+# Cache cleans check that the memory is up to date when they complete,
+# also when they race with snoop filter back-invalidations.
+for name, args in (
+    ("memtest-cmo", ["--percent-cleans=10"]),
+    (
+        "memtest-cmo-back-invalidation",
+        ["--percent-cleans=10", "--snoop-filter-assoc=4"],
+    ),
+):
+    gem5_verify_config(
+        name=name,
+        verifiers=(),  # No need for verfiers this will return non-zero on fail
+        config=joinpath(getcwd(), "memtest-run.py"),
+        config_args=args,
+        valid_isas=(constants.null_tag,),
+        length=constants.long_tag,
+    )
+
+# Restored cache blocks must be known to the snoop filters, or evicting
+# them panics. The run fails on its own, check that something was restored.
+gem5_verify_config(
+    name="cache-checkpoint",
+    verifiers=(
+        verifier.MatchFileRegex(
+            re.compile(r"^system\.l2c\.restoredBlocks\s+[1-9]"),
+            [constants.gem5_simulation_stats],
+        ),
+    ),
+    config=joinpath(getcwd(), "cache-checkpoint-run.py"),
+    config_args=[],
+    valid_isas=(constants.null_tag,),
+    length=constants.long_tag,
+)
+
+# Contents in a checkpoint are restored even by caches that do not save
+# their own
+gem5_verify_config(
+    name="cache-checkpoint-restore-without-contents",
+    verifiers=(
+        verifier.MatchFileRegex(
+            re.compile(r"^system\.l2c\.restoredBlocks\s+[1-9]"),
+            [constants.gem5_simulation_stats],
+        ),
+    ),
+    config=joinpath(getcwd(), "cache-checkpoint-run.py"),
+    config_args=["--restore-without-contents"],
+    valid_isas=(constants.null_tag,),
+    length=constants.long_tag,
+)
+
+# Uncompressed memory images are mapped on restore, compressed ones read,
+# and either way the memory contents survive a round trip
+gem5_verify_config(
+    name="mem-checkpoint",
+    verifiers=(),  # No need for verfiers this will return non-zero on fail
+    config=joinpath(getcwd(), "mem-checkpoint-run.py"),
+    config_args=[],
+    valid_isas=(constants.null_tag,),
+    length=constants.long_tag,
+)
+
 null_tests = [
     ("garnet_synth_traffic", None, ["--sim-cycles", "5000000"]),
     ("memcheck", None, ["--maxtick", "2000000000", "--prefetchers"]),
@@ -122,6 +185,41 @@ null_tests = [
     ("ruby_direct_test", None, ["--requests", "50000"]),
 ]
 
+# Parallel router evaluation must not change the simulated behaviour: the
+# network stats have to match a serial run of the same configuration.
+# Mesh_XY gives every route a single lowest-weight output link, so the
+# serial run drawing route choices from rand() and the parallel run
+# drawing them from per-router generators route the same way.
+garnet_parallel_args = [
+    "--network=garnet",
+    "--topology=Mesh_XY",
+    "--mesh-rows=4",
+    "--num-cpus=16",
+    "--num-dirs=16",
+    "--synthetic=uniform_random",
+    "--injectionrate=0.1",
+    "--sim-cycles=100000",
+]
+garnet_synth_traffic = joinpath(
+    config.base_dir, "configs", "example", "garnet_synth_traffic.py"
+)
+gem5_verify_config(
+    name="garnet_synth_traffic-parallel",
+    fixtures=(),
+    verifiers=(
+        verifier.MatchStatsOfRun(
+            garnet_synth_traffic,
+            garnet_parallel_args + ["--garnet-parallel-threads=0"],
+            r"^(simTicks|system\.ruby\.network\.)",
+        ),
+    ),
+    config=garnet_synth_traffic,
+    config_args=garnet_parallel_args + ["--garnet-parallel-threads=4"],
+    valid_isas=(constants.null_tag,),
+    valid_hosts=constants.supported_hosts,
+    length=constants.long_tag,
+)
+
 for test_name, basename_noext, args in null_tests:
     if basename_noext == None:
         basename_noext = test_name
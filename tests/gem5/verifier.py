@@ -46,7 +46,7 @@ import json
 
 from testlib import test_util
 from testlib.configuration import constants
-from testlib.helper import joinpath, diff_out_file
+from testlib.helper import joinpath, diff_out_file, log_call
 
 
 class Verifier(object):
@@ -330,6 +330,74 @@ class MatchJSONStats(Verifier):
         return self._compare_stats(trusted_file, test_file)
 
 
+class MatchStatsOfRun(Verifier):
+    """
+    Runs gem5 a second time with a reference configuration and checks that
+    the stats matching a regex are identical in both runs. This is used to
+    check that an option (e.g., a parallel implementation) doesn't change
+    the simulated behaviour.
+    """
+
+    def __init__(self, config, config_args, regex, outdir="reference"):
+        """
+        :param config: The config of the reference run.
+        :param config_args: The arguments to the config of the reference run.
+        :param regex: Only stats whose name matches this regex are compared.
+        :param outdir: Output directory of the reference run, relative to
+        the tempdir of the test.
+        """
+        super(MatchStatsOfRun, self).__init__()
+        self.config = config
+        self.config_args = config_args
+        self.regex = re.compile(regex)
+        self.outdir = outdir
+
+    def _read_stats(self, fname):
+        stats = {}
+        with open(fname, "r") as file_:
+            for line in file_:
+                fields = line.split()
+                if len(fields) >= 2 and self.regex.match(fields[0]):
+                    stats[fields[0]] = fields[1:]
+        return stats
+
+    def test(self, params):
+        fixtures = params.fixtures
+        tempdir = fixtures[constants.tempdir_fixture_name].path
+        gem5 = fixtures[constants.gem5_binary_fixture_name].path
+        outdir = joinpath(tempdir, self.outdir)
+
+        command = [gem5, "-d", outdir, "-re", "--silent-redirect"]
+        command.append(self.config)
+        command.extend(self.config_args)
+        log_call(params.log, command, time=params.time)
+
+        test_stats = self._read_stats(
+            joinpath(tempdir, constants.gem5_simulation_stats)
+        )
+        ref_stats = self._read_stats(
+            joinpath(outdir, constants.gem5_simulation_stats)
+        )
+        if not ref_stats:
+            test_util.fail("No stats matching the regex in the reference run")
+
+        diffs = [
+            f"{name}: reference {value}, test {test_stats.get(name)}"
+            for name, value in ref_stats.items()
+            if test_stats.get(name) != value
+        ]
+        diffs += [
+            f"{name}: missing from the reference run"
+            for name in test_stats.keys() - ref_stats.keys()
+        ]
+        if diffs:
+            test_util.fail(
+                "Stats differ from the reference run:\n"
+                + "\n".join(diffs)
+                + f"\nSee {tempdir} for full results"
+            )
+
+
 _re_type = type(re.compile(""))
 
 
@@ -69,17 +69,35 @@
 # types of proto objects can use the same function to decode a single message
 
 import gzip
+import io
 import struct
 
 
 def openFileRd(in_file):
     """
     This opens the file passed as argument for reading using an appropriate
-    function depending on if it is gzipped or not. It returns the file
-    handle.
+    function depending on if it is compressed with zstd, gzipped or not. It
+    returns the file handle.
     """
     try:
-        # First see if this file is gzipped
+        # See if this file is indexed or zstd compressed, the latter
+        # needs the zstandard module
+        with open(in_file, "rb") as f:
+            lead = f.read(4)
+        if lead == b"g5ix":
+            return _openIndexedRd(in_file)
+        is_zstd = lead == b"\x28\xb5\x2f\xfd"
+        if is_zstd:
+            try:
+                import zstandard
+            except ImportError:
+                print("Reading ", in_file, " requires the zstandard module")
+                exit(-1)
+            return zstandard.ZstdDecompressor().stream_reader(
+                open(in_file, "rb")
+            )
+
+        # Otherwise see if this file is gzipped
         try:
             # Opening the file works even if it is not a gzip file
             proto_in = gzip.open(in_file, "rb")
@@ -97,6 +115,38 @@ def openFileRd(in_file):
     return proto_in
 
 
+def _openIndexedRd(in_file):
+    """
+    Indexed files frame independently compressed blocks of messages
+    with a raw header, index and trailer. Strip the framing and return
+    the messages behind a magic number, like in files without index.
+    """
+    with open(in_file, "rb") as f:
+        data = f.read()
+    version, codec = struct.unpack_from("<II", data, 4)
+    index_offset, num_entries, magic, index_magic = struct.unpack_from(
+        "<QQ4s4s", data, len(data) - 24
+    )
+    if version != 1 or magic != b"gem5" or index_magic != b"g5ix":
+        print("Indexed file ", in_file, " is corrupt or unsupported")
+        exit(-1)
+    blocks = data[16:index_offset]
+    if codec == 1:
+        blocks = gzip.decompress(blocks)
+    elif codec == 2:
+        try:
+            import zstandard
+        except ImportError:
+            print("Reading ", in_file, " requires the zstandard module")
+            exit(-1)
+        blocks = (
+            zstandard.ZstdDecompressor()
+            .stream_reader(io.BytesIO(blocks), read_across_frames=True)
+            .read()
+        )
+    return io.BytesIO(b"gem5" + blocks)
+
+
 def _DecodeVarint32(in_file):
     """
     The decoding of the Varint32 is copied from
@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2024 The University of Edinburgh
+ * All rights reserved
+ *
+ * The license below extends only to copyright in the software and shall
+ * not be construed as granting a license to any other intellectual
+ * property including but not limited to intellectual property relating
+ * to a hardware implementation of the functionality of the software
+ * licensed hereunder.  You may use the software subject to the license
+ * terms below provided that you ensure that this notice is replicated
+ * unmodified and in its entirety in all distributions of the software,
+ * modified or unmodified, in source code or in binary form.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Times each family of SVE kernels (unpredicated binary ops, predicated
+ * binary ops and selects, reductions and widening reductions) for every
+ * element size, comparing the host SIMD implementation with the scalar
+ * loops it replaces.
+ *
+ * Usage: sve_kernels_bench [vector length in bits (default 512)]
+ */
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <random>
+
+#include "arch/arm/insts/sve_kernels.hh"
+
+using namespace gem5::ArmISA::sve_kernels;
+
+namespace
+{
+
+constexpr unsigned MaxVecBytes = 256;
+constexpr unsigned Iterations = 2000000;
+
+/** Keep the compiler from optimizing the benchmarked code away. */
+template <typename T>
+inline void
+sink(const T &v)
+{
+    asm volatile("" : : "r,m"(v) : "memory");
+}
+
+template <typename Element>
+struct Regs
+{
+    alignas(16) std::array<Element, MaxVecBytes / sizeof(Element)>
+        src1, src2, dest;
+    std::array<bool, MaxVecBytes> pred;
+
+    Regs()
+    {
+        std::mt19937_64 rng(1);
+        for (unsigned i = 0; i < src1.size(); i++) {
+            src1[i] = rng();
+            src2[i] = rng();
+        }
+        for (auto &p : pred)
+            p = rng() & 1;
+    }
+};
+
+template <typename F>
+double
+nsPerCall(F f)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < Iterations; i++)
+        f();
+    std::chrono::duration<double, std::nano> t =
+        std::chrono::steady_clock::now() - start;
+    return t.count() / Iterations;
+}
+
+void
+report(const char *family, const char *type, double simd, double scalar)
+{
+    std::printf("%-12s %-9s %8.2f %8.2f %6.2fx\n", family, type, simd,
+                scalar, scalar / simd);
+}
+
+template <typename Element>
+void
+benchType(const char *type, unsigned vl_bits)
+{
+    Regs<Element> r;
+    const unsigned count = vl_bits / 8 / sizeof(Element);
+    Element *d = r.dest.data();
+    const Element *a = r.src1.data(), *b = r.src2.data();
+    const bool *p = r.pred.data();
+
+    report("binary", type,
+        nsPerCall([&]{ binary(d, a, b, count, Add()); sink(d[0]); }),
+        nsPerCall([&]{
+            scalar::binary(d, a, b, 0, count, Add()); sink(d[0]); }));
+
+    report("predicated", type,
+        nsPerCall([&]{
+            predBinary(d, a, b, d, p, count, Max()); sink(d[0]); }),
+        nsPerCall([&]{
+            scalar::predBinary(d, a, b, d, p, 0, count, Max());
+            sink(d[0]);
+        }));
+
+    report("select", type,
+        nsPerCall([&]{
+            predBinary(d, a, b, b, p, count, First()); sink(d[0]); }),
+        nsPerCall([&]{
+            scalar::predBinary(d, a, b, b, p, 0, count, First());
+            sink(d[0]);
+        }));
+
+    const Element max = std::numeric_limits<Element>::max();
+    report("reduce", type,
+        nsPerCall([&]{ sink(reduce(a, p, count, max, Min())); }),
+        nsPerCall([&]{
+            sink(scalar::reduce(a, p, 0, count, max, Min())); }));
+
+    using Acc = std::conditional_t<std::is_signed_v<Element>,
+                                   int64_t, uint64_t>;
+    report("widen-reduce", type,
+        nsPerCall([&]{ sink(reduceWiden(a, p, count, Acc(0), Add())); }),
+        nsPerCall([&]{
+            sink(scalar::reduce(a, p, 0, count, Acc(0), Add())); }));
+}
+
+} // anonymous namespace
+
+int
+main(int argc, char **argv)
+{
+    const unsigned vl_bits = argc > 1 ? std::atoi(argv[1]) : 512;
+    if (vl_bits < 128 || vl_bits > 2048 || vl_bits % 128) {
+        std::fprintf(stderr, "Vector length must be a multiple of 128 "
+                     "between 128 and 2048 bits\n");
+        return 1;
+    }
+
+    std::printf("VL %u bits, host vectors of %zu bytes\n", vl_bits,
+                HostVecBytes);
+    std::printf("%-12s %-9s %8s %8s %7s\n", "family", "type", "simd ns",
+                "scalar ns", "speedup");
+    benchType<uint8_t>("uint8", vl_bits);
+    benchType<int16_t>("int16", vl_bits);
+    benchType<uint32_t>("uint32", vl_bits);
+    benchType<int64_t>("int64", vl_bits);
+    return 0;
+}